@@ -1,119 +1,271 @@
 #include "beep.h"
-#include "delay.h"
+#include "beep_tone.h"
+
+#define BEEP_ALARM_STEP_MS  200     // 持续报警音每200ms切换一次
+
+static uint32_t beep_tim_clk;                   // TIM13/TIM6的定时器时钟
+static const Beep_Note_t * volatile beep_song;  // 正在播放的乐谱，NULL表示没有播放
+static uint16_t beep_song_len;
+static volatile uint16_t beep_song_pos;         // 正在播放的音符，仅在中断中推进
+static uint8_t beep_song_loop;                  // 播放完是否从头重复
+static Beep_Note_t beep_single;                 // Beep_Tone的单音符乐谱
+
+// 报警音乐: Do-Do-Sol-Sol-La-La-Sol
+static const Beep_Note_t beep_alarm_song[] = {
+    {DO, 200},  {0, 50},
+    {DO, 200},  {0, 50},
+    {SOL, 200}, {0, 50},
+    {SOL, 200}, {0, 50},
+    {LA, 300},  {0, 100},
+    {LA, 300},  {0, 100},
+    {SOL, 200}, {0, 50},
+};
+
+// 持续报警音: 响200ms、停200ms，循环播放
+static const Beep_Note_t beep_continuous_song[] = {
+    {BEEP_ALARM_FREQ, BEEP_ALARM_STEP_MS},
+    {0, BEEP_ALARM_STEP_MS},
+};
+
+// 设置比较值并立即生效：产生更新事件装入预装载的PSC/ARR/CCR，计数器清零
+static void beep_output(uint16_t ccr)
+{
+    TIM_SetCompare1(BEEP_TIM, ccr);
+    TIM_GenerateEvent(BEEP_TIM, TIM_EventSource_Update);
+}
+
+// 按频率输出PWM，0或超出范围时静音
+static void beep_set_freq(uint16_t freq)
+{
+    Beep_Tone_t tone;
+
+    if(freq == 0 || Beep_Tone_Calc(beep_tim_clk, freq, BEEP_DUTY, &tone) != 0)
+    {
+        beep_output(0);
+        return;
+    }
+    TIM_PrescalerConfig(BEEP_TIM, tone.psc, TIM_PSCReloadMode_Update);
+    TIM_SetAutoreload(BEEP_TIM, tone.arr);
+    beep_output(tone.ccr);
+}
+
+// 输出第pos个音符，并让节拍定时器在音符结束时产生中断
+static void beep_play_note(uint16_t pos)
+{
+    beep_set_freq(beep_song[pos].freq);
+    // 更新中断里计数器刚清零，ARR不预装载，改动对本次计数立即生效
+    TIM_SetAutoreload(BEEP_SEQ_TIM, Beep_Tone_Ticks(BEEP_SEQ_TICK_HZ, beep_song[pos].ms) - 1);
+}
+
+// 停止播放，调用者已关中断或在节拍中断中
+static void beep_stop(void)
+{
+    TIM_Cmd(BEEP_SEQ_TIM, DISABLE);
+    TIM_ClearITPendingBit(BEEP_SEQ_TIM, TIM_IT_Update);
+    beep_song = 0;
+}
+
+// 从第一个音符开始播放乐谱
+static void beep_play(const Beep_Note_t *song, uint16_t len, uint8_t loop)
+{
+    uint32_t primask;
+
+    // 与节拍中断互斥：换乐谱和重启定时器必须是一个整体
+    primask = __get_PRIMASK();
+    __disable_irq();
+    beep_stop();
+    beep_song = song;
+    beep_song_len = len;
+    beep_song_loop = loop;
+    beep_song_pos = 0;
+    TIM_SetCounter(BEEP_SEQ_TIM, 0);
+    beep_play_note(0);
+    TIM_Cmd(BEEP_SEQ_TIM, ENABLE);
+    __set_PRIMASK(primask);
+}
 
 // 初始化蜂鸣器
 void Beep_Init(void)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_TimeBaseInitTypeDef tb;
+    TIM_OCInitTypeDef oc;
+    NVIC_InitTypeDef nvic;
+    RCC_ClocksTypeDef clocks;
 
-    // 使能GPIOF的时钟
-    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOF, ENABLE);
+    // 使能GPIOF和定时器的时钟
+    RCC_AHB1PeriphClockCmd(BEEP_RCC, ENABLE);
+    RCC_APB1PeriphClockCmd(BEEP_TIM_RCC | BEEP_SEQ_TIM_RCC, ENABLE);
 
-    // 配置BEEP (PF8) 为推挽输出模式
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_8;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_100MHz;
+    // 配置BEEP (PF8) 为复用推挽输出，由TIM13_CH1驱动
+    GPIO_InitStructure.GPIO_Pin = BEEP_PIN;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
     GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
     GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;
-    GPIO_Init(GPIOF, &GPIO_InitStructure);
-    
-    // 默认关闭蜂鸣器
-    GPIO_ResetBits(BEEP_GPIO, BEEP_PIN);
+    GPIO_Init(BEEP_GPIO, &GPIO_InitStructure);
+    GPIO_PinAFConfig(BEEP_GPIO, GPIO_PinSource8, GPIO_AF_TIM13);
+
+    // APB1分频不为1时定时器时钟为PCLK1的两倍
+    RCC_GetClocksFreq(&clocks);
+    beep_tim_clk = clocks.PCLK1_Frequency;
+    if(clocks.PCLK1_Frequency != clocks.HCLK_Frequency)
+    {
+        beep_tim_clk *= 2;
+    }
+
+    // TIM13: PWM1模式，ARR和CCR预装载，换音调时在更新事件一起生效；默认比较值为0，输出低电平
+    tb.TIM_Prescaler = 0;
+    tb.TIM_CounterMode = TIM_CounterMode_Up;
+    tb.TIM_Period = BEEP_TONE_ARR_MAX;
+    tb.TIM_ClockDivision = TIM_CKD_DIV1;
+    tb.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(BEEP_TIM, &tb);
+
+    TIM_OCStructInit(&oc);
+    oc.TIM_OCMode = TIM_OCMode_PWM1;
+    oc.TIM_OutputState = TIM_OutputState_Enable;
+    oc.TIM_Pulse = 0;
+    oc.TIM_OCPolarity = TIM_OCPolarity_High;
+    TIM_OC1Init(BEEP_TIM, &oc);
+    TIM_OC1PreloadConfig(BEEP_TIM, TIM_OCPreload_Enable);
+    TIM_ARRPreloadConfig(BEEP_TIM, ENABLE);
+    TIM_Cmd(BEEP_TIM, ENABLE);
+
+    // TIM6: 节拍定时器，每个音符结束时中断一次，切换到下一个音符
+    tb.TIM_Prescaler = (uint16_t)(beep_tim_clk / BEEP_SEQ_TICK_HZ - 1);
+    tb.TIM_Period = 0xFFFF;
+    TIM_TimeBaseInit(BEEP_SEQ_TIM, &tb);
+    TIM_ClearITPendingBit(BEEP_SEQ_TIM, TIM_IT_Update);
+    TIM_ITConfig(BEEP_SEQ_TIM, TIM_IT_Update, ENABLE);
+
+    // 切换音符晚一点听不出来，取最低抢占优先级
+    nvic.NVIC_IRQChannel = BEEP_SEQ_TIM_IRQn;
+    nvic.NVIC_IRQChannelPreemptionPriority = 3;
+    nvic.NVIC_IRQChannelSubPriority = 3;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    beep_song = 0;
 }
 
-// 打开蜂鸣器
+// 打开蜂鸣器：比较值大于ARR，输出恒为高电平
 void Beep_On(void)
 {
-    GPIO_SetBits(BEEP_GPIO, BEEP_PIN);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    beep_stop();
+    beep_output(BEEP_TONE_ARR_MAX + 1);
+    __set_PRIMASK(primask);
 }
 
 // 关闭蜂鸣器
 void Beep_Off(void)
 {
-    GPIO_ResetBits(BEEP_GPIO, BEEP_PIN);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    beep_stop();
+    beep_output(0);
+    __set_PRIMASK(primask);
 }
 
 /**
- * @brief 蜂鸣器发出指定频率和持续时间的音调
+ * @brief 蜂鸣器发出指定频率和持续时间的音调，由定时器输出，立即返回
  * @param freq: 频率 (Hz), 0表示静音
- * @param duration_ms: 持续时间 (毫秒)
+ * @param duration_ms: 持续时间 (毫秒), 0表示一直响到Beep_Off
+ * @note  打断正在播放的报警音
  */
-void Beep_Tone(uint32_t freq, uint32_t duration_ms) 
+void Beep_Tone(uint32_t freq, uint32_t duration_ms)
 {
-    if (freq == 0) {
-        // 静音
-        GPIO_ResetBits(BEEP_GPIO, BEEP_PIN);
-        Mdelay_Lib(duration_ms);
+    uint32_t primask;
+
+    if(duration_ms == 0)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        beep_stop();
+        beep_set_freq(freq > 0xFFFF ? 0 : (uint16_t)freq);
+        __set_PRIMASK(primask);
         return;
     }
-    
-    // 计算半周期时间 (单位: 微秒)
-    uint32_t half_period_us = 500000 / freq;
-    uint32_t cycles = (duration_ms * 1000) / (2 * half_period_us);
-    
-    for (uint32_t i = 0; i < cycles; i++) {
-        GPIO_SetBits(BEEP_GPIO, BEEP_PIN);
-        Udelay_Lib(half_period_us);
-        GPIO_ResetBits(BEEP_GPIO, BEEP_PIN);
-        Udelay_Lib(half_period_us);
-    }
+
+    // 单音符乐谱，关中断改写，节拍中断不会读到一半
+    primask = __get_PRIMASK();
+    __disable_irq();
+    beep_single.freq = freq > 0xFFFF ? 0 : (uint16_t)freq;
+    beep_single.ms = duration_ms > 0xFFFF ? 0xFFFF : (uint16_t)duration_ms;
+    beep_play(&beep_single, 1, 0);
+    __set_PRIMASK(primask);
 }
 
 /**
- * @brief 播放报警音乐 - 简单的警示音
+ * @brief 播放报警音乐 - 简单的警示音，立即返回，由定时器中断逐个音符播放
  */
 void Beep_PlayAlarm(void)
 {
-    // 播放一个简单的报警音调: Do-Sol-Do-Sol
-    Beep_Tone(DO, 200);   // Do 0.2秒
-    Beep_Tone(0, 50);     // 静音 0.05秒
-
-    Beep_Tone(DO, 200);   // Do 0.2秒
-    Beep_Tone(0, 50);     // 静音 0.05秒
-    
-    Beep_Tone(SOL, 200);  // Sol 0.2秒
-    Beep_Tone(0, 50);     // 静音 0.05秒
-
-    Beep_Tone(SOL, 200);  // Sol 0.2秒
-    Beep_Tone(0, 50);     // 静音 0.05秒
-
-    Beep_Tone(LA, 300); // 高音Do 0.3秒
-    Beep_Tone(0, 100);    // 静音 0.1秒
+    beep_play(beep_alarm_song, sizeof(beep_alarm_song) / sizeof(beep_alarm_song[0]), 0);
+}
 
-    Beep_Tone(LA, 300); // 高音Do 0.3秒
-    Beep_Tone(0, 100);    // 静音 0.1秒
+/**
+ * @brief 持续报警音 - 响200ms、停200ms循环，直到Beep_StopAlarm
+ * @note  已在响时再次调用不影响节拍，可以在报警检查中反复调用
+ */
+void Beep_ContinuousAlarm(void)
+{
+    if(beep_song != beep_continuous_song)
+    {
+        beep_play(beep_continuous_song, sizeof(beep_continuous_song) / sizeof(beep_continuous_song[0]), 1);
+    }
+}
 
-    Beep_Tone(SOL, 200);  // Sol 0.2秒
-    Beep_Tone(0, 50);     // 静音 0.05秒
+/**
+ * @brief 停止持续报警音并关闭蜂鸣器
+ */
+void Beep_StopAlarm(void)
+{
+    Beep_Off();
+}
 
+/**
+ * @brief 是否正在播放乐谱或单个音调
+ * @note  播放时不能进入Stop模式，定时器时钟停止后音符不会切换
+ */
+uint8_t Beep_Playing(void)
+{
+    return beep_song != 0;
 }
 
 /**
- * @brief 持续报警音 - 新增函数，专门用于持续报警
+ * @brief 节拍中断：当前音符结束，切换到下一个音符
  */
-void Beep_ContinuousAlarm(void)
+void TIM6_DAC_IRQHandler(void)
 {
-    static uint32_t alarm_step = 0;
-    static uint32_t last_step_time = 0;
-    extern uint32_t system_tick;  // 使用系统时钟
-    
-    // 每200ms切换一次状态，形成连续的报警音
-    if(system_tick - last_step_time >= 200)
+    uint16_t pos;
+
+    // 停止播放时已清除的中断标志可能仍在NVIC中挂起，不能当作音符结束
+    if(TIM_GetITStatus(BEEP_SEQ_TIM, TIM_IT_Update) == RESET)
     {
-        last_step_time = system_tick;
-        
-        switch(alarm_step % 4)
+        return;
+    }
+    TIM_ClearITPendingBit(BEEP_SEQ_TIM, TIM_IT_Update);
+    if(beep_song == 0)
+    {
+        return;
+    }
+
+    pos = beep_song_pos + 1;
+    if(pos >= beep_song_len)
+    {
+        if(!beep_song_loop)
         {
-            case 0:
-            case 2:
-                GPIO_SetBits(BEEP_GPIO, BEEP_PIN);  // 蜂鸣器响
-                break;
-            case 1:
-            case 3:
-                GPIO_ResetBits(BEEP_GPIO, BEEP_PIN); // 蜂鸣器停
-                break;
+            beep_stop();
+            beep_output(0);
+            return;
         }
-        alarm_step++;
+        pos = 0;
     }
+    beep_song_pos = pos;
+    beep_play_note(pos);
 }
-
@@ -3,11 +3,22 @@
 
 #include "stm32f4xx.h"
 
-//Beep PF8
+//Beep PF8 -> TIM13_CH1 (AF9)
 #define BEEP_PIN GPIO_Pin_8
 #define BEEP_GPIO GPIOF
 #define BEEP_RCC RCC_AHB1Periph_GPIOF
 
+// 音调输出定时器，PWM频率和占空比由硬件产生
+#define BEEP_TIM            TIM13
+#define BEEP_TIM_RCC        RCC_APB1Periph_TIM13
+#define BEEP_DUTY           50          // 音调的占空比 (%)
+
+// 节拍定时器，每个音符结束时中断一次切换到下一个音符
+#define BEEP_SEQ_TIM        TIM6
+#define BEEP_SEQ_TIM_RCC    RCC_APB1Periph_TIM6
+#define BEEP_SEQ_TIM_IRQn   TIM6_DAC_IRQn
+#define BEEP_SEQ_TICK_HZ    2000        // 节拍定时器计数频率，音符最长约32秒
+
 // 音符频率定义 (单位: Hz)
 #define DO   262  // Do
 #define RE   294  // Re
@@ -18,6 +29,8 @@
 #define SI   494  // Si
 #define DO_H 523  // 高音Do
 
+#define BEEP_ALARM_FREQ DO_H    // 持续报警音的频率
+
 //蜂鸣器初始化
 //BEEP -> PF8 -> GPIOF
 void Beep_Init(void);
@@ -28,10 +41,12 @@ void Beep_On(void);
 //关闭蜂鸣器
 void Beep_Off(void);
 
-// 音乐蜂鸣器功能
+// 音乐蜂鸣器功能，都由定时器在后台播放，调用后立即返回
 void Beep_Tone(uint32_t freq, uint32_t duration_ms);
 void Beep_PlayAlarm(void);  // 播放报警音
 void Beep_ContinuousAlarm(void);  // 持续报警音
+void Beep_StopAlarm(void);        // 停止持续报警音
+uint8_t Beep_Playing(void);       // 是否正在播放
 
 // 音乐开关控制功能
 void Beep_SetMusicMode(uint8_t enable);  // 设置音乐模式开关
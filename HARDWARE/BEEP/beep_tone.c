@@ -0,0 +1,75 @@
+#include "beep_tone.h"
+
+/**
+ * @file    beep_tone.c
+ * @brief   蜂鸣器PWM音调参数计算源文件
+ */
+
+/**
+ * @brief  计算输出指定频率和占空比所需的定时器参数
+ */
+uint8_t Beep_Tone_Calc(uint32_t clk_hz, uint32_t freq_hz, uint8_t duty, Beep_Tone_t *tone)
+{
+    uint32_t counts, div, period;
+
+    if(freq_hz == 0 || clk_hz / freq_hz < BEEP_TONE_PERIOD_MIN)
+    {
+        return 1;
+    }
+    if(duty > 100)
+    {
+        duty = 100;
+    }
+
+    /* 一个周期的定时器时钟数，四舍五入 */
+    counts = clk_hz / freq_hz;
+    if(clk_hz % freq_hz >= freq_hz - freq_hz / 2)
+    {
+        counts++;
+    }
+
+    /* 最小的PSC+1使ARR+1不超过ARR上限+1，向上取整；先除后加，counts接近32位上限也不溢出 */
+    div = counts / (BEEP_TONE_ARR_MAX + 1);
+    if(counts % (BEEP_TONE_ARR_MAX + 1))
+    {
+        div++;
+    }
+    if(div > 65536)
+    {
+        return 1;
+    }
+    period = counts / div;
+    if(counts % div >= div - div / 2)
+    {
+        period++;
+    }
+
+    tone->psc = (uint16_t)(div - 1);
+    tone->arr = (uint16_t)(period - 1);
+    tone->ccr = (uint16_t)((period * duty + 50) / 100);
+    return 0;
+}
+
+/**
+ * @brief  音符时长换算成节拍定时器的计数值
+ */
+uint32_t Beep_Tone_Ticks(uint32_t tick_hz, uint32_t ms)
+{
+    uint32_t ticks;
+
+    /* 整秒和余下的毫秒分开算，避免乘法溢出 */
+    if(ms / 1000 > 65536 / tick_hz)
+    {
+        return 65536;
+    }
+    ticks = ms / 1000 * tick_hz + (ms % 1000 * tick_hz + 500) / 1000;
+    if(ticks < 2)
+    {
+        return 2;
+    }
+    if(ticks > 65536)
+    {
+        return 65536;
+    }
+    return ticks;
+}
@@ -0,0 +1,54 @@
+#ifndef __BEEP_TONE_H
+#define __BEEP_TONE_H
+
+/**
+ * @file    beep_tone.h
+ * @brief   蜂鸣器PWM音调参数计算
+ * @details 16位定时器输出PWM：计数频率 = 定时器时钟 / (PSC+1)，
+ *          输出频率 = 计数频率 / (ARR+1)，PWM1模式下CNT < CCR时输出高电平。
+ *          先把一个周期四舍五入成定时器时钟数，再取使ARR不超过上限的最小PSC，
+ *          ARR尽量大，频率误差最小，占空比的分辨率也最高。
+ *          ARR上限取65534，占空比100%时CCR = ARR+1仍能放进16位寄存器，输出恒为高。
+ *          乐谱是{频率, 时长}的数组，由定时器中断逐个音符切换。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define BEEP_TONE_ARR_MAX       65534u      /* ARR上限 */
+#define BEEP_TONE_PERIOD_MIN    100u        /* 一个周期至少的定时器时钟数，保证1%的占空比分辨率 */
+
+/**
+ * @brief  一个音调的定时器参数
+ */
+typedef struct {
+    uint16_t psc;               /* 预分频 */
+    uint16_t arr;               /* 自动重装值 */
+    uint16_t ccr;               /* 比较值 */
+} Beep_Tone_t;
+
+/**
+ * @brief  乐谱中的一个音符
+ */
+typedef struct {
+    uint16_t freq;              /* 频率，Hz，0为静音 */
+    uint16_t ms;                /* 时长，ms */
+} Beep_Note_t;
+
+/**
+ * @brief  计算输出指定频率和占空比所需的定时器参数
+ * @param  clk_hz: 定时器时钟，Hz
+ * @param  freq_hz: 频率，Hz
+ * @param  duty: 占空比，百分数，超过100按100
+ * @retval 0-成功, 1-频率为0或超出定时器能输出的范围
+ */
+uint8_t Beep_Tone_Calc(uint32_t clk_hz, uint32_t freq_hz, uint8_t duty, Beep_Tone_t *tone);
+
+/**
+ * @brief  音符时长换算成节拍定时器的计数值（ARR+1）
+ * @param  tick_hz: 节拍定时器的计数频率
+ * @retval 计数值，2~65536，ARR为0时定时器不计数，不足两个计数按两个，超出按65536
+ */
+uint32_t Beep_Tone_Ticks(uint32_t tick_hz, uint32_t ms);
+
+#endif /* __BEEP_TONE_H */
@@ -1,4 +1,5 @@
 #include "bluetooth.h"
+#include "uart.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -10,6 +11,7 @@ static uint8_t bt_recv_index = 0;       // 接收索引
 /* 外部变量（在main.c中定义）*/
 extern char bt_command_buffer[20];      // 命令缓冲区
 extern uint8_t bt_command_ready;        // 命令就绪标志
+extern uint32_t bt_command_stamp;       // 命令收到时刻（DWT周期计数）
 
 /**
  * @brief  蓝牙模块初始化
@@ -35,12 +37,8 @@ void Bluetooth_Init(void)
  */
 void Bluetooth_SendString(char* str)
 {
-    while(*str)
-    {
-        // 等待发送缓冲区空
-        while(USART_GetFlagStatus(BLUETOOTH_UART, USART_FLAG_TXE) == RESET);
-        USART_SendData(BLUETOOTH_UART, *str++);
-    }
+    // 入队后立即返回，由DMA在后台发送
+    UART_SendString(BLUETOOTH_UART, str);
 }
 
 /**
@@ -51,22 +49,19 @@ void Bluetooth_SendString(char* str)
  */
 void Bluetooth_SendData(uint8_t* data, uint16_t len)
 {
-    for(uint16_t i = 0; i < len; i++)
-    {
-        while(USART_GetFlagStatus(BLUETOOTH_UART, USART_FLAG_TXE) == RESET);
-        USART_SendData(BLUETOOTH_UART, data[i]);
-    }
+    UART_Write(BLUETOOTH_UART, data, len);
 }
 
 /**
- * @brief  处理接收到的蓝牙数据（由UART中断调用）
+ * @brief  处理接收到的蓝牙数据（由UART_Poll调用）
  * @param  ch: 接收到的字符
  * @retval None
- * @note   此函数由uart.c中的中断处理函数调用
+ * @note   中断只把数据放入接收队列，此函数在主循环上下文中执行，
+ *         因此回显和写命令缓冲区都不会与main.c的读取发生竞争
  */
 void Bluetooth_ProcessRxData(uint8_t ch)
 {
-    // 回显收到的字符
+    // 回显收到的字符（只入队，不阻塞）
     Bluetooth_SendData(&ch, 1);
     
     // 处理命令接收
@@ -79,7 +74,8 @@ void Bluetooth_ProcessRxData(uint8_t ch)
             // 复制到命令缓冲区
             if(bt_recv_index < 20)
             {
-                strcpy(bt_command_buffer, bt_recv_buffer);
+                memcpy(bt_command_buffer, bt_recv_buffer, bt_recv_index + 1);
+                bt_command_stamp = UART_GetRxStamp(BLUETOOTH_UART);
                 bt_command_ready = 1;
             }
             
@@ -0,0 +1,364 @@
+#include "bt_cmd.h"
+#include <stddef.h>
+
+/**
+ * @file    bt_cmd.c
+ * @brief   蓝牙命令表驱动分发器源文件
+ */
+
+#define BT_CMD_FNV_OFFSET       2166136261u
+#define BT_CMD_FNV_PRIME        16777619u
+#define BT_CMD_SEED_TRIES       4096    /* 寻找哈希乘子的最大尝试次数 */
+
+/**
+ * @brief  FNV-1a哈希累加一个字符
+ */
+static uint32_t BT_Cmd_HashChar(uint32_t h, char c)
+{
+    return (h ^ (uint8_t)c) * BT_CMD_FNV_PRIME;
+}
+
+/**
+ * @brief  哈希值映射到槽位
+ */
+static uint32_t BT_Cmd_Slot(uint32_t h, uint32_t seed)
+{
+    return (h * seed) >> (32 - BT_CMD_HASH_BITS);
+}
+
+/**
+ * @brief  是否为数字参数的起始字符
+ */
+static uint8_t BT_Cmd_IsNumStart(char c)
+{
+    return (uint8_t)((c >= '0' && c <= '9') || c == '-' || c == '+');
+}
+
+/**
+ * @brief  比较两个以'\0'结尾的命令名
+ * @retval 1-相同, 0-不同
+ */
+static uint8_t BT_Cmd_NameEqual(const char *a, const char *b)
+{
+    while(*a != '\0' && *a == *b)
+    {
+        a++;
+        b++;
+    }
+    return (uint8_t)(*a == *b);
+}
+
+/**
+ * @brief  用给定乘子尝试建立哈希表
+ * @retval 0-无冲突, 1-有冲突
+ */
+static uint8_t BT_Cmd_TrySeed(BT_CmdDispatcher_t *d, uint32_t seed)
+{
+    uint8_t i;
+    uint32_t s;
+
+    for(s = 0; s < BT_CMD_HASH_SLOTS; s++)
+    {
+        d->slots[s] = 0;
+    }
+
+    for(i = 0; i < d->count; i++)
+    {
+        s = BT_Cmd_Slot(d->hashes[i], seed);
+        if(d->slots[s] != 0)
+        {
+            return 1;
+        }
+        d->slots[s] = i + 1;
+    }
+
+    d->seed = seed;
+    return 0;
+}
+
+/**
+ * @brief  初始化分发器
+ * @param  d: 分发器
+ * @param  table: 命令表
+ * @param  count: 命令数量，不超过BT_CMD_HASH_SLOTS/2
+ * @retval 0-成功, 1-命令名或编号重复/找不到无冲突的哈希
+ */
+uint8_t BT_Cmd_Init(BT_CmdDispatcher_t *d, const BT_CmdEntry_t *table, uint8_t count)
+{
+    uint8_t i, j;
+    uint32_t h, seed, tries;
+    const char *p;
+
+    if(count > BT_CMD_HASH_SLOTS / 2)
+    {
+        return 1;
+    }
+
+    d->table = table;
+    d->count = count;
+    d->executed = 0;
+    d->errors = 0;
+
+    for(i = 0; i < BT_CMD_OPCODE_COUNT; i++)
+    {
+        d->opcodes[i] = 0;
+    }
+
+    /* 先借用hashes[]按表项顺序存放哈希值，建表完成后再按槽位重排 */
+    for(i = 0; i < count; i++)
+    {
+        h = BT_CMD_FNV_OFFSET;
+        for(p = table[i].name; *p != '\0'; p++)
+        {
+            h = BT_Cmd_HashChar(h, *p);
+        }
+        d->hashes[i] = h;
+
+        for(j = 0; j < i; j++)
+        {
+            if(BT_Cmd_NameEqual(table[i].name, table[j].name))
+            {
+                return 1;
+            }
+        }
+
+        if(table[i].opcode != BT_CMD_NO_OPCODE)
+        {
+            if(table[i].opcode >= BT_CMD_OPCODE_COUNT || d->opcodes[table[i].opcode] != 0)
+            {
+                return 1;
+            }
+            d->opcodes[table[i].opcode] = i + 1;
+        }
+    }
+
+    /* 线性同余序列生成奇数乘子，直到所有命令落在不同槽位 */
+    seed = 0x9E3779B1u;
+    for(tries = 0; tries < BT_CMD_SEED_TRIES; tries++)
+    {
+        if(BT_Cmd_TrySeed(d, seed | 1u) == 0)
+        {
+            break;
+        }
+        seed = seed * 1664525u + 1013904223u;
+    }
+    if(tries == BT_CMD_SEED_TRIES)
+    {
+        return 1;
+    }
+
+    /* hashes[]改为按槽位存放，查找时先比哈希再比名称 */
+    {
+        uint32_t by_entry[BT_CMD_HASH_SLOTS / 2];
+        uint32_t s;
+
+        for(i = 0; i < count; i++)
+        {
+            by_entry[i] = d->hashes[i];
+        }
+        for(s = 0; s < BT_CMD_HASH_SLOTS; s++)
+        {
+            d->hashes[s] = (d->slots[s] != 0) ? by_entry[d->slots[s] - 1] : 0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  解析可选的数字参数
+ * @param  p: 参数起始位置
+ * @param  value: 输入默认值，输出解析结果
+ * @retval BT_CMD_OK 或 BT_CMD_ERR_ARG
+ */
+static BT_CmdStatus_t BT_Cmd_ParseValue(const char *p, int32_t *value)
+{
+    int32_t v = 0;
+    uint8_t neg = 0;
+    uint8_t digits = 0;
+
+    while(*p == ' ')
+    {
+        p++;
+    }
+    if(*p == '\0')
+    {
+        return BT_CMD_OK;
+    }
+
+    if(*p == '-' || *p == '+')
+    {
+        neg = (uint8_t)(*p == '-');
+        p++;
+    }
+
+    while(*p >= '0' && *p <= '9')
+    {
+        /* 最多9位，保证不溢出int32 */
+        if(++digits > 9)
+        {
+            return BT_CMD_ERR_ARG;
+        }
+        v = v * 10 + (*p - '0');
+        p++;
+    }
+    if(digits == 0)
+    {
+        return BT_CMD_ERR_ARG;
+    }
+
+    while(*p == ' ')
+    {
+        p++;
+    }
+    if(*p != '\0')
+    {
+        return BT_CMD_ERR_ARG;
+    }
+
+    *value = neg ? -v : v;
+    return BT_CMD_OK;
+}
+
+/**
+ * @brief  查找文字命令
+ * @param  d: 分发器
+ * @param  pp: 输入命令起始位置，输出参数起始位置
+ * @retval 匹配的表项，未找到返回NULL
+ */
+static const BT_CmdEntry_t *BT_Cmd_LookupName(const BT_CmdDispatcher_t *d, const char **pp)
+{
+    char name[BT_CMD_NAME_MAX + 1];
+    uint8_t n = 0;
+    uint32_t h = BT_CMD_FNV_OFFSET;
+    uint32_t s;
+    const char *p = *pp;
+    char c;
+
+    /* 一遍扫描：单词转大写、合并多余空格、同时计算哈希，遇到数字参数停止 */
+    for(;;)
+    {
+        while(*p != '\0' && *p != ' ')
+        {
+            c = *p++;
+            if(c >= 'a' && c <= 'z')
+            {
+                c = (char)(c - 'a' + 'A');
+            }
+            if(n >= BT_CMD_NAME_MAX)
+            {
+                return NULL;
+            }
+            name[n++] = c;
+            h = BT_Cmd_HashChar(h, c);
+        }
+
+        while(*p == ' ')
+        {
+            p++;
+        }
+        if(*p == '\0' || BT_Cmd_IsNumStart(*p))
+        {
+            break;
+        }
+
+        if(n >= BT_CMD_NAME_MAX)
+        {
+            return NULL;
+        }
+        name[n++] = ' ';
+        h = BT_Cmd_HashChar(h, ' ');
+    }
+    name[n] = '\0';
+
+    s = BT_Cmd_Slot(h, d->seed);
+    if(d->slots[s] == 0 || d->hashes[s] != h)
+    {
+        return NULL;
+    }
+    if(!BT_Cmd_NameEqual(name, d->table[d->slots[s] - 1].name))
+    {
+        return NULL;
+    }
+
+    *pp = p;
+    return &d->table[d->slots[s] - 1];
+}
+
+/**
+ * @brief  解析并执行一条命令
+ * @param  d: 分发器
+ * @param  line: 命令字符串，以'\0'结尾，大小写不敏感
+ * @param  matched: 输出匹配到的表项，未匹配时为NULL，可传NULL
+ * @retval 执行结果
+ */
+BT_CmdStatus_t BT_Cmd_Execute(BT_CmdDispatcher_t *d, const char *line,
+                              const BT_CmdEntry_t **matched)
+{
+    const BT_CmdEntry_t *cmd = NULL;
+    const char *p = line;
+    BT_CmdStatus_t status;
+    int32_t value;
+
+    if(matched != NULL)
+    {
+        *matched = NULL;
+    }
+
+    while(*p == ' ')
+    {
+        p++;
+    }
+    if(*p == '\0')
+    {
+        d->errors++;
+        return BT_CMD_ERR_EMPTY;
+    }
+
+    if(p[0] >= '0' && p[0] <= '9' && p[1] >= '0' && p[1] <= '9' &&
+       (p[2] == '\0' || p[2] == ' '))
+    {
+        /* 两位数字兼容命令，直接按编号索引 */
+        uint8_t idx = d->opcodes[(p[0] - '0') * 10 + (p[1] - '0')];
+        if(idx != 0)
+        {
+            cmd = &d->table[idx - 1];
+            p += 2;
+        }
+    }
+    else
+    {
+        cmd = BT_Cmd_LookupName(d, &p);
+    }
+
+    if(cmd == NULL)
+    {
+        d->errors++;
+        return BT_CMD_ERR_UNKNOWN;
+    }
+    if(matched != NULL)
+    {
+        *matched = cmd;
+    }
+
+    value = cmd->default_value;
+    status = BT_Cmd_ParseValue(p, &value);
+    if(status == BT_CMD_OK && (value < cmd->min_value || value > cmd->max_value))
+    {
+        status = BT_CMD_ERR_RANGE;
+    }
+    if(status == BT_CMD_OK)
+    {
+        status = cmd->handler(cmd, value);
+    }
+
+    if(status == BT_CMD_OK)
+    {
+        d->executed++;
+    }
+    else
+    {
+        d->errors++;
+    }
+    return status;
+}
@@ -0,0 +1,91 @@
+#ifndef __BT_CMD_H
+#define __BT_CMD_H
+
+/**
+ * @file    bt_cmd.h
+ * @brief   蓝牙命令表驱动分发器
+ * @details 命令在一个静态数组中登记，支持两种写法：
+ *          1. 两位数字兼容命令，如 "01"，按编号直接索引
+ *          2. 文字命令，如 "SET TH 35"、"GET ALL"，按完美哈希查找
+ *          初始化时为命令表寻找一个无冲突的哈希乘子，之后每条命令
+ *          只需扫描一遍字符串、一次乘法和一次名称比较。
+ *          本模块不依赖硬件，可以在PC上编译测试
+ */
+
+#include <stdint.h>
+
+#define BT_CMD_NO_OPCODE        0xFF    /* 没有数字编号的命令 */
+#define BT_CMD_OPCODE_COUNT     100     /* 数字编号范围 00-99 */
+#define BT_CMD_HASH_BITS        6       /* 哈希槽数量 = 2^6 */
+#define BT_CMD_HASH_SLOTS       (1u << BT_CMD_HASH_BITS)
+#define BT_CMD_NAME_MAX         16      /* 命令名最大长度（不含参数） */
+
+/**
+ * @brief  命令执行结果
+ */
+typedef enum {
+    BT_CMD_OK = 0,          /* 执行成功 */
+    BT_CMD_ERR_EMPTY,       /* 空命令 */
+    BT_CMD_ERR_UNKNOWN,     /* 未知命令 */
+    BT_CMD_ERR_ARG,         /* 参数格式错误 */
+    BT_CMD_ERR_RANGE,       /* 参数超出范围 */
+    BT_CMD_ERR_FAIL         /* 处理函数执行失败 */
+} BT_CmdStatus_t;
+
+struct BT_CmdEntry;
+
+/**
+ * @brief  命令处理函数类型
+ * @param  cmd: 匹配到的命令表项
+ * @param  value: 参数值（未带参数时为表项的默认值）
+ * @retval 执行结果
+ */
+typedef BT_CmdStatus_t (*BT_CmdHandler)(const struct BT_CmdEntry *cmd, int32_t value);
+
+/**
+ * @brief  命令表项
+ */
+typedef struct BT_CmdEntry {
+    const char *name;       /* 命令名，大写，单词之间一个空格，如 "SET TH" */
+    uint8_t opcode;         /* 两位数字编号，BT_CMD_NO_OPCODE表示无 */
+    uint8_t param;          /* 传给处理函数的附加参数，如阈值编号 */
+    int32_t default_value;  /* 未带参数时使用的值 */
+    int32_t min_value;      /* 参数最小值 */
+    int32_t max_value;      /* 参数最大值 */
+    BT_CmdHandler handler;  /* 处理函数 */
+} BT_CmdEntry_t;
+
+/**
+ * @brief  分发器
+ */
+typedef struct {
+    const BT_CmdEntry_t *table;                 /* 命令表 */
+    uint8_t count;                              /* 命令数量 */
+    uint32_t seed;                              /* 完美哈希乘子 */
+    uint32_t hashes[BT_CMD_HASH_SLOTS];         /* 各槽命令名的哈希值 */
+    uint8_t slots[BT_CMD_HASH_SLOTS];           /* 哈希槽 -> 表项序号+1，0为空 */
+    uint8_t opcodes[BT_CMD_OPCODE_COUNT];       /* 数字编号 -> 表项序号+1，0为空 */
+    uint32_t executed;                          /* 成功执行的命令数 */
+    uint32_t errors;                            /* 出错的命令数 */
+} BT_CmdDispatcher_t;
+
+/**
+ * @brief  初始化分发器
+ * @param  d: 分发器
+ * @param  table: 命令表
+ * @param  count: 命令数量，不超过BT_CMD_HASH_SLOTS/2
+ * @retval 0-成功, 1-命令名或编号重复/找不到无冲突的哈希
+ */
+uint8_t BT_Cmd_Init(BT_CmdDispatcher_t *d, const BT_CmdEntry_t *table, uint8_t count);
+
+/**
+ * @brief  解析并执行一条命令
+ * @param  d: 分发器
+ * @param  line: 命令字符串，以'\0'结尾，大小写不敏感
+ * @param  matched: 输出匹配到的表项，未匹配时为NULL，可传NULL
+ * @retval 执行结果
+ */
+BT_CmdStatus_t BT_Cmd_Execute(BT_CmdDispatcher_t *d, const char *line,
+                              const BT_CmdEntry_t **matched);
+
+#endif /* __BT_CMD_H */
@@ -0,0 +1,390 @@
+#include "bt_frame.h"
+#include <stddef.h>
+
+/**
+ * @file    bt_frame.c
+ * @brief   蓝牙二进制遥测帧源文件
+ */
+
+/**
+ * @brief  计算CRC16-CCITT
+ * @param  crc: 初值，新计算传0xFFFF，分段计算传上一段结果
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval CRC值
+ */
+uint16_t BT_Frame_Crc16(uint16_t crc, const uint8_t *data, uint16_t len)
+{
+    uint8_t i;
+
+    while(len--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for(i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief  COBS编码，不写分隔符
+ * @param  src: 原始数据
+ * @param  len: 原始数据长度
+ * @param  dst: 输出缓冲区，至少 len + len/254 + 1 字节
+ * @retval 编码后的长度
+ */
+uint16_t BT_Frame_CobsEncode(const uint8_t *src, uint16_t len, uint8_t *dst)
+{
+    uint16_t code_pos = 0;      /* 当前段长度字节的位置 */
+    uint16_t out = 1;
+    uint8_t code = 1;
+    uint16_t i;
+
+    for(i = 0; i < len; i++)
+    {
+        if(src[i] == 0)
+        {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+        else
+        {
+            dst[out++] = src[i];
+            if(++code == 0xFF)
+            {
+                /* 满254个非零字节，开始新的一段 */
+                dst[code_pos] = code;
+                code_pos = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+
+/**
+ * @brief  COBS解码，输入不含分隔符
+ * @param  src: 编码数据
+ * @param  len: 编码数据长度
+ * @param  dst: 输出缓冲区，至少len字节，可以与src相同
+ * @retval 解码后的长度，数据非法时返回0
+ */
+uint16_t BT_Frame_CobsDecode(const uint8_t *src, uint16_t len, uint8_t *dst)
+{
+    uint16_t in = 0;
+    uint16_t out = 0;
+    uint8_t code, i;
+
+    while(in < len)
+    {
+        code = src[in++];
+        if(code == 0 || in + code - 1 > len)
+        {
+            return 0;
+        }
+        for(i = 1; i < code; i++)
+        {
+            if(src[in] == 0)
+            {
+                return 0;
+            }
+            dst[out++] = src[in++];
+        }
+        /* 不满254字节的段后面隐含一个0，最后一段除外 */
+        if(code != 0xFF && in < len)
+        {
+            dst[out++] = 0;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief  写入小端16位数
+ */
+static uint8_t *BT_Frame_Put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+/**
+ * @brief  读取小端16位数
+ */
+static uint16_t BT_Frame_Get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+/**
+ * @brief  编码一帧遥测数据
+ * @param  frame: 帧内容，只写入fields中置位的字段
+ * @param  out: 输出缓冲区，至少BT_FRAME_ENCODED_MAX字节
+ * @retval 输出长度（含末尾0x00分隔符）
+ */
+uint16_t BT_Frame_Encode(const BT_Frame_t *frame, uint8_t *out)
+{
+    uint8_t raw[BT_FRAME_RAW_MAX];
+    uint8_t *p = raw;
+    uint16_t fields = frame->fields & BT_FIELD_ALL;
+    uint16_t crc, len;
+    uint8_t i;
+
+    *p++ = BT_FRAME_TYPE_TELEMETRY;
+    *p++ = frame->seq;
+    p = BT_Frame_Put16(p, (uint16_t)frame->timestamp);
+    p = BT_Frame_Put16(p, (uint16_t)(frame->timestamp >> 16));
+    p = BT_Frame_Put16(p, fields);
+
+    if(fields & BT_FIELD_TEMP)
+    {
+        *p++ = frame->temperature;
+    }
+    if(fields & BT_FIELD_HUMI)
+    {
+        *p++ = frame->humidity;
+    }
+    if(fields & BT_FIELD_LIGHT)
+    {
+        *p++ = frame->light_percent;
+        p = BT_Frame_Put16(p, frame->light_raw);
+    }
+    if(fields & BT_FIELD_SMOKE)
+    {
+        p = BT_Frame_Put16(p, frame->smoke_ppm);
+    }
+    if(fields & BT_FIELD_ACCEL)
+    {
+        for(i = 0; i < 3; i++)
+        {
+            p = BT_Frame_Put16(p, (uint16_t)frame->accel_mg[i]);
+        }
+    }
+    if(fields & BT_FIELD_GYRO)
+    {
+        for(i = 0; i < 3; i++)
+        {
+            p = BT_Frame_Put16(p, (uint16_t)frame->gyro_dps10[i]);
+        }
+    }
+    if(fields & BT_FIELD_MPU_TEMP)
+    {
+        p = BT_Frame_Put16(p, (uint16_t)frame->mpu_temp_c100);
+    }
+    if(fields & BT_FIELD_STATUS)
+    {
+        *p++ = frame->status;
+    }
+    if(fields & BT_FIELD_ALARMS)
+    {
+        *p++ = frame->alarms;
+    }
+    if(fields & BT_FIELD_THRESHOLDS)
+    {
+        *p++ = frame->temp_high;
+        *p++ = frame->temp_low;
+        *p++ = frame->humi_high;
+        *p++ = frame->humi_low;
+        *p++ = frame->light_low;
+        p = BT_Frame_Put16(p, frame->smoke_high);
+    }
+    if(fields & BT_FIELD_ANGLE)
+    {
+        p = BT_Frame_Put16(p, (uint16_t)frame->roll_c100);
+        p = BT_Frame_Put16(p, (uint16_t)frame->pitch_c100);
+    }
+
+    crc = BT_Frame_Crc16(0xFFFF, raw, (uint16_t)(p - raw));
+    p = BT_Frame_Put16(p, crc);
+
+    len = BT_Frame_CobsEncode(raw, (uint16_t)(p - raw), out);
+    out[len++] = 0x00;
+    return len;
+}
+
+/**
+ * @brief  解码一帧遥测数据
+ * @param  in: COBS编码数据，不含分隔符
+ * @param  len: 数据长度
+ * @param  frame: 输出帧内容，未包含的字段保持原值
+ * @retval 0-成功, 1-COBS错误, 2-CRC错误, 3-格式错误
+ */
+uint8_t BT_Frame_Decode(const uint8_t *in, uint16_t len, BT_Frame_t *frame)
+{
+    uint8_t raw[BT_FRAME_ENCODED_MAX];
+    const uint8_t *p = raw;
+    const uint8_t *end;
+    uint16_t n, fields, need;
+    uint8_t i;
+
+    if(len > sizeof(raw))
+    {
+        return 3;
+    }
+    n = BT_Frame_CobsDecode(in, len, raw);
+    if(n < BT_FRAME_HEADER_SIZE + 2)
+    {
+        return 1;
+    }
+    if(BT_Frame_Crc16(0xFFFF, raw, n - 2) != BT_Frame_Get16(raw + n - 2))
+    {
+        return 2;
+    }
+    end = raw + n - 2;
+
+    if(*p++ != BT_FRAME_TYPE_TELEMETRY)
+    {
+        return 3;
+    }
+    fields = BT_Frame_Get16(raw + 6);
+    if(fields & ~BT_FIELD_ALL)
+    {
+        return 3;
+    }
+
+    /* 先按掩码核对长度，再取字段 */
+    need = BT_FRAME_HEADER_SIZE;
+    need += (fields & BT_FIELD_TEMP) ? 1 : 0;
+    need += (fields & BT_FIELD_HUMI) ? 1 : 0;
+    need += (fields & BT_FIELD_LIGHT) ? 3 : 0;
+    need += (fields & BT_FIELD_SMOKE) ? 2 : 0;
+    need += (fields & BT_FIELD_ACCEL) ? 6 : 0;
+    need += (fields & BT_FIELD_GYRO) ? 6 : 0;
+    need += (fields & BT_FIELD_MPU_TEMP) ? 2 : 0;
+    need += (fields & BT_FIELD_STATUS) ? 1 : 0;
+    need += (fields & BT_FIELD_ALARMS) ? 1 : 0;
+    need += (fields & BT_FIELD_THRESHOLDS) ? 7 : 0;
+    need += (fields & BT_FIELD_ANGLE) ? 4 : 0;
+    if(raw + need != end)
+    {
+        return 3;
+    }
+
+    frame->seq = *p++;
+    frame->timestamp = BT_Frame_Get16(p) | ((uint32_t)BT_Frame_Get16(p + 2) << 16);
+    p += 4;
+    frame->fields = fields;
+    p += 2;
+
+    if(fields & BT_FIELD_TEMP)
+    {
+        frame->temperature = *p++;
+    }
+    if(fields & BT_FIELD_HUMI)
+    {
+        frame->humidity = *p++;
+    }
+    if(fields & BT_FIELD_LIGHT)
+    {
+        frame->light_percent = *p++;
+        frame->light_raw = BT_Frame_Get16(p);
+        p += 2;
+    }
+    if(fields & BT_FIELD_SMOKE)
+    {
+        frame->smoke_ppm = BT_Frame_Get16(p);
+        p += 2;
+    }
+    if(fields & BT_FIELD_ACCEL)
+    {
+        for(i = 0; i < 3; i++, p += 2)
+        {
+            frame->accel_mg[i] = (int16_t)BT_Frame_Get16(p);
+        }
+    }
+    if(fields & BT_FIELD_GYRO)
+    {
+        for(i = 0; i < 3; i++, p += 2)
+        {
+            frame->gyro_dps10[i] = (int16_t)BT_Frame_Get16(p);
+        }
+    }
+    if(fields & BT_FIELD_MPU_TEMP)
+    {
+        frame->mpu_temp_c100 = (int16_t)BT_Frame_Get16(p);
+        p += 2;
+    }
+    if(fields & BT_FIELD_STATUS)
+    {
+        frame->status = *p++;
+    }
+    if(fields & BT_FIELD_ALARMS)
+    {
+        frame->alarms = *p++;
+    }
+    if(fields & BT_FIELD_THRESHOLDS)
+    {
+        frame->temp_high = *p++;
+        frame->temp_low = *p++;
+        frame->humi_high = *p++;
+        frame->humi_low = *p++;
+        frame->light_low = *p++;
+        frame->smoke_high = BT_Frame_Get16(p);
+        p += 2;
+    }
+    if(fields & BT_FIELD_ANGLE)
+    {
+        frame->roll_c100 = (int16_t)BT_Frame_Get16(p);
+        frame->pitch_c100 = (int16_t)BT_Frame_Get16(p + 2);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  初始化接收分帧器
+ */
+void BT_FrameRx_Init(BT_FrameRx_t *rx)
+{
+    rx->len = 0;
+    rx->overflow = 0;
+    rx->frames = 0;
+    rx->errors = 0;
+}
+
+/**
+ * @brief  向分帧器输入一个字节
+ * @param  rx: 分帧器
+ * @param  ch: 接收到的字节
+ * @param  frame: 解出一帧时写入的帧内容
+ * @retval 1-解出一帧, 0-未完成或帧错误
+ */
+uint8_t BT_FrameRx_Feed(BT_FrameRx_t *rx, uint8_t ch, BT_Frame_t *frame)
+{
+    uint8_t ok = 0;
+
+    if(ch != 0x00)
+    {
+        if(rx->len < sizeof(rx->buf))
+        {
+            rx->buf[rx->len++] = ch;
+        }
+        else
+        {
+            rx->overflow = 1;
+        }
+        return 0;
+    }
+
+    /* 分隔符：连续的0x00视为空帧直接忽略 */
+    if(rx->len != 0 || rx->overflow)
+    {
+        if(!rx->overflow && BT_Frame_Decode(rx->buf, rx->len, frame) == 0)
+        {
+            rx->frames++;
+            ok = 1;
+        }
+        else
+        {
+            rx->errors++;
+        }
+    }
+    rx->len = 0;
+    rx->overflow = 0;
+    return ok;
+}
@@ -0,0 +1,152 @@
+#ifndef __BT_FRAME_H
+#define __BT_FRAME_H
+
+/**
+ * @file    bt_frame.h
+ * @brief   蓝牙二进制遥测帧（CRC16 + COBS分帧）
+ * @details 帧格式（COBS编码前，多字节字段均为小端）：
+ *          [类型1][序号1][时间戳4][字段掩码2][字段...][CRC16 2]
+ *          字段按掩码从低位到高位依次排列，未置位的字段不占字节。
+ *          CRC16-CCITT(0xFFFF初值)覆盖CRC之前的全部字节。
+ *          编码后整帧不含0x00，末尾以0x00作为分隔符，接收端
+ *          丢字节后在下一个0x00处即可重新同步。
+ *          本模块不依赖硬件，可以在PC上编译测试
+ */
+
+#include <stdint.h>
+
+#define BT_FRAME_TYPE_TELEMETRY     0x01    /* 遥测帧类型 */
+
+/* 字段掩码 */
+#define BT_FIELD_TEMP               (1u << 0)   /* 温度 1字节 */
+#define BT_FIELD_HUMI               (1u << 1)   /* 湿度 1字节 */
+#define BT_FIELD_LIGHT              (1u << 2)   /* 光照百分比1 + 原始值2 */
+#define BT_FIELD_SMOKE              (1u << 3)   /* 烟雾ppm 2字节 */
+#define BT_FIELD_ACCEL              (1u << 4)   /* 加速度XYZ，单位mg，3x2字节 */
+#define BT_FIELD_GYRO               (1u << 5)   /* 角速度XYZ，单位0.1dps，3x2字节 */
+#define BT_FIELD_MPU_TEMP           (1u << 6)   /* MPU6050温度，单位0.01℃，2字节 */
+#define BT_FIELD_STATUS             (1u << 7)   /* 传感器状态位 1字节 */
+#define BT_FIELD_ALARMS             (1u << 8)   /* 报警状态位 1字节 */
+#define BT_FIELD_THRESHOLDS         (1u << 9)   /* 阈值 5x1 + 2字节 */
+#define BT_FIELD_ANGLE              (1u << 10)  /* 横滚/俯仰角，单位0.01°，2x2字节 */
+#define BT_FIELD_ALL                0x07FFu
+
+/* 报警状态位（BT_FIELD_ALARMS） */
+#define BT_ALARM_TEMP_HIGH          (1u << 0)
+#define BT_ALARM_TEMP_LOW           (1u << 1)
+#define BT_ALARM_HUMI_HIGH          (1u << 2)
+#define BT_ALARM_HUMI_LOW           (1u << 3)
+#define BT_ALARM_LIGHT_LOW          (1u << 4)
+#define BT_ALARM_SMOKE_HIGH         (1u << 5)
+#define BT_ALARM_DISABLED           (1u << 7)   /* 报警已被命令禁用 */
+
+/* 传感器状态位（BT_FIELD_STATUS） */
+#define BT_STATUS_DHT11_OK          (1u << 0)
+#define BT_STATUS_MPU_OK            (1u << 1)
+
+#define BT_FRAME_HEADER_SIZE        8       /* 类型+序号+时间戳+掩码 */
+#define BT_FRAME_FIELDS_MAX         34      /* 所有字段的字节数之和 */
+#define BT_FRAME_RAW_MAX            (BT_FRAME_HEADER_SIZE + BT_FRAME_FIELDS_MAX + 2)
+/* COBS每254字节最多增加1字节，再加1字节分隔符 */
+#define BT_FRAME_ENCODED_MAX        (BT_FRAME_RAW_MAX + BT_FRAME_RAW_MAX / 254 + 2)
+
+/**
+ * @brief  遥测帧内容
+ */
+typedef struct {
+    uint8_t seq;                /* 序号，发送端每帧加1 */
+    uint32_t timestamp;         /* 采样时间(ms) */
+    uint16_t fields;            /* 帧内包含的字段掩码 */
+
+    uint8_t temperature;        /* ℃ */
+    uint8_t humidity;           /* % */
+    uint8_t light_percent;      /* 0-100 */
+    uint16_t light_raw;         /* ADC原始值 */
+    uint16_t smoke_ppm;         /* ppm */
+    int16_t accel_mg[3];        /* mg */
+    int16_t gyro_dps10[3];      /* 0.1dps */
+    int16_t mpu_temp_c100;      /* 0.01℃ */
+    uint8_t status;             /* BT_STATUS_xxx */
+    uint8_t alarms;             /* BT_ALARM_xxx */
+
+    uint8_t temp_high;          /* 阈值 */
+    uint8_t temp_low;
+    uint8_t humi_high;
+    uint8_t humi_low;
+    uint8_t light_low;
+    uint16_t smoke_high;
+
+    int16_t roll_c100;          /* 横滚角，0.01° */
+    int16_t pitch_c100;         /* 俯仰角，0.01° */
+} BT_Frame_t;
+
+/**
+ * @brief  接收端分帧器，逐字节输入，遇到0x00时尝试解出一帧
+ */
+typedef struct {
+    uint8_t buf[BT_FRAME_ENCODED_MAX];  /* 当前帧的已编码字节 */
+    uint16_t len;                       /* buf中的字节数 */
+    uint8_t overflow;                   /* 当前帧超长，丢弃到下一个0x00 */
+    uint32_t frames;                    /* 成功解出的帧数 */
+    uint32_t errors;                    /* COBS/CRC/格式错误的帧数 */
+} BT_FrameRx_t;
+
+/**
+ * @brief  计算CRC16-CCITT
+ * @param  crc: 初值，新计算传0xFFFF，分段计算传上一段结果
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval CRC值
+ */
+uint16_t BT_Frame_Crc16(uint16_t crc, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  COBS编码，不写分隔符
+ * @param  src: 原始数据
+ * @param  len: 原始数据长度
+ * @param  dst: 输出缓冲区，至少 len + len/254 + 1 字节
+ * @retval 编码后的长度
+ */
+uint16_t BT_Frame_CobsEncode(const uint8_t *src, uint16_t len, uint8_t *dst);
+
+/**
+ * @brief  COBS解码，输入不含分隔符
+ * @param  src: 编码数据
+ * @param  len: 编码数据长度
+ * @param  dst: 输出缓冲区，至少len字节，可以与src相同
+ * @retval 解码后的长度，数据非法时返回0
+ */
+uint16_t BT_Frame_CobsDecode(const uint8_t *src, uint16_t len, uint8_t *dst);
+
+/**
+ * @brief  编码一帧遥测数据
+ * @param  frame: 帧内容，只写入fields中置位的字段
+ * @param  out: 输出缓冲区，至少BT_FRAME_ENCODED_MAX字节
+ * @retval 输出长度（含末尾0x00分隔符）
+ */
+uint16_t BT_Frame_Encode(const BT_Frame_t *frame, uint8_t *out);
+
+/**
+ * @brief  解码一帧遥测数据
+ * @param  in: COBS编码数据，不含分隔符
+ * @param  len: 数据长度
+ * @param  frame: 输出帧内容，未包含的字段保持原值
+ * @retval 0-成功, 1-COBS错误, 2-CRC错误, 3-格式错误
+ */
+uint8_t BT_Frame_Decode(const uint8_t *in, uint16_t len, BT_Frame_t *frame);
+
+/**
+ * @brief  初始化接收分帧器
+ */
+void BT_FrameRx_Init(BT_FrameRx_t *rx);
+
+/**
+ * @brief  向分帧器输入一个字节
+ * @param  rx: 分帧器
+ * @param  ch: 接收到的字节
+ * @param  frame: 解出一帧时写入的帧内容
+ * @retval 1-解出一帧, 0-未完成或帧错误
+ */
+uint8_t BT_FrameRx_Feed(BT_FrameRx_t *rx, uint8_t ch, BT_Frame_t *frame);
+
+#endif /* __BT_FRAME_H */
@@ -0,0 +1,193 @@
+#include "bt_stream.h"
+
+/**
+ * @file    bt_stream.c
+ * @brief   蓝牙遥测订阅推送调度器源文件
+ */
+
+/**
+ * @brief  初始化调度器
+ * @param  s: 调度器
+ * @param  budget: 链路预算(字节/秒)，如9600波特率为960
+ */
+void BT_Stream_Init(BT_Stream_t *s, uint32_t budget)
+{
+    s->fields = 0;
+    s->period = 0;
+    s->next_due = 0;
+    s->next_key = 0;
+    s->budget = budget;
+    s->seq = 0;
+    s->frames = 0;
+    s->keyframes = 0;
+    s->skipped = 0;
+    s->late = 0;
+    s->bytes = 0;
+}
+
+/**
+ * @brief  订阅字段的关键帧编码长度（含分隔符和COBS开销上限）
+ */
+uint16_t BT_Stream_FrameSize(uint16_t fields)
+{
+    uint16_t n = BT_FRAME_HEADER_SIZE + 2;
+
+    n += (fields & BT_FIELD_TEMP) ? 1 : 0;
+    n += (fields & BT_FIELD_HUMI) ? 1 : 0;
+    n += (fields & BT_FIELD_LIGHT) ? 3 : 0;
+    n += (fields & BT_FIELD_SMOKE) ? 2 : 0;
+    n += (fields & BT_FIELD_ACCEL) ? 6 : 0;
+    n += (fields & BT_FIELD_GYRO) ? 6 : 0;
+    n += (fields & BT_FIELD_MPU_TEMP) ? 2 : 0;
+    n += (fields & BT_FIELD_STATUS) ? 1 : 0;
+    n += (fields & BT_FIELD_ALARMS) ? 1 : 0;
+    n += (fields & BT_FIELD_THRESHOLDS) ? 7 : 0;
+    n += (fields & BT_FIELD_ANGLE) ? 4 : 0;
+
+    /* COBS开销1字节 + 分隔符1字节 */
+    return n + 2;
+}
+
+/**
+ * @brief  订阅字段和推送频率
+ * @param  s: 调度器
+ * @param  fields: 字段掩码，0表示停止推送
+ * @param  rate_hz: 推送频率，1-BT_STREAM_RATE_MAX
+ * @param  now: 当前时间(ms)
+ * @retval 订阅结果，失败时保持原有订阅
+ */
+BT_StreamStatus_t BT_Stream_Subscribe(BT_Stream_t *s, uint16_t fields,
+                                      uint8_t rate_hz, uint32_t now)
+{
+    fields &= BT_FIELD_ALL;
+    if(fields == 0)
+    {
+        BT_Stream_Stop(s);
+        return BT_STREAM_OK;
+    }
+    if(rate_hz == 0 || rate_hz > BT_STREAM_RATE_MAX)
+    {
+        return BT_STREAM_ERR_RATE;
+    }
+
+    /* 按最坏情况（每帧都是全部订阅字段）检查带宽 */
+    if((uint32_t)BT_Stream_FrameSize(fields) * rate_hz > s->budget)
+    {
+        return BT_STREAM_ERR_BUDGET;
+    }
+
+    s->fields = fields;
+    s->period = (uint16_t)(1000 / rate_hz);
+    s->next_due = now;
+    s->next_key = now;      /* 订阅后的第一帧为关键帧 */
+    return BT_STREAM_OK;
+}
+
+/**
+ * @brief  停止推送
+ */
+void BT_Stream_Stop(BT_Stream_t *s)
+{
+    s->fields = 0;
+}
+
+/**
+ * @brief  找出与上次发送值不同的字段
+ */
+static uint16_t BT_Stream_Changed(const BT_Frame_t *a, const BT_Frame_t *b, uint16_t fields)
+{
+    uint16_t changed = 0;
+
+    if(a->temperature != b->temperature)
+        changed |= BT_FIELD_TEMP;
+    if(a->humidity != b->humidity)
+        changed |= BT_FIELD_HUMI;
+    if(a->light_percent != b->light_percent || a->light_raw != b->light_raw)
+        changed |= BT_FIELD_LIGHT;
+    if(a->smoke_ppm != b->smoke_ppm)
+        changed |= BT_FIELD_SMOKE;
+    if(a->accel_mg[0] != b->accel_mg[0] || a->accel_mg[1] != b->accel_mg[1] ||
+       a->accel_mg[2] != b->accel_mg[2])
+        changed |= BT_FIELD_ACCEL;
+    if(a->gyro_dps10[0] != b->gyro_dps10[0] || a->gyro_dps10[1] != b->gyro_dps10[1] ||
+       a->gyro_dps10[2] != b->gyro_dps10[2])
+        changed |= BT_FIELD_GYRO;
+    if(a->mpu_temp_c100 != b->mpu_temp_c100)
+        changed |= BT_FIELD_MPU_TEMP;
+    if(a->status != b->status)
+        changed |= BT_FIELD_STATUS;
+    if(a->alarms != b->alarms)
+        changed |= BT_FIELD_ALARMS;
+    if(a->temp_high != b->temp_high || a->temp_low != b->temp_low ||
+       a->humi_high != b->humi_high || a->humi_low != b->humi_low ||
+       a->light_low != b->light_low || a->smoke_high != b->smoke_high)
+        changed |= BT_FIELD_THRESHOLDS;
+    if(a->roll_c100 != b->roll_c100 || a->pitch_c100 != b->pitch_c100)
+        changed |= BT_FIELD_ANGLE;
+
+    return changed & fields;
+}
+
+/**
+ * @brief  本次调用Poll是否可能发送
+ */
+uint8_t BT_Stream_Due(const BT_Stream_t *s, uint32_t now)
+{
+    return s->fields != 0 && (int32_t)(now - s->next_due) >= 0;
+}
+
+/**
+ * @brief  推送调度，周期性调用
+ * @param  s: 调度器
+ * @param  now: 当前时间(ms)
+ * @param  sample: 当前数据，只使用订阅的字段
+ * @param  out: 输出缓冲区，至少BT_FRAME_ENCODED_MAX字节
+ * @retval 需要发送的字节数，0表示本次不发送
+ */
+uint16_t BT_Stream_Poll(BT_Stream_t *s, uint32_t now,
+                        const BT_Frame_t *sample, uint8_t *out)
+{
+    BT_Frame_t frame;
+    uint16_t fields;
+    uint16_t len;
+
+    if(!BT_Stream_Due(s, now))
+    {
+        return 0;
+    }
+
+    /* 按固定节拍推进，不随调用时刻漂移；落后超过一个周期则丢掉欠账 */
+    s->next_due += s->period;
+    if((int32_t)(now - s->next_due) >= 0)
+    {
+        s->late += (now - s->next_due) / s->period + 1;
+        s->next_due = now + s->period;
+    }
+
+    if((int32_t)(now - s->next_key) >= 0)
+    {
+        fields = s->fields;
+        s->next_key = now + BT_STREAM_KEYFRAME_MS;
+        s->keyframes++;
+    }
+    else
+    {
+        fields = BT_Stream_Changed(sample, &s->last, s->fields);
+        if(fields == 0)
+        {
+            s->skipped++;
+            return 0;
+        }
+    }
+
+    frame = *sample;
+    frame.seq = s->seq++;
+    frame.timestamp = now;
+    frame.fields = fields;
+    len = BT_Frame_Encode(&frame, out);
+
+    s->last = *sample;
+    s->frames++;
+    s->bytes += len;
+    return len;
+}
@@ -0,0 +1,96 @@
+#ifndef __BT_STREAM_H
+#define __BT_STREAM_H
+
+/**
+ * @file    bt_stream.h
+ * @brief   蓝牙遥测订阅推送调度器
+ * @details 客户端订阅一组字段(BT_FIELD_xxx)和推送频率后，调度器按
+ *          固定周期生成bt_frame帧，不再需要逐次查询。
+ *          差分编码：普通帧只包含与上次发送值不同的字段，没有变化时
+ *          不发送；每隔BT_STREAM_KEYFRAME_MS发送一次包含全部订阅字段的
+ *          关键帧，供新连接或丢帧的接收端重新同步。
+ *          时间由调用者传入，本模块不依赖硬件，可以在PC上用模拟时钟测试
+ */
+
+#include <stdint.h>
+#include "bt_frame.h"
+
+#define BT_STREAM_RATE_MAX          50      /* 最高推送频率(Hz) */
+#define BT_STREAM_KEYFRAME_MS       1000    /* 关键帧间隔(ms) */
+
+/**
+ * @brief  订阅结果
+ */
+typedef enum {
+    BT_STREAM_OK = 0,           /* 订阅成功 */
+    BT_STREAM_ERR_RATE,         /* 频率超出范围 */
+    BT_STREAM_ERR_BUDGET        /* 关键帧带宽超出链路预算 */
+} BT_StreamStatus_t;
+
+/**
+ * @brief  推送调度器
+ */
+typedef struct {
+    uint16_t fields;            /* 订阅的字段掩码，0表示未订阅 */
+    uint16_t period;            /* 推送周期(ms) */
+    uint32_t next_due;          /* 下一次推送时间 */
+    uint32_t next_key;          /* 下一次关键帧时间 */
+    uint32_t budget;            /* 链路预算(字节/秒) */
+    uint8_t seq;                /* 帧序号 */
+    BT_Frame_t last;            /* 接收端当前持有的值 */
+
+    uint32_t frames;            /* 已发送帧数 */
+    uint32_t keyframes;         /* 其中的关键帧数 */
+    uint32_t skipped;           /* 无变化而省略的周期数 */
+    uint32_t late;              /* 调用过晚、跳过的周期数 */
+    uint32_t bytes;             /* 已发送字节数 */
+} BT_Stream_t;
+
+/**
+ * @brief  初始化调度器
+ * @param  s: 调度器
+ * @param  budget: 链路预算(字节/秒)，如9600波特率为960
+ */
+void BT_Stream_Init(BT_Stream_t *s, uint32_t budget);
+
+/**
+ * @brief  订阅字段和推送频率
+ * @param  s: 调度器
+ * @param  fields: 字段掩码，0表示停止推送
+ * @param  rate_hz: 推送频率，1-BT_STREAM_RATE_MAX
+ * @param  now: 当前时间(ms)
+ * @retval 订阅结果，失败时保持原有订阅
+ */
+BT_StreamStatus_t BT_Stream_Subscribe(BT_Stream_t *s, uint16_t fields,
+                                      uint8_t rate_hz, uint32_t now);
+
+/**
+ * @brief  停止推送
+ */
+void BT_Stream_Stop(BT_Stream_t *s);
+
+/**
+ * @brief  订阅字段的关键帧编码长度（含分隔符和COBS开销上限）
+ */
+uint16_t BT_Stream_FrameSize(uint16_t fields);
+
+/**
+ * @brief  本次调用Poll是否可能发送
+ * @param  s: 调度器
+ * @param  now: 当前时间(ms)
+ * @retval 1-已订阅且到了推送时间，调用者此时才需要准备数据
+ */
+uint8_t BT_Stream_Due(const BT_Stream_t *s, uint32_t now);
+
+/**
+ * @brief  推送调度，周期性调用
+ * @param  s: 调度器
+ * @param  now: 当前时间(ms)
+ * @param  sample: 当前数据，只使用订阅的字段
+ * @param  out: 输出缓冲区，至少BT_FRAME_ENCODED_MAX字节
+ * @retval 需要发送的字节数，0表示本次不发送
+ */
+uint16_t BT_Stream_Poll(BT_Stream_t *s, uint32_t now,
+                        const BT_Frame_t *sample, uint8_t *out);
+
+#endif /* __BT_STREAM_H */
@@ -12,6 +12,7 @@
 #include "DHT11.h"
 #include "lcd.h"
 #include "bluetooth.h"
+#include "uart.h"
 #include <stdio.h>
 
 /* 私有变量 */
@@ -56,6 +57,9 @@ int main(void)
     {
         current_time = SysTick->VAL;  // 简单的时间戳
         
+        // 串口中断只入队，蓝牙命令和MQ-2应答在这里解析
+        UART_Poll();
+        
         // 每100ms检查一次蓝牙命令
         if(current_time - last_bluetooth_check > 100)
         {
@@ -98,6 +102,7 @@ int main(void)
                     uint16_t timeout = 0;
                     while(!MQ2_IsDataReady() && timeout < 500)
                     {
+                        UART_Poll();
                         Mdelay_Lib(10);
                         timeout++;
                     }
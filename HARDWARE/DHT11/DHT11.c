@@ -1,5 +1,6 @@
 #include "dht11.h"
 #include "delay.h"
+#include "dht11_decode.h"
 
 void dht11_io_out()
 {
@@ -136,3 +137,160 @@ unsigned char dht11_read_dat(unsigned char *temp, unsigned char *humi)
         return 1;
     return 0;
 	}
+
+
+/* =================== 非阻塞读取（TIM9输入捕获） =================== */
+
+static DHT11_Sm_t dht11_sm;
+static volatile unsigned char dht11_done = 0;
+static dht11_callback_t dht11_cb = 0;
+
+// 执行状态机给出的动作
+static void dht11_async_apply(DHT11_Action_t act)
+{
+    GPIO_InitTypeDef g;
+
+    switch(act)
+    {
+        case DHT11_ACT_DRIVE_LOW:
+            // 拉低总线，CC2比较中断在起始信号结束时触发
+            dht11_io_out();
+            GPIO_ResetBits(DHT11_PORT, DHT11_IO);
+            TIM_SetCompare2(DHT11_TIM, dht11_sm.deadline);
+            TIM_ClearITPendingBit(DHT11_TIM, TIM_IT_CC1 | TIM_IT_CC2);
+            TIM_ITConfig(DHT11_TIM, TIM_IT_CC2, ENABLE);
+            break;
+
+        case DHT11_ACT_RELEASE:
+            // 释放总线，引脚切到TIM9_CH1复用输入，开始捕获下降沿
+            GPIO_SetBits(DHT11_PORT, DHT11_IO);
+            g.GPIO_Pin = DHT11_IO;
+            g.GPIO_Mode = GPIO_Mode_AF;
+            g.GPIO_OType = GPIO_OType_OD;
+            g.GPIO_Speed = GPIO_Speed_100MHz;
+            g.GPIO_PuPd = GPIO_PuPd_UP;
+            GPIO_Init(DHT11_PORT, &g);
+            TIM_SetCompare2(DHT11_TIM, dht11_sm.deadline);
+            TIM_ClearITPendingBit(DHT11_TIM, TIM_IT_CC1);
+            TIM_ITConfig(DHT11_TIM, TIM_IT_CC1, ENABLE);
+            break;
+
+        case DHT11_ACT_FINISH:
+            TIM_ITConfig(DHT11_TIM, TIM_IT_CC1 | TIM_IT_CC2, DISABLE);
+            dht11_io_in();
+            dht11_done = 1;
+            if(dht11_cb)
+            {
+                dht11_cb(dht11_sm.result, dht11_sm.data[2], dht11_sm.data[0]);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// 初始化TIM9：1MHz自由计数，CH1下降沿输入捕获，CH2作定时比较
+void dht11_async_init(void)
+{
+    TIM_TimeBaseInitTypeDef tb;
+    TIM_ICInitTypeDef ic;
+    NVIC_InitTypeDef nvic;
+    RCC_ClocksTypeDef clocks;
+    uint32_t tim_clk;
+
+    RCC_AHB1PeriphClockCmd(DHT11_RCC, ENABLE);
+    RCC_APB2PeriphClockCmd(DHT11_TIM_RCC, ENABLE);
+    GPIO_PinAFConfig(DHT11_PORT, DHT11_PIN_SOURCE, DHT11_PIN_AF);
+    dht11_io_in();
+
+    // APB2分频不为1时定时器时钟为PCLK2的两倍
+    RCC_GetClocksFreq(&clocks);
+    tim_clk = clocks.PCLK2_Frequency;
+    if(clocks.PCLK2_Frequency != clocks.HCLK_Frequency)
+    {
+        tim_clk *= 2;
+    }
+
+    tb.TIM_Prescaler = (uint16_t)(tim_clk / 1000000 - 1);
+    tb.TIM_CounterMode = TIM_CounterMode_Up;
+    tb.TIM_Period = 0xFFFF;
+    tb.TIM_ClockDivision = TIM_CKD_DIV1;
+    tb.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(DHT11_TIM, &tb);
+
+    ic.TIM_Channel = TIM_Channel_1;
+    ic.TIM_ICPolarity = TIM_ICPolarity_Falling;
+    ic.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    ic.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    ic.TIM_ICFilter = 0x3;      // 滤除短于约1us的毛刺
+    TIM_ICInit(DHT11_TIM, &ic);
+
+    nvic.NVIC_IRQChannel = DHT11_TIM_IRQn;
+    nvic.NVIC_IRQChannelPreemptionPriority = 1;
+    nvic.NVIC_IRQChannelSubPriority = 0;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    dht11_sm_init(&dht11_sm);
+    dht11_done = 0;
+    TIM_Cmd(DHT11_TIM, ENABLE);
+}
+
+// 开始一次非阻塞读取，返回0-已开始, 1-上一次读取尚未完成
+unsigned char dht11_async_start(void)
+{
+    DHT11_Action_t act;
+
+    // 忙时状态机不做任何修改；空闲时定时器中断都已关闭，不会与中断竞争
+    act = dht11_sm_start(&dht11_sm, (uint16_t)TIM_GetCounter(DHT11_TIM));
+    if(act == DHT11_ACT_NONE)
+    {
+        return 1;
+    }
+    dht11_done = 0;
+    dht11_async_apply(act);
+    return 0;
+}
+
+// 读取是否已完成
+unsigned char dht11_async_ready(void)
+{
+    return dht11_done;
+}
+
+// 取出结果并清除完成标志，返回DHT11_Result_t
+unsigned char dht11_async_result(unsigned char *temp, unsigned char *humi)
+{
+    if(!dht11_done)
+    {
+        return DHT11_ERR_BUSY;
+    }
+    dht11_done = 0;
+    if(dht11_sm.result == DHT11_OK)
+    {
+        *humi = dht11_sm.data[0];// 湿度整数部分
+        *temp = dht11_sm.data[2];// 温度整数部分
+    }
+    return dht11_sm.result;
+}
+
+// 注册完成回调（在中断中调用），传0取消
+void dht11_async_set_callback(dht11_callback_t cb)
+{
+    dht11_cb = cb;
+}
+
+void TIM1_BRK_TIM9_IRQHandler(void)
+{
+    if(TIM_GetITStatus(DHT11_TIM, TIM_IT_CC1) != RESET)
+    {
+        // 读CCR1同时清除CC1IF
+        dht11_async_apply(dht11_sm_edge(&dht11_sm, (uint16_t)TIM_GetCapture1(DHT11_TIM)));
+    }
+    if(TIM_GetITStatus(DHT11_TIM, TIM_IT_CC2) != RESET)
+    {
+        TIM_ClearITPendingBit(DHT11_TIM, TIM_IT_CC2);
+        dht11_async_apply(dht11_sm_timer(&dht11_sm, (uint16_t)TIM_GetCapture2(DHT11_TIM)));
+    }
+}
@@ -17,6 +17,22 @@ unsigned char dht11_read_bit(void);
 unsigned char dht11_read_byte(void);
 unsigned char dht11_read_dat(unsigned char *temp, unsigned char *humi);
 
+/* 非阻塞读取：TIM9产生起始信号并用CH1(PE5, AF3)捕获下降沿，
+   解码在中断中完成，主循环查询完成标志或注册回调 */
+#define DHT11_TIM               TIM9
+#define DHT11_TIM_RCC           RCC_APB2Periph_TIM9
+#define DHT11_TIM_IRQn          TIM1_BRK_TIM9_IRQn
+#define DHT11_PIN_SOURCE        GPIO_PinSource5
+#define DHT11_PIN_AF            GPIO_AF_TIM9
+
+typedef void (*dht11_callback_t)(unsigned char result, unsigned char temp, unsigned char humi);
+
+void dht11_async_init(void);
+unsigned char dht11_async_start(void);
+unsigned char dht11_async_ready(void);
+unsigned char dht11_async_result(unsigned char *temp, unsigned char *humi);
+void dht11_async_set_callback(dht11_callback_t cb);
+
 
 #endif
 
@@ -9,6 +9,7 @@
 #include "delay.h"
 #include "lcd.h"
 #include "DHT11.h"
+#include "uart.h"
 #include <stdio.h>
 
 int main(void)
@@ -43,6 +44,7 @@ int main(void)
             lcd_print_str(1, 0, "Check DHT11");
         }
 
+        UART_Poll();      // 串口中断只入队，在主循环中处理收到的数据
         Mdelay_Lib(2000); // 每2秒读取一次
     }
 }
\ No newline at end of file
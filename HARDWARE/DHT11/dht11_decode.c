@@ -0,0 +1,160 @@
+#include "dht11_decode.h"
+
+/**
+ * @file    dht11_decode.c
+ * @brief   DHT11输入捕获解码与时序状态机源文件
+ */
+
+/**
+ * @brief  由下降沿时间戳解码40位数据
+ * @param  edges: 下降沿时间戳(us)，16位定时器值，允许回绕
+ * @param  count: 边沿数
+ * @param  data: 输出5字节数据
+ * @retval 解码结果
+ */
+DHT11_Result_t dht11_decode_edges(const uint16_t *edges, uint8_t count, uint8_t data[5])
+{
+    uint8_t start, i;
+    uint16_t width;
+
+    /* 找响应信号，跳过释放总线时可能出现的毛刺边沿 */
+    for(start = 0; start + 41 < count; start++)
+    {
+        width = (uint16_t)(edges[start + 1] - edges[start]);
+        if(width >= DHT11_PREAMBLE_MIN_US && width <= DHT11_PREAMBLE_MAX_US)
+        {
+            break;
+        }
+    }
+    if(start + 41 >= count)
+    {
+        return DHT11_ERR_NO_RESPONSE;
+    }
+
+    for(i = 0; i < 5; i++)
+    {
+        data[i] = 0;
+    }
+
+    for(i = 0; i < 40; i++)
+    {
+        width = (uint16_t)(edges[start + i + 2] - edges[start + i + 1]);
+        if(width < DHT11_BIT_MIN_US || width > DHT11_BIT_MAX_US)
+        {
+            return DHT11_ERR_PULSE;
+        }
+        data[i >> 3] = (uint8_t)((data[i >> 3] << 1) | (width > DHT11_BIT_ONE_US ? 1 : 0));
+    }
+
+    if((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4])
+    {
+        return DHT11_ERR_CHECKSUM;
+    }
+    return DHT11_OK;
+}
+
+/**
+ * @brief  初始化状态机
+ */
+void dht11_sm_init(DHT11_Sm_t *sm)
+{
+    sm->state = DHT11_SM_IDLE;
+    sm->deadline = 0;
+    sm->count = 0;
+    sm->result = DHT11_ERR_NO_RESPONSE;
+    sm->reads = 0;
+    sm->timeouts = 0;
+    sm->errors = 0;
+}
+
+/**
+ * @brief  结束本次读取并统计结果
+ */
+static DHT11_Action_t dht11_sm_finish(DHT11_Sm_t *sm)
+{
+    sm->result = dht11_decode_edges(sm->edges, sm->count, sm->data);
+    if(sm->result == DHT11_OK)
+    {
+        sm->reads++;
+    }
+    else if(sm->result == DHT11_ERR_NO_RESPONSE)
+    {
+        sm->timeouts++;
+    }
+    else
+    {
+        sm->errors++;
+    }
+    sm->state = DHT11_SM_DONE;
+    return DHT11_ACT_FINISH;
+}
+
+/**
+ * @brief  开始一次读取
+ * @param  sm: 状态机
+ * @param  now: 当前定时器值(us)
+ * @retval DHT11_ACT_DRIVE_LOW，忙时返回DHT11_ACT_NONE
+ */
+DHT11_Action_t dht11_sm_start(DHT11_Sm_t *sm, uint16_t now)
+{
+    if(sm->state == DHT11_SM_START || sm->state == DHT11_SM_CAPTURE)
+    {
+        return DHT11_ACT_NONE;
+    }
+    sm->count = 0;
+    sm->deadline = (uint16_t)(now + DHT11_START_US);
+    sm->state = DHT11_SM_START;
+    return DHT11_ACT_DRIVE_LOW;
+}
+
+/**
+ * @brief  定时事件（到达deadline）
+ * @param  sm: 状态机
+ * @param  now: 当前定时器值(us)
+ * @retval 起始信号结束时为DHT11_ACT_RELEASE，捕获超时为DHT11_ACT_FINISH
+ */
+DHT11_Action_t dht11_sm_timer(DHT11_Sm_t *sm, uint16_t now)
+{
+    switch(sm->state)
+    {
+        case DHT11_SM_START:
+            sm->deadline = (uint16_t)(now + DHT11_TIMEOUT_US);
+            sm->state = DHT11_SM_CAPTURE;
+            return DHT11_ACT_RELEASE;
+
+        case DHT11_SM_CAPTURE:
+            /* 超时：用已捕获的边沿尝试解码，不足时报告无响应 */
+            return dht11_sm_finish(sm);
+
+        default:
+            return DHT11_ACT_NONE;
+    }
+}
+
+/**
+ * @brief  捕获到一个下降沿
+ * @param  sm: 状态机
+ * @param  t: 捕获的定时器值(us)
+ * @retval 边沿收齐且解码成功、或缓冲区满时为DHT11_ACT_FINISH，否则DHT11_ACT_NONE
+ */
+DHT11_Action_t dht11_sm_edge(DHT11_Sm_t *sm, uint16_t t)
+{
+    if(sm->state != DHT11_SM_CAPTURE)
+    {
+        return DHT11_ACT_NONE;
+    }
+
+    sm->edges[sm->count++] = t;
+    if(sm->count < DHT11_EDGE_COUNT)
+    {
+        return DHT11_ACT_NONE;
+    }
+
+    /* 有毛刺时42个边沿还解不出来，继续等后面的边沿 */
+    if(sm->count < DHT11_EDGE_MAX &&
+       dht11_decode_edges(sm->edges, sm->count, sm->data) != DHT11_OK)
+    {
+        return DHT11_ACT_NONE;
+    }
+    return dht11_sm_finish(sm);
+}
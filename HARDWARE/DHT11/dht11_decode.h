@@ -0,0 +1,114 @@
+#ifndef _DHT11_DECODE_H_
+#define _DHT11_DECODE_H_
+
+/**
+ * @file    dht11_decode.h
+ * @brief   DHT11输入捕获解码与时序状态机
+ * @details 定时器以1us为单位捕获DHT11数据线的下降沿：
+ *          F0 传感器响应开始(拉低80us)
+ *          F1 响应结束(再拉高80us后)，即第0位低电平开始，F1-F0约160us
+ *          F2..F41 每一位高电平结束，相邻下降沿间隔 = 50us低 + 高电平
+ *                  26-28us为'0'(间隔约78us)，70us为'1'(间隔约120us)
+ *          状态机只根据事件和时间戳给出动作，由驱动去操作GPIO和定时器，
+ *          本模块不访问外设寄存器，可以在PC上用合成的边沿序列测试
+ */
+
+#include <stdint.h>
+
+#define DHT11_EDGE_COUNT        42      /* 一次完整读数的下降沿数 */
+#define DHT11_EDGE_MAX          44      /* 多留两个位置容纳毛刺边沿 */
+#define DHT11_START_US          20000   /* 主机起始信号拉低时间(>=18ms) */
+#define DHT11_TIMEOUT_US        8000    /* 释放总线后等待全部边沿的超时 */
+
+#define DHT11_PREAMBLE_MIN_US   120     /* F1-F0 允许范围 */
+#define DHT11_PREAMBLE_MAX_US   220
+#define DHT11_BIT_MIN_US        50      /* 一位间隔允许范围 */
+#define DHT11_BIT_MAX_US        180
+#define DHT11_BIT_ONE_US        100     /* 间隔大于此值为'1' */
+
+/**
+ * @brief  解码结果
+ */
+typedef enum {
+    DHT11_OK = 0,               /* 成功 */
+    DHT11_ERR_NO_RESPONSE,      /* 没有找到响应信号或边沿不足 */
+    DHT11_ERR_PULSE,            /* 脉宽超出范围 */
+    DHT11_ERR_CHECKSUM,         /* 校验和错误 */
+    DHT11_ERR_BUSY              /* 上一次读取尚未完成 */
+} DHT11_Result_t;
+
+/**
+ * @brief  状态机状态
+ */
+typedef enum {
+    DHT11_SM_IDLE = 0,          /* 空闲，可以开始新的读取 */
+    DHT11_SM_START,             /* 主机拉低总线中 */
+    DHT11_SM_CAPTURE,           /* 已释放总线，捕获边沿中 */
+    DHT11_SM_DONE               /* 读取结束，结果有效 */
+} DHT11_SmState_t;
+
+/**
+ * @brief  状态机要求驱动执行的动作
+ */
+typedef enum {
+    DHT11_ACT_NONE = 0,         /* 无 */
+    DHT11_ACT_DRIVE_LOW,        /* 拉低总线，在deadline产生定时事件 */
+    DHT11_ACT_RELEASE,          /* 释放总线并开始捕获，在deadline产生超时事件 */
+    DHT11_ACT_FINISH            /* 停止捕获，结果见result */
+} DHT11_Action_t;
+
+/**
+ * @brief  状态机
+ */
+typedef struct {
+    DHT11_SmState_t state;
+    uint16_t deadline;                      /* 下一次定时事件的定时器值 */
+    uint16_t edges[DHT11_EDGE_MAX];         /* 下降沿时间戳(us) */
+    uint8_t count;                          /* 已捕获的边沿数 */
+    uint8_t data[5];                        /* 湿度整数/小数、温度整数/小数、校验和 */
+    DHT11_Result_t result;                  /* 最近一次读取结果 */
+
+    uint32_t reads;                         /* 成功次数 */
+    uint32_t timeouts;                      /* 超时（边沿不足）次数 */
+    uint32_t errors;                        /* 脉宽或校验错误次数 */
+} DHT11_Sm_t;
+
+/**
+ * @brief  由下降沿时间戳解码40位数据
+ * @param  edges: 下降沿时间戳(us)，16位定时器值，允许回绕
+ * @param  count: 边沿数
+ * @param  data: 输出5字节数据
+ * @retval 解码结果
+ */
+DHT11_Result_t dht11_decode_edges(const uint16_t *edges, uint8_t count, uint8_t data[5]);
+
+/**
+ * @brief  初始化状态机
+ */
+void dht11_sm_init(DHT11_Sm_t *sm);
+
+/**
+ * @brief  开始一次读取
+ * @param  sm: 状态机
+ * @param  now: 当前定时器值(us)
+ * @retval DHT11_ACT_DRIVE_LOW，忙时返回DHT11_ACT_NONE
+ */
+DHT11_Action_t dht11_sm_start(DHT11_Sm_t *sm, uint16_t now);
+
+/**
+ * @brief  定时事件（到达deadline）
+ * @param  sm: 状态机
+ * @param  now: 当前定时器值(us)
+ * @retval 起始信号结束时为DHT11_ACT_RELEASE，捕获超时为DHT11_ACT_FINISH
+ */
+DHT11_Action_t dht11_sm_timer(DHT11_Sm_t *sm, uint16_t now);
+
+/**
+ * @brief  捕获到一个下降沿
+ * @param  sm: 状态机
+ * @param  t: 捕获的定时器值(us)
+ * @retval 边沿收齐且解码成功、或缓冲区满时为DHT11_ACT_FINISH，否则DHT11_ACT_NONE
+ */
+DHT11_Action_t dht11_sm_edge(DHT11_Sm_t *sm, uint16_t t);
+
+#endif
@@ -1,8 +1,56 @@
 #include "lcd.h"
 #include "delay.h"     
+#include "dwt_time.h"
+#include "lcd_bus.h"
+#include "lcd_async.h"
+
+// 32位写BSRR，一次存储同时完成置位和复位
+#define LCD_BSRR(port)  (*(__IO uint32_t *)&(port)->BSRRL)
+
+// HD44780 时序（取2.7-4.5V档的最小值，兼顾3.3V供电）
+#define LCD_T_AS_NS     60      // RS/RW 建立时间 tAS
+#define LCD_T_PW_NS     450     // EN 高电平脉宽 PWEH，同时覆盖数据建立时间 tDSW
+#define LCD_T_H_NS      20      // 地址/数据保持时间 tH
+#define LCD_T_EXEC_US   40      // 普通指令/数据执行时间（手册37us）
+#define LCD_T_CLEAR_US  1600    // 清屏/归位执行时间（手册1.52ms）
+#define LCD_T_DDR_NS    360     // 读操作 EN 上升沿到数据有效 tDDR
+#define LCD_T_CYC_NS    1000    // EN 周期 tcycE
+
+// 忙标志轮询超时，超过即认为屏幕不再应答，退回定时模式
+#define LCD_BUSY_TIMEOUT_US  5000
+
+// 影子帧缓冲，lcd_print_str也经由它只写变化的字符
+LCD_Fb_t lcd_screen;
+
+// 执行等待方式与忙标志统计
+LCD_BusyStats_t lcd_busy;
+
+// 异步写队列，lcd_async_on置位后由LCD_TIM中断消费
+LCD_Async_t lcd_queue;
+static volatile unsigned char lcd_async_on = 0;
+
+// 忙标志模式下已写出、尚未确认执行完的一项（仅中断修改）
+static volatile unsigned char lcd_inflight = 0;
+static uint32_t lcd_inflight_start;
+static uint16_t lcd_inflight_ticks;
+
+// 数据总线各端口的 MODER 掩码与输出模式值，读忙标志时整条总线切换为输入，
+// 避免与屏幕驱动的 DB0~DB7 冲突
+static GPIO_TypeDef * const lcd_bus_ports[LCD_BUS_PORTS] = {
+    LCD_BUS_PORT0, LCD_BUS_PORT1, LCD_BUS_PORT2, LCD_BUS_PORT3
+};
+static uint32_t lcd_bus_moder_mask[LCD_BUS_PORTS];
+static uint32_t lcd_bus_moder_out[LCD_BUS_PORTS];
+
+// 帧缓冲刷新计时
+static uint32_t lcd_fb_now(void) {
+    return time_now_cycles();
+}
 
 // 初始化 LCD1602 的 GPIO 引脚
 void lcd_gpio_init() {
+    unsigned char k, p;
+
     // 使能时钟
     RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOB | RCC_AHB1Periph_GPIOC | RCC_AHB1Periph_GPIOD | RCC_AHB1Periph_GPIOG, ENABLE);
 
@@ -24,86 +72,199 @@ void lcd_gpio_init() {
     GPIO_Init(EN_GPIO_PORT, &GPIO_InitStructure);
 
     // 初始化数据总线引脚
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_7;
-    GPIO_Init(GPIOD, &GPIO_InitStructure);
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_15;
-    GPIO_Init(GPIOG, &GPIO_InitStructure);
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6 | GPIO_Pin_7 | GPIO_Pin_8 | GPIO_Pin_9 | GPIO_Pin_11;
-    GPIO_Init(GPIOC, &GPIO_InitStructure);
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6;
-    GPIO_Init(GPIOB, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = D0_PIN;
+    GPIO_Init(D0_GPIO_PORT, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = D1_PIN;
+    GPIO_Init(D1_GPIO_PORT, &GPIO_InitStructure);
+    GPIO_InitStructure.GPIO_Pin = D2_PIN | D3_PIN | D4_PIN | D5_PIN | D6_PIN;
+    GPIO_Init(D2_GPIO_PORT, &GPIO_InitStructure);
+    // D7 带下拉：屏幕不驱动总线时读到"不忙"，由lcd_busy_enable的探测发现
+    GPIO_InitStructure.GPIO_Pin = D7_PIN;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_DOWN;
+    GPIO_Init(D7_GPIO_PORT, &GPIO_InitStructure);
+
+    // 由查找表中0xFF一项（每个端口的低16位即该端口上的全部数据线）得出 MODER 掩码
+    for (k = 0; k < LCD_BUS_PORTS; k++) {
+        uint32_t pins = lcd_bus_table[0xFF].bsrr[k] & 0xFFFFu;
+        lcd_bus_moder_mask[k] = 0;
+        lcd_bus_moder_out[k] = 0;
+        for (p = 0; p < 16; p++) {
+            if (pins & (1u << p)) {
+                lcd_bus_moder_mask[k] |= 3u << (2 * p);
+                lcd_bus_moder_out[k] |= 1u << (2 * p);
+            }
+        }
+    }
+}
+
+// 数据总线切换为输入（读）或推挽输出（写）
+static void lcd_bus_dir(unsigned char input) {
+    unsigned char k;
+
+    for (k = 0; k < LCD_BUS_PORTS; k++) {
+        uint32_t moder = lcd_bus_ports[k]->MODER & ~lcd_bus_moder_mask[k];
+        lcd_bus_ports[k]->MODER = input ? moder : (moder | lcd_bus_moder_out[k]);
+    }
+}
+
+// 一次总线写操作：RS、8位数据（每个端口一次BSRR存储）、EN脉冲
+static void lcd_bus_cycle(unsigned char rs, unsigned char v) {
+    const LCD_BusEntry_t *e = &lcd_bus_table[v];
+
+    // RS 选择指令/数据，RW = 0 写，EN 保持低
+    LCD_BSRR(RS_GPIO_PORT) = rs ? (uint32_t)RS_PIN : ((uint32_t)RS_PIN << 16);
+    LCD_BSRR(RW_GPIO_PORT) = (uint32_t)RW_PIN << 16;
+
+    // 将数据送到 D0 ~ D7
+    LCD_BSRR(LCD_BUS_PORT0) = e->bsrr[0];
+    LCD_BSRR(LCD_BUS_PORT1) = e->bsrr[1];
+    LCD_BSRR(LCD_BUS_PORT2) = e->bsrr[2];
+    LCD_BSRR(LCD_BUS_PORT3) = e->bsrr[3];
+
+    // 地址建立时间后拉高 EN，保持脉宽后拉低，数据在下降沿被锁存
+    ndelay(LCD_T_AS_NS);
+    LCD_BSRR(EN_GPIO_PORT) = (uint32_t)EN_PIN;
+    ndelay(LCD_T_PW_NS);
+    LCD_BSRR(EN_GPIO_PORT) = (uint32_t)EN_PIN << 16;
+    ndelay(LCD_T_H_NS);
+}
+
+// 读一次忙标志（总线须已切换为输入）
+static unsigned char lcd_read_busy(void) {
+    unsigned char busy;
+
+    // RS = 0、RW = 1 读忙标志和地址，EN 高电平期间屏幕驱动数据线
+    LCD_BSRR(RS_GPIO_PORT) = (uint32_t)RS_PIN << 16;
+    LCD_BSRR(RW_GPIO_PORT) = (uint32_t)RW_PIN;
+    ndelay(LCD_T_AS_NS);
+    LCD_BSRR(EN_GPIO_PORT) = (uint32_t)EN_PIN;
+    ndelay(LCD_T_DDR_NS);
+    busy = (D7_GPIO_PORT->IDR & D7_PIN) ? 1 : 0;
+    ndelay(LCD_T_PW_NS - LCD_T_DDR_NS);
+    LCD_BSRR(EN_GPIO_PORT) = (uint32_t)EN_PIN << 16;
+    ndelay(LCD_T_CYC_NS - LCD_T_PW_NS);
+    return busy;
+}
+
+// 记录一次实测忙时间
+static void lcd_busy_record(uint32_t us) {
+    lcd_busy.polls++;
+    lcd_busy.last_us = us;
+    lcd_busy.total_us += us;
+    if (us > lcd_busy.max_us) {
+        lcd_busy.max_us = us;
+    }
+}
+
+// 轮询忙标志直到空闲
+// 返回0成功；超时返回1，此时已退回定时模式
+static unsigned char lcd_wait_ready(void) {
+    uint32_t start = time_now_cycles();
+    uint32_t us;
+    unsigned char busy;
+
+    lcd_bus_dir(1);
+    do {
+        busy = lcd_read_busy();
+        us = time_elapsed_us(start);
+    } while (busy && us < LCD_BUSY_TIMEOUT_US);
+    LCD_BSRR(RW_GPIO_PORT) = (uint32_t)RW_PIN << 16;
+    lcd_bus_dir(0);
+
+    if (busy) {
+        lcd_busy.mode = LCD_WAIT_TIMED;
+        lcd_busy.timeouts++;
+        return 1;
+    }
+    lcd_busy_record(us);
+    return 0;
+}
+
+// 等待刚写入的指令/数据执行完成
+static void lcd_wait_exec(uint32_t timed_us) {
+    if (lcd_busy.mode == LCD_WAIT_BUSY && lcd_wait_ready() == 0) {
+        return;
+    }
+    // 定时模式按手册最坏值等待；轮询超时后也补足一次，屏幕状态未知时宁可多等
+    udelay(timed_us);
+}
+
+// 放入异步队列，队列满时等待中断腾出空间
+static void lcd_async_write(uint16_t entry) {
+    if (!lcd_async_put(&lcd_queue, entry)) {
+        lcd_queue.stalls++;
+        while (!lcd_async_put(&lcd_queue, entry)) {
+        }
+    }
+    // 队列空闲时中断已关闭，入队后重新打开
+    TIM_ITConfig(LCD_TIM, TIM_IT_Update, ENABLE);
 }
 
 // 写指令到 LCD1602
 void lcd_write_cmd(unsigned char cmd) {
-    // RS = 0, RW = 0, EN = 0
-    GPIO_WriteBit(RS_GPIO_PORT, RS_PIN, Bit_RESET);
-    GPIO_WriteBit(RW_GPIO_PORT, RW_PIN, Bit_RESET);
-    GPIO_WriteBit(EN_GPIO_PORT, EN_PIN, Bit_RESET);
-
-    // 稍微延时确保控制信号稳定
-    Mdelay_Lib(1);
-
-    // 将指令送到 D0 ~ D7
-		GPIO_WriteBit(GPIOD, GPIO_Pin_7, ((cmd >> 0) & 1) ? Bit_SET : Bit_RESET);  // D0
-		GPIO_WriteBit(GPIOG, GPIO_Pin_15, ((cmd >> 1) & 1) ? Bit_SET : Bit_RESET); // D1
-		GPIO_WriteBit(GPIOC, GPIO_Pin_6, ((cmd >> 2) & 1) ? Bit_SET : Bit_RESET);  // D2
-		GPIO_WriteBit(GPIOC, GPIO_Pin_7, ((cmd >> 3) & 1) ? Bit_SET : Bit_RESET);  // D3
-		GPIO_WriteBit(GPIOC, GPIO_Pin_8, ((cmd >> 4) & 1) ? Bit_SET : Bit_RESET);  // D4
-		GPIO_WriteBit(GPIOC, GPIO_Pin_9, ((cmd >> 5) & 1) ? Bit_SET : Bit_RESET);  // D5
-		GPIO_WriteBit(GPIOC, GPIO_Pin_11, ((cmd >> 6) & 1) ? Bit_SET : Bit_RESET); // D6
-		GPIO_WriteBit(GPIOB, GPIO_Pin_6, ((cmd >> 7) & 1) ? Bit_SET : Bit_RESET);  // D7
-
-    // 延时确保数据线稳定
-    Mdelay_Lib(1);
-
-    // 将 EN 拉高
-    GPIO_WriteBit(EN_GPIO_PORT, EN_PIN, Bit_SET);
-
-    // 延时一段时间 - EN高电平持续时间
-    Mdelay_Lib(1);
-
-    // 将 EN 拉低
-    GPIO_WriteBit(EN_GPIO_PORT, EN_PIN, Bit_RESET);
+    if (lcd_async_on) {
+        lcd_async_write(cmd);
+        return;
+    }
+    lcd_bus_cycle(0, cmd);
     
-    // 命令执行需要时间
-    Mdelay_Lib(2);
+    // 等待指令执行完成：清屏和归位约1.52ms，其余约37us
+    lcd_wait_exec(cmd <= 0x03 ? LCD_T_CLEAR_US : LCD_T_EXEC_US);
 }
 
 // 写数据到 LCD1602
 void lcd_write_dat(unsigned char dat) {
-    // RS = 1, RW = 0, EN = 0
-    GPIO_WriteBit(RS_GPIO_PORT, RS_PIN, Bit_SET);
-    GPIO_WriteBit(RW_GPIO_PORT, RW_PIN, Bit_RESET);
-    GPIO_WriteBit(EN_GPIO_PORT, EN_PIN, Bit_RESET);
-
-    // 稍微延时确保控制信号稳定
-    Mdelay_Lib(1);
-
-    // 将数据送到 D0 ~ D7
-		GPIO_WriteBit(GPIOD, GPIO_Pin_7, ((dat >> 0) & 1) ? Bit_SET : Bit_RESET);  // D0
-		GPIO_WriteBit(GPIOG, GPIO_Pin_15, ((dat >> 1) & 1) ? Bit_SET : Bit_RESET); // D1
-		GPIO_WriteBit(GPIOC, GPIO_Pin_6, ((dat >> 2) & 1) ? Bit_SET : Bit_RESET);  // D2
-		GPIO_WriteBit(GPIOC, GPIO_Pin_7, ((dat >> 3) & 1) ? Bit_SET : Bit_RESET);  // D3
-		GPIO_WriteBit(GPIOC, GPIO_Pin_8, ((dat >> 4) & 1) ? Bit_SET : Bit_RESET);  // D4
-		GPIO_WriteBit(GPIOC, GPIO_Pin_9, ((dat >> 5) & 1) ? Bit_SET : Bit_RESET);  // D5
-		GPIO_WriteBit(GPIOC, GPIO_Pin_11, ((dat >> 6) & 1) ? Bit_SET : Bit_RESET); // D6
-		GPIO_WriteBit(GPIOB, GPIO_Pin_6, ((dat >> 7) & 1) ? Bit_SET : Bit_RESET);  // D7
-		
-    // 延时确保数据线稳定
-    Mdelay_Lib(1);
-
-    // 将 EN 拉高
-    GPIO_WriteBit(EN_GPIO_PORT, EN_PIN, Bit_SET);
-
-    // 延时一段时间 - EN高电平持续时间
-    Mdelay_Lib(1);
-
-    // 将 EN 拉低
-    GPIO_WriteBit(EN_GPIO_PORT, EN_PIN, Bit_RESET);
+    if (lcd_async_on) {
+        lcd_async_write(LCD_ASYNC_RS | dat);
+        return;
+    }
+    lcd_bus_cycle(1, dat);
     
     // 数据写入需要时间
-    Mdelay_Lib(1);
+    lcd_wait_exec(LCD_T_EXEC_US);
+}
+
+// 切换到忙标志轮询模式
+// 先发送归位指令（执行约1.52ms）并立即读忙标志：读不到"忙"说明屏幕不驱动总线
+// （RW未接或屏幕无应答），保持定时模式。返回0成功，1失败
+unsigned char lcd_busy_enable(void) {
+    unsigned char busy, ret;
+
+    // 异步模式下先排空队列，探测期间屏蔽写屏中断，避免与中断争用总线
+    if (lcd_async_on) {
+        lcd_sync();
+        NVIC_DisableIRQ(LCD_TIM_IRQn);
+    }
+
+    lcd_busy.mode = LCD_WAIT_TIMED;
+    lcd_bus_cycle(0, 0x02);
+    lcd_bus_dir(1);
+    busy = lcd_read_busy();
+    LCD_BSRR(RW_GPIO_PORT) = (uint32_t)RW_PIN << 16;
+    lcd_bus_dir(0);
+    // 归位把地址置0，帧缓冲下次刷新时重新定位
+    lcd_screen.cur_valid = 0;
+
+    if (!busy) {
+        lcd_busy.probe_failures++;
+        udelay(LCD_T_CLEAR_US);
+        ret = 1;
+    } else {
+        lcd_busy.mode = LCD_WAIT_BUSY;
+        ret = lcd_wait_ready();
+    }
+
+    if (lcd_async_on) {
+        NVIC_EnableIRQ(LCD_TIM_IRQn);
+    }
+    return ret;
+}
+
+// 回到定时模式
+void lcd_busy_disable(void) {
+    // 先等在途的一项执行完，切换后中断按定时模式计算下一项的等待
+    lcd_sync();
+    lcd_busy.mode = LCD_WAIT_TIMED;
 }
 
 // 初始化 LCD1602
@@ -123,14 +284,124 @@ void lcd_init() {
     lcd_write_cmd(0x38); // 第三次发送确保初始化
     Mdelay_Lib(5);
     
+    lcd_fb_init(&lcd_screen, LCD_ROWS, LCD_COLS, lcd_write_cmd, lcd_write_dat, lcd_fb_now);
+
+    // 功能设置完成后忙标志才有效，此后的指令由lcd_write_cmd等待执行完成
+#if LCD_USE_BUSY_FLAG
+    lcd_busy_enable();
+#endif
+
     lcd_write_cmd(0x0C); // 显示开，光标关，光标不闪烁
-    Mdelay_Lib(5);
-    
     lcd_write_cmd(0x06); // 写一个数据后，显示位置右移一位
-    Mdelay_Lib(5);
-    
     lcd_write_cmd(0x01); // 显示清屏
-    Mdelay_Lib(10);      // 清屏命令需要更长的延时
+
+#if LCD_USE_ASYNC
+    lcd_async_start();
+#endif
+}
+
+// 启动定时器中断异步写屏
+void lcd_async_start(void) {
+    TIM_TimeBaseInitTypeDef tb;
+    NVIC_InitTypeDef nvic;
+    RCC_ClocksTypeDef clocks;
+    uint32_t tim_clk;
+
+    if (lcd_async_on) {
+        return;
+    }
+    lcd_async_init(&lcd_queue, LCD_TICK_US, LCD_T_EXEC_US, LCD_T_CLEAR_US);
+    lcd_inflight = 0;
+
+    RCC_APB1PeriphClockCmd(LCD_TIM_RCC, ENABLE);
+
+    // APB1分频不为1时定时器时钟为PCLK1的两倍
+    RCC_GetClocksFreq(&clocks);
+    tim_clk = clocks.PCLK1_Frequency;
+    if (clocks.PCLK1_Frequency != clocks.HCLK_Frequency) {
+        tim_clk *= 2;
+    }
+
+    tb.TIM_Prescaler = (uint16_t)(tim_clk / 1000000 - 1);
+    tb.TIM_CounterMode = TIM_CounterMode_Up;
+    tb.TIM_Period = LCD_TICK_US - 1;
+    tb.TIM_ClockDivision = TIM_CKD_DIV1;
+    tb.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(LCD_TIM, &tb);
+    TIM_ClearITPendingBit(LCD_TIM, TIM_IT_Update);
+
+    // 写屏不紧急，取最低抢占优先级
+    nvic.NVIC_IRQChannel = LCD_TIM_IRQn;
+    nvic.NVIC_IRQChannelPreemptionPriority = 3;
+    nvic.NVIC_IRQChannelSubPriority = 3;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    TIM_Cmd(LCD_TIM, ENABLE);
+    lcd_async_on = 1;
+}
+
+// 屏障：等待队列中的内容全部写到屏幕并执行完毕
+void lcd_sync(void) {
+    while (!lcd_idle()) {
+    }
+}
+
+// 队列已空且最后一条指令已执行完毕
+uint8_t lcd_idle(void) {
+    return !lcd_async_on || (lcd_async_idle(&lcd_queue) && !lcd_inflight);
+}
+
+// 把帧缓冲的变化写到屏幕，不阻塞
+uint16_t lcd_refresh(void) {
+    // 帧缓冲保留未写出的内容，推迟的变化在下次刷新时一并写出
+    if (lcd_async_on && lcd_async_space(&lcd_queue) < LCD_REFRESH_MAX) {
+        lcd_queue.deferred++;
+        return 0;
+    }
+    return lcd_fb_flush(&lcd_screen);
+}
+
+// 写屏中断：每个tick最多一次总线写操作
+void TIM7_IRQHandler(void) {
+    uint16_t entry;
+
+    TIM_ClearITPendingBit(LCD_TIM, TIM_IT_Update);
+
+    // 忙标志模式：上一项执行完之前不写出下一项
+    if (lcd_inflight) {
+        if (lcd_busy.mode == LCD_WAIT_BUSY) {
+            lcd_bus_dir(1);
+            if (lcd_read_busy()) {
+                LCD_BSRR(RW_GPIO_PORT) = (uint32_t)RW_PIN << 16;
+                lcd_bus_dir(0);
+                if (++lcd_inflight_ticks < LCD_BUSY_TIMEOUT_US / LCD_TICK_US) {
+                    return;
+                }
+                // 屏幕不再应答，退回定时模式并按最坏值补足等待
+                lcd_busy.mode = LCD_WAIT_TIMED;
+                lcd_busy.timeouts++;
+                lcd_async_delay(&lcd_queue, LCD_T_CLEAR_US);
+            } else {
+                LCD_BSRR(RW_GPIO_PORT) = (uint32_t)RW_PIN << 16;
+                lcd_bus_dir(0);
+                lcd_busy_record(time_elapsed_us(lcd_inflight_start));
+            }
+        }
+        lcd_inflight = 0;
+    }
+
+    if (lcd_async_next(&lcd_queue, lcd_busy.mode == LCD_WAIT_BUSY, &entry)) {
+        lcd_bus_cycle((entry & LCD_ASYNC_RS) ? 1 : 0, (unsigned char)entry);
+        if (lcd_busy.mode == LCD_WAIT_BUSY) {
+            lcd_inflight = 1;
+            lcd_inflight_start = time_now_cycles();
+            lcd_inflight_ticks = 0;
+        }
+    } else if (lcd_async_idle(&lcd_queue)) {
+        // 没有待写内容也不需要计时，关闭中断直到下次入队
+        TIM_ITConfig(LCD_TIM, TIM_IT_Update, DISABLE);
+    }
 }
 
 // 设置光标位置
@@ -140,21 +411,22 @@ void lcd_gotoxy(unsigned char line, unsigned char column) {
     } else if (line == 1) { // 第二行
         lcd_write_cmd(0x80 + 0x40 + column);
     }
+    // 地址被外部改变，帧缓冲下次刷新时重新定位
+    lcd_screen.cur_valid = 0;
 }
 
 // 在 LCD1602 上显示字符串
+// 经由帧缓冲写出，与屏幕上已有内容相同的字符不再发送
 void lcd_print_str(unsigned char line, unsigned char column, const char *str) {
-    lcd_gotoxy(line, column); // 设置光标位置
-    while (*str != '\0') {
-        lcd_write_dat(*str++);
-        Mdelay_Lib(1); // 每个字符间稍微延时
-    }
+    lcd_fb_puts(&lcd_screen, line, column, str);
+    lcd_fb_flush(&lcd_screen);
 }
 
 // 清屏函数
 void lcd_clear(void) {
-    lcd_write_cmd(0x01); // 清屏命令
-    Mdelay_Lib(10);      // 清屏需要较长延时
+    lcd_write_cmd(0x01); // 清屏命令，执行等待在lcd_write_cmd中完成
+    lcd_fb_clear(&lcd_screen);
+    lcd_fb_panel_cleared(&lcd_screen);
 }
 
 // LCD调试测试函数
@@ -2,6 +2,12 @@
 #define __LCD_H
 
 #include "stm32f4xx.h"
+#include "lcd_fb.h"
+#include "lcd_async.h"
+
+// 屏幕尺寸
+#define LCD_ROWS     2
+#define LCD_COLS     16
 
 // 定义 LCD1602 的控制引脚
 #define RS_PIN       GPIO_Pin_7
@@ -33,6 +39,61 @@
 #define D6_GPIO_PORT  GPIOC
 #define D7_GPIO_PORT  GPIOB
 
+// 数据总线用到的 GPIO 端口（lcd_bus.c 按端口生成 BSRR 查找表）
+#define LCD_BUS_PORT0  GPIOD
+#define LCD_BUS_PORT1  GPIOG
+#define LCD_BUS_PORT2  GPIOC
+#define LCD_BUS_PORT3  GPIOB
+#define LCD_BUS_PORTS  4
+
+// 每根数据线所在端口的序号，必须与上面的 Dx_GPIO_PORT 一致
+#define D0_PORT_IDX   0
+#define D1_PORT_IDX   1
+#define D2_PORT_IDX   2
+#define D3_PORT_IDX   2
+#define D4_PORT_IDX   2
+#define D5_PORT_IDX   2
+#define D6_PORT_IDX   2
+#define D7_PORT_IDX   3
+
+// 初始化时是否启用忙标志轮询（探测失败自动保持定时模式）
+#define LCD_USE_BUSY_FLAG  1
+
+// 初始化后是否由定时器中断异步写屏（0则所有写操作阻塞到执行完成）
+#define LCD_USE_ASYNC  1
+
+// 异步写屏定时器：每个tick完成一次总线写操作，tick不短于普通指令的执行时间
+#define LCD_TIM          TIM7
+#define LCD_TIM_RCC      RCC_APB1Periph_TIM7
+#define LCD_TIM_IRQn     TIM7_IRQn
+#define LCD_TICK_US      50
+
+// 一次刷新最多写入的项数：每行一条设置地址指令加整行数据
+#define LCD_REFRESH_MAX  (LCD_ROWS * (LCD_COLS + 1))
+
+// 指令执行等待方式
+#define LCD_WAIT_TIMED  0   // 按手册最坏执行时间延时
+#define LCD_WAIT_BUSY   1   // 读回忙标志，屏幕空闲即返回
+
+// 忙标志统计：实测执行时间与定时模式的最坏值（40us/1.6ms）对比
+typedef struct {
+    uint8_t mode;               // 当前等待方式 LCD_WAIT_xxx
+    uint32_t polls;             // 成功轮询次数
+    uint32_t last_us;           // 上次实测忙时间（异步模式下为上限，粒度一个tick）
+    uint32_t max_us;            // 最长忙时间
+    uint32_t total_us;          // 累计忙时间，平均值 = total_us / polls
+    uint32_t timeouts;          // 轮询超时次数（每次超时都会退回定时模式）
+    uint32_t probe_failures;    // 启用时探测失败次数
+} LCD_BusyStats_t;
+
+extern LCD_BusyStats_t lcd_busy;
+
+// 切换到忙标志轮询模式，返回0成功，1屏幕无应答（保持定时模式）
+unsigned char lcd_busy_enable(void);
+
+// 回到定时模式
+void lcd_busy_disable(void);
+
 // 初始化 LCD1602 的 GPIO 引脚
 void lcd_gpio_init(void);
 
@@ -51,6 +112,27 @@ void lcd_gotoxy(unsigned char line, unsigned char column);
 // 在 LCD1602 上显示字符串
 void lcd_print_str(unsigned char line, unsigned char column, const char *str);
 
+// 影子帧缓冲：lcd_fb_puts/lcd_fb_put_line绘制后调用lcd_fb_flush，只写变化的字符
+// 刷新统计在lcd_screen中，耗时单位为CPU周期（可用time_cycles_to_us换算）
+extern LCD_Fb_t lcd_screen;
+
+// 异步写队列及其统计（stalls/deferred/max_depth）
+extern LCD_Async_t lcd_queue;
+
+// 启动定时器中断异步写屏，此后lcd_write_cmd/lcd_write_dat只入队
+// 队列满时写入方等待中断腾出空间，不能在中断中调用
+void lcd_async_start(void);
+
+// 屏障：等待队列中的内容全部写到屏幕并执行完毕（同步模式下立即返回）
+void lcd_sync(void);
+
+// 异步写屏是否已全部完成（同步模式下总是1），不阻塞
+uint8_t lcd_idle(void);
+
+// 把帧缓冲的变化写到屏幕，不阻塞
+// 异步模式下队列放不下一次最坏情况的刷新时推迟到下次调用，返回0
+uint16_t lcd_refresh(void);
+
 // LCD调试和测试函数
 void lcd_debug_test(void);
 void lcd_clear(void);
@@ -0,0 +1,110 @@
+#include "lcd_async.h"
+
+/**
+ * @file    lcd_async.c
+ * @brief   字符LCD异步写队列源文件
+ */
+
+/* 微秒换算为tick数，向上取整，保证等待不短于执行时间 */
+static uint16_t lcd_async_ticks(uint16_t us, uint16_t tick_us)
+{
+    return (uint16_t)((us + tick_us - 1) / tick_us);
+}
+
+/**
+ * @brief  初始化队列
+ */
+void lcd_async_init(LCD_Async_t *a, uint16_t tick_us, uint16_t exec_us, uint16_t clear_us)
+{
+    SPSC_Init(&a->q, a->buf, sizeof(a->buf));
+    a->tick_us = tick_us;
+    a->exec_ticks = lcd_async_ticks(exec_us, tick_us);
+    a->clear_ticks = lcd_async_ticks(clear_us, tick_us);
+    a->holdoff = 0;
+    a->issued = 0;
+    a->stalls = 0;
+    a->deferred = 0;
+    a->max_depth = 0;
+}
+
+/**
+ * @brief  队列剩余空间（项）
+ */
+uint16_t lcd_async_space(const LCD_Async_t *a)
+{
+    return (uint16_t)(SPSC_Free(&a->q) / 2);
+}
+
+/**
+ * @brief  放入一项（生产者调用），不等待
+ */
+uint8_t lcd_async_put(LCD_Async_t *a, uint16_t entry)
+{
+    uint8_t item[2];
+    uint32_t depth;
+
+    /* 一次写入两个字节，head在两字节都写完后才发布，消费者不会读到半项 */
+    if(SPSC_Free(&a->q) < 2)
+    {
+        return 0;
+    }
+    item[0] = (entry & LCD_ASYNC_RS) ? 1 : 0;
+    item[1] = (uint8_t)entry;
+    SPSC_Write(&a->q, item, 2);
+
+    depth = SPSC_Count(&a->q) / 2;
+    if(depth > a->max_depth)
+    {
+        a->max_depth = depth;
+    }
+    return 1;
+}
+
+/**
+ * @brief  队列已空且最后一项已执行完（定时模式）
+ */
+uint8_t lcd_async_idle(const LCD_Async_t *a)
+{
+    return (SPSC_Count(&a->q) == 0 && a->holdoff == 0) ? 1 : 0;
+}
+
+/**
+ * @brief  每个tick调用一次（消费者调用），取出本tick应写出的项
+ */
+uint8_t lcd_async_next(LCD_Async_t *a, uint8_t busy_mode, uint16_t *entry)
+{
+    uint8_t item[2];
+
+    /* 暂停计数减到0的这个tick即可写出下一项 */
+    if(a->holdoff != 0 && --a->holdoff != 0)
+    {
+        return 0;
+    }
+    if(SPSC_Count(&a->q) < 2)
+    {
+        return 0;
+    }
+    SPSC_Read(&a->q, item, 2);
+    *entry = (uint16_t)(item[1] | (item[0] ? LCD_ASYNC_RS : 0));
+    a->issued++;
+
+    if(!busy_mode)
+    {
+        /* 清屏(0x01)和归位(0x02/0x03)执行时间约为其他指令的40倍 */
+        a->holdoff = (!item[0] && item[1] <= 0x03) ? a->clear_ticks : a->exec_ticks;
+    }
+    return 1;
+}
+
+/**
+ * @brief  暂停出队至少us微秒（消费者调用）
+ */
+void lcd_async_delay(LCD_Async_t *a, uint16_t us)
+{
+    uint16_t ticks = lcd_async_ticks(us, a->tick_us);
+
+    if(ticks > a->holdoff)
+    {
+        a->holdoff = ticks;
+    }
+}
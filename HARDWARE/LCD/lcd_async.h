@@ -0,0 +1,80 @@
+#ifndef __LCD_ASYNC_H
+#define __LCD_ASYNC_H
+
+/**
+ * @file    lcd_async.h
+ * @brief   字符LCD异步写队列
+ * @details 主循环把指令/数据放入队列后立即返回，定时器中断每个tick取出一项
+ *          完成一次总线写操作。定时模式下，每项写出后按其执行时间换算成
+ *          tick数暂停出队（清屏/归位约1.6ms，其余约40us）；忙标志模式下
+ *          由调用者读忙标志决定能否出队。
+ *          每项占两个字节（RS标志、数据），经SPSC_Queue在主循环（生产者）
+ *          与中断（消费者）之间传递，不需要关中断。
+ *          本模块不访问外设寄存器，可以在PC上测试
+ */
+
+#include <stdint.h>
+#include "spsc_queue.h"
+
+#define LCD_ASYNC_DEPTH     64          /* 队列容量（项），必须是2的幂 */
+#define LCD_ASYNC_RS        0x100u      /* 项中的RS标志：置位为数据，否则为指令 */
+
+/**
+ * @brief  异步写队列
+ */
+typedef struct {
+    SPSC_Queue_t q;                             /* 两字节一项 */
+    uint8_t buf[LCD_ASYNC_DEPTH * 2];
+    uint16_t tick_us;                           /* 中断周期 */
+    uint16_t exec_ticks;                        /* 普通指令/数据的执行时间（tick） */
+    uint16_t clear_ticks;                       /* 清屏/归位的执行时间（tick） */
+    volatile uint16_t holdoff;                  /* 还需等待的tick数，仅中断修改 */
+
+    uint32_t issued;                            /* 已写出的项数，仅中断修改 */
+    uint32_t stalls;                            /* 队列满使写入方等待的次数 */
+    uint32_t deferred;                          /* 队列空间不足而推迟的刷新次数 */
+    uint32_t max_depth;                         /* 队列最大深度（项） */
+} LCD_Async_t;
+
+/**
+ * @brief  初始化队列
+ * @param  a: 队列
+ * @param  tick_us: 中断周期
+ * @param  exec_us: 普通指令/数据的执行时间
+ * @param  clear_us: 清屏/归位的执行时间
+ */
+void lcd_async_init(LCD_Async_t *a, uint16_t tick_us, uint16_t exec_us, uint16_t clear_us);
+
+/**
+ * @brief  队列剩余空间（项）
+ */
+uint16_t lcd_async_space(const LCD_Async_t *a);
+
+/**
+ * @brief  放入一项（生产者调用），不等待
+ * @param  a: 队列
+ * @param  entry: 数据，写数据时或上LCD_ASYNC_RS
+ * @retval 1-成功, 0-队列满
+ */
+uint8_t lcd_async_put(LCD_Async_t *a, uint16_t entry);
+
+/**
+ * @brief  队列已空且最后一项已执行完（定时模式）
+ */
+uint8_t lcd_async_idle(const LCD_Async_t *a);
+
+/**
+ * @brief  每个tick调用一次（消费者调用），取出本tick应写出的项
+ * @param  a: 队列
+ * @param  busy_mode: 1-调用者已确认屏幕空闲，不按执行时间暂停
+ * @param  entry: 输出，待写出的项
+ * @retval 1-取出一项，调用者应立即写出；0-本tick不写
+ */
+uint8_t lcd_async_next(LCD_Async_t *a, uint8_t busy_mode, uint16_t *entry);
+
+/**
+ * @brief  暂停出队至少us微秒（消费者调用，如忙标志超时后补足等待）
+ */
+void lcd_async_delay(LCD_Async_t *a, uint16_t us);
+
+#endif /* __LCD_ASYNC_H */
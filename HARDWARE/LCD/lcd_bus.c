@@ -0,0 +1,23 @@
+#include "lcd_bus.h"
+
+/**
+ * @file    lcd_bus.c
+ * @brief   LCD1602 八位数据总线的 BSRR 查找表
+ */
+
+#if LCD_BUS_PORTS != 4
+#error "lcd_bus_table 按4个端口生成，修改端口数后需要同步修改 LCD_BUS_ENTRY"
+#endif
+
+#define LCD_BUS_ENTRY(v)    { { LCD_BUS_WORD(v, 0), LCD_BUS_WORD(v, 1), \
+                                LCD_BUS_WORD(v, 2), LCD_BUS_WORD(v, 3) } }
+#define LCD_BUS_ROW4(v)     LCD_BUS_ENTRY(v), LCD_BUS_ENTRY((v) + 1), \
+                            LCD_BUS_ENTRY((v) + 2), LCD_BUS_ENTRY((v) + 3)
+#define LCD_BUS_ROW16(v)    LCD_BUS_ROW4(v), LCD_BUS_ROW4((v) + 4), \
+                            LCD_BUS_ROW4((v) + 8), LCD_BUS_ROW4((v) + 12)
+#define LCD_BUS_ROW64(v)    LCD_BUS_ROW16(v), LCD_BUS_ROW16((v) + 16), \
+                            LCD_BUS_ROW16((v) + 32), LCD_BUS_ROW16((v) + 48)
+
+const LCD_BusEntry_t lcd_bus_table[256] = {
+    LCD_BUS_ROW64(0), LCD_BUS_ROW64(64), LCD_BUS_ROW64(128), LCD_BUS_ROW64(192)
+};
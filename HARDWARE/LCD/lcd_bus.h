@@ -0,0 +1,37 @@
+#ifndef __LCD_BUS_H
+#define __LCD_BUS_H
+
+/**
+ * @file    lcd_bus.h
+ * @brief   LCD1602 八位数据总线的 BSRR 查找表
+ * @details 数据线分布在 LCD_BUS_PORTS 个端口上。对每个字节值，表中为每个端口
+ *          预先算好一个 BSRR 字：低16位置位为1的数据线，高16位复位为0的数据线。
+ *          写一个字节只需对每个端口做一次32位存储，不再逐位读-改-写。
+ *          表在编译期由 lcd.h 中的 Dx_PIN / Dx_PORT_IDX 宏生成
+ */
+
+#include <stdint.h>
+#include "lcd.h"
+
+/* 一根数据线在端口k上的BSRR位：不在该端口为0，否则按值置位或复位 */
+#define LCD_BUS_LINE(v, n, pin, idx, k) \
+    (((idx) != (k)) ? 0u : ((((v) >> (n)) & 1u) ? (uint32_t)(pin) : ((uint32_t)(pin) << 16)))
+
+/* 字节值v在端口k上的BSRR字 */
+#define LCD_BUS_WORD(v, k) \
+    (LCD_BUS_LINE(v, 0, D0_PIN, D0_PORT_IDX, k) | LCD_BUS_LINE(v, 1, D1_PIN, D1_PORT_IDX, k) | \
+     LCD_BUS_LINE(v, 2, D2_PIN, D2_PORT_IDX, k) | LCD_BUS_LINE(v, 3, D3_PIN, D3_PORT_IDX, k) | \
+     LCD_BUS_LINE(v, 4, D4_PIN, D4_PORT_IDX, k) | LCD_BUS_LINE(v, 5, D5_PIN, D5_PORT_IDX, k) | \
+     LCD_BUS_LINE(v, 6, D6_PIN, D6_PORT_IDX, k) | LCD_BUS_LINE(v, 7, D7_PIN, D7_PORT_IDX, k))
+
+/**
+ * @brief  一个字节值对应的各端口BSRR字
+ */
+typedef struct {
+    uint32_t bsrr[LCD_BUS_PORTS];
+} LCD_BusEntry_t;
+
+/* 256项查找表，位于flash */
+extern const LCD_BusEntry_t lcd_bus_table[256];
+
+#endif /* __LCD_BUS_H */
@@ -0,0 +1,186 @@
+#include "lcd_fb.h"
+
+/**
+ * @file    lcd_fb.c
+ * @brief   字符LCD影子帧缓冲源文件
+ */
+
+/* 各行起始DDRAM地址，4x20屏第3、4行接在第1、2行之后 */
+static const uint8_t lcd_fb_row_addr[LCD_FB_ROWS_MAX] = { 0x00, 0x40, 0x14, 0x54 };
+
+/**
+ * @brief  初始化帧缓冲，两份内容都置为空格（与清屏后的屏幕一致）
+ */
+void lcd_fb_init(LCD_Fb_t *fb, uint8_t rows, uint8_t cols,
+                 void (*write_cmd)(uint8_t), void (*write_dat)(uint8_t),
+                 uint32_t (*now)(void))
+{
+    fb->rows = rows > LCD_FB_ROWS_MAX ? LCD_FB_ROWS_MAX : rows;
+    fb->cols = cols > LCD_FB_COLS_MAX ? LCD_FB_COLS_MAX : cols;
+    fb->write_cmd = write_cmd;
+    fb->write_dat = write_dat;
+    fb->now = now;
+    fb->flushes = 0;
+    fb->bytes = 0;
+    fb->last_bytes = 0;
+    fb->last_time = 0;
+    fb->max_time = 0;
+    lcd_fb_clear(fb);
+    lcd_fb_panel_cleared(fb);
+}
+
+/**
+ * @brief  清除待显示内容（不访问屏幕）
+ */
+void lcd_fb_clear(LCD_Fb_t *fb)
+{
+    uint8_t r, c;
+
+    for(r = 0; r < LCD_FB_ROWS_MAX; r++)
+    {
+        for(c = 0; c < LCD_FB_COLS_MAX; c++)
+        {
+            fb->draw[r][c] = ' ';
+        }
+    }
+}
+
+/**
+ * @brief  屏幕已被硬件清屏，同步影子内容
+ */
+void lcd_fb_panel_cleared(LCD_Fb_t *fb)
+{
+    uint8_t r, c;
+
+    for(r = 0; r < LCD_FB_ROWS_MAX; r++)
+    {
+        for(c = 0; c < LCD_FB_COLS_MAX; c++)
+        {
+            fb->panel[r][c] = ' ';
+        }
+    }
+    /* 清屏指令把地址置0 */
+    fb->cur_row = 0;
+    fb->cur_col = 0;
+    fb->cur_valid = 1;
+}
+
+/**
+ * @brief  屏幕内容未知（如外部直接写过屏幕），下次刷新全部重写
+ */
+void lcd_fb_invalidate(LCD_Fb_t *fb)
+{
+    uint8_t r, c;
+
+    for(r = 0; r < LCD_FB_ROWS_MAX; r++)
+    {
+        for(c = 0; c < LCD_FB_COLS_MAX; c++)
+        {
+            /* 0不是可显示字符，保证与任何待显示内容都不同 */
+            fb->panel[r][c] = 0;
+        }
+    }
+    fb->cur_valid = 0;
+}
+
+/**
+ * @brief  在待显示内容中写字符串，超出行尾的部分丢弃
+ */
+void lcd_fb_puts(LCD_Fb_t *fb, uint8_t row, uint8_t col, const char *str)
+{
+    if(row >= fb->rows)
+    {
+        return;
+    }
+    while(*str != '\0' && col < fb->cols)
+    {
+        fb->draw[row][col++] = *str++;
+    }
+}
+
+/**
+ * @brief  写一整行，字符串不足一行时用空格补齐
+ */
+void lcd_fb_put_line(LCD_Fb_t *fb, uint8_t row, const char *str)
+{
+    uint8_t col = 0;
+
+    if(row >= fb->rows)
+    {
+        return;
+    }
+    while(*str != '\0' && col < fb->cols)
+    {
+        fb->draw[row][col++] = *str++;
+    }
+    while(col < fb->cols)
+    {
+        fb->draw[row][col++] = ' ';
+    }
+}
+
+/**
+ * @brief  写一个字符并跟踪控制器地址
+ */
+static void lcd_fb_emit(LCD_Fb_t *fb, uint8_t row, uint8_t col, uint16_t *count)
+{
+    fb->write_dat((uint8_t)fb->draw[row][col]);
+    fb->panel[row][col] = fb->draw[row][col];
+    fb->cur_col = col + 1;
+    (*count)++;
+}
+
+/**
+ * @brief  把变化的字符写到屏幕
+ * @param  fb: 帧缓冲
+ * @retval 本次写入总线的字节数
+ */
+uint16_t lcd_fb_flush(LCD_Fb_t *fb)
+{
+    uint32_t start = fb->now ? fb->now() : 0;
+    uint16_t count = 0;
+    uint8_t r, c, k;
+
+    for(r = 0; r < fb->rows; r++)
+    {
+        for(c = 0; c < fb->cols; c++)
+        {
+            if(fb->draw[r][c] == fb->panel[r][c])
+            {
+                continue;
+            }
+
+            if(fb->cur_valid && fb->cur_row == r && fb->cur_col <= c &&
+               c - fb->cur_col <= LCD_FB_GAP_REWRITE)
+            {
+                /* 与当前地址之间只隔少量未变字符，顺带重写 */
+                for(k = fb->cur_col; k < c; k++)
+                {
+                    lcd_fb_emit(fb, r, k, &count);
+                }
+            }
+            else
+            {
+                fb->write_cmd((uint8_t)(0x80 | (lcd_fb_row_addr[r] + c)));
+                fb->cur_row = r;
+                fb->cur_col = c;
+                fb->cur_valid = 1;
+                count++;
+            }
+            lcd_fb_emit(fb, r, c, &count);
+        }
+    }
+
+    fb->flushes++;
+    fb->bytes += count;
+    fb->last_bytes = count;
+    if(fb->now)
+    {
+        fb->last_time = fb->now() - start;
+        if(fb->last_time > fb->max_time)
+        {
+            fb->max_time = fb->last_time;
+        }
+    }
+    return count;
+}
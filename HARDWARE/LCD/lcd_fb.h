@@ -0,0 +1,93 @@
+#ifndef __LCD_FB_H
+#define __LCD_FB_H
+
+/**
+ * @file    lcd_fb.h
+ * @brief   字符LCD影子帧缓冲
+ * @details 调用者先在内存中绘制，lcd_fb_flush再与屏幕上已有的内容比较，
+ *          只发送变化的字符。HD44780写数据后地址自动加1，所以相邻的变化
+ *          连续写出；两处变化之间只隔一个未变字符时直接重写它，
+ *          比发送一次设置地址命令更省，更远时才移动光标。
+ *          支持2x16到4x20的屏幕。总线操作通过回调完成，
+ *          本模块不访问外设寄存器，可以在PC上用模拟的HD44780测试
+ */
+
+#include <stdint.h>
+
+#define LCD_FB_ROWS_MAX     4
+#define LCD_FB_COLS_MAX     20
+#define LCD_FB_GAP_REWRITE  1       /* 未变字符不超过此数时直接重写而不移动光标 */
+
+/**
+ * @brief  帧缓冲
+ */
+typedef struct {
+    uint8_t rows;                                   /* 行数 */
+    uint8_t cols;                                   /* 列数 */
+    char draw[LCD_FB_ROWS_MAX][LCD_FB_COLS_MAX];    /* 待显示内容 */
+    char panel[LCD_FB_ROWS_MAX][LCD_FB_COLS_MAX];   /* 屏幕上的实际内容 */
+    uint8_t cur_row;                                /* 控制器当前地址对应的行列 */
+    uint8_t cur_col;
+    uint8_t cur_valid;                              /* 当前地址是否已知 */
+
+    void (*write_cmd)(uint8_t cmd);                 /* 写指令 */
+    void (*write_dat)(uint8_t dat);                 /* 写数据 */
+    uint32_t (*now)(void);                          /* 取时间戳，可为空 */
+
+    uint32_t flushes;                               /* 刷新次数 */
+    uint32_t bytes;                                 /* 总线写入字节数（指令+数据） */
+    uint32_t last_bytes;                            /* 上次刷新写入的字节数 */
+    uint32_t last_time;                             /* 上次刷新耗时（now的单位） */
+    uint32_t max_time;                              /* 最长刷新耗时 */
+} LCD_Fb_t;
+
+/**
+ * @brief  初始化帧缓冲，两份内容都置为空格（与清屏后的屏幕一致）
+ * @param  fb: 帧缓冲
+ * @param  rows: 行数，不超过LCD_FB_ROWS_MAX
+ * @param  cols: 列数，不超过LCD_FB_COLS_MAX
+ * @param  write_cmd: 写指令函数
+ * @param  write_dat: 写数据函数
+ * @param  now: 取时间戳函数，用于统计刷新耗时，可为空
+ */
+void lcd_fb_init(LCD_Fb_t *fb, uint8_t rows, uint8_t cols,
+                 void (*write_cmd)(uint8_t), void (*write_dat)(uint8_t),
+                 uint32_t (*now)(void));
+
+/**
+ * @brief  清除待显示内容（不访问屏幕）
+ */
+void lcd_fb_clear(LCD_Fb_t *fb);
+
+/**
+ * @brief  屏幕已被硬件清屏，同步影子内容
+ */
+void lcd_fb_panel_cleared(LCD_Fb_t *fb);
+
+/**
+ * @brief  屏幕内容未知（如外部直接写过屏幕），下次刷新全部重写
+ */
+void lcd_fb_invalidate(LCD_Fb_t *fb);
+
+/**
+ * @brief  在待显示内容中写字符串，超出行尾的部分丢弃
+ * @param  fb: 帧缓冲
+ * @param  row: 行
+ * @param  col: 列
+ * @param  str: 字符串
+ */
+void lcd_fb_puts(LCD_Fb_t *fb, uint8_t row, uint8_t col, const char *str);
+
+/**
+ * @brief  写一整行，字符串不足一行时用空格补齐
+ */
+void lcd_fb_put_line(LCD_Fb_t *fb, uint8_t row, const char *str);
+
+/**
+ * @brief  把变化的字符写到屏幕
+ * @param  fb: 帧缓冲
+ * @retval 本次写入总线的字节数
+ */
+uint16_t lcd_fb_flush(LCD_Fb_t *fb);
+
+#endif /* __LCD_FB_H */
@@ -2,9 +2,18 @@
 #include "led.h"
 #include "key.h"
 #include "beep.h"
+#include "timer_wheel.h"
+
+#define BREATHING_STEP_MS   10      // 呼吸灯每10ms更新一次亮度
 
 // 全局变量记录呼吸灯状态
 static uint8_t breathing_enabled = 0;
+static Timer_Wheel_t *breathing_timers;     // 亮度更新定时器所在的时间轮
+static Timer_t breathing_timer[2];          // LED2和LED3的亮度更新定时器
+static int16_t breathing_brightness[2] = {0, 0};
+static int8_t breathing_direction[2] = {1, 1};
+
+static void Led_BreathingStep(void *arg);
 
 // 初始化LED灯
 void Led_Init(void)
@@ -41,8 +50,9 @@ void Led_Init(void)
 
 /**
  * @brief 初始化呼吸灯PWM功能 (TIM1_CH3和TIM1_CH4)
+ * @param timers: 驱动亮度更新的软件定时器时间轮，须已初始化
  */
-void Led_BreathingInit(void)
+void Led_BreathingInit(Timer_Wheel_t *timers)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
     TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
@@ -93,6 +103,9 @@ void Led_BreathingInit(void)
     // 使能 TIM1
     TIM_Cmd(TIM1, ENABLE);
     
+    breathing_timers = timers;
+    Timer_Init(&breathing_timer[0], Led_BreathingStep, (void *)LED2);
+    Timer_Init(&breathing_timer[1], Led_BreathingStep, (void *)LED3);
     breathing_enabled = 1;
 }
 
@@ -116,40 +129,44 @@ void Led_SetBreathing(uint16_t led_num, uint16_t brightness)
 }
 
 /**
- * @brief 呼吸灯效果 (单次呼吸循环)
+ * @brief 呼吸灯更新一步亮度，由breathing_timer每10ms调用
+ * @param arg: LED编号 (2或3)
+ */
+static void Led_BreathingStep(void *arg)
+{
+    uint16_t led_num = (uint16_t)(uintptr_t)arg;
+    uint8_t idx = (led_num == LED2) ? 0 : 1;
+    
+    // 更新亮度
+    breathing_brightness[idx] += breathing_direction[idx] * 5; // 每次增减5
+    
+    // 检查边界并改变方向
+    if(breathing_brightness[idx] >= 999) {
+        breathing_brightness[idx] = 999;
+        breathing_direction[idx] = -1;
+    }
+    else if(breathing_brightness[idx] <= 0) {
+        breathing_brightness[idx] = 0;
+        breathing_direction[idx] = 1;
+    }
+    
+    // 设置新亮度
+    Led_SetBreathing(led_num, breathing_brightness[idx]);
+}
+
+/**
+ * @brief 呼吸灯效果 - 启动后由软件定时器每10ms更新亮度，直到Led_On/Led_Off/Led_StopBreathing
  * @param led_num: LED编号 (2或3)
+ * @note  已在呼吸时再次调用不影响效果，可以在报警检查中反复调用
  */
 void Led_BreathingEffect(uint16_t led_num)
 {
     if(!breathing_enabled) return;
     
-    static uint16_t brightness[2] = {0, 0}; // LED2和LED3的亮度
-    static int8_t direction[2] = {1, 1};    // 亮度变化方向
-    static uint32_t last_update[2] = {0, 0}; // 上次更新时间
-    
-    extern uint32_t system_tick;
-    
     uint8_t idx = (led_num == LED2) ? 0 : 1;
     
-    // 每10ms更新一次亮度
-    if(system_tick - last_update[idx] >= 10) {
-        last_update[idx] = system_tick;
-        
-        // 更新亮度
-        brightness[idx] += direction[idx] * 5; // 每次增减5
-        
-        // 检查边界并改变方向
-        if(brightness[idx] >= 999) {
-            brightness[idx] = 999;
-            direction[idx] = -1;
-        }
-        else if(brightness[idx] <= 0) {
-            brightness[idx] = 0;
-            direction[idx] = 1;
-        }
-        
-        // 设置新亮度
-        Led_SetBreathing(led_num, brightness[idx]);
+    if(!Timer_Pending(&breathing_timer[idx])) {
+        Timer_Start(breathing_timers, &breathing_timer[idx], 0, BREATHING_STEP_MS);
     }
 }
 
@@ -161,6 +178,10 @@ void Led_StopBreathing(uint16_t led_num)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
     
+    if(breathing_enabled) {
+        Timer_Stop(breathing_timers, &breathing_timer[(led_num == LED2) ? 0 : 1]);
+    }
+    
     if(led_num == LED2) {
         // 停止PWM输出
         TIM_SetCompare3(TIM1, 0);
@@ -208,6 +229,7 @@ void Led_On(uint16_t Led_Num)
         
         case 2: // LED2 (PE13) - 湿度
             if(breathing_enabled) {
+                Timer_Stop(breathing_timers, &breathing_timer[0]);
                 Led_SetBreathing(LED2, 999); // 最亮
             } else {
                 GPIO_ResetBits(LED2_GPIO, LED2_PIN);
@@ -216,6 +238,7 @@ void Led_On(uint16_t Led_Num)
         
         case 3: // LED3 (PE14) - 光照
             if(breathing_enabled) {
+                Timer_Stop(breathing_timers, &breathing_timer[1]);
                 Led_SetBreathing(LED3, 999); // 最亮
             } else {
                 GPIO_ResetBits(LED3_GPIO, LED3_PIN);
@@ -242,6 +265,7 @@ void Led_Off(uint16_t Led_Num)
 
         case 2: // LED2 (PE13) - 湿度
             if(breathing_enabled) {
+                Timer_Stop(breathing_timers, &breathing_timer[0]);
                 Led_SetBreathing(LED2, 0); // 最暗
             } else {
                 GPIO_SetBits(LED2_GPIO, LED2_PIN);
@@ -250,6 +274,7 @@ void Led_Off(uint16_t Led_Num)
         
         case 3: // LED3 (PE14) - 光照
             if(breathing_enabled) {
+                Timer_Stop(breathing_timers, &breathing_timer[1]);
                 Led_SetBreathing(LED3, 0); // 最暗
             } else {
                 GPIO_SetBits(LED3_GPIO, LED3_PIN);
@@ -2,6 +2,7 @@
 #define __LED_H
 
 #include "stm32f4xx.h"
+#include "timer_wheel.h"
 
 //有四个LED
 //LED0 PF9  - 烟雾指示
@@ -40,7 +41,7 @@ void Led_Off(uint16_t Led_Num);
 void Led_Toggle(uint16_t Led_Num);
 
 // 呼吸灯功能 (仅LED2和LED3支持)
-void Led_BreathingInit(void);                    // 初始化呼吸灯PWM
+void Led_BreathingInit(Timer_Wheel_t *timers);  // 初始化呼吸灯PWM，亮度由timers中的定时器更新
 void Led_SetBreathing(uint16_t led_num, uint16_t brightness); // 设置呼吸灯亮度 (0-999)
 void Led_BreathingEffect(uint16_t led_num);      // 呼吸灯效果
 void Led_StopBreathing(uint16_t led_num);        // 停止呼吸灯，恢复普通模式
@@ -1,12 +1,18 @@
 #include "light.h"
 #include "adc3.h" // <--- 已修改: 包含 adc3.h
 #include "delay.h"
+#include "light_conv.h"
+
+/* 光照低报警状态，由看门狗中断切换 */
+static volatile uint8_t light_alarm = 0;
+static uint16_t light_alarm_raw = LIGHT_RAW_MAX + 1;   // 原始值不小于此值即报警
+static uint8_t light_alarm_init = 0;
 
 /**
  * @brief  光敏电阻初始化
  * @param  None
  * @retval None
- * @note   初始化正确的GPIO(PF7)和ADC3
+ * @note   初始化正确的GPIO(PF7)，启动ADC3定时扫描
  */
 void Light_Init(void)
 {
@@ -21,52 +27,116 @@ void Light_Init(void)
     GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;    // 不上拉不下拉
     GPIO_Init(LIGHT_GPIO_PORT, &GPIO_InitStructure);
     
-    // 初始化ADC3
-    Adc3_Init(); // <--- 已修改: 调用 Adc3_Init()
+    // 启动ADC3定时扫描，光敏电阻在扫描序列的ADC3_SCAN_LIGHT位置
+    Adc3_Scan_Init();
     
-    // 短暂延时等待ADC稳定
+    // 等待第一个滤波结果（约ADC3_SCAN_BLOCK ms）
     Mdelay_Lib(20);
 }
 
 /**
- * @brief  获取光敏电阻原始ADC值(单次采样)
+ * @brief  获取光敏电阻ADC值(扫描的最新滤波值，不阻塞)
  * @param  None
- * @retval 12位ADC转换结果 (0-4095)
+ * @retval 12位ADC值 (0-4095)
  */
 uint16_t Light_GetRawValue(void)
 {
-    // 直接返回单次ADC转换结果
-    return Get_Adc3(LIGHT_ADC_CHANNEL);
+    return Adc3_Scan_Get(ADC3_SCAN_LIGHT);
 }
 
 /**
- * @brief  获取光敏电阻值 (多次采样平均，0-100范围)
+ * @brief  获取光敏电阻值 (0-100范围，不阻塞)
  * @param  None
  * @retval 光照强度值 (0-100，0最暗，100最亮)
+ * @note   平均由ADC3扫描的过采样和IIR平滑完成，不再逐次采样等待
  */
 uint8_t Light_GetValue(void)
 {
-    uint32_t temp_val = 0;
-    uint8_t t;
+    uint32_t temp_val = Adc3_Scan_Get(ADC3_SCAN_LIGHT);
+
+    // 线性映射：ADC值小 → 光照强；ADC值大 → 光照弱
+    // light_percent = 100 - (ADC值 / 最大值 * 100)，与报警阈值换算共用
+    return Light_RawToPercent((uint16_t)temp_val);
+}
 
-    // 多次采样取平均值，提高稳定性
-    for(t = 0; t < LSENS_READ_TIMES; t++)
+/* 按当前报警状态设置看门狗窗口：未报警时等待原始值升到阈值，
+ * 报警时等待原始值降到阈值减回差以下 */
+static void Light_Alarm_Arm(void)
+{
+    if(light_alarm_raw > LIGHT_RAW_MAX)
+    {
+        // 阈值为0，永不报警
+        light_alarm = 0;
+        Adc3_Watchdog_SetWindow(0, LIGHT_RAW_MAX);
+    }
+    else if(!light_alarm)
     {
-        temp_val += Get_Adc3(LIGHT_ADC_CHANNEL); // <--- 调用 ADC 获取函数
-        Mdelay_Lib(5);  // 每次采样间隔5ms
+        if(light_alarm_raw == 0)
+        {
+            // 阈值超过100%，始终报警，窗口全量程不再触发
+            light_alarm = 1;
+            Adc3_Watchdog_SetWindow(0, LIGHT_RAW_MAX);
+        }
+        else
+        {
+            Adc3_Watchdog_SetWindow(0, light_alarm_raw - 1);
+        }
     }
+    else
+    {
+        Adc3_Watchdog_SetWindow(light_alarm_raw > LIGHT_ALARM_HYST_RAW ?
+                                light_alarm_raw - LIGHT_ALARM_HYST_RAW : 0, LIGHT_RAW_MAX);
+    }
+}
 
-    temp_val = temp_val / LSENS_READ_TIMES;  // 得到平均值
+/* 看门狗中断：某次原始转换越出了窗口。状态以滤波值为准（与Light_GetValue
+ * 和初始状态一致），滤波值也越过阈值才切换并换到另一侧的窗口；
+ * 否则只是噪声或滤波值尚未跟上，窗口不变，原始值仍在窗口外时下次转换再检查 */
+static void Light_Alarm_Event(void)
+{
+    uint16_t raw = Adc3_Scan_Get(ADC3_SCAN_LIGHT);
 
-    // --- 安全判断，防止ADC超出范围 ---
-    if(temp_val > 4095)
-        temp_val = 4095;
+    if(!light_alarm)
+    {
+        if(raw < light_alarm_raw)
+        {
+            return;
+        }
+    }
+    else if(raw + LIGHT_ALARM_HYST_RAW >= light_alarm_raw)
+    {
+        return;
+    }
+    light_alarm = !light_alarm;
+    Light_Alarm_Arm();
+}
 
-    // 线性映射：ADC值小 → 光照强；ADC值大 → 光照弱
-    // light_percent = 100 - (ADC值 / 最大值 * 100)
-    uint8_t light_percent = 100 - (temp_val * 100 / 4095);
+/**
+ * @brief  设置光照低报警阈值并重新设置看门狗窗口
+ * @param  low_percent: 光照低于此百分比时报警，0为不报警
+ * @note   须在Light_Init之后调用；初始状态和之后的切换都按滤波值确定，
+ *         看门狗只负责在原始值越过阈值时唤醒检查
+ */
+void Light_Alarm_SetThreshold(uint8_t low_percent)
+{
+    NVIC_DisableIRQ(ADC_IRQn);
+    if(!light_alarm_init)
+    {
+        Adc3_Watchdog_Init(ADC3_SCAN_LIGHT, Light_Alarm_Event);
+        light_alarm_init = 1;
+    }
+    light_alarm_raw = Light_LowAlarmRaw(low_percent);
+    light_alarm = (Adc3_Scan_Get(ADC3_SCAN_LIGHT) >= light_alarm_raw);
+    Light_Alarm_Arm();
+    NVIC_EnableIRQ(ADC_IRQn);
+}
 
-    return light_percent;
+/**
+ * @brief  光照低报警是否有效
+ */
+uint8_t Light_Alarm_Active(void)
+{
+    return light_alarm;
 }
 
 
@@ -11,9 +11,6 @@
 #define LIGHT_GPIO_PIN          GPIO_Pin_7          // 使用 Pin 7
 #define LIGHT_GPIO_CLK          RCC_AHB1Periph_GPIOF
 
-/* 光敏电阻读取次数定义 */
-#define LSENS_READ_TIMES        5              // 多次采样取平均值，增加稳定性
-
 /* 光照强度等级定义 (基于0-100范围) */
 typedef enum
 {
@@ -31,4 +28,8 @@ uint8_t Light_GetValue(void);               // 获取0-100范围的光照强度
 LightLevel_t Light_GetLevel(void);
 const char* Light_GetLevelString(LightLevel_t level);
 
+/* 光照低报警：由ADC3模拟看门狗在硬件中比较，只在越过阈值时进入中断 */
+void Light_Alarm_SetThreshold(uint8_t low_percent);    // 阈值变化时调用，重新设置窗口
+uint8_t Light_Alarm_Active(void);
+
 #endif /* __LIGHT_H */
@@ -0,0 +1,44 @@
+#include "light_conv.h"
+
+/**
+ * @file    light_conv.c
+ * @brief   光照百分比与ADC原始值的换算源文件
+ */
+
+/**
+ * @brief  ADC原始值换算为光照百分比
+ */
+uint8_t Light_RawToPercent(uint16_t raw)
+{
+    if(raw > LIGHT_RAW_MAX)
+    {
+        raw = LIGHT_RAW_MAX;
+    }
+    return (uint8_t)(100 - ((uint32_t)raw * 100 / LIGHT_RAW_MAX));
+}
+
+/**
+ * @brief  百分比不超过percent的最小原始值
+ */
+uint16_t Light_PercentToRaw(uint8_t percent)
+{
+    /* 100 - floor(raw*100/4095) <= p  <=>  raw*100 >= (100-p)*4095，向上取整 */
+    if(percent > 100)
+    {
+        percent = 100;
+    }
+    return (uint16_t)(((uint32_t)(100 - percent) * LIGHT_RAW_MAX + 99) / 100);
+}
+
+/**
+ * @brief  光照低报警的原始值阈值
+ */
+uint16_t Light_LowAlarmRaw(uint8_t low_percent)
+{
+    /* percent < low  <=>  percent <= low - 1 */
+    if(low_percent == 0)
+    {
+        return LIGHT_RAW_MAX + 1;
+    }
+    return Light_PercentToRaw(low_percent - 1);
+}
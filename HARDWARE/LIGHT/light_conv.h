@@ -0,0 +1,43 @@
+#ifndef __LIGHT_CONV_H
+#define __LIGHT_CONV_H
+
+/**
+ * @file    light_conv.h
+ * @brief   光照百分比与ADC原始值的换算
+ * @details 光敏电阻分压：ADC值越大光照越弱，percent = 100 - raw * 100 / 4095
+ *          （整数除法）。报警阈值以百分比给出，模拟看门狗比较的是原始值，
+ *          两边必须用同一个映射，否则阈值附近软件显示和硬件报警会不一致。
+ *          本模块不访问外设寄存器，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define LIGHT_RAW_MAX   4095
+
+/* 光照低报警回差：报警后原始值回落到阈值以下这么多才解除。
+ * 每1%对应4095/100 = 40.95个原始值，41即1%：低于N%报警，回到N+1%及以上才解除 */
+#define LIGHT_ALARM_HYST_RAW    41
+
+/**
+ * @brief  ADC原始值换算为光照百分比（Light_GetValue使用的映射）
+ * @param  raw: 12位ADC值，超过4095时按4095
+ * @retval 0-100，0最暗
+ */
+uint8_t Light_RawToPercent(uint16_t raw);
+
+/**
+ * @brief  百分比不超过percent的最小原始值
+ * @details Light_RawToPercent(raw) <= percent 当且仅当 raw >= 返回值
+ * @param  percent: 0-100，超过100时按100
+ */
+uint16_t Light_PercentToRaw(uint8_t percent);
+
+/**
+ * @brief  光照低报警的原始值阈值
+ * @details Light_RawToPercent(raw) < low_percent 当且仅当 raw >= 返回值
+ * @param  low_percent: 报警阈值（百分比）
+ * @retval 原始值阈值；low_percent为0时永不报警，返回LIGHT_RAW_MAX + 1
+ */
+uint16_t Light_LowAlarmRaw(uint8_t low_percent);
+
+#endif /* __LIGHT_CONV_H */
@@ -9,6 +9,7 @@
 #include "delay.h"
 #include "lcd.h"
 #include "light.h"
+#include "uart.h"
 #include <stdio.h>
 
 int main(void)
@@ -52,6 +53,7 @@ int main(void)
         sprintf(str, "Level: %s", Light_GetLevelString(light_level));
         lcd_print_str(1, 0, str);
         
+        UART_Poll();     // 串口中断只入队，在主循环中处理收到的数据
         Mdelay_Lib(500); // 0.5秒更新一次
     }
 }
@@ -30,6 +30,8 @@ void MQ2_Init(void)
     uart_config.DataBits = UART_DATABIT_8;
     uart_config.FlowControl = UART_FLOWCTRL_NONE;
     uart_config.RxIntEnable = ENABLE;
+    uart_config.TxDmaEnable = ENABLE;
+    uart_config.RxDmaEnable = ENABLE;
     uart_config.PreemptionPriority = 2;
     uart_config.SubPriority = 3;
     
@@ -45,6 +45,8 @@ void MQ2_Init(void)
     uart_config.DataBits = UART_DATABIT_8;
     uart_config.FlowControl = UART_FLOWCTRL_NONE;
     uart_config.RxIntEnable = ENABLE;
+    uart_config.TxDmaEnable = ENABLE;
+    uart_config.RxDmaEnable = ENABLE;
     uart_config.PreemptionPriority = 2;
     uart_config.SubPriority = 3;
     
@@ -146,6 +148,7 @@ int main()
         // 等待数据接收完成
         while(MQ2_IsDataReady() == 0)
         {
+            UART_Poll();    // 接收中断只入队，在这里解析MQ-2应答
             Mdelay_Lib(10); // 使用正确的延时函数
         }
 
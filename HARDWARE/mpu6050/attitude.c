@@ -0,0 +1,144 @@
+#include "attitude.h"
+
+/**
+ * @file    attitude.c
+ * @brief   陀螺仪/加速度计互补滤波姿态解算源文件
+ */
+
+/* 绝对值，Cortex-M4F上编译为一条VABS */
+static float attitude_abs(float x)
+{
+    return x < 0.0f ? -x : x;
+}
+
+/* 角度差归一化到-180~180 */
+static float attitude_wrap(float deg)
+{
+    if(deg > 180.0f)
+    {
+        deg -= 360.0f;
+    }
+    else if(deg < -180.0f)
+    {
+        deg += 360.0f;
+    }
+    return deg;
+}
+
+/**
+ * @brief  atan2近似
+ * @details 先把|y|/|x|或|x|/|y|约化到[0,1]，用9次奇多项式计算atan
+ *          （Abramowitz & Stegun 4.4.49，误差不超过1e-5），再按象限展开
+ */
+float Attitude_Atan2(float y, float x)
+{
+    float ax = attitude_abs(x);
+    float ay = attitude_abs(y);
+    float z, z2, r;
+    uint8_t swap;
+
+    if(ax == 0.0f && ay == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    swap = (ay > ax);
+    z = swap ? ax / ay : ay / ax;
+    z2 = z * z;
+    r = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+    if(swap)
+    {
+        r = ATTITUDE_PI / 2 - r;
+    }
+    if(x < 0.0f)
+    {
+        r = ATTITUDE_PI - r;
+    }
+    return y < 0.0f ? -r : r;
+}
+
+/**
+ * @brief  1/sqrt(x)近似
+ * @details 由浮点数的位模式得到初值，再做两次牛顿迭代
+ */
+float Attitude_InvSqrt(float x)
+{
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    float half = 0.5f * x;
+
+    u.f = x;
+    u.i = 0x5F375A86u - (u.i >> 1);
+    u.f = u.f * (1.5f - half * u.f * u.f);
+    u.f = u.f * (1.5f - half * u.f * u.f);
+    return u.f;
+}
+
+/**
+ * @brief  只用加速度计计算横滚和俯仰
+ */
+void Attitude_Accel_Angles(float ax, float ay, float az, float *roll, float *pitch)
+{
+    float yz2 = ay * ay + az * az;
+
+    *roll = Attitude_Atan2(ay, az) * ATTITUDE_RAD2DEG;
+    /* sqrt(yz2) = yz2 * (1/sqrt(yz2)) */
+    *pitch = Attitude_Atan2(-ax, yz2 > 0.0f ? yz2 * Attitude_InvSqrt(yz2) : 0.0f) * ATTITUDE_RAD2DEG;
+}
+
+/**
+ * @brief  初始化
+ */
+void Attitude_Init(Attitude_t *a, float rate_hz, float tau_s)
+{
+    a->roll = 0.0f;
+    a->pitch = 0.0f;
+    a->dt = 1.0f / rate_hz;
+    a->alpha = tau_s / (tau_s + a->dt);
+    a->valid = 0;
+    a->rejected = 0;
+}
+
+/**
+ * @brief  输入一个采样
+ * @note   直接积分机体角速度，倾角不大时与欧拉角速度近似相等
+ */
+void Attitude_Update(Attitude_t *a, float ax, float ay, float az, float gx, float gy)
+{
+    float norm2 = ax * ax + ay * ay + az * az;
+    float lo = 1.0f - ATTITUDE_ACCEL_TOL;
+    float hi = 1.0f + ATTITUDE_ACCEL_TOL;
+    float roll_acc, pitch_acc;
+    uint8_t accel_ok = (norm2 >= lo * lo && norm2 <= hi * hi);
+
+    if(accel_ok)
+    {
+        Attitude_Accel_Angles(ax, ay, az, &roll_acc, &pitch_acc);
+    }
+
+    if(!a->valid)
+    {
+        if(accel_ok)
+        {
+            a->roll = roll_acc;
+            a->pitch = pitch_acc;
+            a->valid = 1;
+        }
+        return;
+    }
+
+    a->roll = attitude_wrap(a->roll + gx * a->dt);
+    a->pitch += gy * a->dt;
+    if(accel_ok)
+    {
+        a->roll = attitude_wrap(a->roll + (1.0f - a->alpha) * attitude_wrap(roll_acc - a->roll));
+        a->pitch += (1.0f - a->alpha) * (pitch_acc - a->pitch);
+    }
+    else
+    {
+        a->rejected++;
+    }
+}
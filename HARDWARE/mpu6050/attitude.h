@@ -0,0 +1,64 @@
+#ifndef __ATTITUDE_H
+#define __ATTITUDE_H
+
+/**
+ * @file    attitude.h
+ * @brief   陀螺仪/加速度计互补滤波姿态解算
+ * @details 每个IMU采样调用一次：横滚、俯仰先按陀螺仪角速度积分，再以
+ *          (1 - alpha)的权重向加速度计算出的角度靠拢，alpha = tau / (tau + dt)。
+ *          陀螺仪负责短时间的快速变化，加速度计消除积分漂移。
+ *          加速度模长偏离1g过多（振动、加速运动）时本次不做加速度修正。
+ *          全部使用单精度浮点（Cortex-M4F硬件FPU），atan2和1/sqrt用近似计算：
+ *          atan2最大误差约1e-5弧度，1/sqrt相对误差小于1e-5。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define ATTITUDE_PI             3.14159265f
+#define ATTITUDE_RAD2DEG        57.2957795f
+#define ATTITUDE_ACCEL_TOL      0.3f        /* 加速度模长在1g±30%以内才用于修正 */
+
+/**
+ * @brief  姿态滤波器
+ */
+typedef struct {
+    float roll;             /* 横滚角，度，-180~180 */
+    float pitch;            /* 俯仰角，度，-90~90 */
+    float dt;               /* 采样周期，秒 */
+    float alpha;            /* 陀螺仪积分的权重 */
+    uint8_t valid;          /* 已用加速度计得到初值 */
+    uint32_t rejected;      /* 加速度模长异常而跳过修正的次数 */
+} Attitude_t;
+
+/**
+ * @brief  初始化
+ * @param  a: 滤波器
+ * @param  rate_hz: 采样率
+ * @param  tau_s: 时间常数，越大越信任陀螺仪
+ */
+void Attitude_Init(Attitude_t *a, float rate_hz, float tau_s);
+
+/**
+ * @brief  输入一个采样
+ * @param  ax, ay, az: 加速度，g
+ * @param  gx, gy: 绕X、Y轴的角速度，度/秒
+ */
+void Attitude_Update(Attitude_t *a, float ax, float ay, float az, float gx, float gy);
+
+/**
+ * @brief  只用加速度计计算横滚和俯仰（度），加速度单位任意
+ */
+void Attitude_Accel_Angles(float ax, float ay, float az, float *roll, float *pitch);
+
+/**
+ * @brief  atan2近似，弧度，最大误差约1e-5
+ */
+float Attitude_Atan2(float y, float x);
+
+/**
+ * @brief  1/sqrt(x)近似，x > 0，相对误差小于1e-5
+ */
+float Attitude_InvSqrt(float x);
+
+#endif /* __ATTITUDE_H */
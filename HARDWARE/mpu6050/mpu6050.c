@@ -1,5 +1,42 @@
 #include "mpu6050.h"
 #include "I2C.h"  // ʹôдI2C.hƥ޸ĵļ
+#include "dwt_time.h"
+#include "exti.h"
+#include "spsc_queue.h"
+
+// 첽ȡ״̬
+#define MPU6050_DMA_IDLE    0
+#define MPU6050_DMA_BUSY    1
+#define MPU6050_DMA_READY   2
+#define MPU6050_DMA_ERROR   3
+
+static uint8_t mpu6050_dma_buf[MPU6050_SAMPLE_SIZE];
+static volatile uint8_t mpu6050_dma_state = MPU6050_DMA_IDLE;
+static uint32_t mpu6050_dma_start;
+static volatile uint32_t mpu6050_dma_cycles;    // ϴ첽ȡߺʱ
+
+// FIFOģʽĽ׶
+#define MPU6050_FIFO_IDLE   0
+#define MPU6050_FIFO_COUNT  1   // FIFO_COUNT
+#define MPU6050_FIFO_STATUS 2   // INT_STATUS
+#define MPU6050_FIFO_DATA   3   // FIFO
+#define MPU6050_FIFO_RESET  4   // λFIFO
+
+static uint8_t mpu6050_fifo_state = MPU6050_FIFO_IDLE;     // ǰ׶Σֻѭ޸
+static uint8_t mpu6050_fifo_busy = 0;                       // ǰ׶εĴѿʼ
+static volatile uint8_t mpu6050_fifo_done = 0;              // I2Cɻصλ
+static volatile uint8_t mpu6050_fifo_result;
+static uint8_t mpu6050_fifo_on = 0;
+static uint8_t mpu6050_fifo_batch = 1;
+static volatile uint8_t mpu6050_fifo_pending = 0;           // ϴζݾ
+static uint16_t mpu6050_fifo_count;
+static uint16_t mpu6050_fifo_len;                           // ζֽ
+static uint8_t mpu6050_fifo_count_buf[2];
+static uint8_t mpu6050_fifo_int_status;
+static uint8_t mpu6050_fifo_buf[MPU6050_FIFO_BURST_MAX];
+static uint8_t mpu6050_fifo_queue_buf[MPU6050_FIFO_QUEUE_SIZE];
+static SPSC_Queue_t mpu6050_fifo_queue;             // ǰݴ
+static MPU6050_FIFO_Stats_t mpu6050_fifo_stats;
 
 // ʼMPU60500ʾɹԭϵͳ
 uint8_t MPU6050_Init(void)
@@ -7,6 +44,7 @@ uint8_t MPU6050_Init(void)
     uint8_t temp;
     
     My_I2C_Init();  // ʼI2Cӿ
+    I2C_Set_Device_Speed(MPU6050_ADDR, I2C_SPEED_FAST, I2C_TIMING_DUTY_AUTO);  // MPU6050֧400kHzģʽ
 
     // MPU6050Ƿ
     temp = MPU6050_Read_Byte(0x75);  // WHO_AM_IĴ
@@ -76,28 +114,368 @@ int16_t MPU6050_Read_Temp(void)
     return (buf[0] << 8) | buf[1];
 }
 
-// ԭϵͳݻȡ
-void MPU6050_GetData(MPU6050_Data_t *data)
+// ԭʼֵΪ
+static void MPU6050_Convert(const MPU6050_Raw_t *raw, MPU6050_Data_t *data)
 {
-    int16_t ax, ay, az, gx, gy, gz, temp;
-    
-    // ȡԭʼ
-    MPU6050_Read_Accel(&ax, &ay, &az);
-    MPU6050_Read_Gyro(&gx, &gy, &gz);
-    temp = MPU6050_Read_Temp();
-    
     // תΪýţ
     // ٶȼƣ2gLSB Sensitivity = 16384 LSB/g
-    data->accel_x = (float)ax / 16384.0f;
-    data->accel_y = (float)ay / 16384.0f;
-    data->accel_z = (float)az / 16384.0f;
+    data->accel_x = (float)raw->accel[0] / 16384.0f;
+    data->accel_y = (float)raw->accel[1] / 16384.0f;
+    data->accel_z = (float)raw->accel[2] / 16384.0f;
     
     // ǣ250/sLSB Sensitivity = 131 LSB/(/s)
-    data->gyro_x = (float)gx / 131.0f;
-    data->gyro_y = (float)gy / 131.0f;
-    data->gyro_z = (float)gz / 131.0f;
+    data->gyro_x = (float)raw->gyro[0] / 131.0f;
+    data->gyro_y = (float)raw->gyro[1] / 131.0f;
+    data->gyro_z = (float)raw->gyro[2] / 131.0f;
     
     // ¶ȣTemperature in degrees C = (TEMP_OUT Register Value as a signed quantity)/340 + 36.53
-    data->temp = (float)temp / 340.0f + 36.53f;
+    data->temp = (float)raw->temp / 340.0f + 36.53f;
+}
+
+// ACCEL_XOUT_Hʼ14ֽڲFIFOȫݵһʽͬ
+void MPU6050_Parse_Sample(const uint8_t *raw, MPU6050_Data_t *data)
+{
+    MPU6050_Raw_t r;
+    
+    mpu6050_fifo_parse(raw, MPU6050_SAMPLE_SIZE, MPU6050_FIFO_ALL, &r, 1);
+    MPU6050_Convert(&r, data);
+}
+
+// ԭϵͳݻȡ
+// һζ14ֽڣٶȡ¶ȡͬһβ߿ֻһ
+void MPU6050_GetData(MPU6050_Data_t *data)
+{
+    uint8_t buf[MPU6050_SAMPLE_SIZE];
+    
+    MPU6050_Read_Multiple(ACCEL_XOUT_H, buf, MPU6050_SAMPLE_SIZE);
+    MPU6050_Parse_Sample(buf, data);
+}
+
+// 첽ȡɣжеã
+static void MPU6050_Read_Done(uint8_t status)
+{
+    mpu6050_dma_cycles = time_now_cycles() - mpu6050_dma_start;
+    mpu6050_dma_state = (status == I2C_OK) ? MPU6050_DMA_READY : MPU6050_DMA_ERROR;
+}
+
+// ʼһ첽ȡ0-ѿʼ, 1-һζȡδɻæ
+uint8_t MPU6050_Start_Read(void)
+{
+    if(mpu6050_dma_state == MPU6050_DMA_BUSY)
+    {
+        return 1;
+    }
+    mpu6050_dma_state = MPU6050_DMA_BUSY;
+    mpu6050_dma_start = time_now_cycles();
+    if(I2C_Read_DMA(MPU6050_ADDR, ACCEL_XOUT_H, mpu6050_dma_buf, MPU6050_SAMPLE_SIZE,
+                    MPU6050_Read_Done) != 0)
+    {
+        mpu6050_dma_state = MPU6050_DMA_IDLE;
+        return 1;
+    }
+    return 0;
+}
+
+// ȡ첽ȡĽ0-, MPU6050_READ_NONE, MPU6050_READ_ERROR
+uint8_t MPU6050_Read_Result(MPU6050_Data_t *data)
+{
+    switch(mpu6050_dma_state)
+    {
+    case MPU6050_DMA_READY:
+        MPU6050_Parse_Sample(mpu6050_dma_buf, data);
+        mpu6050_dma_state = MPU6050_DMA_IDLE;
+        return 0;
+    case MPU6050_DMA_ERROR:
+        mpu6050_dma_state = MPU6050_DMA_IDLE;
+        return MPU6050_READ_ERROR;
+    default:
+        I2C_Poll();     // ƽʱ
+        return MPU6050_READ_NONE;
+    }
+}
+
+// Ƚֶȡʽÿβĺʱظroundsȡƽ
+void MPU6050_Benchmark(MPU6050_Bench_t *bench, uint8_t rounds)
+{
+    MPU6050_Data_t data;
+    int16_t ax, ay, az, gx, gy, gz;
+    uint32_t legacy = 0, burst = 0, bus = 0, cpu = 0;
+    uint32_t t;
+    uint8_t i;
+    
+    if(rounds == 0)
+    {
+        rounds = 1;
+    }
+    time_init();
+    
+    for(i = 0; i < rounds; i++)
+    {
+        // ԭʽζ䣬ÿζSTART/ַ/Ĵ/ظSTART
+        t = time_now_cycles();
+        MPU6050_Read_Accel(&ax, &ay, &az);
+        MPU6050_Read_Gyro(&gx, &gy, &gz);
+        (void)MPU6050_Read_Temp();
+        legacy += time_now_cycles() - t;
+        
+        // һ14ֽȡ
+        t = time_now_cycles();
+        MPU6050_GetData(&data);
+        burst += time_now_cycles() - t;
+        
+        // DMA첽ȡCPUֻжϺDMA
+        while(I2C_DMA_Busy());
+        t = time_now_cycles();
+        if(MPU6050_Start_Read() == 0)
+        {
+            cpu += time_now_cycles() - t;
+            while(mpu6050_dma_state == MPU6050_DMA_BUSY)
+            {
+                I2C_Poll();
+            }
+            bus += mpu6050_dma_cycles;
+            (void)MPU6050_Read_Result(&data);
+        }
+    }
+    
+    bench->legacy_us = time_cycles_to_us(legacy / rounds);
+    bench->burst_us = time_cycles_to_us(burst / rounds);
+    bench->dma_bus_us = time_cycles_to_us(bus / rounds);
+    bench->dma_cpu_us = time_cycles_to_us(cpu / rounds);
+}
+
+// FIFOÿδжеãֻ¼ѭƽһ׶
+static void MPU6050_FIFO_Done(uint8_t status)
+{
+    mpu6050_fifo_result = status;
+    mpu6050_fifo_done = 1;
+}
+
+// Уѭȡʱ
+static void MPU6050_FIFO_Queue(uint8_t size)
+{
+    uint16_t i;
+
+    mpu6050_fifo_stats.bursts++;
+    for(i = 0; i < mpu6050_fifo_len; i += size)
+    {
+        if(SPSC_Free(&mpu6050_fifo_queue) >= size)
+        {
+            SPSC_Write(&mpu6050_fifo_queue, &mpu6050_fifo_buf[i], size);
+            mpu6050_fifo_stats.samples++;
+        }
+        else
+        {
+            mpu6050_fifo_stats.dropped++;
+        }
+    }
 }
 
+// ƽFIFOѭеãFIFO_COUNT -> INT_STATUS -> ݣʱλFIFO
+// I2Cֻ￪ʼEXTII2Cжпʼ
+static void MPU6050_FIFO_Service(void)
+{
+    uint8_t size = mpu6050_fifo_packet_size(MPU6050_FIFO_CONTENT);
+    uint8_t tx[2];
+    uint8_t err;
+
+    I2C_Poll();     // ƽʱ
+
+    if(mpu6050_fifo_busy)
+    {
+        if(!mpu6050_fifo_done)
+        {
+            return;
+        }
+        mpu6050_fifo_busy = 0;
+        mpu6050_fifo_done = 0;
+
+        if(mpu6050_fifo_result != I2C_OK)
+        {
+            mpu6050_fifo_stats.errors++;
+            mpu6050_fifo_state = MPU6050_FIFO_IDLE;
+        }
+        else
+        {
+            switch(mpu6050_fifo_state)
+            {
+            case MPU6050_FIFO_COUNT:
+                mpu6050_fifo_count = ((uint16_t)mpu6050_fifo_count_buf[0] << 8) | mpu6050_fifo_count_buf[1];
+                mpu6050_fifo_state = MPU6050_FIFO_STATUS;
+                break;
+            case MPU6050_FIFO_STATUS:
+                // һдһʱȡµ´
+                mpu6050_fifo_len = mpu6050_fifo_burst_len(mpu6050_fifo_count, size, MPU6050_FIFO_BURST_MAX);
+                if(mpu6050_fifo_overflowed(mpu6050_fifo_int_status, mpu6050_fifo_count))
+                {
+                    mpu6050_fifo_stats.overflows++;
+                    mpu6050_fifo_state = MPU6050_FIFO_RESET;
+                }
+                else
+                {
+                    mpu6050_fifo_state = mpu6050_fifo_len ? MPU6050_FIFO_DATA : MPU6050_FIFO_IDLE;
+                }
+                break;
+            case MPU6050_FIFO_DATA:
+                MPU6050_FIFO_Queue(size);
+                mpu6050_fifo_state = MPU6050_FIFO_IDLE;
+                break;
+            default:
+                mpu6050_fifo_state = MPU6050_FIFO_IDLE;
+                break;
+            }
+        }
+    }
+
+    // ÿbatchݾ忪ʼһֶ
+    if(mpu6050_fifo_state == MPU6050_FIFO_IDLE)
+    {
+        if(!mpu6050_fifo_on || mpu6050_fifo_pending < mpu6050_fifo_batch)
+        {
+            return;
+        }
+        mpu6050_fifo_pending = 0;
+        mpu6050_fifo_state = MPU6050_FIFO_COUNT;
+    }
+
+    // ʼǰ׶εĴ䣻߱ռʱ´
+    switch(mpu6050_fifo_state)
+    {
+    case MPU6050_FIFO_COUNT:
+        tx[0] = FIFO_COUNTH;
+        err = I2C_Transfer_Async(MPU6050_ADDR, tx, 1, mpu6050_fifo_count_buf, 2, MPU6050_FIFO_Done);
+        break;
+    case MPU6050_FIFO_STATUS:
+        // FIFO_COUNT֮ζȡ֮䷢Ҳܷ
+        tx[0] = INT_STATUS;
+        err = I2C_Transfer_Async(MPU6050_ADDR, tx, 1, &mpu6050_fifo_int_status, 1, MPU6050_FIFO_Done);
+        break;
+    case MPU6050_FIFO_DATA:
+        tx[0] = FIFO_R_W;
+        err = I2C_Transfer_Async(MPU6050_ADDR, tx, 1, mpu6050_fifo_buf, mpu6050_fifo_len, MPU6050_FIFO_Done);
+        break;
+    case MPU6050_FIFO_RESET:
+        tx[0] = USER_CTRL;
+        tx[1] = 0x44;   // FIFO_EN | FIFO_RESET
+        err = I2C_Transfer_Async(MPU6050_ADDR, tx, 2, 0, 0, MPU6050_FIFO_Done);
+        break;
+    default:
+        return;
+    }
+    if(err == I2C_OK)
+    {
+        mpu6050_fifo_busy = 1;
+    }
+}
+
+// MPU6050ݾֻѭеMPU6050_FIFO_Readʼ
+void EXTI15_10_IRQHandler(void)
+{
+    if(EXTI_GetITStatus(MPU6050_INT_EXTI_LINE) != RESET)
+    {
+        EXTI_ClearITPendingBit(MPU6050_INT_EXTI_LINE);
+        mpu6050_fifo_stats.drdy++;
+        if(mpu6050_fifo_pending < 255)
+        {
+            mpu6050_fifo_pending++;
+        }
+    }
+}
+
+// FIFOģʽ
+uint8_t MPU6050_FIFO_Start(uint16_t rate_hz, uint8_t batch)
+{
+    uint32_t div;
+    uint8_t err = 0;
+
+    MPU6050_FIFO_Stop();
+
+    if(rate_hz == 0)
+    {
+        rate_hz = 1;
+    }
+    div = MPU6050_GYRO_RATE_HZ / rate_hz;
+    if(div < MPU6050_GYRO_RATE_HZ / 1000)
+    {
+        div = MPU6050_GYRO_RATE_HZ / 1000;      // ٶȼֻ1kHz
+    }
+    if(div > 256)
+    {
+        div = 256;
+    }
+
+    SPSC_Init(&mpu6050_fifo_queue, mpu6050_fifo_queue_buf, MPU6050_FIFO_QUEUE_SIZE);
+    mpu6050_fifo_stats.rate_hz = MPU6050_GYRO_RATE_HZ / div;
+    mpu6050_fifo_stats.drdy = 0;
+    mpu6050_fifo_stats.bursts = 0;
+    mpu6050_fifo_stats.samples = 0;
+    mpu6050_fifo_stats.overflows = 0;
+    mpu6050_fifo_stats.dropped = 0;
+    mpu6050_fifo_stats.errors = 0;
+    mpu6050_fifo_batch = batch ? batch : 1;
+    mpu6050_fifo_pending = 0;
+    mpu6050_fifo_state = MPU6050_FIFO_IDLE;
+    mpu6050_fifo_busy = 0;
+    mpu6050_fifo_done = 0;
+
+    err |= I2C_Write_Byte(MPU6050_ADDR, SMPLRT_DIV, (uint8_t)(div - 1));
+    err |= I2C_Write_Byte(MPU6050_ADDR, INT_PIN_CFG, 0x00);                 // ߵƽЧ졢50us
+    err |= I2C_Write_Byte(MPU6050_ADDR, FIFO_EN, MPU6050_FIFO_CONTENT);
+    err |= I2C_Write_Byte(MPU6050_ADDR, USER_CTRL, 0x44);                   // FIFO_EN | FIFO_RESET
+    err |= I2C_Write_Byte(MPU6050_ADDR, INT_ENABLE, 0x11);                  // FIFO_OFLOW_EN | DATA_RDY_EN
+    if(err)
+    {
+        return 1;
+    }
+
+    // EXTIжֻȼI2Cжͬ
+    mpu6050_fifo_on = 1;
+    EXTI_Config(MPU6050_INT_GPIO, MPU6050_INT_PIN,
+                MPU6050_INT_PORT_SOURCE, MPU6050_INT_PIN_SOURCE,
+                MPU6050_INT_EXTI_LINE, MPU6050_INT_IRQn,
+                EXTI_TRIGGER_RISING, 2, 3);
+    return 0;
+}
+
+// رFIFOģʽ
+void MPU6050_FIFO_Stop(void)
+{
+    if(!mpu6050_fifo_on)
+    {
+        return;
+    }
+    mpu6050_fifo_on = 0;
+    NVIC_DisableIRQ(MPU6050_INT_IRQn);
+    // еһֶ꣬ٿʼµһ
+    while(mpu6050_fifo_state != MPU6050_FIFO_IDLE)
+    {
+        MPU6050_FIFO_Service();
+    }
+    I2C_Write_Byte(MPU6050_ADDR, USER_CTRL, 0x00);
+    I2C_Write_Byte(MPU6050_ADDR, FIFO_EN, 0x00);
+}
+
+// ȡѶĲ
+uint16_t MPU6050_FIFO_Read(MPU6050_Data_t *data, uint16_t max)
+{
+    uint8_t size = mpu6050_fifo_packet_size(MPU6050_FIFO_CONTENT);
+    uint8_t packet[MPU6050_SAMPLE_SIZE];
+    MPU6050_Raw_t raw;
+    uint16_t n = 0;
+
+    MPU6050_FIFO_Service();
+    while(n < max && SPSC_Count(&mpu6050_fifo_queue) >= size)
+    {
+        SPSC_Read(&mpu6050_fifo_queue, packet, size);
+        mpu6050_fifo_parse(packet, size, MPU6050_FIFO_CONTENT, &raw, 1);
+        MPU6050_Convert(&raw, &data[n]);
+        n++;
+    }
+    return n;
+}
+
+// FIFOģʽͳ
+const MPU6050_FIFO_Stats_t *MPU6050_FIFO_Get_Stats(void)
+{
+    return &mpu6050_fifo_stats;
+}
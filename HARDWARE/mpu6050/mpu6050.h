@@ -2,6 +2,7 @@
 #define __MPU6050_H
 
 #include "stm32f4xx.h"
+#include "mpu6050_fifo.h"
 
 // MPU6050ݽṹԭϵͳ
 typedef struct {
@@ -24,17 +25,77 @@ typedef struct {
 #define GYRO_CONFIG 0x1B
 #define ACCEL_CONFIG 0x1C
 #define INT_ENABLE 0x38
+#define INT_STATUS 0x3A
+#define FIFO_EN 0x23
+#define INT_PIN_CFG 0x37
+#define USER_CTRL 0x6A
+#define FIFO_COUNTH 0x72
+#define FIFO_R_W 0x74
 #define ACCEL_XOUT_H 0x3B
 #define GYRO_XOUT_H 0x43
 #define TEMP_OUT_H 0x41
 
+// ACCEL_XOUT_Hʼ14ֽڣٶ6¶26ͬһβ
+#define MPU6050_SAMPLE_SIZE 14
+
+// 첽ȡ
+#define MPU6050_READ_NONE   1   // ûݣδʼڴ䣩
+#define MPU6050_READ_ERROR  2   // I2C
+
+// ÿβߺʱԱȣDWTڼλus
+typedef struct {
+    uint32_t legacy_us;     // ٶ//¶ȷȡ
+    uint32_t burst_us;      // һ14ֽȡ
+    uint32_t dma_bus_us;    // DMA첽ȡӿʼж
+    uint32_t dma_cpu_us;    // DMA첽ȡʼռõCPUʱ
+} MPU6050_Bench_t;
+
+// FIFOģʽMPU6050趨ʰдڲFIFOINTÿβݾ壬
+// EXTIжֻÿbatchMPU6050_FIFO_Readѭ첽
+// FIFO_COUNTINT_STATUSٰFIFOеһζINT_STATUSʱλFIFO
+// MPU6050ûFIFOˮλжϣݾ
+#define MPU6050_INT_GPIO            GPIOE
+#define MPU6050_INT_PIN             GPIO_Pin_12
+#define MPU6050_INT_PORT_SOURCE     EXTI_PortSourceGPIOE
+#define MPU6050_INT_PIN_SOURCE      EXTI_PinSource12
+#define MPU6050_INT_EXTI_LINE       EXTI_Line12
+#define MPU6050_INT_IRQn            EXTI15_10_IRQn
+
+#define MPU6050_FIFO_CONTENT        MPU6050_FIFO_ALL    // дFIFOݣFIFO_ENĴ
+#define MPU6050_FIFO_BURST_MAX      448     // һֽ32
+#define MPU6050_FIFO_QUEUE_SIZE     1024    // Ѷݣ2
+#define MPU6050_GYRO_RATE_HZ        8000    // CONFIGDLPFرʱʣ = 8000 / (1 + SMPLRT_DIV)
+
+// FIFOģʽͳ
+typedef struct {
+    uint32_t rate_hz;       // ʵʲ
+    uint32_t drdy;          // ݾжϴ
+    uint32_t bursts;        // FIFOĴ
+    uint32_t samples;       // Ĳ
+    uint32_t overflows;     // FIFOѸλFIFO
+    uint32_t dropped;       // ѭȡĲ
+    uint32_t errors;        // I2Cʧܴ
+} MPU6050_FIFO_Stats_t;
+
 // 
 uint8_t MPU6050_Init(void);                    // 0ʾɹԭϵͳ
 uint8_t MPU6050_Read_Byte(uint8_t reg);
 void MPU6050_Read_Multiple(uint8_t reg, uint8_t *buf, uint8_t len);
 void MPU6050_Read_Accel(int16_t *ax, int16_t *ay, int16_t *az);
 void MPU6050_Read_Gyro(int16_t *gx, int16_t *gy, int16_t *gz);
-void MPU6050_GetData(MPU6050_Data_t *data);    // ԭϵͳݻȡ
+void MPU6050_GetData(MPU6050_Data_t *data);    // ԭϵͳݻȡһȡ
+void MPU6050_Parse_Sample(const uint8_t *raw, MPU6050_Data_t *data);  // 14ֽڲ
+
+// 첽ȡʼDMAգѭԺȡ
+uint8_t MPU6050_Start_Read(void);                      // 0-ѿʼ, 1-æ
+uint8_t MPU6050_Read_Result(MPU6050_Data_t *data);     // 0-, MPU6050_READ_xxx
+void MPU6050_Benchmark(MPU6050_Bench_t *bench, uint8_t rounds);
+
+// FIFOģʽ
+uint8_t MPU6050_FIFO_Start(uint16_t rate_hz, uint8_t batch);    // rate_hz10000-ɹ, 1-I2C
+void MPU6050_FIFO_Stop(void);
+uint16_t MPU6050_FIFO_Read(MPU6050_Data_t *data, uint16_t max); // ƽFIFOȡѶĲظѭڵ
+const MPU6050_FIFO_Stats_t *MPU6050_FIFO_Get_Stats(void);
 
 #endif
 
@@ -1,26 +1,48 @@
 #include "mpu6050_angle_display.h"
-#include <math.h>
-#include <stdio.h>  //  stdio.h ʹ sprintf 
+#include "fmt.h"
 
-// ֶ M_PI
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+static Attitude_t mpu_attitude;     // ٶȼںϵ̬
+static uint8_t mpu_attitude_on = 0;
 
-// ԭʼתΪǶ
+// ԭʼתΪǶݣֻüٶȼƣȽƼ㣩
 void Convert_To_Angle(int16_t ax, int16_t ay, int16_t az, float *roll, float *pitch)
 {
-    *roll = atan2(ay, az) * 180 / M_PI;
-    *pitch = atan2(-ax, sqrt(ay * ay + az * az)) * 180 / M_PI;
+    Attitude_Accel_Angles((float)ax, (float)ay, (float)az, roll, pitch);
 }
 
-// תΪַ
+// ʼ̬ںϣrate_hzΪMPU6050
+void MPU6050_Attitude_Init(float rate_hz)
+{
+    Attitude_Init(&mpu_attitude, rate_hz, MPU6050_ATTITUDE_TAU_S);
+    mpu_attitude_on = 1;
+}
+
+// ÿһ
+void MPU6050_Attitude_Feed(const MPU6050_Data_t *data)
+{
+    Attitude_Update(&mpu_attitude, data->accel_x, data->accel_y, data->accel_z,
+                    data->gyro_x, data->gyro_y);
+}
+
+// ںϺ̬δʼںʱ0
+uint8_t MPU6050_Attitude_Get(float *roll, float *pitch)
+{
+    if (!mpu_attitude_on || !mpu_attitude.valid)
+    {
+        return 0;
+    }
+    *roll = mpu_attitude.roll;
+    *pitch = mpu_attitude.pitch;
+    return 1;
+}
+
+// תΪַλС룬-0.5"-0.50"
 void Float_To_String(float num, char *str)
 {
-    int int_part = (int)num;
-    int dec_part = (int)((num - int_part) * 100);
-    if (dec_part < 0) dec_part = -dec_part;  // 
-    sprintf(str, "%d.%02d", int_part, dec_part);
+    Fmt_t f;
+
+    Fmt_Init(&f, str, MPU6050_FLOAT_STR_SIZE);
+    Fmt_Float(&f, num, 2, 0);
 }
 
 // ȡMPU6050ݲʾLCDϣƳLCDʼʹϵͳеLCD
@@ -28,14 +50,15 @@ void MPU6050_Read_And_Display(void)
 {
     int16_t ax, ay, az;
     float roll, pitch;
-    char roll_str[10];
-    char pitch_str[10];
-
-    // ȡٶȼ
-    MPU6050_Read_Accel(&ax, &ay, &az);
+    char roll_str[MPU6050_FLOAT_STR_SIZE];
+    char pitch_str[MPU6050_FLOAT_STR_SIZE];
 
-    // ԭʼתΪǶ
-    Convert_To_Angle(ax, ay, az, &roll, &pitch);
+    // ںϽʱֱʹãȡٶȼݼ
+    if (!MPU6050_Attitude_Get(&roll, &pitch))
+    {
+        MPU6050_Read_Accel(&ax, &ay, &az);
+        Convert_To_Angle(ax, ay, az, &roll, &pitch);
+    }
 
     // תΪַ
     Float_To_String(roll, roll_str);
@@ -4,11 +4,20 @@
 #include "stm32f4xx.h"
 #include "mpu6050.h"
 #include "lcd.h"        // ޸ΪϵͳʵʹõLCDͷļ
+#include "attitude.h"
+
+#define MPU6050_ATTITUDE_TAU_S  0.5f    // ˲ʱ䳣룩
+#define MPU6050_FLOAT_STR_SIZE  10      // Float_To_StringС
 
 // ԭʼתΪǶ
 void Convert_To_Angle(int16_t ax, int16_t ay, int16_t az, float *roll, float *pitch);
 
-// תΪַ
+// ̬ںϣԲʳʼÿιһΣʱȡµĺ/ǣȣ
+void MPU6050_Attitude_Init(float rate_hz);
+void MPU6050_Attitude_Feed(const MPU6050_Data_t *data);
+uint8_t MPU6050_Attitude_Get(float *roll, float *pitch);   // 0-޽
+
+// תΪַstrMPU6050_FLOAT_STR_SIZEֽ
 void Float_To_String(float num, char *str);
 
 // ȡMPU6050ݲʾLCDϣƳLCDʼܣͻ
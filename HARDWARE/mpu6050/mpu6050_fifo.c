@@ -0,0 +1,104 @@
+#include "mpu6050_fifo.h"
+
+/**
+ * @file    mpu6050_fifo.c
+ * @brief   MPU6050 FIFO数据包解析源文件
+ */
+
+/* 读出一个高字节在前的16位数 */
+static int16_t mpu6050_fifo_be16(const uint8_t *p)
+{
+    return (int16_t)((p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief  每包字节数
+ */
+uint8_t mpu6050_fifo_packet_size(uint8_t fifo_en)
+{
+    uint8_t size = 0;
+
+    if(fifo_en & MPU6050_FIFO_ACCEL) size += 6;
+    if(fifo_en & MPU6050_FIFO_TEMP)  size += 2;
+    if(fifo_en & MPU6050_FIFO_XG)    size += 2;
+    if(fifo_en & MPU6050_FIFO_YG)    size += 2;
+    if(fifo_en & MPU6050_FIFO_ZG)    size += 2;
+    return size;
+}
+
+/**
+ * @brief  判断FIFO是否溢出
+ */
+uint8_t mpu6050_fifo_overflowed(uint8_t int_status, uint16_t count)
+{
+    return (uint8_t)((int_status & MPU6050_INT_FIFO_OFLOW) != 0 || count >= MPU6050_FIFO_SIZE);
+}
+
+/**
+ * @brief  本次应读出的字节数
+ */
+uint16_t mpu6050_fifo_burst_len(uint16_t count, uint8_t packet_size, uint16_t max_bytes)
+{
+    if(packet_size == 0)
+    {
+        return 0;
+    }
+    if(count > max_bytes)
+    {
+        count = max_bytes;
+    }
+    return count - count % packet_size;
+}
+
+/**
+ * @brief  解析FIFO中读出的数据
+ */
+uint16_t mpu6050_fifo_parse(const uint8_t *buf, uint16_t len, uint8_t fifo_en,
+                            MPU6050_Raw_t *out, uint16_t max)
+{
+    uint8_t size = mpu6050_fifo_packet_size(fifo_en);
+    uint16_t n = 0;
+    uint8_t i;
+
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    while(len >= size && n < max)
+    {
+        for(i = 0; i < 3; i++)
+        {
+            out->accel[i] = 0;
+            out->gyro[i] = 0;
+        }
+        out->temp = 0;
+
+        if(fifo_en & MPU6050_FIFO_ACCEL)
+        {
+            for(i = 0; i < 3; i++)
+            {
+                out->accel[i] = mpu6050_fifo_be16(buf);
+                buf += 2;
+            }
+        }
+        if(fifo_en & MPU6050_FIFO_TEMP)
+        {
+            out->temp = mpu6050_fifo_be16(buf);
+            buf += 2;
+        }
+        for(i = 0; i < 3; i++)
+        {
+            if(fifo_en & (MPU6050_FIFO_XG >> i))
+            {
+                out->gyro[i] = mpu6050_fifo_be16(buf);
+                buf += 2;
+            }
+        }
+
+        len -= size;
+        out++;
+        n++;
+    }
+    return n;
+}
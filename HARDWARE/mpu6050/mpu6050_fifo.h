@@ -0,0 +1,71 @@
+#ifndef __MPU6050_FIFO_H
+#define __MPU6050_FIFO_H
+
+/**
+ * @file    mpu6050_fifo.h
+ * @brief   MPU6050 FIFO数据包解析
+ * @details FIFO_EN寄存器选择写入FIFO的数据，每次采样按寄存器地址顺序写入一包：
+ *          加速度XYZ(6字节)、温度(2)、陀螺仪X(2)、Y(2)、Z(2)，未选择的项不占空间，
+ *          均为高字节在前。FIFO容量1024字节，满后新数据覆盖旧数据，
+ *          包边界随之错位，只能复位FIFO；溢出由INT_STATUS的FIFO_OFLOW_INT位报告。
+ *          FIFO_COUNT可能在一包写到一半时读到，不是整包的倍数不代表溢出，
+ *          读出时向下取整包，余下的字节留到下次。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+/* FIFO_EN寄存器各位 */
+#define MPU6050_FIFO_TEMP       0x80
+#define MPU6050_FIFO_XG         0x40
+#define MPU6050_FIFO_YG         0x20
+#define MPU6050_FIFO_ZG         0x10
+#define MPU6050_FIFO_ACCEL      0x08
+#define MPU6050_FIFO_ALL        0xF8    /* 一包14字节，与ACCEL_XOUT_H开始的连续读取相同 */
+
+#define MPU6050_FIFO_SIZE       1024
+
+/* INT_STATUS寄存器中的FIFO溢出位，读INT_STATUS后清零 */
+#define MPU6050_INT_FIFO_OFLOW  0x10
+
+/**
+ * @brief  一次采样的原始值，未写入FIFO的项为0
+ */
+typedef struct {
+    int16_t accel[3];
+    int16_t temp;
+    int16_t gyro[3];
+} MPU6050_Raw_t;
+
+/**
+ * @brief  每包字节数
+ * @param  fifo_en: FIFO_EN寄存器的值
+ */
+uint8_t mpu6050_fifo_packet_size(uint8_t fifo_en);
+
+/**
+ * @brief  判断FIFO是否溢出
+ * @param  int_status: INT_STATUS寄存器的值
+ * @param  count: FIFO_COUNT，计数达到1024说明已写满，下一次采样必然溢出
+ * @retval 1-已溢出，需要复位FIFO
+ */
+uint8_t mpu6050_fifo_overflowed(uint8_t int_status, uint16_t count);
+
+/**
+ * @brief  本次应读出的字节数：不超过count和max_bytes的整包
+ */
+uint16_t mpu6050_fifo_burst_len(uint16_t count, uint8_t packet_size, uint16_t max_bytes);
+
+/**
+ * @brief  解析FIFO中读出的数据
+ * @param  buf: 数据，从包边界开始
+ * @param  len: 字节数，不足一包的尾部忽略
+ * @param  fifo_en: FIFO_EN寄存器的值
+ * @param  out: 输出
+ * @param  max: out最多容纳的包数
+ * @retval 解析的包数
+ */
+uint16_t mpu6050_fifo_parse(const uint8_t *buf, uint16_t len, uint8_t fifo_en,
+                            MPU6050_Raw_t *out, uint16_t max);
+
+#endif /* __MPU6050_FIFO_H */
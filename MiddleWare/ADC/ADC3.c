@@ -1,6 +1,29 @@
 #include "stm32f4xx.h"
 #include "ADC3.h"
 #include "sys.h"
+#include "adc_filter.h"
+
+/* 扫描序列：通道号与对应引脚，顺序即ADC3_SCAN_xxx序号 */
+typedef struct {
+    uint8_t channel;
+    GPIO_TypeDef *port;
+    uint16_t pin;
+} Adc3_ScanChannel_t;
+
+static const Adc3_ScanChannel_t adc3_scan_table[ADC3_SCAN_CHANNELS] = {
+    {ADC_Channel_5, GPIOF, GPIO_Pin_7},     // 光敏电阻
+    {ADC_Channel_4, GPIOF, GPIO_Pin_6},     // 备用
+    {ADC_Channel_9, GPIOF, GPIO_Pin_3},     // 备用
+};
+
+/* DMA循环写入，前后两半交替：DMA写一半时中断处理另一半 */
+#define ADC3_DMA_HALF   (ADC3_SCAN_BLOCK * ADC3_SCAN_CHANNELS)
+static uint16_t adc3_dma_buf[2 * ADC3_DMA_HALF];
+
+static ADC_Decim_t adc3_filter[ADC3_SCAN_CHANNELS];
+static volatile uint8_t adc3_scan_on = 0;
+static uint32_t adc3_overruns = 0;
+static Adc3_WatchdogCallback adc3_awd_cb = 0;
  
 void Adc3_Init(void)
 {
@@ -59,16 +82,265 @@ u16 Get_Adc3(u8 ch)
         default: return 0; // 无效通道返回0
     }
     
+    // 扫描运行时规则序列归扫描所有，扫描中的通道直接返回滤波值
+    if(adc3_scan_on)
+    {
+        u8 i;
+        for(i = 0; i < ADC3_SCAN_CHANNELS; i++)
+        {
+            if(adc3_scan_table[i].channel == ch)
+            {
+                return Adc3_Scan_Get(i);
+            }
+        }
+        return 0;
+    }
+    
 	ADC_RegularChannelConfig(ADC3, adc_channel, 1, ADC_SampleTime_480Cycles); //设置ADC规则组通道，1个序列 采样时间
 	ADC_SoftwareStartConv(ADC3);//使能指定的ADC3的软件转换启动功能
 	while(!ADC_GetFlagStatus(ADC3,ADC_FLAG_EOC));//等待状态寄存器转换标志位结束
 	return ADC_GetConversionValue(ADC3);   //返回转换的结果
 }
 
+/**
+ * @brief  启动ADC3多通道扫描
+ * @note   TIM2更新事件(TRGO)以ADC3_SCAN_RATE_HZ触发一次规则组扫描，
+ *         DMA2 Stream0 Channel2循环搬运结果，半满/全满中断中把刚写完的
+ *         一半交给各通道的抽取滤波器。之后Get_Adc3对扫描中的通道返回滤波值
+ */
+void Adc3_Scan_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    ADC_CommonInitTypeDef ADC_CommonInitStructure;
+    ADC_InitTypeDef ADC_InitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    RCC_ClocksTypeDef clocks;
+    uint32_t tim_clk;
+    u8 i;
+
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOF | RCC_AHB1Periph_DMA2, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC3, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+
+    // 扫描通道的引脚配置为模拟输入
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AN;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;
+    for(i = 0; i < ADC3_SCAN_CHANNELS; i++)
+    {
+        GPIO_InitStructure.GPIO_Pin = adc3_scan_table[i].pin;
+        GPIO_Init(adc3_scan_table[i].port, &GPIO_InitStructure);
+        ADC_Decim_Init(&adc3_filter[i], ADC3_OVERSAMPLE_BITS, ADC3_IIR_SHIFT);
+    }
+
+    RCC_APB2PeriphResetCmd(RCC_APB2Periph_ADC3, ENABLE);
+    RCC_APB2PeriphResetCmd(RCC_APB2Periph_ADC3, DISABLE);
+
+    // DMA：ADC3 DR -> adc3_dma_buf，半字，循环模式
+    DMA_DeInit(DMA2_Stream0);
+    while(DMA_GetCmdStatus(DMA2_Stream0) != DISABLE);
+
+    DMA_InitStructure.DMA_Channel = DMA_Channel_2;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&ADC3->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)adc3_dma_buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = 2 * ADC3_DMA_HALF;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(DMA2_Stream0, &DMA_InitStructure);
+    DMA_ITConfig(DMA2_Stream0, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = DMA2_Stream0_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+    DMA_Cmd(DMA2_Stream0, ENABLE);
+
+    ADC_CommonInitStructure.ADC_Mode = ADC_Mode_Independent;
+    ADC_CommonInitStructure.ADC_Prescaler = ADC_Prescaler_Div4;
+    ADC_CommonInitStructure.ADC_DMAAccessMode = ADC_DMAAccessMode_Disabled;  // 多重模式才用，独立模式由ADC3自身发DMA请求
+    ADC_CommonInitStructure.ADC_TwoSamplingDelay = ADC_TwoSamplingDelay_5Cycles;
+    ADC_CommonInit(&ADC_CommonInitStructure);
+
+    ADC_InitStructure.ADC_Resolution = ADC_Resolution_12b;
+    ADC_InitStructure.ADC_ScanConvMode = ENABLE;                     // 一次触发转换全部通道
+    ADC_InitStructure.ADC_ContinuousConvMode = DISABLE;              // 由定时器节拍触发
+    ADC_InitStructure.ADC_ExternalTrigConvEdge = ADC_ExternalTrigConvEdge_Rising;
+    ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_T2_TRGO;
+    ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
+    ADC_InitStructure.ADC_NbrOfConversion = ADC3_SCAN_CHANNELS;
+    ADC_Init(ADC3, &ADC_InitStructure);
 
+    // 光敏电阻分压内阻较大，保留480周期采样；每通道约23us，一次扫描远小于1ms
+    for(i = 0; i < ADC3_SCAN_CHANNELS; i++)
+    {
+        ADC_RegularChannelConfig(ADC3, adc3_scan_table[i].channel, i + 1, ADC_SampleTime_480Cycles);
+    }
+
+    ADC_DMARequestAfterLastTransferCmd(ADC3, ENABLE);   // 循环DMA需要持续发出请求
+    ADC_DMACmd(ADC3, ENABLE);
+    ADC_Cmd(ADC3, ENABLE);
 
+    // TIM2：1MHz计数，更新事件作为TRGO；APB1分频不为1时定时器时钟为PCLK1的两倍
+    RCC_GetClocksFreq(&clocks);
+    tim_clk = clocks.PCLK1_Frequency;
+    if(clocks.PCLK1_Frequency != clocks.HCLK_Frequency)
+    {
+        tim_clk *= 2;
+    }
+    TIM_TimeBaseStructure.TIM_Prescaler = (uint16_t)(tim_clk / 1000000 - 1);
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseStructure.TIM_Period = 1000000 / ADC3_SCAN_RATE_HZ - 1;
+    TIM_TimeBaseStructure.TIM_ClockDivision = TIM_CKD_DIV1;
+    TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;
+    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
+    TIM_SelectOutputTrigger(TIM2, TIM_TRGOSource_Update);
+
+    adc3_overruns = 0;
+    adc3_scan_on = 1;
+    TIM_Cmd(TIM2, ENABLE);
+}
+
+/**
+ * @brief  扫描是否在运行
+ */
+uint8_t Adc3_Scan_Running(void)
+{
+    return adc3_scan_on;
+}
 
+/**
+ * @brief  该通道是否已有滤波结果（启动后约 ADC3_SCAN_BLOCK ms）
+ */
+uint8_t Adc3_Scan_Ready(uint8_t idx)
+{
+    return (idx < ADC3_SCAN_CHANNELS) ? adc3_filter[idx].valid : 0;
+}
 
+/**
+ * @brief  最新滤波值，12位，不阻塞
+ */
+u16 Adc3_Scan_Get(uint8_t idx)
+{
+    return (idx < ADC3_SCAN_CHANNELS) ? ADC_Decim_Get12(&adc3_filter[idx]) : 0;
+}
 
+/**
+ * @brief  最新滤波值，12+ADC3_OVERSAMPLE_BITS位
+ */
+u16 Adc3_Scan_GetHires(uint8_t idx)
+{
+    return (idx < ADC3_SCAN_CHANNELS) ? ADC_Decim_Get(&adc3_filter[idx]) : 0;
+}
 
+/**
+ * @brief  缓冲区覆盖次数
+ */
+uint32_t Adc3_Scan_Overruns(void)
+{
+    return adc3_overruns;
+}
 
+/* 把一半缓冲区交给各通道的滤波器 */
+static void Adc3_Scan_Process(const uint16_t *half)
+{
+    u8 i;
+
+    for(i = 0; i < ADC3_SCAN_CHANNELS; i++)
+    {
+        ADC_Decim_FeedBlock(&adc3_filter[i], half + i, ADC3_SCAN_CHANNELS, ADC3_SCAN_BLOCK);
+    }
+}
+
+void DMA2_Stream0_IRQHandler(void)
+{
+    uint8_t ht = DMA_GetITStatus(DMA2_Stream0, DMA_IT_HTIF0) != RESET;
+    uint8_t tc = DMA_GetITStatus(DMA2_Stream0, DMA_IT_TCIF0) != RESET;
+
+    DMA_ClearITPendingBit(DMA2_Stream0, DMA_IT_HTIF0 | DMA_IT_TCIF0);
+
+    // 两个标志同时置位说明上一个中断被耽搁太久，DMA已越过未处理的一半
+    if(ht && tc)
+    {
+        adc3_overruns++;
+    }
+    if(ht)
+    {
+        Adc3_Scan_Process(&adc3_dma_buf[0]);
+    }
+    if(tc)
+    {
+        Adc3_Scan_Process(&adc3_dma_buf[ADC3_DMA_HALF]);
+    }
+}
+
+/**
+ * @brief  在扫描通道idx上启用模拟看门狗中断
+ * @param  idx: ADC3_SCAN_xxx
+ * @param  cb: 越出窗口时在中断中调用
+ *         （扫描中后续通道的转换很快覆盖DR，所以不传触发时的原始值）
+ * @note   须在Adc3_Scan_Init之后调用；窗口初始为全量程，不会触发
+ */
+void Adc3_Watchdog_Init(uint8_t idx, Adc3_WatchdogCallback cb)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    if(idx >= ADC3_SCAN_CHANNELS)
+    {
+        return;
+    }
+    adc3_awd_cb = cb;
+
+    ADC_AnalogWatchdogThresholdsConfig(ADC3, 4095, 0);
+    ADC_AnalogWatchdogSingleChannelConfig(ADC3, adc3_scan_table[idx].channel);
+    ADC_AnalogWatchdogCmd(ADC3, ADC_AnalogWatchdog_SingleRegEnable);
+    ADC_ClearITPendingBit(ADC3, ADC_IT_AWD);
+    ADC_ITConfig(ADC3, ADC_IT_AWD, ENABLE);
+
+    // ADC1/2/3共用一个中断向量
+    NVIC_InitStructure.NVIC_IRQChannel = ADC_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/**
+ * @brief  设置看门狗窗口，原始值小于low或大于high时触发
+ */
+void Adc3_Watchdog_SetWindow(u16 low, u16 high)
+{
+    ADC_AnalogWatchdogThresholdsConfig(ADC3, high, low);
+}
+
+/**
+ * @brief  关闭看门狗中断
+ */
+void Adc3_Watchdog_Disable(void)
+{
+    ADC_ITConfig(ADC3, ADC_IT_AWD, DISABLE);
+    ADC_AnalogWatchdogCmd(ADC3, ADC_AnalogWatchdog_None);
+    ADC_ClearITPendingBit(ADC3, ADC_IT_AWD);
+}
+
+void ADC_IRQHandler(void)
+{
+    if(ADC_GetITStatus(ADC3, ADC_IT_AWD) != RESET)
+    {
+        ADC_ClearITPendingBit(ADC3, ADC_IT_AWD);
+        if(adc3_awd_cb)
+        {
+            adc3_awd_cb();
+        }
+    }
+}
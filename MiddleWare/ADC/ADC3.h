@@ -7,10 +7,37 @@
 typedef uint8_t u8;
 typedef uint16_t u16;
 
+/* 扫描通道序号，顺序与ADC3.c中adc3_scan_table一致 */
+#define ADC3_SCAN_LIGHT         0       /* PF7 -> ADC3_IN5 光敏电阻 */
+#define ADC3_SCAN_SPARE1        1       /* PF6 -> ADC3_IN4 备用 */
+#define ADC3_SCAN_SPARE2        2       /* PF3 -> ADC3_IN9 备用 */
+#define ADC3_SCAN_CHANNELS      3
+
+/* 扫描参数 */
+#define ADC3_SCAN_RATE_HZ       1000    /* TIM2触发的扫描频率，每次扫描转换全部通道 */
+#define ADC3_SCAN_BLOCK         16      /* DMA半缓冲区包含的扫描次数，即中断间隔（ms） */
+#define ADC3_OVERSAMPLE_BITS    2       /* 16倍过采样，14位结果，每通道62.5Hz输出 */
+#define ADC3_IIR_SHIFT          2       /* 抽取后IIR平滑系数1/4 */
+
 /* 函数声明 */
 void Adc3_Init(void);
 u16 Get_Adc3(u8 ch);
 
+/* 定时器触发的多通道扫描：DMA双缓冲，中断中完成过采样抽取 */
+void Adc3_Scan_Init(void);
+uint8_t Adc3_Scan_Running(void);
+uint8_t Adc3_Scan_Ready(uint8_t idx);      /* 该通道已有滤波结果 */
+u16 Adc3_Scan_Get(uint8_t idx);            /* 最新滤波值，12位，不阻塞 */
+u16 Adc3_Scan_GetHires(uint8_t idx);       /* 最新滤波值，12+ADC3_OVERSAMPLE_BITS位 */
+uint32_t Adc3_Scan_Overruns(void);         /* 中断未及时处理导致的缓冲区覆盖次数 */
+
+/* 模拟看门狗：监视一个扫描通道的每次转换，原始值越出[low, high]窗口时
+ * 在中断中调用回调。回调中通常改写窗口，否则之后每次转换都会再触发 */
+typedef void (*Adc3_WatchdogCallback)(void);
+void Adc3_Watchdog_Init(uint8_t idx, Adc3_WatchdogCallback cb);
+void Adc3_Watchdog_SetWindow(u16 low, u16 high);
+void Adc3_Watchdog_Disable(void);
+
 #endif
 
 
@@ -0,0 +1,103 @@
+#include "adc_filter.h"
+
+/**
+ * @file    adc_filter.c
+ * @brief   ADC过采样抽取滤波器源文件
+ */
+
+/**
+ * @brief  初始化滤波器
+ */
+void ADC_Decim_Init(ADC_Decim_t *d, uint8_t os_bits, uint8_t iir_shift)
+{
+    if(os_bits > ADC_DECIM_BITS_MAX)
+    {
+        os_bits = ADC_DECIM_BITS_MAX;
+    }
+    d->os_bits = os_bits;
+    d->iir_shift = iir_shift;
+    d->n = (uint16_t)(1u << (2 * os_bits));
+    d->count = 0;
+    d->acc = 0;
+    d->iir = 0;
+    d->value = 0;
+    d->valid = 0;
+    d->outputs = 0;
+}
+
+/**
+ * @brief  输入一个采样
+ */
+uint8_t ADC_Decim_Feed(ADC_Decim_t *d, uint16_t sample)
+{
+    uint32_t out;
+
+    d->acc += sample;
+    if(++d->count < d->n)
+    {
+        return 0;
+    }
+
+    /* 4^n个采样的和右移n位，四舍五入 */
+    out = d->os_bits ? (d->acc + (1u << (d->os_bits - 1))) >> d->os_bits : d->acc;
+    d->acc = 0;
+    d->count = 0;
+
+    if(d->iir_shift == 0)
+    {
+        d->value = (uint16_t)out;
+    }
+    else
+    {
+        /* 第一个输出直接作为初值，避免从0缓慢爬升 */
+        if(!d->valid)
+        {
+            d->iir = out << d->iir_shift;
+        }
+        else
+        {
+            d->iir = d->iir - (d->iir >> d->iir_shift) + out;
+        }
+        d->value = (uint16_t)((d->iir + (1u << (d->iir_shift - 1))) >> d->iir_shift);
+    }
+    d->valid = 1;
+    d->outputs++;
+    return 1;
+}
+
+/**
+ * @brief  输入一段交织存放的采样
+ */
+uint16_t ADC_Decim_FeedBlock(ADC_Decim_t *d, const uint16_t *samples, uint16_t stride, uint16_t count)
+{
+    uint16_t outputs = 0;
+
+    while(count--)
+    {
+        outputs += ADC_Decim_Feed(d, *samples);
+        samples += stride;
+    }
+    return outputs;
+}
+
+/**
+ * @brief  最新输出，12+os_bits位
+ */
+uint16_t ADC_Decim_Get(const ADC_Decim_t *d)
+{
+    return d->value;
+}
+
+/**
+ * @brief  最新输出换算回12位（四舍五入）
+ */
+uint16_t ADC_Decim_Get12(const ADC_Decim_t *d)
+{
+    uint32_t v = d->value;
+
+    if(d->os_bits)
+    {
+        v = (v + (1u << (d->os_bits - 1))) >> d->os_bits;
+    }
+    return v > 4095 ? 4095 : (uint16_t)v;
+}
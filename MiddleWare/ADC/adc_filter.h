@@ -0,0 +1,66 @@
+#ifndef __ADC_FILTER_H
+#define __ADC_FILTER_H
+
+/**
+ * @file    adc_filter.h
+ * @brief   ADC过采样抽取滤波器
+ * @details 每累加4^n个12位采样输出一次，和右移n位得到12+n位的结果
+ *          （噪声足够时每4倍过采样多1位有效分辨率），输出率为采样率的1/4^n。
+ *          抽取结果再经过一阶IIR平滑：y += (x - y) / 2^k。
+ *          最新值可随时O(1)读取。本模块不访问外设寄存器，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define ADC_DECIM_BITS_MAX  4       /* 最多256倍过采样，结果16位 */
+
+/**
+ * @brief  一个通道的抽取滤波器
+ */
+typedef struct {
+    uint8_t os_bits;            /* 过采样增加的位数n */
+    uint8_t iir_shift;          /* IIR平滑系数k，0为不平滑 */
+    uint16_t n;                 /* 每次输出累加的采样数4^n */
+    uint16_t count;             /* 已累加的采样数 */
+    uint32_t acc;               /* 累加和 */
+    uint32_t iir;               /* IIR状态，为输出值左移k位 */
+    volatile uint16_t value;    /* 最新输出，12+n位 */
+    volatile uint8_t valid;     /* 已有输出 */
+    uint32_t outputs;           /* 输出次数 */
+} ADC_Decim_t;
+
+/**
+ * @brief  初始化滤波器
+ * @param  d: 滤波器
+ * @param  os_bits: 过采样增加的位数，超过ADC_DECIM_BITS_MAX时按最大值
+ * @param  iir_shift: IIR平滑系数，0为不平滑
+ */
+void ADC_Decim_Init(ADC_Decim_t *d, uint8_t os_bits, uint8_t iir_shift);
+
+/**
+ * @brief  输入一个采样
+ * @retval 1-产生了新的输出, 0-没有
+ */
+uint8_t ADC_Decim_Feed(ADC_Decim_t *d, uint16_t sample);
+
+/**
+ * @brief  输入一段交织存放的采样（DMA扫描缓冲区中的一个通道）
+ * @param  d: 滤波器
+ * @param  samples: 该通道的第一个采样
+ * @param  stride: 相邻两个采样的间隔（扫描的通道数）
+ * @param  count: 采样个数
+ * @retval 新产生的输出个数
+ */
+uint16_t ADC_Decim_FeedBlock(ADC_Decim_t *d, const uint16_t *samples, uint16_t stride, uint16_t count);
+
+/**
+ * @brief  最新输出，12+os_bits位；尚无输出时为0
+ */
+uint16_t ADC_Decim_Get(const ADC_Decim_t *d);
+
+/**
+ * @brief  最新输出换算回12位（四舍五入）
+ */
+uint16_t ADC_Decim_Get12(const ADC_Decim_t *d);
+
+#endif /* __ADC_FILTER_H */
@@ -1,17 +1,75 @@
 #include "i2c.h"
+#include "dwt_time.h"
+
+// I2C1_RXDMA1 Stream0 Channel1Stream5USART2_RX
+#define I2C_RX_DMA_STREAM   DMA1_Stream0
+#define I2C_RX_DMA_CHANNEL  DMA_Channel_1
+#define I2C_RX_DMA_IRQn     DMA1_Stream0_IRQn
+#define I2C_RX_DMA_TCIF     DMA_IT_TCIF0
+#define I2C_RX_DMA_FLAGS    (DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 | DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0)
+
+#define I2C_SCL_PIN         GPIO_Pin_8
+#define I2C_SDA_PIN         GPIO_Pin_9
+
+// Ǽǹٶȵ豸
+typedef struct {
+    uint8_t addr;
+    I2C_Timing_t timing;
+} I2C_Profile_t;
+
+static I2C_Sm_t i2c_sm;
+static I2C_Profile_t i2c_profiles[I2C_MAX_DEVICES];
+static uint8_t i2c_profile_count = 0;
+static I2C_Timing_t i2c_default_timing;                     // δǼǵ豸ʹñ׼ģʽ
+static const I2C_Timing_t *i2c_timing = &i2c_default_timing; // ǰдĴ
+static I2C_DoneCallback i2c_cb = 0;
+static volatile uint8_t i2c_recover_pending = 0;           // жгҪ߻ָI2C_Pollִ
+static uint16_t i2c_start_act = I2C_ACT_NONE;              // ߿кִеSTART
+static volatile uint8_t i2c_block_done;
+static volatile uint8_t i2c_block_status;
+
+// дʱӼĴCCRTRISEֻPE=0ʱ޸
+static void I2C_Timing_Write(const I2C_Timing_t *t)
+{
+    I2C_Cmd(I2C1, DISABLE);
+    I2C1->CR2 = (I2C1->CR2 & ~I2C_CR2_FREQ) | t->freq;
+    I2C1->CCR = t->ccr;
+    I2C1->TRISE = t->trise;
+    I2C_Cmd(I2C1, ENABLE);
+}
 
-// ʼI2Cӿ
-void My_I2C_Init(void)
+// 豸ٶ
+static const I2C_Timing_t *I2C_Profile_Find(uint8_t addr)
+{
+    uint8_t i;
+
+    for (i = 0; i < i2c_profile_count; i++)
+    {
+        if (i2c_profiles[i].addr == (addr & 0xFE))
+        {
+            return &i2c_profiles[i].timing;
+        }
+    }
+    return &i2c_default_timing;
+}
+
+// APB1ʱ
+static uint32_t I2C_PCLK1(void)
+{
+    RCC_ClocksTypeDef clocks;
+
+    RCC_GetClocksFreq(&clocks);
+    return clocks.PCLK1_Frequency;
+}
+
+// PB8/PB9I2C1Ĵʼ߻ָ
+static void I2C_Periph_Config(void)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
     I2C_InitTypeDef I2C_InitStructure;
 
-    // ʹGPIOBI2C1ʱ
-    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
-
     // PB8PB9Ϊù
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_8 | GPIO_Pin_9;
+    GPIO_InitStructure.GPIO_Pin = I2C_SCL_PIN | I2C_SDA_PIN;
     GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
     GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
@@ -31,94 +89,450 @@ void My_I2C_Init(void)
     I2C_InitStructure.I2C_ClockSpeed = 100000;
     I2C_Init(I2C1, &I2C_InitStructure);
 
-    // ʹI2C1
-    I2C_Cmd(I2C1, ENABLE);
+    // ǰ豸ٶдʱӼĴʹI2C1
+    I2C_Timing_Write(i2c_timing);
 }
 
-// I2C豸дһֽ
-void I2C_Write_Byte(uint8_t addr, uint8_t reg, uint8_t data)
+// ߻ָӻڴ;ʱһֱסSDA
+// ֶ9SCLʱ굱ǰֽڣٲSTOPλI2C1
+static void I2C_Bus_Recover(void)
 {
-    while (I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY));
+    GPIO_InitTypeDef GPIO_InitStructure;
+    uint8_t i;
 
-    I2C_GenerateSTART(I2C1, ENABLE);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+    I2C_Cmd(I2C1, DISABLE);
 
-    I2C_Send7bitAddress(I2C1, addr, I2C_Direction_Transmitter);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED));
+    GPIO_SetBits(GPIOB, I2C_SCL_PIN | I2C_SDA_PIN);
+    GPIO_InitStructure.GPIO_Pin = I2C_SCL_PIN | I2C_SDA_PIN;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+    udelay(I2C_RECOVER_HALF_US);
 
-    I2C_SendData(I2C1, reg);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+    for (i = 0; i < 9 && GPIO_ReadInputDataBit(GPIOB, I2C_SDA_PIN) == Bit_RESET; i++)
+    {
+        GPIO_ResetBits(GPIOB, I2C_SCL_PIN);
+        udelay(I2C_RECOVER_HALF_US);
+        GPIO_SetBits(GPIOB, I2C_SCL_PIN);
+        udelay(I2C_RECOVER_HALF_US);
+    }
 
-    I2C_SendData(I2C1, data);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+    // STOPSCLΪʱSDAɵͱ
+    GPIO_ResetBits(GPIOB, I2C_SCL_PIN);
+    udelay(I2C_RECOVER_HALF_US);
+    GPIO_ResetBits(GPIOB, I2C_SDA_PIN);
+    udelay(I2C_RECOVER_HALF_US);
+    GPIO_SetBits(GPIOB, I2C_SCL_PIN);
+    udelay(I2C_RECOVER_HALF_US);
+    GPIO_SetBits(GPIOB, I2C_SDA_PIN);
+    udelay(I2C_RECOVER_HALF_US);
+
+    // λסBUSY־λĴ
+    I2C_SoftwareResetCmd(I2C1, ENABLE);
+    I2C_SoftwareResetCmd(I2C1, DISABLE);
+    I2C_Periph_Config();
+}
 
-    I2C_GenerateSTOP(I2C1, ENABLE);
+// DMAlenֽڵbuf
+static void I2C_RX_DMA_Config(uint8_t *buf, uint16_t len)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+
+    DMA_Cmd(I2C_RX_DMA_STREAM, DISABLE);
+    while (DMA_GetCmdStatus(I2C_RX_DMA_STREAM) != DISABLE);
+
+    DMA_InitStructure.DMA_Channel = I2C_RX_DMA_CHANNEL;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&I2C1->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = len;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(I2C_RX_DMA_STREAM, &DMA_InitStructure);
+    DMA_ClearFlag(I2C_RX_DMA_STREAM, I2C_RX_DMA_FLAGS);
+    DMA_ITConfig(I2C_RX_DMA_STREAM, DMA_IT_TC, ENABLE);
+    DMA_Cmd(I2C_RX_DMA_STREAM, ENABLE);
 }
 
-// I2C豸ȡһֽ
-uint8_t I2C_Read_Byte(uint8_t addr, uint8_t reg)
+// ִ״̬صĶ˳i2c_sm.hеĶһ
+static void I2C_Apply(uint16_t act)
+{
+    I2C_DoneCallback cb;
+
+    if (act & I2C_ACT_ACK_ON)
+    {
+        I2C_AcknowledgeConfig(I2C1, ENABLE);
+    }
+    if (act & I2C_ACT_ACK_OFF)
+    {
+        I2C_AcknowledgeConfig(I2C1, DISABLE);
+    }
+    if (act & I2C_ACT_DMA_RX)
+    {
+        // DMAENADDR֮ǰλһֽӲԶNACK
+        I2C_RX_DMA_Config(i2c_sm.rx, i2c_sm.rx_len);
+        I2C_DMALastTransferCmd(I2C1, ENABLE);
+        I2C_DMACmd(I2C1, ENABLE);
+    }
+    if (act & I2C_ACT_CLEAR_ADDR)
+    {
+        (void)I2C1->SR2;    // SR1SR2ADDR
+    }
+    if (act & I2C_ACT_EVT_OFF)
+    {
+        I2C_ITConfig(I2C1, I2C_IT_EVT, DISABLE);
+    }
+    if (act & I2C_ACT_BUF_ON)
+    {
+        I2C_ITConfig(I2C1, I2C_IT_BUF, ENABLE);
+    }
+    if (act & I2C_ACT_SEND)
+    {
+        I2C_SendData(I2C1, i2c_sm.out);
+    }
+    if (act & I2C_ACT_STOP)
+    {
+        I2C_GenerateSTOP(I2C1, ENABLE);
+    }
+    if (act & I2C_ACT_START)
+    {
+        I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+        I2C_GenerateSTART(I2C1, ENABLE);
+    }
+    if (act & I2C_ACT_IT_OFF)
+    {
+        I2C_ITConfig(I2C1, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+        I2C_DMACmd(I2C1, DISABLE);
+        I2C_DMALastTransferCmd(I2C1, DISABLE);
+        DMA_Cmd(I2C_RX_DMA_STREAM, DISABLE);
+    }
+    if (act & I2C_ACT_RECOVER)
+    {
+        // ֶ9SCLҪ΢룬жУֻñ־I2C_Poll
+        i2c_recover_pending = 1;
+    }
+    if (act & I2C_ACT_DONE)
+    {
+        cb = i2c_cb;
+        i2c_cb = 0;
+        if (cb)
+        {
+            cb(i2c_sm.result);
+        }
+    }
+}
+
+// ʼһγԣһεSTOPܻû꣬ߵȴָ
+// ʱæȣ¶I2C_Poll߿кִУ
+// BUSYһֱͷʱSTART׶γʱ״̬Ҫָߺ
+static void I2C_Start(uint16_t act)
+{
+    const I2C_Timing_t *timing;
+
+    if (i2c_recover_pending || I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY))
+    {
+        i2c_start_act = act;
+        return;
+    }
+    i2c_start_act = I2C_ACT_NONE;
+
+    // 豸ٶȲͬ߿ʱлʱ
+    timing = I2C_Profile_Find(i2c_sm.addr);
+    if (timing != i2c_timing)
+    {
+        i2c_timing = timing;
+        I2C_Timing_Write(timing);
+    }
+    I2C_Apply(act);
+}
+
+// /ָI2Cжϣѭв״̬ʱʹ
+static void I2C_IRQ_Mask(FunctionalState mask)
+{
+    if (mask == ENABLE)
+    {
+        NVIC_DisableIRQ(I2C1_EV_IRQn);
+        NVIC_DisableIRQ(I2C1_ER_IRQn);
+        NVIC_DisableIRQ(I2C_RX_DMA_IRQn);
+    }
+    else
+    {
+        NVIC_EnableIRQ(I2C1_EV_IRQn);
+        NVIC_EnableIRQ(I2C1_ER_IRQn);
+        NVIC_EnableIRQ(I2C_RX_DMA_IRQn);
+    }
+}
+
+// ʼI2Cӿ
+void My_I2C_Init(void)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    // ʹGPIOBI2C1DMA1ʱ
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB | RCC_AHB1Periph_DMA1, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
+
+    time_init();
+    i2c_sm_init(&i2c_sm, time_us_to_cycles(I2C_PHASE_TIMEOUT_US), time_us_to_cycles(I2C_BYTE_TIMEOUT_US),
+                time_us_to_cycles(I2C_BACKOFF_US), I2C_MAX_RETRIES);
+    i2c_cb = 0;
+
+    i2c_timing_compute(I2C_PCLK1(), I2C_SPEED_STANDARD, I2C_TIMING_DUTY_2, &i2c_default_timing);
+    i2c_timing = &i2c_default_timing;
+    i2c_profile_count = 0;
+
+    // ϵʱӻSDAMCUڴ;λȻָ
+    I2C_Periph_Config();
+    if (I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY))
+    {
+        i2c_sm.recoveries++;
+        I2C_Bus_Recover();
+    }
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = I2C1_EV_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = I2C1_ER_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = I2C_RX_DMA_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+// 豸ٶ
+uint32_t I2C_Set_Device_Speed(uint8_t addr, uint32_t hz, uint8_t duty)
 {
-    uint8_t data;
+    I2C_Timing_t t;
+    I2C_Profile_t *p = 0;
+    uint8_t i;
+
+    if (i2c_timing_compute(I2C_PCLK1(), hz, duty, &t) != 0)
+    {
+        return 0;
+    }
+
+    addr &= 0xFE;
+    for (i = 0; i < i2c_profile_count; i++)
+    {
+        if (i2c_profiles[i].addr == addr)
+        {
+            p = &i2c_profiles[i];
+            break;
+        }
+    }
+    if (p == 0)
+    {
+        if (i2c_profile_count >= I2C_MAX_DEVICES)
+        {
+            return 0;
+        }
+        p = &i2c_profiles[i2c_profile_count];
+    }
 
-    while (I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY));
+    // вܸʱӼĴ
+    while (I2C_DMA_Busy());
+    p->addr = addr;
+    p->timing = t;
+    if (p == &i2c_profiles[i2c_profile_count])
+    {
+        i2c_profile_count++;
+    }
+    if (i2c_timing == &p->timing)
+    {
+        I2C_Timing_Write(i2c_timing);
+    }
+    return t.scl_hz;
+}
 
-    I2C_GenerateSTART(I2C1, ENABLE);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+// ǰߵSCLƵ
+uint32_t I2C_Get_Speed(void)
+{
+    return i2c_timing->scl_hz;
+}
 
-    I2C_Send7bitAddress(I2C1, addr, I2C_Direction_Transmitter);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED));
+// 첽
+uint8_t I2C_Transfer_Async(uint8_t addr, const uint8_t *tx, uint8_t tx_len,
+                           uint8_t *rx, uint16_t rx_len, I2C_DoneCallback cb)
+{
+    uint32_t primask;
+    uint16_t act;
 
-    I2C_SendData(I2C1, reg);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+    // ɻصжУҲܿʼ䣬еռ״̬֮䲻ܱ
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (i2c_sm_busy(&i2c_sm))
+    {
+        __set_PRIMASK(primask);
+        return I2C_ERR_BUSY;
+    }
 
-    I2C_GenerateSTART(I2C1, ENABLE);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+    act = i2c_sm_begin(&i2c_sm, addr, tx, tx_len, rx, rx_len, time_now_cycles());
+    if (act != I2C_ACT_NONE)
+    {
+        i2c_cb = cb;
+    }
+    __set_PRIMASK(primask);
+    if (act == I2C_ACT_NONE)
+    {
+        return I2C_ERR_BUSY;
+    }
+    I2C_Start(act);
+    return I2C_OK;
+}
 
-    I2C_Send7bitAddress(I2C1, addr, I2C_Direction_Receiver);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED));
+// 
+static void I2C_Block_Done(uint8_t status)
+{
+    i2c_block_status = status;
+    i2c_block_done = 1;
+}
 
-    I2C_AcknowledgeConfig(I2C1, DISABLE);
-    I2C_GenerateSTOP(I2C1, ENABLE);
+// 
+uint8_t I2C_Transfer(uint8_t addr, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint16_t rx_len)
+{
+    uint8_t status;
 
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED));
-    data = I2C_ReceiveData(I2C1);
+    // ȴе첽ͬʱI2C1
+    // տֱжȿʼ˴ʱٵһ
+    i2c_block_done = 0;
+    do
+    {
+        while (I2C_DMA_Busy());
+        status = I2C_Transfer_Async(addr, tx, tx_len, rx, rx_len, I2C_Block_Done);
+    } while (status == I2C_ERR_BUSY && i2c_sm_busy(&i2c_sm));
+    if (status != I2C_OK)
+    {
+        return status;
+    }
+    while (!i2c_block_done)
+    {
+        I2C_Poll();
+    }
+    return i2c_block_status;
+}
 
+// I2C豸дһֽ
+uint8_t I2C_Write_Byte(uint8_t addr, uint8_t reg, uint8_t data)
+{
+    uint8_t tx[2];
+
+    tx[0] = reg;
+    tx[1] = data;
+    return I2C_Transfer(addr, tx, 2, 0, 0);
+}
+
+// I2C豸ȡһֽ
+uint8_t I2C_Read_Byte(uint8_t addr, uint8_t reg)
+{
+    uint8_t data = 0;
+
+    if (I2C_Transfer(addr, &reg, 1, &data, 1) != I2C_OK)
+    {
+        return 0;
+    }
     return data;
 }
 
 // I2C豸ȡֽ
-void I2C_Read_Multiple(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len)
+uint8_t I2C_Read_Multiple(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len)
 {
-    while (I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY));
+    return I2C_Transfer(addr, &reg, 1, buf, len);
+}
 
-    I2C_GenerateSTART(I2C1, ENABLE);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+// 첽ֽ
+uint8_t I2C_Read_DMA(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len, I2C_DoneCallback cb)
+{
+    return I2C_Transfer_Async(addr, &reg, 1, buf, len, cb);
+}
 
-    I2C_Send7bitAddress(I2C1, addr, I2C_Direction_Transmitter);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED));
+// 첽Ƿ
+uint8_t I2C_DMA_Busy(void)
+{
+    I2C_Poll();
+    return i2c_sm_busy(&i2c_sm);
+}
 
-    I2C_SendData(I2C1, reg);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_TRANSMITTED));
+// 鳬ʱƽԣִ߻ָƳٵSTART߳ģ
+void I2C_Poll(void)
+{
+    uint16_t act;
 
-    I2C_GenerateSTART(I2C1, ENABLE);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_MODE_SELECT));
+    if (!i2c_sm_busy(&i2c_sm) && !i2c_recover_pending)
+    {
+        return;
+    }
+    I2C_IRQ_Mask(ENABLE);
+    act = i2c_sm_poll(&i2c_sm, time_now_cycles());
+    if (act & I2C_ACT_START)
+    {
+        // ˱ܺԣ´һ߿ٿʼ
+        i2c_start_act = act;
+        act = I2C_ACT_NONE;
+    }
+    else if (act & I2C_ACT_IT_OFF)
+    {
+        // γʧܣƳٵSTART
+        i2c_start_act = I2C_ACT_NONE;
+    }
+    I2C_Apply(act);
 
-    I2C_Send7bitAddress(I2C1, addr, I2C_Direction_Receiver);
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED));
+    if (i2c_recover_pending)
+    {
+        i2c_recover_pending = 0;
+        I2C_Bus_Recover();
+    }
+    if (i2c_start_act != I2C_ACT_NONE)
+    {
+        I2C_Start(i2c_start_act);
+    }
+    I2C_IRQ_Mask(DISABLE);
+}
 
-    I2C_AcknowledgeConfig(I2C1, ENABLE);
+// ͳ
+const I2C_Sm_t *I2C_Get_Stats(void)
+{
+    return &i2c_sm;
+}
 
-    for (uint8_t i = 0; i < len - 1; i++)
+// ¼жϣSBADDRBTFֽڶRXNE
+void I2C1_EV_IRQHandler(void)
+{
+    uint16_t sr1 = I2C1->SR1;
+    uint8_t data = 0;
+
+    if (sr1 & I2C_SR1_RXNE)
     {
-        while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED));
-        buf[i] = I2C_ReceiveData(I2C1);
+        data = I2C_ReceiveData(I2C1);
     }
+    I2C_Apply(i2c_sm_event(&i2c_sm, sr1, data, time_now_cycles()));
+}
 
-    I2C_AcknowledgeConfig(I2C1, DISABLE);
-    I2C_GenerateSTOP(I2C1, ENABLE);
+// жϣӦʧܡߴٲöʧ
+void I2C1_ER_IRQHandler(void)
+{
+    uint16_t flags = I2C1->SR1 & (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR);
 
-    while (!I2C_CheckEvent(I2C1, I2C_EVENT_MASTER_BYTE_RECEIVED));
-    buf[len - 1] = I2C_ReceiveData(I2C1);
+    I2C_ClearITPendingBit(I2C1, I2C_IT_AF | I2C_IT_ARLO | I2C_IT_BERR | I2C_IT_OVR);
+    I2C_Apply(i2c_sm_error(&i2c_sm, flags, time_now_cycles()));
 }
 
-
+// DMAɣһֽѻNACKSTOP
+void DMA1_Stream0_IRQHandler(void)
+{
+    if (DMA_GetITStatus(I2C_RX_DMA_STREAM, I2C_RX_DMA_TCIF) != RESET)
+    {
+        DMA_ClearITPendingBit(I2C_RX_DMA_STREAM, I2C_RX_DMA_TCIF);
+        I2C_Apply(i2c_sm_dma_done(&i2c_sm, time_now_cycles()));
+    }
+}
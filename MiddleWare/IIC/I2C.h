@@ -2,15 +2,52 @@
 #define __I2C_H
 
 #include "stm32f4xx.h"
+#include "i2c_sm.h"
+#include "i2c_timing.h"
+
+// д䶼I2C1¼/жƽi2c_sm״̬ȡ2ֽʱDMA1 Stream0ա
+// ÿ׶гʱI2C_MAX_RETRIESΣߴͳʱȻָ
+#define I2C_PHASE_TIMEOUT_US    2000    // ÿ׶ΣSTARTַÿֽڣĳʱ
+#define I2C_BYTE_TIMEOUT_US     200     // DMAս׶ÿֽ׷ӵĳʱ
+#define I2C_BACKOFF_US          1000    // Եĵȴʱ
+#define I2C_MAX_RETRIES         2
+#define I2C_RECOVER_HALF_US     5       // ߻ָʱֶSCLİڣ100kHz
+#define I2C_MAX_DEVICES         4       // ɵٶȵ豸
 
 // ʼI2Cӿ
 void My_I2C_Init(void);
-// I2C豸дһֽ
-void I2C_Write_Byte(uint8_t addr, uint8_t reg, uint8_t data);
-// I2C豸ȡһֽ
+// 豸ٶȣhzΪI2C_SPEED_STANDARD/I2C_SPEED_FASTȣdutyΪģʽռձI2C_TIMING_DUTY_xxx
+// δõ豸ʹ100kHz׼ģʽ俪ʼǰ豸лʱãͬٶȵ豸ɹI2C1
+// ذAPB1ʱʵʵõSCLƵʣ0ʾ޷豸
+uint32_t I2C_Set_Device_Speed(uint8_t addr, uint32_t hz, uint8_t duty);
+// ǰߵSCLƵ
+uint32_t I2C_Get_Speed(void);
+// I2C豸дһֽڣI2C_OKI2C_ERR_xxx
+uint8_t I2C_Write_Byte(uint8_t addr, uint8_t reg, uint8_t data);
+// I2C豸ȡһֽڣʧʱ0
 uint8_t I2C_Read_Byte(uint8_t addr, uint8_t reg);
-// I2C豸ȡֽ
-void I2C_Read_Multiple(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len);
+// I2C豸ȡֽڣI2C_OKI2C_ERR_xxx
+uint8_t I2C_Read_Multiple(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len);
 
-#endif
+// 䣺ȷtxĴַݣҪʱظSTARTrxI2C_OKI2C_ERR_xxx
+uint8_t I2C_Transfer(uint8_t addr, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint16_t rx_len);
+
+// 첽ɻصжϻI2C_PollеãstatusΪI2C_OKI2C_ERR_xxx
+typedef void (*I2C_DoneCallback)(uint8_t status);
 
+// 첽䣬ͬI2C_TransfertxᱻƣrxǰЧȴжеã
+// æһεSTOPδ꣩ȴָʱSTARTƳٵI2C_Poll߿к󷢳
+// I2C_OK-ѿʼ, I2C_ERR_BUSY-һδδɻ
+uint8_t I2C_Transfer_Async(uint8_t addr, const uint8_t *tx, uint8_t tx_len,
+                           uint8_t *rx, uint16_t rx_len, I2C_DoneCallback cb);
+// 첽ֽڣֵͬI2C_Transfer_Async
+uint8_t I2C_Read_DMA(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len, I2C_DoneCallback cb);
+// 첽ǷУ˳I2C_Poll
+uint8_t I2C_DMA_Busy(void);
+// 鳬ʱƽԣִг߻ָƳٵSTART첽ʱѭڵá
+// ߻ָҪæȽ΢룬ִֻУж
+void I2C_Poll(void);
+// ͳƣԡ߻ָʱDWTڣ
+const I2C_Sm_t *I2C_Get_Stats(void);
+
+#endif
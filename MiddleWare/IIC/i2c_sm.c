@@ -0,0 +1,287 @@
+#include "i2c_sm.h"
+
+/**
+ * @file    i2c_sm.c
+ * @brief   I2C主机传输状态机源文件
+ */
+
+/**
+ * @brief  初始化状态机
+ */
+void i2c_sm_init(I2C_Sm_t *sm, uint32_t phase_timeout, uint32_t byte_timeout,
+                 uint32_t backoff, uint8_t max_retries)
+{
+    sm->phase_timeout = phase_timeout;
+    sm->byte_timeout = byte_timeout;
+    sm->backoff = backoff;
+    sm->max_retries = max_retries;
+    sm->state = I2C_SM_IDLE;
+    sm->result = I2C_OK;
+
+    sm->transfers = 0;
+    sm->ok = 0;
+    sm->failures = 0;
+    sm->nacks = 0;
+    sm->arlo = 0;
+    sm->bus_errors = 0;
+    sm->timeouts = 0;
+    sm->retries = 0;
+    sm->recoveries = 0;
+    sm->last_latency = 0;
+    sm->max_latency = 0;
+    sm->total_latency = 0;
+}
+
+/* 进入新阶段 */
+static void i2c_sm_enter(I2C_Sm_t *sm, I2C_SmState_t state, uint32_t now)
+{
+    sm->state = state;
+    sm->phase = now;
+}
+
+/* 发起一次尝试：有发送字节时从写阶段开始，否则直接读 */
+static uint16_t i2c_sm_attempt(I2C_Sm_t *sm, uint32_t now)
+{
+    sm->tx_pos = 0;
+    sm->reading = (sm->tx_len == 0);
+    i2c_sm_enter(sm, I2C_SM_START, now);
+    return I2C_ACT_ACK_ON | I2C_ACT_START;
+}
+
+/* 传输结束 */
+static uint16_t i2c_sm_finish(I2C_Sm_t *sm, uint8_t result, uint32_t now)
+{
+    uint32_t latency;
+
+    sm->state = I2C_SM_IDLE;
+    sm->result = result;
+    if(result == I2C_OK)
+    {
+        latency = now - sm->begin;
+        sm->ok++;
+        sm->last_latency = latency;
+        sm->total_latency += latency;
+        if(latency > sm->max_latency)
+        {
+            sm->max_latency = latency;
+        }
+    }
+    else
+    {
+        sm->failures++;
+    }
+    return I2C_ACT_IT_OFF | I2C_ACT_DONE;
+}
+
+/* 出错：释放总线，还有重试次数时退避后重来 */
+static uint16_t i2c_sm_fail(I2C_Sm_t *sm, uint8_t result, uint32_t now)
+{
+    uint16_t act = I2C_ACT_IT_OFF;
+
+    switch(result)
+    {
+    case I2C_ERR_NACK:
+        sm->nacks++;
+        act |= I2C_ACT_STOP;
+        break;
+    case I2C_ERR_ARLO:
+        /* 仲裁丢失后外设已自动退回从机模式，不能再发STOP */
+        sm->arlo++;
+        break;
+    case I2C_ERR_BUS:
+        sm->bus_errors++;
+        sm->recoveries++;
+        act |= I2C_ACT_RECOVER;
+        break;
+    default:
+        /* 超时：从机可能拉住了SDA，STOP发不出去，直接恢复总线 */
+        sm->timeouts++;
+        sm->recoveries++;
+        act |= I2C_ACT_RECOVER;
+        break;
+    }
+
+    if(sm->attempts < sm->max_retries)
+    {
+        sm->attempts++;
+        sm->retries++;
+        i2c_sm_enter(sm, I2C_SM_BACKOFF, now);
+        return act;
+    }
+    return act | i2c_sm_finish(sm, result, now);
+}
+
+/**
+ * @brief  开始一次传输
+ */
+uint16_t i2c_sm_begin(I2C_Sm_t *sm, uint8_t addr, const uint8_t *tx, uint8_t tx_len,
+                      uint8_t *rx, uint16_t rx_len, uint32_t now)
+{
+    uint8_t i;
+
+    if(sm->state != I2C_SM_IDLE || tx_len > I2C_SM_TX_MAX || (tx_len == 0 && rx_len == 0))
+    {
+        return I2C_ACT_NONE;
+    }
+
+    sm->addr = addr & 0xFE;
+    for(i = 0; i < tx_len; i++)
+    {
+        sm->tx[i] = tx[i];
+    }
+    sm->tx_len = tx_len;
+    sm->rx = rx;
+    sm->rx_len = rx_len;
+    sm->attempts = 0;
+    sm->begin = now;
+    sm->transfers++;
+    return i2c_sm_attempt(sm, now);
+}
+
+/**
+ * @brief  事件中断
+ */
+uint16_t i2c_sm_event(I2C_Sm_t *sm, uint16_t sr1, uint8_t data, uint32_t now)
+{
+    switch(sm->state)
+    {
+    case I2C_SM_START:
+        if(sr1 & I2C_SM_SB)
+        {
+            sm->out = sm->addr | (sm->reading ? 1 : 0);
+            i2c_sm_enter(sm, I2C_SM_ADDRESS, now);
+            return I2C_ACT_SEND;
+        }
+        break;
+
+    case I2C_SM_ADDRESS:
+        if(sr1 & I2C_SM_ADDR)
+        {
+            if(!sm->reading)
+            {
+                sm->out = sm->tx[sm->tx_pos++];
+                i2c_sm_enter(sm, I2C_SM_TX, now);
+                return I2C_ACT_CLEAR_ADDR | I2C_ACT_SEND;
+            }
+            if(sm->rx_len == 1)
+            {
+                /* 单字节：清除ADDR前关闭应答，清除后立即STOP */
+                i2c_sm_enter(sm, I2C_SM_RX_1, now);
+                return I2C_ACT_ACK_OFF | I2C_ACT_CLEAR_ADDR | I2C_ACT_BUF_ON | I2C_ACT_STOP;
+            }
+            i2c_sm_enter(sm, I2C_SM_RX_DMA, now);
+            return I2C_ACT_DMA_RX | I2C_ACT_CLEAR_ADDR | I2C_ACT_EVT_OFF;
+        }
+        break;
+
+    case I2C_SM_TX:
+        if(sr1 & I2C_SM_BTF)
+        {
+            if(sm->tx_pos < sm->tx_len)
+            {
+                sm->out = sm->tx[sm->tx_pos++];
+                sm->phase = now;
+                return I2C_ACT_SEND;
+            }
+            if(sm->rx_len > 0)
+            {
+                sm->reading = 1;
+                i2c_sm_enter(sm, I2C_SM_START, now);
+                return I2C_ACT_START;
+            }
+            return I2C_ACT_STOP | i2c_sm_finish(sm, I2C_OK, now);
+        }
+        break;
+
+    case I2C_SM_RX_1:
+        if(sr1 & I2C_SM_RXNE)
+        {
+            sm->rx[0] = data;
+            return i2c_sm_finish(sm, I2C_OK, now);
+        }
+        break;
+
+    case I2C_SM_IDLE:
+    case I2C_SM_BACKOFF:
+        /* 不属于任何传输的事件，关闭中断避免反复进入 */
+        return I2C_ACT_IT_OFF;
+
+    default:
+        break;
+    }
+    return I2C_ACT_NONE;
+}
+
+/**
+ * @brief  错误中断
+ */
+uint16_t i2c_sm_error(I2C_Sm_t *sm, uint16_t flags, uint32_t now)
+{
+    if(sm->state == I2C_SM_IDLE || sm->state == I2C_SM_BACKOFF)
+    {
+        return I2C_ACT_NONE;
+    }
+    if(flags & I2C_SM_ARLO)
+    {
+        return i2c_sm_fail(sm, I2C_ERR_ARLO, now);
+    }
+    if(flags & I2C_SM_BERR)
+    {
+        return i2c_sm_fail(sm, I2C_ERR_BUS, now);
+    }
+    if(flags & I2C_SM_AF)
+    {
+        return i2c_sm_fail(sm, I2C_ERR_NACK, now);
+    }
+    return I2C_ACT_NONE;
+}
+
+/**
+ * @brief  DMA接收完成
+ */
+uint16_t i2c_sm_dma_done(I2C_Sm_t *sm, uint32_t now)
+{
+    if(sm->state != I2C_SM_RX_DMA)
+    {
+        return I2C_ACT_NONE;
+    }
+    return I2C_ACT_STOP | i2c_sm_finish(sm, I2C_OK, now);
+}
+
+/**
+ * @brief  周期性调用，检查超时并在退避结束后重试
+ */
+uint16_t i2c_sm_poll(I2C_Sm_t *sm, uint32_t now)
+{
+    uint32_t limit = sm->phase_timeout;
+
+    switch(sm->state)
+    {
+    case I2C_SM_IDLE:
+        return I2C_ACT_NONE;
+    case I2C_SM_BACKOFF:
+        if(now - sm->phase >= sm->backoff)
+        {
+            return i2c_sm_attempt(sm, now);
+        }
+        return I2C_ACT_NONE;
+    case I2C_SM_RX_DMA:
+        limit += sm->byte_timeout * sm->rx_len;
+        break;
+    default:
+        break;
+    }
+    if(now - sm->phase >= limit)
+    {
+        return i2c_sm_fail(sm, I2C_ERR_TIMEOUT, now);
+    }
+    return I2C_ACT_NONE;
+}
+
+/**
+ * @brief  是否有传输进行中
+ */
+uint8_t i2c_sm_busy(const I2C_Sm_t *sm)
+{
+    return sm->state != I2C_SM_IDLE;
+}
@@ -0,0 +1,150 @@
+#ifndef __I2C_SM_H
+#define __I2C_SM_H
+
+/**
+ * @file    i2c_sm.h
+ * @brief   I2C主机传输状态机
+ * @details 一次传输为：START、地址+写、发送tx字节，再（需要读时）重复START、
+ *          地址+读、接收rx字节，最后STOP。状态机由中断中的SR1事件、错误标志、
+ *          DMA完成和周期性的轮询推进，返回需要对外设执行的动作，
+ *          本身不访问寄存器，可以在PC上用脚本化的事件序列测试。
+ *          每个阶段都有超时；应答失败、仲裁丢失、总线错误和超时按重试次数
+ *          退避后重来，总线错误和超时还要求先做总线恢复
+ */
+
+#include <stdint.h>
+
+/* SR1中用到的事件位，与STM32F4 I2C_SR1一致 */
+#define I2C_SM_SB           0x0001u
+#define I2C_SM_ADDR         0x0002u
+#define I2C_SM_BTF          0x0004u
+#define I2C_SM_RXNE         0x0040u
+
+/* 错误标志，与STM32F4 I2C_SR1一致 */
+#define I2C_SM_BERR         0x0100u
+#define I2C_SM_ARLO         0x0200u
+#define I2C_SM_AF           0x0400u
+
+/* 传输结果 */
+#define I2C_OK              0
+#define I2C_ERR_NACK        1       /* 从机未应答 */
+#define I2C_ERR_BUS         2       /* 总线错误 */
+#define I2C_ERR_ARLO        3       /* 仲裁丢失 */
+#define I2C_ERR_TIMEOUT     4       /* 某个阶段超时 */
+#define I2C_ERR_BUSY        5       /* 上一次传输未完成 */
+
+#define I2C_SM_TX_MAX       4       /* 发送字节数上限（寄存器地址+数据） */
+
+/* 动作，可同时返回多个，按下列顺序执行 */
+#define I2C_ACT_NONE        0x0000u
+#define I2C_ACT_ACK_ON      0x0001u     /* 使能应答 */
+#define I2C_ACT_ACK_OFF     0x0002u     /* 关闭应答（单字节读） */
+#define I2C_ACT_DMA_RX      0x0004u     /* 使能DMA请求，最后一个字节自动NACK；须在清除ADDR前 */
+#define I2C_ACT_CLEAR_ADDR  0x0008u     /* 读SR2清除ADDR */
+#define I2C_ACT_EVT_OFF     0x0010u     /* 关闭事件中断（数据交给DMA） */
+#define I2C_ACT_BUF_ON      0x0020u     /* 使能缓冲中断（单字节读的RXNE） */
+#define I2C_ACT_SEND        0x0040u     /* 把sm->out写入DR（地址或数据） */
+#define I2C_ACT_STOP        0x0080u     /* 产生STOP */
+#define I2C_ACT_START       0x0100u     /* 产生（重复）START，并使能事件/错误中断 */
+#define I2C_ACT_IT_OFF      0x0200u     /* 关闭全部中断、DMA请求和DMA数据流 */
+#define I2C_ACT_RECOVER     0x0400u     /* 总线恢复：手动输出SCL释放卡住的从机，复位外设 */
+#define I2C_ACT_DONE        0x0800u     /* 传输结束，结果在sm->result */
+
+typedef enum {
+    I2C_SM_IDLE = 0,
+    I2C_SM_START,       /* 等待SB */
+    I2C_SM_ADDRESS,     /* 等待ADDR */
+    I2C_SM_TX,          /* 等待BTF */
+    I2C_SM_RX_DMA,      /* DMA接收中 */
+    I2C_SM_RX_1,        /* 单字节接收，等待RXNE */
+    I2C_SM_BACKOFF      /* 出错后等待重试 */
+} I2C_SmState_t;
+
+/**
+ * @brief  状态机
+ */
+typedef struct {
+    /* 配置，时间单位由调用者决定（通常为DWT周期） */
+    uint32_t phase_timeout;         /* 每个阶段的超时 */
+    uint32_t byte_timeout;          /* DMA接收阶段每字节追加的超时 */
+    uint32_t backoff;               /* 出错后到重试的等待时间 */
+    uint8_t max_retries;            /* 出错后最多重试次数 */
+
+    /* 当前传输 */
+    I2C_SmState_t state;
+    uint8_t addr;                   /* 8位写地址 */
+    uint8_t tx[I2C_SM_TX_MAX];
+    uint8_t tx_len;
+    uint8_t tx_pos;
+    uint8_t *rx;
+    uint16_t rx_len;
+    uint8_t reading;                /* 处于读阶段 */
+    uint8_t attempts;               /* 已重试次数 */
+    uint8_t out;                    /* I2C_ACT_SEND要写入DR的字节 */
+    uint8_t result;                 /* I2C_ACT_DONE时的结果 */
+    uint32_t begin;                 /* 传输开始时间 */
+    uint32_t phase;                 /* 当前阶段开始时间 */
+
+    /* 统计 */
+    uint32_t transfers;             /* 开始的传输数 */
+    uint32_t ok;                    /* 成功的传输数 */
+    uint32_t failures;              /* 重试用尽后失败的传输数 */
+    uint32_t nacks;                 /* 各类错误次数（含重试中的） */
+    uint32_t arlo;
+    uint32_t bus_errors;
+    uint32_t timeouts;
+    uint32_t retries;
+    uint32_t recoveries;
+    uint32_t last_latency;          /* 上次成功传输的耗时 */
+    uint32_t max_latency;
+    uint64_t total_latency;         /* 成功传输的累计耗时，平均 = total_latency / ok */
+} I2C_Sm_t;
+
+/**
+ * @brief  初始化状态机
+ */
+void i2c_sm_init(I2C_Sm_t *sm, uint32_t phase_timeout, uint32_t byte_timeout,
+                 uint32_t backoff, uint8_t max_retries);
+
+/**
+ * @brief  开始一次传输
+ * @param  addr: 8位写地址
+ * @param  tx: 发送的字节（通常为寄存器地址），可为空
+ * @param  tx_len: 不超过I2C_SM_TX_MAX
+ * @param  rx: 接收缓冲区
+ * @param  rx_len: 接收字节数，0为只写
+ * @param  now: 当前时间
+ * @retval 动作；忙或参数错误时为I2C_ACT_NONE
+ */
+uint16_t i2c_sm_begin(I2C_Sm_t *sm, uint8_t addr, const uint8_t *tx, uint8_t tx_len,
+                      uint8_t *rx, uint16_t rx_len, uint32_t now);
+
+/**
+ * @brief  事件中断
+ * @param  sr1: SR1
+ * @param  data: SR1中RXNE置位时读出的DR
+ */
+uint16_t i2c_sm_event(I2C_Sm_t *sm, uint16_t sr1, uint8_t data, uint32_t now);
+
+/**
+ * @brief  错误中断
+ * @param  flags: SR1中的错误标志
+ */
+uint16_t i2c_sm_error(I2C_Sm_t *sm, uint16_t flags, uint32_t now);
+
+/**
+ * @brief  DMA接收完成
+ */
+uint16_t i2c_sm_dma_done(I2C_Sm_t *sm, uint32_t now);
+
+/**
+ * @brief  周期性调用，检查超时并在退避结束后重试
+ */
+uint16_t i2c_sm_poll(I2C_Sm_t *sm, uint32_t now);
+
+/**
+ * @brief  是否有传输进行中
+ */
+uint8_t i2c_sm_busy(const I2C_Sm_t *sm);
+
+#endif /* __I2C_SM_H */
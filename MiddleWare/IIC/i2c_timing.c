@@ -0,0 +1,84 @@
+#include "i2c_timing.h"
+
+/**
+ * @file    i2c_timing.c
+ * @brief   I2C时钟寄存器计算源文件
+ */
+
+#define I2C_TIMING_CCR_MASK     0x0FFFu
+
+/* 快速模式下按一种占空比计算，每个SCL周期为div个CCR */
+static uint8_t i2c_timing_fast(uint32_t pclk1_hz, uint32_t scl_hz, uint32_t div, uint16_t bits,
+                               I2C_Timing_t *t)
+{
+    uint32_t ccr = (pclk1_hz + div * scl_hz - 1) / (div * scl_hz);
+
+    if(ccr == 0)
+    {
+        ccr = 1;
+    }
+    if(ccr > I2C_TIMING_CCR_MASK)
+    {
+        return 1;
+    }
+    t->ccr = (uint16_t)(ccr | bits);
+    t->scl_hz = pclk1_hz / (div * ccr);
+    return 0;
+}
+
+/**
+ * @brief  计算I2C时钟寄存器
+ */
+uint8_t i2c_timing_compute(uint32_t pclk1_hz, uint32_t scl_hz, uint8_t duty, I2C_Timing_t *t)
+{
+    I2C_Timing_t alt;
+    uint32_t ccr;
+    uint8_t err2, err169;
+
+    t->freq = (uint16_t)(pclk1_hz / 1000000u);
+    if(t->freq < I2C_TIMING_FREQ_MIN || t->freq > I2C_TIMING_FREQ_MAX ||
+       scl_hz == 0 || scl_hz > I2C_SPEED_FAST)
+    {
+        return 1;
+    }
+
+    if(scl_hz <= I2C_SPEED_STANDARD)
+    {
+        ccr = (pclk1_hz + 2 * scl_hz - 1) / (2 * scl_hz);
+        if(ccr < 4)
+        {
+            ccr = 4;
+        }
+        if(ccr > I2C_TIMING_CCR_MASK)
+        {
+            return 1;
+        }
+        t->ccr = (uint16_t)ccr;
+        t->scl_hz = pclk1_hz / (2 * ccr);
+        t->trise = t->freq + 1;
+        return 0;
+    }
+
+    if(t->freq < I2C_TIMING_FREQ_MIN_FM)
+    {
+        return 1;
+    }
+    t->trise = (uint16_t)(t->freq * 300u / 1000u + 1);
+    switch(duty)
+    {
+    case I2C_TIMING_DUTY_2:
+        return i2c_timing_fast(pclk1_hz, scl_hz, 3, I2C_TIMING_CCR_FS, t);
+    case I2C_TIMING_DUTY_16_9:
+        return i2c_timing_fast(pclk1_hz, scl_hz, 25, I2C_TIMING_CCR_FS | I2C_TIMING_CCR_DUTY, t);
+    default:
+        alt = *t;
+        err169 = i2c_timing_fast(pclk1_hz, scl_hz, 25, I2C_TIMING_CCR_FS | I2C_TIMING_CCR_DUTY, t);
+        err2 = i2c_timing_fast(pclk1_hz, scl_hz, 3, I2C_TIMING_CCR_FS, &alt);
+        if(err169 || (!err2 && alt.scl_hz > t->scl_hz))
+        {
+            *t = alt;
+            return err2;
+        }
+        return 0;
+    }
+}
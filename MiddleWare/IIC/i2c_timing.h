@@ -0,0 +1,53 @@
+#ifndef __I2C_TIMING_H
+#define __I2C_TIMING_H
+
+/**
+ * @file    i2c_timing.h
+ * @brief   I2C时钟寄存器计算
+ * @details 由APB1时钟和目标SCL频率计算CR2.FREQ、CCR和TRISE：
+ *          标准模式  T(SCL) = 2 * CCR * T(PCLK1)，CCR >= 4，上升时间上限1000ns；
+ *          快速模式  占空比2:1时T(SCL) = 3 * CCR * T(PCLK1)，
+ *                    占空比16:9时T(SCL) = 25 * CCR * T(PCLK1)，CCR >= 1，上升时间上限300ns。
+ *          CCR向上取整，实际SCL频率不会超过目标值；同时给出实际频率供调用者核对。
+ *          本模块不访问外设寄存器，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define I2C_SPEED_STANDARD      100000u
+#define I2C_SPEED_FAST          400000u
+
+/* 快速模式占空比 */
+#define I2C_TIMING_DUTY_2       0       /* Tlow/Thigh = 2 */
+#define I2C_TIMING_DUTY_16_9    1       /* Tlow/Thigh = 16/9，PCLK1为10MHz整数倍时可精确得到400kHz */
+#define I2C_TIMING_DUTY_AUTO    2       /* 取实际频率更接近目标的一种，相同时用16/9 */
+
+/* CCR寄存器中的模式位，与STM32F4 I2C_CCR一致 */
+#define I2C_TIMING_CCR_FS       0x8000u
+#define I2C_TIMING_CCR_DUTY     0x4000u
+
+#define I2C_TIMING_FREQ_MIN     2       /* CR2.FREQ范围（MHz） */
+#define I2C_TIMING_FREQ_MAX     50
+#define I2C_TIMING_FREQ_MIN_FM  4       /* 快速模式要求PCLK1至少4MHz */
+
+/**
+ * @brief  计算结果
+ */
+typedef struct {
+    uint16_t freq;          /* CR2.FREQ，PCLK1的MHz数 */
+    uint16_t ccr;           /* CCR寄存器值，含FS/DUTY位 */
+    uint16_t trise;         /* TRISE寄存器值 */
+    uint32_t scl_hz;        /* 实际SCL频率（不计上升时间） */
+} I2C_Timing_t;
+
+/**
+ * @brief  计算I2C时钟寄存器
+ * @param  pclk1_hz: APB1时钟
+ * @param  scl_hz: 目标SCL频率，不超过100kHz为标准模式，否则为快速模式（最高400kHz）
+ * @param  duty: 快速模式占空比I2C_TIMING_DUTY_xxx，标准模式忽略
+ * @param  t: 输出
+ * @retval 0-成功, 1-PCLK1超出范围或目标频率无法产生
+ */
+uint8_t i2c_timing_compute(uint32_t pclk1_hz, uint32_t scl_hz, uint8_t duty, I2C_Timing_t *t);
+
+#endif /* __I2C_TIMING_H */
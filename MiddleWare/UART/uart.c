@@ -1,4 +1,7 @@
 #include "uart.h"
+#include "spsc_queue.h"
+#include "fmt.h"
+#include "dwt_time.h"
 #include <stdarg.h>
 #include <stdio.h>
 
@@ -14,6 +17,354 @@
 /* 声明 fputc 函数（用于重定向 printf 输出） */
 int fputc(int ch, FILE *f);
 
+/**
+ * @brief  串口DMA发送端口描述
+ */
+typedef struct {
+    USART_TypeDef* USARTx;          /* UART外设 */
+    DMA_Stream_TypeDef* stream;     /* 发送DMA数据流 */
+    uint32_t channel;               /* DMA通道 */
+    uint32_t dma_rcc;               /* DMA时钟 */
+    uint8_t irqn;                   /* DMA数据流中断号 */
+    uint32_t it_tc;                 /* 传输完成中断标志 */
+    uint32_t flags;                 /* 启动前需要清除的全部标志 */
+    uint8_t *buf;                   /* 发送缓冲区 */
+    uint16_t buf_size;              /* 发送缓冲区大小 */
+    uint8_t enabled;                /* 是否已使能DMA发送 */
+    UART_TxQueue_t queue;           /* 发送队列 */
+} UART_TxPort_t;
+
+/* 发送缓冲区 */
+static uint8_t uart1_tx_buf[UART1_TX_BUF_SIZE];
+static uint8_t uart2_tx_buf[UART2_TX_BUF_SIZE];
+static uint8_t uart3_tx_buf[UART3_TX_BUF_SIZE];
+
+/* 发送端口表 */
+static UART_TxPort_t uart_tx_ports[3] = {
+    {USART1, UART1_TX_DMA_STREAM, UART1_TX_DMA_CHANNEL, UART1_TX_DMA_RCC, UART1_TX_DMA_IRQn,
+     UART1_TX_DMA_IT_TC, UART1_TX_DMA_FLAGS, uart1_tx_buf, UART1_TX_BUF_SIZE, 0},
+    {USART2, UART2_TX_DMA_STREAM, UART2_TX_DMA_CHANNEL, UART2_TX_DMA_RCC, UART2_TX_DMA_IRQn,
+     UART2_TX_DMA_IT_TC, UART2_TX_DMA_FLAGS, uart2_tx_buf, UART2_TX_BUF_SIZE, 0},
+    {USART3, UART3_TX_DMA_STREAM, UART3_TX_DMA_CHANNEL, UART3_TX_DMA_RCC, UART3_TX_DMA_IRQn,
+     UART3_TX_DMA_IT_TC, UART3_TX_DMA_FLAGS, uart3_tx_buf, UART3_TX_BUF_SIZE, 0}
+};
+
+/**
+ * @brief  串口环形DMA接收端口描述
+ */
+typedef struct {
+    USART_TypeDef* USARTx;          /* UART外设 */
+    DMA_Stream_TypeDef* stream;     /* 接收DMA数据流 */
+    uint32_t channel;               /* DMA通道 */
+    uint32_t dma_rcc;               /* DMA时钟 */
+    uint8_t irqn;                   /* DMA数据流中断号 */
+    uint32_t it_ht;                 /* 半满中断标志 */
+    uint32_t it_tc;                 /* 全满中断标志 */
+    uint8_t *buf;                   /* 环形接收缓冲区 */
+    uint16_t buf_size;              /* 缓冲区大小 */
+    uint8_t enabled;                /* 是否已使能DMA接收 */
+    UART_RxDma_t rx;                /* 分段状态 */
+} UART_RxPort_t;
+
+/* 中断与主循环之间的接收队列，中断只入队，解析在UART_Poll中进行 */
+static uint8_t uart1_rxq_buf[UART1_RXQ_SIZE];
+static uint8_t uart2_rxq_buf[UART2_RXQ_SIZE];
+static uint8_t uart3_rxq_buf[UART3_RXQ_SIZE];
+static SPSC_Queue_t uart_rx_queues[3] = {
+    SPSC_INITIALIZER(uart1_rxq_buf, UART1_RXQ_SIZE),
+    SPSC_INITIALIZER(uart2_rxq_buf, UART2_RXQ_SIZE),
+    SPSC_INITIALIZER(uart3_rxq_buf, UART3_RXQ_SIZE)
+};
+
+/* 每个串口最近一次收到数据时的DWT周期计数，用于统计命令响应延迟 */
+static volatile uint32_t uart_rx_stamp[3];
+
+/* 编译期检查队列容量为2的幂 */
+typedef char uart_rxq_size_check[((UART1_RXQ_SIZE & (UART1_RXQ_SIZE - 1)) == 0 &&
+                                  (UART2_RXQ_SIZE & (UART2_RXQ_SIZE - 1)) == 0 &&
+                                  (UART3_RXQ_SIZE & (UART3_RXQ_SIZE - 1)) == 0) ? 1 : -1];
+
+/* 接收缓冲区 */
+static uint8_t uart2_rx_dma_buf[UART2_RX_DMA_BUF_SIZE];
+static uint8_t uart3_rx_dma_buf[UART3_RX_DMA_BUF_SIZE];
+
+/* 接收端口表 */
+static UART_RxPort_t uart_rx_ports[2] = {
+    {USART2, UART2_RX_DMA_STREAM, UART2_RX_DMA_CHANNEL, UART2_RX_DMA_RCC, UART2_RX_DMA_IRQn,
+     UART2_RX_DMA_IT_HT, UART2_RX_DMA_IT_TC, uart2_rx_dma_buf, UART2_RX_DMA_BUF_SIZE, 0},
+    {USART3, UART3_RX_DMA_STREAM, UART3_RX_DMA_CHANNEL, UART3_RX_DMA_RCC, UART3_RX_DMA_IRQn,
+     UART3_RX_DMA_IT_HT, UART3_RX_DMA_IT_TC, uart3_rx_dma_buf, UART3_RX_DMA_BUF_SIZE, 0}
+};
+
+/**
+ * @brief  查找串口对应的发送端口
+ * @param  USARTx: UART外设
+ * @retval 端口指针，不支持的串口返回NULL
+ */
+static UART_TxPort_t* UART_FindTxPort(USART_TypeDef* USARTx)
+{
+    uint8_t i;
+
+    for(i = 0; i < 3; i++)
+    {
+        if(uart_tx_ports[i].USARTx == USARTx)
+        {
+            return &uart_tx_ports[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  启动一段DMA发送（作为发送队列的回调）
+ * @param  ctx: 发送端口
+ * @param  data: 连续数据首地址
+ * @param  len: 字节数
+ * @retval None
+ */
+static void UART_TxDmaStart(void *ctx, const uint8_t *data, uint16_t len)
+{
+    UART_TxPort_t *port = (UART_TxPort_t *)ctx;
+
+    /* 普通模式下传输完成后EN已自动清零，可以直接改写地址和长度 */
+    DMA_ClearFlag(port->stream, port->flags);
+    port->stream->M0AR = (uint32_t)data;
+    DMA_SetCurrDataCounter(port->stream, len);
+    DMA_Cmd(port->stream, ENABLE);
+}
+
+/**
+ * @brief  初始化串口发送DMA
+ * @param  port: 发送端口
+ * @param  PreemptionPriority: 抢占优先级
+ * @param  SubPriority: 子优先级
+ * @retval None
+ */
+static void UART_TxDmaInit(UART_TxPort_t *port, uint8_t PreemptionPriority, uint8_t SubPriority)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    port->enabled = 0;
+
+    RCC_AHB1PeriphClockCmd(port->dma_rcc, ENABLE);
+
+    DMA_DeInit(port->stream);
+    while(DMA_GetCmdStatus(port->stream) != DISABLE);
+
+    DMA_InitStructure.DMA_Channel = port->channel;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&port->USARTx->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)port->buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    DMA_InitStructure.DMA_BufferSize = 1;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(port->stream, &DMA_InitStructure);
+
+    DMA_ITConfig(port->stream, DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = port->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = PreemptionPriority;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = SubPriority;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    UART_TxQueue_Init(&port->queue, port->buf, port->buf_size, UART_TX_DMA_CHUNK);
+
+    USART_DMACmd(port->USARTx, USART_DMAReq_Tx, ENABLE);
+    port->enabled = 1;
+}
+
+/**
+ * @brief  发送DMA传输完成中断处理
+ * @param  port: 发送端口
+ * @retval None
+ */
+static void UART_TxDmaIRQHandler(UART_TxPort_t *port)
+{
+    if(DMA_GetITStatus(port->stream, port->it_tc) != RESET)
+    {
+        DMA_ClearITPendingBit(port->stream, port->it_tc);
+
+        /* 释放已发送的部分并启动下一段 */
+        UART_TxQueue_ChunkDone(&port->queue);
+        UART_TxQueue_Kick(&port->queue, UART_TxDmaStart, port);
+    }
+}
+
+/**
+ * @brief  查找串口对应的接收队列
+ * @param  USARTx: UART外设
+ * @retval 队列指针，不支持的串口返回NULL
+ */
+static SPSC_Queue_t* UART_FindRxQueue(USART_TypeDef* USARTx)
+{
+    if(USARTx == USART1) return &uart_rx_queues[0];
+    if(USARTx == USART2) return &uart_rx_queues[1];
+    if(USARTx == USART3) return &uart_rx_queues[2];
+    return NULL;
+}
+
+/**
+ * @brief  查找串口对应的DMA接收端口
+ * @param  USARTx: UART外设
+ * @retval 端口指针，不支持DMA接收的串口返回NULL
+ */
+static UART_RxPort_t* UART_FindRxPort(USART_TypeDef* USARTx)
+{
+    uint8_t i;
+
+    for(i = 0; i < 2; i++)
+    {
+        if(uart_rx_ports[i].USARTx == USARTx)
+        {
+            return &uart_rx_ports[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief  初始化串口环形DMA接收
+ * @param  port: 接收端口
+ * @param  PreemptionPriority: 抢占优先级，与串口中断相同以免相互嵌套
+ * @param  SubPriority: 子优先级
+ * @retval None
+ */
+static void UART_RxDmaInit(UART_RxPort_t *port, uint8_t PreemptionPriority, uint8_t SubPriority)
+{
+    DMA_InitTypeDef DMA_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    port->enabled = 0;
+
+    RCC_AHB1PeriphClockCmd(port->dma_rcc, ENABLE);
+
+    DMA_DeInit(port->stream);
+    while(DMA_GetCmdStatus(port->stream) != DISABLE);
+
+    DMA_InitStructure.DMA_Channel = port->channel;
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&port->USARTx->DR;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)port->buf;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    DMA_InitStructure.DMA_BufferSize = port->buf_size;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+    DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+    DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+    DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+    DMA_Init(port->stream, &DMA_InitStructure);
+
+    /* 半满和全满各中断一次，保证处理速度跟得上DMA写入 */
+    DMA_ITConfig(port->stream, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannel = port->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = PreemptionPriority;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = SubPriority;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    UART_RxDma_Init(&port->rx, port->buf, port->buf_size);
+
+    USART_DMACmd(port->USARTx, USART_DMAReq_Rx, ENABLE);
+    DMA_Cmd(port->stream, ENABLE);
+    port->enabled = 1;
+}
+
+/**
+ * @brief  把分段交给串口数据段回调（作为分段逻辑的回调）
+ */
+static void UART_RxDmaDeliver(void *ctx, const uint8_t *data, uint16_t len)
+{
+    UART_RxPort_t *port = (UART_RxPort_t *)ctx;
+
+    UART_RxChunkCallback(port->USARTx, data, len);
+}
+
+/**
+ * @brief  处理DMA已写入但尚未交付的数据
+ * @param  port: 接收端口
+ * @retval None
+ * @note   由串口空闲中断和DMA半满/全满中断调用
+ */
+static void UART_RxDmaPoll(UART_RxPort_t *port)
+{
+    uint16_t pos = port->buf_size - (uint16_t)DMA_GetCurrDataCounter(port->stream);
+
+    UART_RxDma_Process(&port->rx, pos, UART_RxDmaDeliver, port);
+}
+
+/**
+ * @brief  接收DMA半满/全满中断处理
+ * @param  port: 接收端口
+ * @retval None
+ */
+static void UART_RxDmaIRQHandler(UART_RxPort_t *port)
+{
+    if(DMA_GetITStatus(port->stream, port->it_ht) != RESET)
+    {
+        DMA_ClearITPendingBit(port->stream, port->it_ht);
+    }
+    if(DMA_GetITStatus(port->stream, port->it_tc) != RESET)
+    {
+        DMA_ClearITPendingBit(port->stream, port->it_tc);
+    }
+    UART_RxDmaPoll(port);
+}
+
+/**
+ * @brief  USART2接收DMA中断 (DMA1 Stream5)
+ */
+void DMA1_Stream5_IRQHandler(void)
+{
+    UART_RxDmaIRQHandler(&uart_rx_ports[0]);
+}
+
+/**
+ * @brief  USART3接收DMA中断 (DMA1 Stream1)
+ */
+void DMA1_Stream1_IRQHandler(void)
+{
+    UART_RxDmaIRQHandler(&uart_rx_ports[1]);
+}
+
+/**
+ * @brief  USART1发送DMA中断 (DMA2 Stream7)
+ */
+void DMA2_Stream7_IRQHandler(void)
+{
+    UART_TxDmaIRQHandler(&uart_tx_ports[0]);
+}
+
+/**
+ * @brief  USART2发送DMA中断 (DMA1 Stream6)
+ */
+void DMA1_Stream6_IRQHandler(void)
+{
+    UART_TxDmaIRQHandler(&uart_tx_ports[1]);
+}
+
+/**
+ * @brief  USART3发送DMA中断 (DMA1 Stream3)
+ */
+void DMA1_Stream3_IRQHandler(void)
+{
+    UART_TxDmaIRQHandler(&uart_tx_ports[2]);
+}
+
 /**
  * @brief  串口1初始化函数
  * @param  baudrate: 波特率，如UART_BAUD_115200
@@ -31,6 +382,8 @@ void UART1_Init(UART_BaudRateTypeDef baudrate)
     config.DataBits = UART_DATABIT_8;
     config.FlowControl = UART_FLOWCTRL_NONE;
     config.RxIntEnable = ENABLE;
+    config.TxDmaEnable = ENABLE;
+    config.RxDmaEnable = DISABLE;
     config.PreemptionPriority = 1;
     config.SubPriority = 1;
     
@@ -54,6 +407,8 @@ void UART2_Init(UART_BaudRateTypeDef baudrate)
     config.DataBits = UART_DATABIT_8;
     config.FlowControl = UART_FLOWCTRL_NONE;
     config.RxIntEnable = ENABLE;
+    config.TxDmaEnable = ENABLE;
+    config.RxDmaEnable = ENABLE;
     config.PreemptionPriority = 2;
     config.SubPriority = 2;
     
@@ -77,6 +432,8 @@ void UART3_Init(UART_BaudRateTypeDef baudrate)
     config.DataBits = UART_DATABIT_8;
     config.FlowControl = UART_FLOWCTRL_NONE;
     config.RxIntEnable = ENABLE;
+    config.TxDmaEnable = ENABLE;
+    config.RxDmaEnable = ENABLE;
     config.PreemptionPriority = 2;
     config.SubPriority = 3;
     
@@ -247,7 +604,17 @@ void UART_Init(UART_ConfigTypeDef *config)
     /* 配置中断 */
     if(config->RxIntEnable == ENABLE)
     {
-        USART_ITConfig(config->USARTx, USART_IT_RXNE, ENABLE);
+        if(config->RxDmaEnable == ENABLE && UART_FindRxPort(config->USARTx) != NULL)
+        {
+            /* 数据由DMA搬运，只在线路空闲时中断一次 */
+            UART_RxDmaInit(UART_FindRxPort(config->USARTx),
+                           config->PreemptionPriority, config->SubPriority);
+            USART_ITConfig(config->USARTx, USART_IT_IDLE, ENABLE);
+        }
+        else
+        {
+            USART_ITConfig(config->USARTx, USART_IT_RXNE, ENABLE);
+        }
         
         NVIC_InitStructure.NVIC_IRQChannel = USART_IRQn;
         NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = config->PreemptionPriority;
@@ -256,6 +623,13 @@ void UART_Init(UART_ConfigTypeDef *config)
         NVIC_Init(&NVIC_InitStructure);
     }
     
+    /* 配置DMA发送 */
+    if(config->TxDmaEnable == ENABLE)
+    {
+        UART_TxDmaInit(UART_FindTxPort(config->USARTx),
+                       config->PreemptionPriority, config->SubPriority);
+    }
+    
     /* 使能USART */
     USART_Cmd(config->USARTx, ENABLE);
 }
@@ -264,73 +638,16 @@ void UART_Init(UART_ConfigTypeDef *config)
  * @brief  USART1中断服务函数
  * @param  None
  * @retval None
- * @note   直接在中断函数中处理LED和蜂鸣器控制
+ * @note   中断中只入队，回显和LED/蜂鸣器命令在UART_Poll中处理
  */
 void USART1_IRQHandler(void)
 {
-    uint8_t ch;
-    
     if(USART_GetITStatus(USART1, USART_IT_RXNE) != RESET)
     {
-        /* 读取接收到的数据 */
-        ch = USART_ReceiveData(USART1);
-        
-        /* 回显接收到的字符 */
-        UART_SendChar(USART1, ch);
+        /* 读取接收到的数据并入队 */
+        SPSC_Put(&uart_rx_queues[0], (uint8_t)USART_ReceiveData(USART1));
+        uart_rx_stamp[0] = time_now_cycles();
         
-        /* 直接在中断中处理命令 */
-        switch(ch)
-        {
-            case '1':
-                /* 点亮LED0 */
-                Led_On(0);
-                UART_SendString(USART1, "LED0 ON\r\n");
-                break;
-                
-            case '2':
-                /* 熄灭LED0 */
-                Led_Off(0);
-                UART_SendString(USART1, "LED0 OFF\r\n");
-                break;
-                
-            case '3':
-                /* 点亮LED1 */
-                Led_On(1);
-                UART_SendString(USART1, "LED1 ON\r\n");
-                break;
-                
-            case '4':
-                /* 熄灭LED1 */
-                Led_Off(1);
-                UART_SendString(USART1, "LED1 OFF\r\n");
-                break;
-                
-            case '5':
-                /* 打开蜂鸣器 */
-                Beep_On();
-                UART_SendString(USART1, "BEEP ON\r\n");
-                break;
-                
-            case '6':
-                /* 关闭蜂鸣器 */
-                Beep_Off();
-                UART_SendString(USART1, "BEEP OFF\r\n");
-                break;
-                
-            case '0':
-                /* 关闭所有LED和蜂鸣器 */
-                Led_Off(0);
-                Led_Off(1);
-                Led_Off(2);
-                Led_Off(3);
-                Beep_Off();
-                UART_SendString(USART1, "ALL OFF\r\n");
-                break; 
-            default:
-                /* 对于其他字符，不做特殊处理 */
-                break;
-        }
-
         /* 清除中断标志 */
         USART_ClearITPendingBit(USART1, USART_IT_RXNE);
     }
@@ -345,11 +662,7 @@ void USART1_IRQHandler(void)
  */
 void UART_SendChar(USART_TypeDef* USARTx, uint8_t ch)
 {
-    /* 等待上一个字节发送完成 */
-    while(USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET);
-    
-    /* 发送数据 */
-    USART_SendData(USARTx, ch);
+    UART_Write(USARTx, &ch, 1);
 }
 
 /**
@@ -360,10 +673,119 @@ void UART_SendChar(USART_TypeDef* USARTx, uint8_t ch)
  */
 void UART_SendString(USART_TypeDef* USARTx, char *str)
 {
-    while(*str)
+    uint16_t len = 0;
+    
+    while(str[len] != '\0')
+    {
+        len++;
+    }
+    UART_Write(USARTx, (const uint8_t *)str, len);
+}
+
+/**
+ * @brief  串口发送指定长度的数据
+ * @param  USARTx: UART外设
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval 实际入队的字节数，队列满时多余字节被丢弃并计数
+ */
+uint16_t UART_Write(USART_TypeDef* USARTx, const uint8_t *data, uint16_t len)
+{
+    UART_TxPort_t *port = UART_FindTxPort(USARTx);
+    uint32_t primask;
+    uint16_t count;
+    uint16_t i;
+    
+    if(port == NULL || !port->enabled)
+    {
+        /* 未使能DMA发送，退回到逐字节等待TXE的方式 */
+        for(i = 0; i < len; i++)
+        {
+            while(USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET);
+            USART_SendData(USARTx, data[i]);
+        }
+        return len;
+    }
+    
+    /* 与DMA完成中断互斥：入队和启动DMA必须是一个整体 */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    count = UART_TxQueue_Write(&port->queue, data, len);
+    UART_TxQueue_Kick(&port->queue, UART_TxDmaStart, port);
+    __set_PRIMASK(primask);
+    
+    return count;
+}
+
+/**
+ * @brief  等待发送队列中的数据全部发出
+ * @param  USARTx: UART外设
+ * @retval 0-已全部发出, 1-不能等待或等待超时
+ */
+uint8_t UART_Flush(USART_TypeDef* USARTx)
+{
+    UART_TxPort_t *port = UART_FindTxPort(USARTx);
+    uint32_t stall = time_us_to_cycles(UART_FLUSH_STALL_MS * 1000u);
+    uint32_t start;
+    uint16_t depth, last;
+    
+    /* 关中断或在中断中时DMA完成中断可能得不到执行，队列永远发不空 */
+    if(__get_PRIMASK() || __get_IPSR())
+    {
+        return 1;
+    }
+    time_init();
+    
+    if(port != NULL && port->enabled)
+    {
+        /* 每发完一段DMA深度减小一次，深度变化时重新计时 */
+        last = UART_TxQueue_Depth(&port->queue);
+        start = time_now_cycles();
+        while((depth = UART_TxQueue_Depth(&port->queue)) != 0)
+        {
+            if(depth != last)
+            {
+                last = depth;
+                start = time_now_cycles();
+            }
+            else if(time_elapsed_cycles(start, time_now_cycles()) > stall)
+            {
+                return 1;
+            }
+        }
+    }
+    
+    /* 等待最后一个字节移出移位寄存器，外设未使能时TC不会置位 */
+    start = time_now_cycles();
+    while(USART_GetFlagStatus(USARTx, USART_FLAG_TC) == RESET)
+    {
+        if(time_elapsed_cycles(start, time_now_cycles()) > stall)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief  获取发送队列统计信息
+ * @param  USARTx: UART外设
+ * @param  stats: 输出队列深度、历史最高深度和丢弃字节数
+ * @retval None
+ */
+void UART_GetTxStats(USART_TypeDef* USARTx, UART_TxStats_t *stats)
+{
+    UART_TxPort_t *port = UART_FindTxPort(USARTx);
+    
+    if(port == NULL)
     {
-        UART_SendChar(USARTx, *str++);
+        stats->depth = 0;
+        stats->high_water = 0;
+        stats->dropped = 0;
+        stats->sent = 0;
+        return;
     }
+    UART_TxQueue_GetStats(&port->queue, stats);
 }
 
 /**
@@ -375,21 +797,12 @@ void UART_SendString(USART_TypeDef* USARTx, char *str)
  */
 void USART1_SendString(USART_TypeDef* USARTx, uint8_t* Sendbuf, uint8_t n)
 {
-    int i;
-    for(i = 0; i < n; i++)
-    {
-        /* 等待TXE标志位被设置，即上一个数据已发送完成 */
-        while(USART_GetFlagStatus(USARTx, USART_FLAG_TXE) == RESET)
-        {
-            /* 等待发送数据寄存器为空 */
-        }
-        /* 发送数据 */
-        USART_SendData(USARTx, Sendbuf[i]);
-    }
+    UART_Write(USARTx, Sendbuf, n);
 }
 
 /**
  * @brief  串口发送格式化字符串（类似printf）
+ * @note   由Fmt_VPrintf格式化，只支持整数：%d %u %x %X %c %s %%，不支持浮点
  * @param  USARTx: UART外设
  * @param  fmt: 格式化字符串
  * @param  ...: 可变参数
@@ -397,14 +810,22 @@ void USART1_SendString(USART_TypeDef* USARTx, uint8_t* Sendbuf, uint8_t n)
  */
 void UART_Printf(USART_TypeDef* USARTx, const char *fmt, ...)
 {
-    char buffer[256]; /* 格式化字符串缓冲区 */
+    char buffer[UART_PRINTF_BUF_SIZE]; /* 格式化字符串缓冲区，超出部分截断 */
     va_list args;
+    Fmt_t f;
     
+    Fmt_Init(&f, buffer, sizeof(buffer));
     va_start(args, fmt);
-    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    Fmt_VPrintf(&f, fmt, args);
     va_end(args);
     
-    UART_SendString(USARTx, buffer);
+    if(f.len == 0)
+    {
+        return;
+    }
+    
+    /* 入队后立即返回，由DMA在后台发送 */
+    UART_Write(USARTx, (const uint8_t *)buffer, f.len);
 }
 
 /**
@@ -425,7 +846,7 @@ void UART_RedirectPrintf(void)
  */
 int fputc(int ch, FILE *f)
 {
-    /* 将Printf内容发往串口 */
+    /* 将Printf内容发往串口，使能DMA发送后只入队 */
     UART_SendChar(USART1, (uint8_t)ch);
     return ch;
 }
@@ -440,13 +861,20 @@ void USART2_IRQHandler(void)
 {
     uint8_t ch;
     
+    /* DMA接收模式：线路空闲说明一段数据结束 */
+    if(USART_GetITStatus(USART2, USART_IT_IDLE) != RESET)
+    {
+        /* 先读SR(已在GetITStatus中读取)再读DR，清除IDLE标志 */
+        (void)USART_ReceiveData(USART2);
+        UART_RxDmaPoll(&uart_rx_ports[0]);
+    }
+    
     if(USART_GetITStatus(USART2, USART_IT_RXNE) != RESET)
     {
-        /* 读取接收到的数据 */
+        /* 读取接收到的数据并入队，由UART_Poll处理 */
         ch = USART_ReceiveData(USART2);
-        
-        /* 调用回调函数处理接收到的数据 */
-        UART_RxCallback(USART2, ch);
+        SPSC_Put(&uart_rx_queues[1], ch);
+        uart_rx_stamp[1] = time_now_cycles();
         
         /* 清除中断标志 */
         USART_ClearITPendingBit(USART2, USART_IT_RXNE);
@@ -462,13 +890,20 @@ void USART3_IRQHandler(void)
 {
     uint8_t ch;
     
+    /* DMA接收模式：线路空闲说明一段数据结束 */
+    if(USART_GetITStatus(USART3, USART_IT_IDLE) != RESET)
+    {
+        /* 先读SR(已在GetITStatus中读取)再读DR，清除IDLE标志 */
+        (void)USART_ReceiveData(USART3);
+        UART_RxDmaPoll(&uart_rx_ports[1]);
+    }
+    
     if(USART_GetITStatus(USART3, USART_IT_RXNE) != RESET)
     {
-        /* 读取接收到的数据 */
+        /* 读取接收到的数据并入队，由UART_Poll处理 */
         ch = USART_ReceiveData(USART3);
-        
-        /* 调用回调函数处理接收到的数据 */
-        UART_RxCallback(USART3, ch);
+        SPSC_Put(&uart_rx_queues[2], ch);
+        uart_rx_stamp[2] = time_now_cycles();
         
         /* 清除中断标志 */
         USART_ClearITPendingBit(USART3, USART_IT_RXNE);
@@ -476,10 +911,81 @@ void USART3_IRQHandler(void)
 }
 
 /**
- * @brief  串口接收中断回调函数
+ * @brief  串口DMA接收数据段回调函数
+ * @param  USARTx: UART外设
+ * @param  data: 新收到的连续数据
+ * @param  len: 数据长度
+ * @note   在中断中调用，只把数据写入接收队列
+ */
+void UART_RxChunkCallback(USART_TypeDef* USARTx, const uint8_t *data, uint16_t len)
+{
+    SPSC_Queue_t *q = UART_FindRxQueue(USARTx);
+    
+    if(q != NULL)
+    {
+        SPSC_Write(q, data, len);
+        uart_rx_stamp[q - uart_rx_queues] = time_now_cycles();
+    }
+}
+
+/**
+ * @brief  处理各串口接收队列中的数据
+ * @param  None
+ * @retval None
+ * @note   在主循环中调用，逐字节转交给UART_RxCallback
+ */
+void UART_Poll(void)
+{
+    static USART_TypeDef* const usarts[3] = {USART1, USART2, USART3};
+    uint8_t buf[32];
+    uint32_t n;
+    uint32_t i;
+    uint8_t u;
+    
+    for(u = 0; u < 3; u++)
+    {
+        SPSC_Queue_t *q = UART_FindRxQueue(usarts[u]);
+        
+        while((n = SPSC_Read(q, buf, sizeof(buf))) != 0)
+        {
+            for(i = 0; i < n; i++)
+            {
+                UART_RxCallback(usarts[u], buf[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief  获取接收队列满时丢弃的字节数
+ * @param  USARTx: UART外设
+ * @retval 丢弃字节数
+ */
+uint32_t UART_GetRxDropped(USART_TypeDef* USARTx)
+{
+    SPSC_Queue_t *q = UART_FindRxQueue(USARTx);
+    
+    return (q != NULL) ? q->dropped : 0;
+}
+
+/**
+ * @brief  获取最近一次收到数据的时刻
+ * @param  USARTx: UART外设
+ * @retval DWT周期计数，DMA接收时是一段数据结束（线路空闲）的时刻
+ */
+uint32_t UART_GetRxStamp(USART_TypeDef* USARTx)
+{
+    SPSC_Queue_t *q = UART_FindRxQueue(USARTx);
+    
+    return (q != NULL) ? uart_rx_stamp[q - uart_rx_queues] : 0;
+}
+
+/**
+ * @brief  串口接收回调函数
  * @param  USARTx: UART外设
  * @param  ch: 接收到的字符
- * @note   用户可以在其他文件中重新实现此函数以处理接收数据
+ * @note   由UART_Poll在主循环上下文中调用，可以安全地发送回显和解析命令；
+ *         用户可以在其他文件中重新实现此函数以处理接收数据
  */
 void UART_RxCallback(USART_TypeDef* USARTx, uint8_t ch)
 {
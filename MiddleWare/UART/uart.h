@@ -14,6 +14,8 @@
 #include <stdio.h>
 #include "led.h"
 #include "beep.h"
+#include "uart_txq.h"
+#include "uart_rxdma.h"
 
 /* USART1 引脚定义  tx pa9 , rx pa10*/
 #define UART1_TX_PIN           GPIO_Pin_9
@@ -60,6 +62,71 @@
 
 #define UART3_RCC              RCC_APB1Periph_USART3
 
+/* 发送DMA映射 (参考手册 DMA1/DMA2 请求映射表) */
+/* USART1_TX: DMA2 Stream7 Channel4 */
+#define UART1_TX_DMA_STREAM    DMA2_Stream7
+#define UART1_TX_DMA_CHANNEL   DMA_Channel_4
+#define UART1_TX_DMA_RCC       RCC_AHB1Periph_DMA2
+#define UART1_TX_DMA_IRQn      DMA2_Stream7_IRQn
+#define UART1_TX_DMA_IT_TC     DMA_IT_TCIF7
+#define UART1_TX_DMA_FLAGS     (DMA_FLAG_TCIF7 | DMA_FLAG_HTIF7 | DMA_FLAG_TEIF7 | DMA_FLAG_DMEIF7 | DMA_FLAG_FEIF7)
+
+/* USART2_TX: DMA1 Stream6 Channel4 */
+#define UART2_TX_DMA_STREAM    DMA1_Stream6
+#define UART2_TX_DMA_CHANNEL   DMA_Channel_4
+#define UART2_TX_DMA_RCC       RCC_AHB1Periph_DMA1
+#define UART2_TX_DMA_IRQn      DMA1_Stream6_IRQn
+#define UART2_TX_DMA_IT_TC     DMA_IT_TCIF6
+#define UART2_TX_DMA_FLAGS     (DMA_FLAG_TCIF6 | DMA_FLAG_HTIF6 | DMA_FLAG_TEIF6 | DMA_FLAG_DMEIF6 | DMA_FLAG_FEIF6)
+
+/* USART3_TX: DMA1 Stream3 Channel4 */
+#define UART3_TX_DMA_STREAM    DMA1_Stream3
+#define UART3_TX_DMA_CHANNEL   DMA_Channel_4
+#define UART3_TX_DMA_RCC       RCC_AHB1Periph_DMA1
+#define UART3_TX_DMA_IRQn      DMA1_Stream3_IRQn
+#define UART3_TX_DMA_IT_TC     DMA_IT_TCIF3
+#define UART3_TX_DMA_FLAGS     (DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 | DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3)
+
+/* 接收DMA映射，循环模式 + 串口空闲中断 */
+/* USART2_RX: DMA1 Stream5 Channel4 */
+#define UART2_RX_DMA_STREAM    DMA1_Stream5
+#define UART2_RX_DMA_CHANNEL   DMA_Channel_4
+#define UART2_RX_DMA_RCC       RCC_AHB1Periph_DMA1
+#define UART2_RX_DMA_IRQn      DMA1_Stream5_IRQn
+#define UART2_RX_DMA_IT_HT     DMA_IT_HTIF5
+#define UART2_RX_DMA_IT_TC     DMA_IT_TCIF5
+
+/* USART3_RX: DMA1 Stream1 Channel4 */
+#define UART3_RX_DMA_STREAM    DMA1_Stream1
+#define UART3_RX_DMA_CHANNEL   DMA_Channel_4
+#define UART3_RX_DMA_RCC       RCC_AHB1Periph_DMA1
+#define UART3_RX_DMA_IRQn      DMA1_Stream1_IRQn
+#define UART3_RX_DMA_IT_HT     DMA_IT_HTIF1
+#define UART3_RX_DMA_IT_TC     DMA_IT_TCIF1
+
+/* 接收DMA环形缓冲区大小 (字节)，半满/全满时各中断一次 */
+#define UART2_RX_DMA_BUF_SIZE  256
+#define UART3_RX_DMA_BUF_SIZE  32
+
+/* 中断到主循环的接收队列大小 (字节)，必须是2的幂 */
+#define UART1_RXQ_SIZE         64
+#define UART2_RXQ_SIZE         256
+#define UART3_RXQ_SIZE         64
+
+/* 发送队列大小 (字节)，蓝牙串口输出较多，分配最大 */
+#define UART1_TX_BUF_SIZE      512
+#define UART2_TX_BUF_SIZE      1024
+#define UART3_TX_BUF_SIZE      64
+
+/* 单次DMA最多发送的字节数，分段越小缓冲区释放越及时 */
+#define UART_TX_DMA_CHUNK      128
+
+/* UART_Flush等待时发送这么久没有进展就放弃，须大于最低波特率下发送一段DMA的时间(9600时约133ms) */
+#define UART_FLUSH_STALL_MS    200
+
+/* UART_Printf单次输出的最大长度 (含结尾'\0')，缓冲区在栈上 */
+#define UART_PRINTF_BUF_SIZE   128
+
 
 
 /* 串口波特率定义 */
@@ -112,6 +179,8 @@ typedef struct {
     UART_DataBitTypeDef DataBits;        /* 数据位 */
     UART_FlowControlTypeDef FlowControl; /* 流控 */
     FunctionalState RxIntEnable;         /* 接收中断使能 */
+    FunctionalState TxDmaEnable;         /* DMA非阻塞发送使能 */
+    FunctionalState RxDmaEnable;         /* 环形DMA+空闲中断接收使能（仅USART2/USART3） */
     uint8_t PreemptionPriority;          /* 抢占优先级 */
     uint8_t SubPriority;                 /* 子优先级 */
 } UART_ConfigTypeDef;
@@ -154,6 +223,7 @@ void UART_Init(UART_ConfigTypeDef *config);
  * @param  USARTx: UART外设
  * @param  ch: 要发送的字符
  * @retval None
+ * @note   已使能DMA发送时只入队，立即返回，队列满时丢弃（见UART_Write）；否则等待TXE后发送
  */
 void UART_SendChar(USART_TypeDef* USARTx, uint8_t ch);
 
@@ -162,11 +232,42 @@ void UART_SendChar(USART_TypeDef* USARTx, uint8_t ch);
  * @param  USARTx: UART外设
  * @param  str: 要发送的字符串
  * @retval None
+ * @note   已使能DMA发送时只入队，立即返回，队列满时丢弃（见UART_Write）
  */
 void UART_SendString(USART_TypeDef* USARTx, char *str);
 
+/**
+ * @brief  串口发送指定长度的数据
+ * @param  USARTx: UART外设
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval 实际入队的字节数，队列满时多余字节被丢弃并计数
+ * @note   已使能DMA发送时不再阻塞等待：队列满时多余的字节直接丢弃，计入
+ *         UART_GetTxStats的dropped，输出可能丢失；不能丢的数据应检查返回值，
+ *         或先用UART_Flush等队列发空
+ */
+uint16_t UART_Write(USART_TypeDef* USARTx, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  等待发送队列中的数据全部发出
+ * @param  USARTx: UART外设
+ * @retval 0-已全部发出, 1-关中断或在中断中调用（DMA完成中断无法推进队列），
+ *         或超过UART_FLUSH_STALL_MS没有进展（外设未使能等）
+ * @note   会阻塞调用者，仅用于复位前等需要确保数据发出的场合
+ */
+uint8_t UART_Flush(USART_TypeDef* USARTx);
+
+/**
+ * @brief  获取发送队列统计信息
+ * @param  USARTx: UART外设
+ * @param  stats: 输出队列深度、历史最高深度和丢弃字节数
+ * @retval None
+ */
+void UART_GetTxStats(USART_TypeDef* USARTx, UART_TxStats_t *stats);
+
 /**
  * @brief  串口发送格式化字符串（类似printf）
+ * @note   只支持整数格式（%d %u %x %X %c %s %%），不支持浮点
  * @param  USARTx: UART外设
  * @param  fmt: 格式化字符串
  * @param  ...: 可变参数
@@ -181,13 +282,45 @@ void UART_Printf(USART_TypeDef* USARTx, const char *fmt, ...);
 void UART_RedirectPrintf(void);
 
 /**
- * @brief  串口接收中断回调函数
+ * @brief  串口接收回调函数
  * @param  USARTx: UART外设
  * @param  ch: 接收到的字符
- * @note   用户需要自己实现此函数
+ * @note   由UART_Poll在主循环上下文中调用，不在中断中执行
  */
 void UART_RxCallback(USART_TypeDef* USARTx, uint8_t ch);
 
+/**
+ * @brief  处理各串口接收队列中的数据
+ * @param  None
+ * @retval None
+ * @note   中断只把数据写入无锁队列，需要在主循环中周期调用本函数
+ */
+void UART_Poll(void);
+
+/**
+ * @brief  获取接收队列满时丢弃的字节数
+ * @param  USARTx: UART外设
+ * @retval 丢弃字节数
+ */
+uint32_t UART_GetRxDropped(USART_TypeDef* USARTx);
+
+/**
+ * @brief  获取最近一次收到数据的时刻（DWT周期计数）
+ * @param  USARTx: UART外设
+ * @retval 周期计数，用于计算从收到命令到回复的延迟
+ */
+uint32_t UART_GetRxStamp(USART_TypeDef* USARTx);
+
+/**
+ * @brief  串口DMA接收数据段回调函数
+ * @param  USARTx: UART外设
+ * @param  data: 新收到的连续数据
+ * @param  len: 数据长度
+ * @note   在串口空闲中断或DMA半满/全满中断中调用，
+ *         只把数据写入接收队列
+ */
+void UART_RxChunkCallback(USART_TypeDef* USARTx, const uint8_t *data, uint16_t len);
+
 /**
  * @brief  USART1发送指定长度的字符串
  * @param  USARTx: UART外设
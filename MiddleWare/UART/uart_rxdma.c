@@ -0,0 +1,84 @@
+#include "uart_rxdma.h"
+
+/**
+ * @file    uart_rxdma.c
+ * @brief   UART环形DMA接收分段逻辑源文件
+ * @date    2025-07-12
+ * @version 1.0
+ */
+
+/**
+ * @brief  初始化接收状态
+ * @param  rx: 接收状态
+ * @param  buf: DMA接收缓冲区
+ * @param  size: 缓冲区大小
+ * @retval None
+ */
+void UART_RxDma_Init(UART_RxDma_t *rx, const uint8_t *buf, uint16_t size)
+{
+    rx->buf = buf;
+    rx->size = size;
+    rx->last_pos = 0;
+    rx->events = 0;
+    rx->chunks = 0;
+    rx->bytes = 0;
+}
+
+/**
+ * @brief  交付一段连续数据
+ */
+static void UART_RxDma_Deliver(UART_RxDma_t *rx, uint16_t from, uint16_t len,
+                               UART_RxChunkFunc cb, void *ctx)
+{
+    cb(ctx, &rx->buf[from], len);
+    rx->chunks++;
+    rx->bytes += len;
+}
+
+/**
+ * @brief  根据DMA写入位置交付新数据
+ * @param  rx: 接收状态
+ * @param  pos: DMA当前写入位置，即 size - NDTR
+ * @param  cb: 数据段回调，回绕时调用两次
+ * @param  ctx: 回调上下文
+ * @retval 本次交付的字节数
+ */
+uint16_t UART_RxDma_Process(UART_RxDma_t *rx, uint16_t pos, UART_RxChunkFunc cb, void *ctx)
+{
+    uint16_t last = rx->last_pos;
+    uint16_t total = 0;
+
+    rx->events++;
+
+    /* NDTR重装瞬间可能读到0，此时位置等同于缓冲区起点 */
+    if(pos >= rx->size)
+    {
+        pos = 0;
+    }
+
+    if(pos == last)
+    {
+        return 0;
+    }
+
+    if(pos > last)
+    {
+        /* 未回绕，一段连续数据 */
+        total = pos - last;
+        UART_RxDma_Deliver(rx, last, total, cb, ctx);
+    }
+    else
+    {
+        /* 回绕，先交付到缓冲区末尾，再交付开头部分 */
+        total = rx->size - last;
+        UART_RxDma_Deliver(rx, last, total, cb, ctx);
+        if(pos > 0)
+        {
+            UART_RxDma_Deliver(rx, 0, pos, cb, ctx);
+            total += pos;
+        }
+    }
+
+    rx->last_pos = pos;
+    return total;
+}
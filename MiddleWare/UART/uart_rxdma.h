@@ -0,0 +1,57 @@
+#ifndef __UART_RXDMA_H
+#define __UART_RXDMA_H
+
+/**
+ * @file    uart_rxdma.h
+ * @brief   UART环形DMA接收分段逻辑头文件
+ * @details DMA以循环模式不停写入接收缓冲区，串口空闲中断和DMA半满/全满
+ *          中断发生时，根据DMA当前写入位置把新到的数据分段交给使用者。
+ *          本模块不访问外设寄存器，可以在PC上编译测试
+ * @date    2025-07-12
+ * @version 1.0
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief  数据段回调函数类型
+ * @param  ctx: 用户上下文
+ * @param  data: 新收到的连续数据
+ * @param  len: 数据长度
+ */
+typedef void (*UART_RxChunkFunc)(void *ctx, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  环形DMA接收状态
+ */
+typedef struct {
+    const uint8_t *buf;     /* DMA接收缓冲区 */
+    uint16_t size;          /* 缓冲区大小 */
+    uint16_t last_pos;      /* 上次处理到的位置 */
+    uint32_t events;        /* 处理事件次数（即中断次数） */
+    uint32_t chunks;        /* 交付的数据段数 */
+    uint32_t bytes;         /* 交付的总字节数 */
+} UART_RxDma_t;
+
+/**
+ * @brief  初始化接收状态
+ * @param  rx: 接收状态
+ * @param  buf: DMA接收缓冲区
+ * @param  size: 缓冲区大小
+ * @retval None
+ */
+void UART_RxDma_Init(UART_RxDma_t *rx, const uint8_t *buf, uint16_t size);
+
+/**
+ * @brief  根据DMA写入位置交付新数据
+ * @param  rx: 接收状态
+ * @param  pos: DMA当前写入位置，即 size - NDTR
+ * @param  cb: 数据段回调，回绕时调用两次
+ * @param  ctx: 回调上下文
+ * @retval 本次交付的字节数
+ * @note   两次调用之间DMA写入的数据不能超过一整圈缓冲区，
+ *         半满/全满中断保证了这一点
+ */
+uint16_t UART_RxDma_Process(UART_RxDma_t *rx, uint16_t pos, UART_RxChunkFunc cb, void *ctx);
+
+#endif /* __UART_RXDMA_H */
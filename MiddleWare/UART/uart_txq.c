@@ -0,0 +1,179 @@
+#include "uart_txq.h"
+
+/**
+ * @file    uart_txq.c
+ * @brief   UART发送环形队列（DMA分块发送）源文件
+ * @details 队列只在一端写、DMA完成时另一端释放。DMA每次只能发送一段
+ *          连续内存，因此在缓冲区末尾回绕时分成两段发送
+ * @date    2025-07-10
+ * @version 1.0
+ */
+
+/**
+ * @brief  初始化发送队列
+ * @param  q: 队列指针
+ * @param  buf: 缓冲区
+ * @param  size: 缓冲区大小（至少为2）
+ * @param  max_chunk: 单次DMA最大发送字节数，0表示不限制
+ * @retval None
+ */
+void UART_TxQueue_Init(UART_TxQueue_t *q, uint8_t *buf, uint16_t size, uint16_t max_chunk)
+{
+    q->buf = buf;
+    q->size = size;
+    q->max_chunk = max_chunk;
+    q->head = 0;
+    q->tail = 0;
+    q->dma_len = 0;
+    q->high_water = 0;
+    q->dropped = 0;
+    q->sent = 0;
+}
+
+/**
+ * @brief  获取当前队列深度
+ * @param  q: 队列指针
+ * @retval 队列中的字节数（含DMA正在发送的字节）
+ */
+uint16_t UART_TxQueue_Depth(const UART_TxQueue_t *q)
+{
+    uint16_t head = q->head;
+    uint16_t tail = q->tail;
+
+    if(head >= tail)
+    {
+        return head - tail;
+    }
+    return q->size - tail + head;
+}
+
+/**
+ * @brief  写入数据到发送队列
+ * @param  q: 队列指针
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval 实际写入的字节数，剩余部分计入dropped
+ */
+uint16_t UART_TxQueue_Write(UART_TxQueue_t *q, const uint8_t *data, uint16_t len)
+{
+    uint16_t free_space;
+    uint16_t count;
+    uint16_t head;
+    uint16_t depth;
+    uint16_t i;
+
+    free_space = (uint16_t)(q->size - 1 - UART_TxQueue_Depth(q));
+    count = (len < free_space) ? len : free_space;
+
+    head = q->head;
+    for(i = 0; i < count; i++)
+    {
+        q->buf[head] = data[i];
+        head++;
+        if(head >= q->size)
+        {
+            head = 0;
+        }
+    }
+    q->head = head;
+
+    /* 队列满，剩余字节丢弃 */
+    q->dropped += (uint32_t)(len - count);
+
+    depth = UART_TxQueue_Depth(q);
+    if(depth > q->high_water)
+    {
+        q->high_water = depth;
+    }
+
+    return count;
+}
+
+/**
+ * @brief  获取下一段可由DMA发送的连续数据
+ * @param  q: 队列指针
+ * @param  chunk: 输出，连续数据首地址
+ * @retval 本段长度；DMA忙或队列为空时返回0
+ */
+uint16_t UART_TxQueue_NextChunk(UART_TxQueue_t *q, const uint8_t **chunk)
+{
+    uint16_t head = q->head;
+    uint16_t tail = q->tail;
+    uint16_t len;
+
+    if(q->dma_len != 0 || head == tail)
+    {
+        return 0;
+    }
+
+    /* 只取到缓冲区末尾为止的连续部分，回绕部分留给下一段 */
+    if(head > tail)
+    {
+        len = head - tail;
+    }
+    else
+    {
+        len = q->size - tail;
+    }
+
+    if(q->max_chunk != 0 && len > q->max_chunk)
+    {
+        len = q->max_chunk;
+    }
+
+    *chunk = &q->buf[tail];
+    q->dma_len = len;
+    return len;
+}
+
+/**
+ * @brief  当前DMA段发送完成，释放其占用的缓冲区
+ * @param  q: 队列指针
+ * @retval None
+ */
+void UART_TxQueue_ChunkDone(UART_TxQueue_t *q)
+{
+    uint16_t tail = q->tail + q->dma_len;
+
+    if(tail >= q->size)
+    {
+        tail -= q->size;
+    }
+
+    q->sent += q->dma_len;
+    q->tail = tail;
+    q->dma_len = 0;
+}
+
+/**
+ * @brief  DMA空闲时启动下一段发送
+ * @param  q: 队列指针
+ * @param  start: DMA启动回调
+ * @param  ctx: 回调上下文
+ * @retval None
+ */
+void UART_TxQueue_Kick(UART_TxQueue_t *q, UART_TxStartFunc start, void *ctx)
+{
+    const uint8_t *chunk;
+    uint16_t len;
+
+    len = UART_TxQueue_NextChunk(q, &chunk);
+    if(len != 0)
+    {
+        start(ctx, chunk, len);
+    }
+}
+
+/**
+ * @brief  获取统计信息
+ * @param  q: 队列指针
+ * @param  stats: 输出统计信息
+ * @retval None
+ */
+void UART_TxQueue_GetStats(const UART_TxQueue_t *q, UART_TxStats_t *stats)
+{
+    stats->depth = UART_TxQueue_Depth(q);
+    stats->high_water = q->high_water;
+    stats->dropped = q->dropped;
+    stats->sent = q->sent;
+}
@@ -0,0 +1,110 @@
+#ifndef __UART_TXQ_H
+#define __UART_TXQ_H
+
+/**
+ * @file    uart_txq.h
+ * @brief   UART发送环形队列（DMA分块发送）头文件
+ * @details 只包含环形缓冲区和DMA分块逻辑，不访问任何外设寄存器，
+ *          DMA的启动通过回调函数完成，因此可以在PC上用模拟DMA编译测试
+ * @date    2025-07-10
+ * @version 1.0
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief  DMA启动回调函数类型
+ * @param  ctx: 用户上下文（硬件层传入端口描述符）
+ * @param  data: 本次要发送的连续数据首地址
+ * @param  len: 本次要发送的字节数
+ */
+typedef void (*UART_TxStartFunc)(void *ctx, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  发送队列统计信息
+ */
+typedef struct {
+    uint16_t depth;         /* 当前队列深度（含DMA正在发送的字节） */
+    uint16_t high_water;    /* 队列深度历史最高值 */
+    uint32_t dropped;       /* 队列满时丢弃的字节数 */
+    uint32_t sent;          /* DMA已发送完成的字节数 */
+} UART_TxStats_t;
+
+/**
+ * @brief  发送环形队列结构体
+ * @note   head由写入方推进，tail只在DMA完成时推进；
+ *         dma_len不为0表示DMA正在发送从tail开始的dma_len个字节
+ */
+typedef struct {
+    uint8_t *buf;                   /* 缓冲区 */
+    uint16_t size;                  /* 缓冲区大小，实际可用容量为size-1 */
+    uint16_t max_chunk;             /* 单次DMA最大发送字节数 */
+    volatile uint16_t head;         /* 写入位置 */
+    volatile uint16_t tail;         /* 读取位置 */
+    volatile uint16_t dma_len;      /* 当前DMA发送长度，0表示DMA空闲 */
+    uint16_t high_water;            /* 队列深度历史最高值 */
+    uint32_t dropped;               /* 丢弃字节计数 */
+    uint32_t sent;                  /* 已发送字节计数 */
+} UART_TxQueue_t;
+
+/**
+ * @brief  初始化发送队列
+ * @param  q: 队列指针
+ * @param  buf: 缓冲区
+ * @param  size: 缓冲区大小（至少为2）
+ * @param  max_chunk: 单次DMA最大发送字节数，0表示不限制
+ * @retval None
+ */
+void UART_TxQueue_Init(UART_TxQueue_t *q, uint8_t *buf, uint16_t size, uint16_t max_chunk);
+
+/**
+ * @brief  写入数据到发送队列
+ * @param  q: 队列指针
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval 实际写入的字节数，剩余部分计入dropped
+ * @note   不会阻塞，调用者负责与DMA完成中断互斥
+ */
+uint16_t UART_TxQueue_Write(UART_TxQueue_t *q, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief  获取当前队列深度
+ * @param  q: 队列指针
+ * @retval 队列中的字节数（含DMA正在发送的字节）
+ */
+uint16_t UART_TxQueue_Depth(const UART_TxQueue_t *q);
+
+/**
+ * @brief  获取下一段可由DMA发送的连续数据
+ * @param  q: 队列指针
+ * @param  chunk: 输出，连续数据首地址
+ * @retval 本段长度；DMA忙或队列为空时返回0
+ * @note   返回值不为0时队列进入"DMA忙"状态，直到调用UART_TxQueue_ChunkDone
+ */
+uint16_t UART_TxQueue_NextChunk(UART_TxQueue_t *q, const uint8_t **chunk);
+
+/**
+ * @brief  当前DMA段发送完成，释放其占用的缓冲区
+ * @param  q: 队列指针
+ * @retval None
+ */
+void UART_TxQueue_ChunkDone(UART_TxQueue_t *q);
+
+/**
+ * @brief  DMA空闲时启动下一段发送
+ * @param  q: 队列指针
+ * @param  start: DMA启动回调
+ * @param  ctx: 回调上下文
+ * @retval None
+ */
+void UART_TxQueue_Kick(UART_TxQueue_t *q, UART_TxStartFunc start, void *ctx);
+
+/**
+ * @brief  获取统计信息
+ * @param  q: 队列指针
+ * @param  stats: 输出统计信息
+ * @retval None
+ */
+void UART_TxQueue_GetStats(const UART_TxQueue_t *q, UART_TxStats_t *stats);
+
+#endif /* __UART_TXQ_H */
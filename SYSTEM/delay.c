@@ -1,4 +1,6 @@
 #include "delay.h"
+#include "dwt_time.h"
+#include "os.h"
 
 static volatile int mdelay_time;  // volatileؼַֹŻ
 extern volatile uint32_t system_tick;  // main.cеϵͳʱ
@@ -13,12 +15,24 @@ void SysTick_Handler(void)
     
     // ͬʱϵͳʱ
     system_tick++;
+
+#if ENABLE_RTOS
+    // ںʱʱƬδʱֱӷ
+    OS_Tick();
+#endif
 }
 /*
     뼶ʱ - ޸İ棬SysTick
 */
 void Mdelay_Lib(int nms)
 {
+    // еʱóCPU
+    if(OS_Running())
+    {
+        OS_Delay((uint32_t)nms);
+        return;
+    }
+
     // SysTickǷѾΪ1ms
     if(SysTick->LOAD == (SystemCoreClock/1000 - 1))
     {
@@ -26,7 +40,7 @@ void Mdelay_Lib(int nms)
         uint32_t start_tick = system_tick;
         while((system_tick - start_tick) < nms)
         {
-            __NOP();
+            __WFI();    // ˯ߵһжϣSysTickÿ1msһ
         }
     }
     else
@@ -56,15 +70,14 @@ void Simple_Delay_Ms(uint32_t ms)
 }
 
 /*
-    ΢뼶ʱ - 汾SysTick
+    ΢뼶ʱ - ʹDWTڼSystemCoreClockԶ㣬
+    жֻʱ䳤SysTick
 */
 void Udelay_Lib(int nms)
 {
-    // ʹʱSysTick
-    volatile uint32_t count = nms * 42;  // Լ1΢ѭ
-    while(count--)
+    if(nms > 0)
     {
-        __NOP();
+        udelay((uint32_t)nms);
     }
 }
 
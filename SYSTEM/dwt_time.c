@@ -0,0 +1,104 @@
+#include "dwt_time.h"
+
+/**
+ * @file    dwt_time.c
+ * @brief   基于DWT周期计数器的精确延时与时间戳源文件
+ */
+
+#ifdef TIME_HOST
+volatile uint32_t time_host_cycles = 0;
+#endif
+
+/**
+ * @brief  使能DWT周期计数器，可重复调用
+ */
+void time_init(void)
+{
+#ifndef TIME_HOST
+    if((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+#endif
+}
+
+/**
+ * @brief  周期数换算为微秒，按当前SystemCoreClock
+ */
+uint32_t time_cycles_to_us(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000u) / SystemCoreClock);
+}
+
+/**
+ * @brief  周期数换算为纳秒，结果超过32位时饱和
+ */
+uint32_t time_cycles_to_ns(uint32_t cycles)
+{
+    uint64_t ns = ((uint64_t)cycles * 1000000000u) / SystemCoreClock;
+    return ns > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)ns;
+}
+
+/**
+ * @brief  微秒换算为周期数，向上取整，结果超过32位时饱和
+ */
+uint32_t time_us_to_cycles(uint32_t us)
+{
+    uint64_t c = ((uint64_t)us * SystemCoreClock + 999999u) / 1000000u;
+    return c > 0xFFFFFFFFu ? 0xFFFFFFFFu : (uint32_t)c;
+}
+
+/**
+ * @brief  纳秒换算为周期数，向上取整
+ */
+uint32_t time_ns_to_cycles(uint32_t ns)
+{
+    return (uint32_t)(((uint64_t)ns * SystemCoreClock + 999999999u) / 1000000000u);
+}
+
+/**
+ * @brief  从start到现在经过的微秒数
+ */
+uint32_t time_elapsed_us(uint32_t start)
+{
+    return time_cycles_to_us(time_elapsed_cycles(start, time_now_cycles()));
+}
+
+/**
+ * @brief  按周期数等待
+ */
+static void time_wait_cycles(uint32_t start, uint32_t cycles)
+{
+    /* 超过半个回绕周期会被time_reached误判为已到达，这里截断 */
+    if(cycles > 0x7FFFFFFFu)
+    {
+        cycles = 0x7FFFFFFFu;
+    }
+    while(!time_reached(time_now_cycles(), start + cycles))
+    {
+    }
+}
+
+/**
+ * @brief  精确微秒延时
+ */
+void udelay(uint32_t us)
+{
+    uint32_t start = time_now_cycles();
+
+    time_init();
+    time_wait_cycles(start, time_us_to_cycles(us));
+}
+
+/**
+ * @brief  精确纳秒延时，实际分辨率为一个CPU周期加上函数调用开销
+ */
+void ndelay(uint32_t ns)
+{
+    uint32_t start = time_now_cycles();
+
+    time_init();
+    time_wait_cycles(start, time_ns_to_cycles(ns));
+}
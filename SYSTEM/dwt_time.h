@@ -0,0 +1,77 @@
+#ifndef __DWT_TIME_H
+#define __DWT_TIME_H
+
+/**
+ * @file    dwt_time.h
+ * @brief   基于DWT周期计数器的精确延时与时间戳
+ * @details CYCCNT是32位自由计数器，每个CPU时钟加1，168MHz时约25.5秒回绕一次。
+ *          所有时间差都用无符号减法计算，跨一次回绕也正确。
+ *          换算按SystemCoreClock进行，时钟改变后无需重新标定。
+ *          PC上编译时定义TIME_HOST，计数器由测试代码通过time_host_cycles控制
+ */
+
+#include <stdint.h>
+
+#ifdef TIME_HOST
+extern volatile uint32_t time_host_cycles;      /* 模拟的CYCCNT */
+extern uint32_t SystemCoreClock;
+#define TIME_CYCCNT         (time_host_cycles)
+#else
+#include "stm32f4xx.h"
+#define TIME_CYCCNT         (DWT->CYCCNT)
+#endif
+
+/**
+ * @brief  使能DWT周期计数器，可重复调用
+ */
+void time_init(void);
+
+/**
+ * @brief  当前周期计数
+ */
+static __inline uint32_t time_now_cycles(void)
+{
+    return TIME_CYCCNT;
+}
+
+/**
+ * @brief  两个周期计数之间经过的周期数，允许一次回绕
+ */
+static __inline uint32_t time_elapsed_cycles(uint32_t start, uint32_t end)
+{
+    return end - start;
+}
+
+/**
+ * @brief  now是否已到达或越过deadline，两者相差不超过半个回绕周期
+ */
+static __inline uint8_t time_reached(uint32_t now, uint32_t deadline)
+{
+    return (uint8_t)((int32_t)(now - deadline) >= 0);
+}
+
+/**
+ * @brief  周期数换算为微秒/纳秒，按当前SystemCoreClock
+ */
+uint32_t time_cycles_to_us(uint32_t cycles);
+uint32_t time_cycles_to_ns(uint32_t cycles);
+
+/**
+ * @brief  微秒/纳秒换算为周期数，向上取整，结果超过32位时饱和
+ */
+uint32_t time_us_to_cycles(uint32_t us);
+uint32_t time_ns_to_cycles(uint32_t ns);
+
+/**
+ * @brief  从start到现在经过的微秒数
+ */
+uint32_t time_elapsed_us(uint32_t start);
+
+/**
+ * @brief  精确延时，单次不超过半个回绕周期（168MHz时约12秒）
+ * @note   中断只会让延时变长，不会让它变短
+ */
+void udelay(uint32_t us);
+void ndelay(uint32_t ns);
+
+#endif /* __DWT_TIME_H */
@@ -0,0 +1,334 @@
+#include "fmt.h"
+
+/**
+ * @file    fmt.c
+ * @brief   整数格式化输出源文件
+ */
+
+static const uint32_t fmt_pow10[10] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+/* 无符号数转为十进制，逆序写入tmp，返回位数 */
+static uint8_t fmt_digits(uint32_t v, char *tmp)
+{
+    uint8_t n = 0;
+
+    do
+    {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while(v);
+    return n;
+}
+
+/* 写入重复的字符 */
+static void fmt_fill(Fmt_t *f, char c, int16_t count)
+{
+    while(count-- > 0)
+    {
+        Fmt_Char(f, c);
+    }
+}
+
+/* 写入带符号、宽度、填充的数字，digits为逆序 */
+static void fmt_number(Fmt_t *f, uint8_t neg, const char *digits, uint8_t n, uint8_t width, char pad)
+{
+    int16_t fill = (int16_t)width - n - (neg ? 1 : 0);
+
+    if(pad == '0')
+    {
+        if(neg)
+        {
+            Fmt_Char(f, '-');
+        }
+        fmt_fill(f, '0', fill);
+    }
+    else
+    {
+        fmt_fill(f, ' ', fill);
+        if(neg)
+        {
+            Fmt_Char(f, '-');
+        }
+    }
+    while(n)
+    {
+        Fmt_Char(f, digits[--n]);
+    }
+}
+
+/**
+ * @brief  开始向buf写入
+ */
+void Fmt_Init(Fmt_t *f, char *buf, uint16_t size)
+{
+    f->buf = buf;
+    f->size = size;
+    f->len = 0;
+    f->truncated = 0;
+    if(size)
+    {
+        buf[0] = '\0';
+    }
+}
+
+/**
+ * @brief  写入一个字符
+ */
+void Fmt_Char(Fmt_t *f, char c)
+{
+    if(f->len + 1 >= f->size)
+    {
+        f->truncated = 1;
+        return;
+    }
+    f->buf[f->len++] = c;
+    f->buf[f->len] = '\0';
+}
+
+/**
+ * @brief  写入字符串
+ */
+void Fmt_Str(Fmt_t *f, const char *s)
+{
+    while(*s)
+    {
+        Fmt_Char(f, *s++);
+    }
+}
+
+/**
+ * @brief  无符号十进制
+ */
+void Fmt_Uint(Fmt_t *f, uint32_t v, uint8_t width, char pad)
+{
+    char tmp[10];
+    uint8_t n = fmt_digits(v, tmp);
+
+    fmt_number(f, 0, tmp, n, width, pad);
+}
+
+/**
+ * @brief  有符号十进制
+ */
+void Fmt_Int(Fmt_t *f, int32_t v, uint8_t width, char pad)
+{
+    char tmp[10];
+    uint8_t neg = (v < 0);
+    uint32_t u = neg ? 0u - (uint32_t)v : (uint32_t)v;
+    uint8_t n = fmt_digits(u, tmp);
+
+    fmt_number(f, neg, tmp, n, width, pad);
+}
+
+/**
+ * @brief  大写十六进制
+ */
+void Fmt_Hex(Fmt_t *f, uint32_t v, uint8_t digits)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char tmp[8];
+    uint8_t n = 0;
+
+    do
+    {
+        tmp[n++] = hex[v & 0xF];
+        v >>= 4;
+    } while(v);
+    fmt_fill(f, '0', (int16_t)digits - n);
+    while(n)
+    {
+        Fmt_Char(f, tmp[--n]);
+    }
+}
+
+/**
+ * @brief  定点小数
+ */
+void Fmt_Fixed(Fmt_t *f, int32_t v, uint8_t decimals, uint8_t width)
+{
+    char tmp[10];
+    uint8_t neg = (v < 0);
+    uint32_t u = neg ? 0u - (uint32_t)v : (uint32_t)v;
+    uint32_t ip, fp;
+    uint8_t n, i, frac_w;
+
+    if(decimals > 9)
+    {
+        decimals = 9;
+    }
+    ip = u / fmt_pow10[decimals];
+    fp = u % fmt_pow10[decimals];
+    n = fmt_digits(ip, tmp);
+
+    /* 整数部分的宽度 = 总宽度 - 小数点和小数位 */
+    frac_w = decimals ? decimals + 1 : 0;
+    fmt_number(f, neg, tmp, n, width > frac_w ? width - frac_w : 0, ' ');
+    if(decimals)
+    {
+        Fmt_Char(f, '.');
+        for(i = decimals; i > 0; i--)
+        {
+            Fmt_Char(f, (char)('0' + (fp / fmt_pow10[i - 1]) % 10));
+        }
+    }
+}
+
+/**
+ * @brief  浮点数按定点小数输出
+ */
+void Fmt_Float(Fmt_t *f, float v, uint8_t decimals, uint8_t width)
+{
+    float scaled;
+    int32_t iv;
+
+    /* NaN与任何数都不相等；无穷大超出最大的有限值。fmt_number的数字为逆序 */
+    if(v != v)
+    {
+        fmt_number(f, 0, "nan", 3, width, ' ');
+        return;
+    }
+    if(v > 3.40282347e38f || v < -3.40282347e38f)
+    {
+        fmt_number(f, v < 0.0f, "fni", 3, width, ' ');
+        return;
+    }
+
+    if(decimals > 9)
+    {
+        decimals = 9;
+    }
+    scaled = v * (float)fmt_pow10[decimals];
+    scaled += (scaled < 0.0f) ? -0.5f : 0.5f;
+    /* 2147483647不能用float精确表示，会舍入成2^31，转换溢出；
+     * 以2^31为界判断，界内的值转换一定不溢出 */
+    if(scaled >= 2147483648.0f)
+    {
+        iv = 2147483647;
+    }
+    else if(scaled <= -2147483648.0f)
+    {
+        iv = -2147483647;
+    }
+    else
+    {
+        iv = (int32_t)scaled;
+    }
+    Fmt_Fixed(f, iv, decimals, width);
+}
+
+/**
+ * @brief  补空格直到长度为col
+ */
+void Fmt_Pad(Fmt_t *f, uint16_t col)
+{
+    fmt_fill(f, ' ', (int16_t)(col - f->len));
+}
+
+/**
+ * @brief  按格式串输出（整数子集）
+ */
+uint16_t Fmt_VPrintf(Fmt_t *f, const char *fmt, va_list ap)
+{
+    uint8_t left, width, is_long;
+    char pad;
+    uint16_t start;
+    const char *s;
+
+    while(*fmt)
+    {
+        if(*fmt != '%')
+        {
+            Fmt_Char(f, *fmt++);
+            continue;
+        }
+        fmt++;
+
+        left = 0;
+        pad = ' ';
+        width = 0;
+        if(*fmt == '-')
+        {
+            left = 1;
+            fmt++;
+        }
+        if(*fmt == '0')
+        {
+            pad = '0';
+            fmt++;
+        }
+        while(*fmt >= '0' && *fmt <= '9')
+        {
+            width = (uint8_t)(width * 10 + (*fmt++ - '0'));
+        }
+        is_long = (*fmt == 'l');
+        if(is_long)
+        {
+            fmt++;
+        }
+
+        start = f->len;
+        switch(*fmt)
+        {
+        case 'd':
+        case 'i':
+            Fmt_Int(f, is_long ? (int32_t)va_arg(ap, long) : (int32_t)va_arg(ap, int), left ? 0 : width, pad);
+            break;
+        case 'u':
+            Fmt_Uint(f, is_long ? (uint32_t)va_arg(ap, unsigned long) : va_arg(ap, unsigned int), left ? 0 : width, pad);
+            break;
+        case 'x':
+        case 'X':
+            /* 只输出大写，宽度只支持补0（%03X） */
+            Fmt_Hex(f, is_long ? (uint32_t)va_arg(ap, unsigned long) : va_arg(ap, unsigned int),
+                    (left || pad != '0') ? 0 : width);
+            break;
+        case 'c':
+            Fmt_Char(f, (char)va_arg(ap, int));
+            break;
+        case 's':
+            s = va_arg(ap, const char *);
+            if(!left && width)
+            {
+                uint16_t n = 0;
+                while(s[n])
+                {
+                    n++;
+                }
+                fmt_fill(f, ' ', (int16_t)width - n);
+            }
+            Fmt_Str(f, s);
+            break;
+        case '%':
+            Fmt_Char(f, '%');
+            break;
+        case '\0':
+            return f->len;
+        default:
+            Fmt_Char(f, '%');
+            Fmt_Char(f, *fmt);
+            break;
+        }
+        if(left)
+        {
+            Fmt_Pad(f, start + width);
+        }
+        fmt++;
+    }
+    return f->len;
+}
+
+/**
+ * @brief  按格式串输出（整数子集）
+ */
+uint16_t Fmt_Printf(Fmt_t *f, const char *fmt, ...)
+{
+    va_list ap;
+    uint16_t len;
+
+    va_start(ap, fmt);
+    len = Fmt_VPrintf(f, fmt, ap);
+    va_end(ap);
+    return len;
+}
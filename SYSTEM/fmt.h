@@ -0,0 +1,85 @@
+#ifndef __FMT_H
+#define __FMT_H
+
+/**
+ * @file    fmt.h
+ * @brief   整数格式化输出
+ * @details 代替sprintf/vsnprintf：按字段依次写入调用者的缓冲区（LCD一行、串口发送缓冲），
+ *          只用整数运算，不引入C库的格式化代码，栈占用只有几十字节。
+ *          小数按定点数输出：值乘以10^n后作为整数传入，或由Fmt_Float先换算。
+ *          缓冲区不够时截断并置truncated，结果始终以'\0'结尾。
+ *          Fmt_Printf只支持%d %u %x %X %c %s %%，可带'-'、'0'、宽度和'l'，没有浮点。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+#include <stdarg.h>
+
+/**
+ * @brief  输出缓冲区
+ */
+typedef struct {
+    char *buf;
+    uint16_t size;          /* 缓冲区大小，含结尾'\0' */
+    uint16_t len;           /* 已写入的字符数 */
+    uint8_t truncated;      /* 有内容因缓冲区满被丢弃 */
+} Fmt_t;
+
+/**
+ * @brief  开始向buf写入，size至少为1
+ */
+void Fmt_Init(Fmt_t *f, char *buf, uint16_t size);
+
+/**
+ * @brief  写入一个字符
+ */
+void Fmt_Char(Fmt_t *f, char c);
+
+/**
+ * @brief  写入字符串
+ */
+void Fmt_Str(Fmt_t *f, const char *s);
+
+/**
+ * @brief  无符号十进制
+ * @param  width: 最小宽度，不足时右对齐，0为不限
+ * @param  pad: 填充字符，' '或'0'
+ */
+void Fmt_Uint(Fmt_t *f, uint32_t v, uint8_t width, char pad);
+
+/**
+ * @brief  有符号十进制，pad为'0'时负号在填充的0之前
+ */
+void Fmt_Int(Fmt_t *f, int32_t v, uint8_t width, char pad);
+
+/**
+ * @brief  大写十六进制，至少digits位，不足补0
+ */
+void Fmt_Hex(Fmt_t *f, uint32_t v, uint8_t digits);
+
+/**
+ * @brief  定点小数
+ * @param  v: 以10^-decimals为单位的值，如decimals=1时123输出"12.3"
+ * @param  decimals: 小数位数，0~9
+ * @param  width: 最小宽度（含负号和小数点），右对齐补空格
+ */
+void Fmt_Fixed(Fmt_t *f, int32_t v, uint8_t decimals, uint8_t width);
+
+/**
+ * @brief  浮点数四舍五入到decimals位后按定点小数输出，超出int32范围时饱和
+ * @note   NaN输出"nan"，无穷大输出"inf"或"-inf"，同样按width右对齐
+ */
+void Fmt_Float(Fmt_t *f, float v, uint8_t decimals, uint8_t width);
+
+/**
+ * @brief  补空格直到长度为col（对齐LCD列）
+ */
+void Fmt_Pad(Fmt_t *f, uint16_t col);
+
+/**
+ * @brief  按格式串输出（整数子集），返回写入后的总长度
+ */
+uint16_t Fmt_VPrintf(Fmt_t *f, const char *fmt, va_list ap);
+uint16_t Fmt_Printf(Fmt_t *f, const char *fmt, ...);
+
+#endif /* __FMT_H */
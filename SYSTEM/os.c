@@ -0,0 +1,679 @@
+#include "os.h"
+#include <string.h>
+
+/**
+ * @file    os.c
+ * @brief   抢占式实时内核源文件
+ */
+
+#define OS_INITIAL_XPSR         0x01000000u     /* Thumb状态 */
+#define OS_INITIAL_EXC_RETURN   0xFFFFFFFDu     /* 返回线程模式，使用PSP，无FPU上下文 */
+
+OS_Task_t *os_current = 0;                      /* 当前任务，PendSV/SVC中访问，不能是static */
+
+static OS_Task_t *os_tasks[OS_MAX_TASKS];
+static uint8_t os_task_count = 0;
+static volatile uint32_t os_ticks = 0;
+static volatile uint8_t os_running = 0;
+static volatile uint8_t os_lock = 0;            /* OS_Suspend嵌套层数 */
+static volatile uint8_t os_switch_pending = 0;  /* 暂停期间被推迟的切换 */
+
+static OS_Task_t os_idle_task;
+static uint32_t os_idle_stack[OS_IDLE_STACK_WORDS] __attribute__((aligned(8)));
+
+void OS_Switch(void);
+
+/* 进入临界区，返回原来的PRIMASK */
+static uint32_t os_enter(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    return primask;
+}
+
+/* 退出临界区，挂起的PendSV在此执行 */
+static void os_exit(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+/* 请求一次任务切换 */
+static void os_pend_switch(void)
+{
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    __DSB();
+    __ISB();
+}
+
+/* 就绪任务中优先级最高的，相同优先级从当前任务的下一个开始找，实现轮转 */
+static OS_Task_t *os_pick(void)
+{
+    OS_Task_t *t, *best = 0;
+    uint8_t start = os_current ? os_current->index : 0;
+    uint8_t i;
+
+    for(i = 1; i <= os_task_count; i++)
+    {
+        t = os_tasks[(start + i) % os_task_count];
+        if(t->state == OS_READY && (best == 0 || t->priority < best->priority))
+        {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/* 唤醒等待obj的任务中优先级最高的一个，须在临界区中调用，返回1-唤醒了 */
+static uint8_t os_wake_one(const void *obj, uint8_t wait_send)
+{
+    OS_Task_t *t, *best = 0;
+    uint8_t i;
+
+    for(i = 0; i < os_task_count; i++)
+    {
+        t = os_tasks[i];
+        if(t->state == OS_BLOCKED && t->wait == obj && t->wait_send == wait_send &&
+           (best == 0 || t->priority < best->priority))
+        {
+            best = t;
+        }
+    }
+    if(best)
+    {
+        best->state = OS_READY;
+        best->wait = 0;
+        best->timed = 0;
+        if(best->priority < os_current->priority)
+        {
+            os_pend_switch();
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/* 当前任务阻塞等待obj，须在临界区中调用，退出临界区后切换 */
+static void os_block(const void *obj, uint8_t wait_send, uint32_t timeout, uint32_t start)
+{
+    os_current->state = OS_BLOCKED;
+    os_current->wait = obj;
+    os_current->wait_send = wait_send;
+    os_current->timed = (timeout != OS_WAIT_FOREVER);
+    os_current->wake = start + timeout;
+    os_pend_switch();
+}
+
+/* 是否应该放弃等待：不允许等待、已超时或内核未启动 */
+static uint8_t os_give_up(uint32_t timeout, uint32_t start)
+{
+    if(timeout == 0 || !os_running)
+    {
+        return 1;
+    }
+    return timeout != OS_WAIT_FOREVER && os_ticks - start >= timeout;
+}
+
+/* 任务函数返回后停在这里 */
+static void os_task_exit(void)
+{
+    uint32_t primask = os_enter();
+
+    os_current->state = OS_BLOCKED;
+    os_current->wait = 0;
+    os_current->timed = 0;
+    os_pend_switch();
+    os_exit(primask);
+    while(1)
+    {
+    }
+}
+
+/* 空闲任务，没有其它就绪任务时睡眠到下一个中断 */
+static void os_idle(void *arg)
+{
+    while(1)
+    {
+        __WFI();
+    }
+}
+
+/**
+ * @brief  选出下一个运行的任务，由PendSV在关中断时调用
+ */
+void OS_Switch(void)
+{
+    if(os_current->stack[0] != OS_STACK_FILL)
+    {
+        os_current->overflow = 1;
+    }
+    if(os_lock && os_current->state == OS_READY)
+    {
+        os_switch_pending = 1;
+        return;
+    }
+    os_current = os_pick();
+    os_current->switches++;
+}
+
+/* =================== Cortex-M4F移植 =================== */
+#if defined(__CC_ARM)
+
+#if ENABLE_RTOS
+
+/**
+ * @brief  启动第一个任务：从os_current的栈恢复上下文
+ */
+__asm void SVC_Handler(void)
+{
+    extern os_current
+
+    PRESERVE8
+
+    ldr r3, =os_current
+    ldr r1, [r3]
+    ldr r0, [r1]
+    ldmia r0!, {r4-r11, r14}
+    msr psp, r0
+    isb
+    mov r0, #0
+    msr basepri, r0
+    bx r14
+
+    ALIGN
+}
+
+/**
+ * @brief  任务切换：保存当前任务上下文，OS_Switch选出下一个任务后恢复
+ * @note   EXC_RETURN的bit4为0说明任务用过FPU，硬件已压入s0-s15，这里补存s16-s31
+ */
+__asm void PendSV_Handler(void)
+{
+    extern os_current
+    extern OS_Switch
+
+    PRESERVE8
+
+    mrs r0, psp
+    isb
+    ldr r3, =os_current
+    ldr r2, [r3]
+    tst r14, #0x10
+    it eq
+    vstmdbeq r0!, {s16-s31}
+    stmdb r0!, {r4-r11, r14}
+    str r0, [r2]
+
+    stmdb sp!, {r0, r3}
+    cpsid i
+    bl OS_Switch
+    cpsie i
+    ldmia sp!, {r0, r3}
+
+    ldr r1, [r3]
+    ldr r0, [r1]
+    ldmia r0!, {r4-r11, r14}
+    tst r14, #0x10
+    it eq
+    vldmiaeq r0!, {s16-s31}
+    msr psp, r0
+    isb
+    bx r14
+
+    ALIGN
+}
+
+#endif /* ENABLE_RTOS */
+
+/* 主栈恢复到向量表初值，清除FPU上下文标志，进入SVC启动第一个任务 */
+__asm static void os_start_first(void)
+{
+    PRESERVE8
+
+    ldr r0, =0xE000ED08
+    ldr r0, [r0]
+    ldr r0, [r0]
+    msr msp, r0
+    mov r0, #0
+    msr control, r0
+    cpsie i
+    cpsie f
+    dsb
+    isb
+    svc 0
+    nop
+
+    ALIGN
+}
+
+#elif defined(__GNUC__)
+
+#if ENABLE_RTOS
+
+/**
+ * @brief  启动第一个任务：从os_current的栈恢复上下文
+ */
+__attribute__((naked)) void SVC_Handler(void)
+{
+    __asm volatile(
+        "   ldr r3, =os_current         \n"
+        "   ldr r1, [r3]                \n"
+        "   ldr r0, [r1]                \n"
+        "   ldmia r0!, {r4-r11, r14}    \n"
+        "   msr psp, r0                 \n"
+        "   isb                         \n"
+        "   mov r0, #0                  \n"
+        "   msr basepri, r0             \n"
+        "   bx r14                      \n"
+        "   .ltorg                      \n"
+    );
+}
+
+/**
+ * @brief  任务切换：保存当前任务上下文，OS_Switch选出下一个任务后恢复
+ * @note   EXC_RETURN的bit4为0说明任务用过FPU，硬件已压入s0-s15，这里补存s16-s31
+ */
+__attribute__((naked)) void PendSV_Handler(void)
+{
+    __asm volatile(
+        "   mrs r0, psp                 \n"
+        "   isb                         \n"
+        "   ldr r3, =os_current         \n"
+        "   ldr r2, [r3]                \n"
+        "   tst r14, #0x10              \n"
+        "   it eq                       \n"
+        "   vstmdbeq r0!, {s16-s31}     \n"
+        "   stmdb r0!, {r4-r11, r14}    \n"
+        "   str r0, [r2]                \n"
+        "                               \n"
+        "   stmdb sp!, {r0, r3}         \n"
+        "   cpsid i                     \n"
+        "   bl OS_Switch                \n"
+        "   cpsie i                     \n"
+        "   ldmia sp!, {r0, r3}         \n"
+        "                               \n"
+        "   ldr r1, [r3]                \n"
+        "   ldr r0, [r1]                \n"
+        "   ldmia r0!, {r4-r11, r14}    \n"
+        "   tst r14, #0x10              \n"
+        "   it eq                       \n"
+        "   vldmiaeq r0!, {s16-s31}     \n"
+        "   msr psp, r0                 \n"
+        "   isb                         \n"
+        "   bx r14                      \n"
+        "   .ltorg                      \n"
+    );
+}
+
+#endif /* ENABLE_RTOS */
+
+/* 主栈恢复到向量表初值，清除FPU上下文标志，进入SVC启动第一个任务 */
+__attribute__((naked)) static void os_start_first(void)
+{
+    __asm volatile(
+        "   ldr r0, =0xE000ED08         \n"
+        "   ldr r0, [r0]                \n"
+        "   ldr r0, [r0]                \n"
+        "   msr msp, r0                 \n"
+        "   mov r0, #0                  \n"
+        "   msr control, r0             \n"
+        "   cpsie i                     \n"
+        "   cpsie f                     \n"
+        "   dsb                         \n"
+        "   isb                         \n"
+        "   svc 0                       \n"
+        "   nop                         \n"
+        "   .ltorg                      \n"
+    );
+}
+
+#else
+#error "os.c: unsupported compiler"
+#endif
+
+/**
+ * @brief  创建任务
+ */
+uint8_t OS_Task_Create(OS_Task_t *t, const char *name, OS_Task_Func_t func, void *arg,
+                       uint32_t *stack, uint32_t stack_words, uint8_t priority)
+{
+    uint32_t *sp;
+    uint32_t i;
+
+    if(os_task_count >= OS_MAX_TASKS || stack_words < OS_STACK_MIN || os_running)
+    {
+        return 1;
+    }
+
+    for(i = 0; i < stack_words; i++)
+    {
+        stack[i] = OS_STACK_FILL;
+    }
+
+    /* 栈顶按8字节对齐，依次是硬件自动出栈的8个寄存器和PendSV恢复的r4-r11、EXC_RETURN */
+    sp = (uint32_t *)((uintptr_t)(stack + stack_words) & ~(uintptr_t)7);
+    *(--sp) = OS_INITIAL_XPSR;
+    *(--sp) = (uint32_t)(uintptr_t)func & ~1u;  /* PC */
+    *(--sp) = (uint32_t)(uintptr_t)os_task_exit; /* LR */
+    *(--sp) = 0;                                /* R12 */
+    *(--sp) = 0;                                /* R3 */
+    *(--sp) = 0;                                /* R2 */
+    *(--sp) = 0;                                /* R1 */
+    *(--sp) = (uint32_t)(uintptr_t)arg;         /* R0 */
+    *(--sp) = OS_INITIAL_EXC_RETURN;
+    for(i = 0; i < 8; i++)
+    {
+        *(--sp) = 0;                            /* R11-R4 */
+    }
+
+    t->sp = sp;
+    t->stack = stack;
+    t->stack_words = stack_words;
+    t->name = name;
+    t->priority = priority;
+    t->index = os_task_count;
+    t->state = OS_READY;
+    t->timed = 0;
+    t->wait_send = 0;
+    t->overflow = 0;
+    t->wait = 0;
+    t->wake = 0;
+    t->switches = 0;
+    t->ticks = 0;
+    os_tasks[os_task_count++] = t;
+    return 0;
+}
+
+/**
+ * @brief  创建空闲任务并开始调度
+ */
+void OS_Start(void)
+{
+    __disable_irq();
+    OS_Task_Create(&os_idle_task, "idle", os_idle, 0, os_idle_stack, OS_IDLE_STACK_WORDS, OS_PRIO_IDLE);
+
+    /* PendSV优先级最低，只在没有其它中断时切换 */
+    NVIC_SetPriority(PendSV_IRQn, 0xFF);
+
+    os_current = os_pick();
+    os_current->switches++;
+    os_running = 1;
+    os_start_first();
+}
+
+/**
+ * @brief  内核是否已开始调度
+ */
+uint8_t OS_Running(void)
+{
+    return os_running;
+}
+
+/**
+ * @brief  SysTick中断中调用
+ */
+void OS_Tick(void)
+{
+    OS_Task_t *t;
+    uint8_t i, need = 0;
+
+    if(!os_running)
+    {
+        return;
+    }
+
+    os_ticks++;
+    os_current->ticks++;
+    for(i = 0; i < os_task_count; i++)
+    {
+        t = os_tasks[i];
+        if(t->state != OS_READY)
+        {
+            if(t->timed && (int32_t)(os_ticks - t->wake) >= 0)
+            {
+                t->state = OS_READY;
+                t->wait = 0;
+                t->timed = 0;
+                need |= (t->priority <= os_current->priority);
+            }
+        }
+        else if(t != os_current && t->priority == os_current->priority)
+        {
+            need = 1;       /* 时间片轮转 */
+        }
+    }
+    if(need)
+    {
+        os_pend_switch();
+    }
+}
+
+/**
+ * @brief  内核tick计数
+ */
+uint32_t OS_Now(void)
+{
+    return os_ticks;
+}
+
+/**
+ * @brief  让出CPU
+ */
+void OS_Yield(void)
+{
+    if(os_running)
+    {
+        os_pend_switch();
+    }
+}
+
+/**
+ * @brief  延时
+ */
+void OS_Delay(uint32_t ms)
+{
+    uint32_t primask;
+
+    if(ms == 0 || !os_running)
+    {
+        OS_Yield();
+        return;
+    }
+
+    primask = os_enter();
+    os_current->state = OS_DELAYED;
+    os_current->timed = 1;
+    os_current->wake = os_ticks + ms;
+    os_pend_switch();
+    os_exit(primask);
+}
+
+/**
+ * @brief  周期延时
+ */
+void OS_Delay_Until(uint32_t *prev, uint32_t period)
+{
+    uint32_t primask;
+
+    primask = os_enter();
+    *prev += period;
+    if(os_running && (int32_t)(*prev - os_ticks) > 0)
+    {
+        os_current->state = OS_DELAYED;
+        os_current->timed = 1;
+        os_current->wake = *prev;
+        os_pend_switch();
+    }
+    os_exit(primask);
+}
+
+/**
+ * @brief  暂停任务切换
+ */
+void OS_Suspend(void)
+{
+    uint32_t primask = os_enter();
+
+    os_lock++;
+    os_exit(primask);
+}
+
+/**
+ * @brief  恢复任务切换
+ */
+void OS_Resume(void)
+{
+    uint32_t primask = os_enter();
+
+    if(os_lock && --os_lock == 0 && os_switch_pending)
+    {
+        os_switch_pending = 0;
+        os_pend_switch();
+    }
+    os_exit(primask);
+}
+
+/**
+ * @brief  初始化队列
+ */
+void OS_Queue_Init(OS_Queue_t *q, void *buf, uint16_t item_size, uint16_t length)
+{
+    q->buf = (uint8_t *)buf;
+    q->item_size = item_size;
+    q->length = length;
+    q->head = 0;
+    q->count = 0;
+    q->peak = 0;
+    q->full = 0;
+}
+
+/**
+ * @brief  发送一个元素到队尾
+ */
+uint8_t OS_Queue_Send(OS_Queue_t *q, const void *item, uint32_t timeout)
+{
+    uint32_t start = os_ticks;
+    uint32_t primask;
+    uint16_t tail;
+
+    while(1)
+    {
+        primask = os_enter();
+        if(q->count < q->length)
+        {
+            tail = (uint16_t)((q->head + q->count) % q->length);
+            memcpy(q->buf + (uint32_t)tail * q->item_size, item, q->item_size);
+            q->count++;
+            if(q->count > q->peak)
+            {
+                q->peak = q->count;
+            }
+            os_wake_one(q, 0);
+            os_exit(primask);
+            return 0;
+        }
+        if(os_give_up(timeout, start))
+        {
+            q->full++;
+            os_exit(primask);
+            return 1;
+        }
+        os_block(q, 1, timeout, start);
+        os_exit(primask);
+    }
+}
+
+/* 取出或只读取队头元素 */
+static uint8_t os_queue_get(OS_Queue_t *q, void *item, uint32_t timeout, uint8_t remove)
+{
+    uint32_t start = os_ticks;
+    uint32_t primask;
+
+    while(1)
+    {
+        primask = os_enter();
+        if(q->count)
+        {
+            memcpy(item, q->buf + (uint32_t)q->head * q->item_size, q->item_size);
+            if(remove)
+            {
+                q->head = (uint16_t)((q->head + 1) % q->length);
+                q->count--;
+                os_wake_one(q, 1);
+            }
+            os_exit(primask);
+            return 0;
+        }
+        if(os_give_up(timeout, start))
+        {
+            os_exit(primask);
+            return 1;
+        }
+        os_block(q, 0, timeout, start);
+        os_exit(primask);
+    }
+}
+
+/**
+ * @brief  从队头取出一个元素
+ */
+uint8_t OS_Queue_Receive(OS_Queue_t *q, void *item, uint32_t timeout)
+{
+    return os_queue_get(q, item, timeout, 1);
+}
+
+/**
+ * @brief  读取队头元素但不取出
+ */
+uint8_t OS_Queue_Peek(OS_Queue_t *q, void *item, uint32_t timeout)
+{
+    return os_queue_get(q, item, timeout, 0);
+}
+
+/**
+ * @brief  覆盖写入
+ */
+void OS_Queue_Overwrite(OS_Queue_t *q, const void *item)
+{
+    uint32_t primask = os_enter();
+
+    q->head = 0;
+    q->count = 1;
+    q->peak = 1;
+    memcpy(q->buf, item, q->item_size);
+    /* 所有等待读取的任务都能读到，逐个唤醒 */
+    while(os_wake_one(q, 0))
+    {
+    }
+    os_exit(primask);
+}
+
+/**
+ * @brief  任务栈从未用到的字节数
+ */
+uint32_t OS_Stack_Free(const OS_Task_t *t)
+{
+    uint32_t i = 0;
+
+    while(i < t->stack_words && t->stack[i] == OS_STACK_FILL)
+    {
+        i++;
+    }
+    return i * 4;
+}
+
+/**
+ * @brief  任务个数
+ */
+uint8_t OS_Task_Count(void)
+{
+    return os_task_count;
+}
+
+/**
+ * @brief  按序号取任务
+ */
+const OS_Task_t *OS_Task_Get(uint8_t index)
+{
+    return (index < os_task_count) ? os_tasks[index] : 0;
+}
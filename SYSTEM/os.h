@@ -0,0 +1,176 @@
+#ifndef __OS_H
+#define __OS_H
+
+/**
+ * @file    os.h
+ * @brief   抢占式实时内核
+ * @details 固定优先级抢占调度，数值越小越优先，相同优先级按tick轮转。
+ *          任务控制块和栈由调用者静态分配，上下文切换在PendSV中完成，
+ *          支持FPU（惰性压栈，只有用过浮点的任务才保存s16-s31）。
+ *          SysTick每1ms调用OS_Tick处理延时和超时；任务之间通过消息队列通信，
+ *          队列满/空时发送/接收的任务阻塞，可以设超时。
+ *          创建任务时栈填充OS_STACK_FILL，OS_Stack_Free按未被改写的部分统计栈余量。
+ *          队列和延时只能在任务中调用，不能在中断中调用；中断只与内核共用PRIMASK临界区。
+ *          OS_Start之前内核不工作，OS_Tick直接返回；SVC/PendSV异常处理和SysTick中的OS_Tick
+ *          只在ENABLE_RTOS（os_config.h）为1时编译
+ */
+
+#include "stm32f4xx.h"
+#include "os_config.h"
+
+#define OS_MAX_TASKS            12
+#define OS_PRIO_IDLE            0xFF            /* 空闲任务优先级，应用任务不能使用 */
+#define OS_WAIT_FOREVER         0xFFFFFFFFu     /* 永久等待 */
+#define OS_STACK_FILL           0xA5A5A5A5u     /* 栈填充值，用于统计栈余量 */
+#define OS_STACK_MIN            64              /* 最小栈，字，含硬件和FPU上下文 */
+#define OS_IDLE_STACK_WORDS     128
+
+typedef void (*OS_Task_Func_t)(void *arg);
+
+/**
+ * @brief  任务状态
+ */
+typedef enum {
+    OS_READY = 0,
+    OS_DELAYED,                 /* OS_Delay中 */
+    OS_BLOCKED                  /* 等待队列 */
+} OS_State_t;
+
+/**
+ * @brief  任务控制块，由OS_Task_Create初始化
+ */
+typedef struct {
+    uint32_t *sp;               /* 保存的栈指针，必须是第一个成员，PendSV中直接访问 */
+    uint32_t *stack;            /* 栈的最低地址 */
+    uint32_t stack_words;       /* 栈大小，字 */
+    const char *name;
+    uint8_t priority;
+    uint8_t index;              /* 在任务表中的序号 */
+    uint8_t state;              /* OS_State_t */
+    uint8_t timed;              /* 延时或等待是否有超时 */
+    uint8_t wait_send;          /* 1-等待队列有空位, 0-等待队列有数据 */
+    uint8_t overflow;           /* 切换时发现栈底填充值被改写 */
+    const void *wait;           /* 等待的队列 */
+    uint32_t wake;              /* 到期的tick */
+    uint32_t switches;          /* 被切换进来的次数 */
+    uint32_t ticks;             /* tick中断时正在运行的次数，近似CPU占用 */
+} OS_Task_t;
+
+/**
+ * @brief  消息队列，元素按值复制
+ */
+typedef struct {
+    uint8_t *buf;
+    uint16_t item_size;         /* 每个元素的字节数 */
+    uint16_t length;            /* 最多元素个数 */
+    uint16_t head;              /* 最早的元素位置 */
+    uint16_t count;             /* 当前元素个数 */
+    uint16_t peak;              /* 最多同时有多少个元素 */
+    uint32_t full;              /* 发送时队列满的次数 */
+} OS_Queue_t;
+
+/**
+ * @brief  创建任务，须在OS_Start之前调用
+ * @param  stack: 栈，按8字节对齐
+ * @param  stack_words: 栈大小，字，不小于OS_STACK_MIN
+ * @param  priority: 优先级，数值越小越优先，不能是OS_PRIO_IDLE
+ * @retval 0-成功, 1-任务表已满或参数错误
+ */
+uint8_t OS_Task_Create(OS_Task_t *t, const char *name, OS_Task_Func_t func, void *arg,
+                       uint32_t *stack, uint32_t stack_words, uint8_t priority);
+
+/**
+ * @brief  创建空闲任务并开始调度，不返回
+ * @note   主栈（MSP）重新从向量表初值开始，之后只供中断使用
+ */
+void OS_Start(void);
+
+/**
+ * @brief  内核是否已开始调度
+ */
+uint8_t OS_Running(void);
+
+/**
+ * @brief  SysTick中断中调用，每次1个tick
+ */
+void OS_Tick(void);
+
+/**
+ * @brief  内核tick计数
+ */
+uint32_t OS_Now(void);
+
+/**
+ * @brief  让出CPU给相同优先级的就绪任务
+ */
+void OS_Yield(void);
+
+/**
+ * @brief  延时ms个tick，0等同于OS_Yield
+ */
+void OS_Delay(uint32_t ms);
+
+/**
+ * @brief  周期延时：从*prev开始每period个tick释放一次，不受任务自身执行时间影响
+ * @param  prev: 上一次释放的时刻，首次调用前设为OS_Now()，返回时更新
+ * @note   已经落后时不延时，立即返回
+ */
+void OS_Delay_Until(uint32_t *prev, uint32_t period);
+
+/**
+ * @brief  暂停任务切换（可嵌套），中断照常响应；暂停期间不能阻塞
+ */
+void OS_Suspend(void);
+
+/**
+ * @brief  恢复任务切换，暂停期间有需要的切换在此补做
+ */
+void OS_Resume(void);
+
+/**
+ * @brief  初始化队列
+ * @param  buf: 至少item_size * length字节
+ */
+void OS_Queue_Init(OS_Queue_t *q, void *buf, uint16_t item_size, uint16_t length);
+
+/**
+ * @brief  发送一个元素到队尾
+ * @param  timeout: 队列满时最多等待的tick数，0-不等待
+ * @retval 0-成功, 1-超时
+ */
+uint8_t OS_Queue_Send(OS_Queue_t *q, const void *item, uint32_t timeout);
+
+/**
+ * @brief  从队头取出一个元素
+ * @param  timeout: 队列空时最多等待的tick数，0-不等待
+ * @retval 0-成功, 1-超时
+ */
+uint8_t OS_Queue_Receive(OS_Queue_t *q, void *item, uint32_t timeout);
+
+/**
+ * @brief  读取队头元素但不取出
+ * @retval 0-成功, 1-超时
+ */
+uint8_t OS_Queue_Peek(OS_Queue_t *q, void *item, uint32_t timeout);
+
+/**
+ * @brief  覆盖写入，用于长度为1的队列（邮箱），保存最新的值，不会阻塞
+ */
+void OS_Queue_Overwrite(OS_Queue_t *q, const void *item);
+
+/**
+ * @brief  任务栈从未用到的字节数（栈余量）
+ */
+uint32_t OS_Stack_Free(const OS_Task_t *t);
+
+/**
+ * @brief  任务个数（含空闲任务）
+ */
+uint8_t OS_Task_Count(void);
+
+/**
+ * @brief  按序号取任务，超出范围返回NULL
+ */
+const OS_Task_t *OS_Task_Get(uint8_t index);
+
+#endif /* __OS_H */
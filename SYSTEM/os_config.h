@@ -0,0 +1,16 @@
+#ifndef __OS_CONFIG_H
+#define __OS_CONFIG_H
+
+/**
+ * @file    os_config.h
+ * @brief   内核开关
+ * @details ENABLE_RTOS为1时os.c提供SVC_Handler和PendSV_Handler，SysTick中断调用OS_Tick；
+ *          为0时不链接内核的异常处理，stm32f4xx_it.c保留默认实现。
+ *          main.c、delay.c、os.c、stm32f4xx_it.c共用这个开关，只在这里修改
+ */
+
+#ifndef ENABLE_RTOS
+#define ENABLE_RTOS        0    // 1-各传感器、显示、蓝牙命令作为抢占式内核任务运行 (SYSTEM/os.c)，0-协作式调度
+#endif
+
+#endif /* __OS_CONFIG_H */
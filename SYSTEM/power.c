@@ -0,0 +1,250 @@
+#include "power.h"
+#include "tickless.h"
+
+/**
+ * @file    power.c
+ * @brief   无节拍空闲与低功耗模式源文件
+ */
+
+extern volatile uint32_t system_tick;   // main.c中的系统时钟，SysTick每1ms加1
+
+static Tickless_t power_tickless;
+static Power_Stats_t power_stats;
+static uint8_t power_stop_ready = 0;
+static uint32_t power_sleep_frac = 0;   // 不足1ms的睡眠计数
+static uint32_t power_rtc_frac = 0;     // 不足1ms的RTC亚秒余数
+
+/* 累计睡眠计数，换算为毫秒 */
+static void Power_Account(uint32_t counts)
+{
+    power_sleep_frac += counts;
+    power_stats.sleep_ms += power_sleep_frac / power_tickless.tick_cycles;
+    power_sleep_frac %= power_tickless.tick_cycles;
+}
+
+/* 配置LSE驱动的RTC和唤醒定时器中断，返回0-成功 */
+static uint8_t Power_RTC_Init(void)
+{
+    RTC_InitTypeDef rtc;
+    EXTI_InitTypeDef exti;
+    NVIC_InitTypeDef nvic;
+    uint32_t start;
+
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_PWR, ENABLE);
+    PWR_BackupAccessCmd(ENABLE);
+
+    RCC_LSEConfig(RCC_LSE_ON);
+    start = system_tick;
+    while(RCC_GetFlagStatus(RCC_FLAG_LSERDY) == RESET)
+    {
+        if(system_tick - start > POWER_LSE_TIMEOUT_MS)
+        {
+            RCC_LSEConfig(RCC_LSE_OFF);
+            return 1;
+        }
+    }
+
+    RCC_RTCCLKConfig(RCC_RTCCLKSource_LSE);
+    RCC_RTCCLKCmd(ENABLE);
+    RTC_WaitForSynchro();
+
+    rtc.RTC_AsynchPrediv = POWER_RTC_PREDIV_A;
+    rtc.RTC_SynchPrediv = POWER_RTC_PREDIV_S;
+    rtc.RTC_HourFormat = RTC_HourFormat_24;
+    if(RTC_Init(&rtc) != SUCCESS)
+    {
+        return 1;
+    }
+    // 直接读计数器，Stop醒来后不必等影子寄存器同步
+    RTC_BypassShadowCmd(ENABLE);
+
+    RTC_WakeUpCmd(DISABLE);
+    RTC_WakeUpClockConfig(RTC_WakeUpClock_RTCCLK_Div16);
+
+    // RTC唤醒事件接在EXTI22
+    exti.EXTI_Line = EXTI_Line22;
+    exti.EXTI_Mode = EXTI_Mode_Interrupt;
+    exti.EXTI_Trigger = EXTI_Trigger_Rising;
+    exti.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&exti);
+
+    RTC_ClearITPendingBit(RTC_IT_WUT);
+    EXTI_ClearITPendingBit(EXTI_Line22);
+    RTC_ITConfig(RTC_IT_WUT, ENABLE);
+
+    nvic.NVIC_IRQChannel = RTC_WKUP_IRQn;
+    nvic.NVIC_IRQChannelPreemptionPriority = 3;
+    nvic.NVIC_IRQChannelSubPriority = 3;
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+    return 0;
+}
+
+/* 当前RTC时间戳（一天中的亚秒计数），两次读到的亚秒相同才有效 */
+static uint32_t Power_RTC_Stamp(void)
+{
+    RTC_TimeTypeDef time;
+    uint32_t ss;
+
+    do
+    {
+        ss = RTC_GetSubSecond();
+        RTC_GetTime(RTC_Format_BIN, &time);
+    } while(ss != RTC_GetSubSecond());
+
+    return tickless_rtc_stamp(time.RTC_Hours * 3600u + time.RTC_Minutes * 60u + time.RTC_Seconds,
+                              ss, POWER_RTC_PREDIV_S);
+}
+
+/* Stop模式醒来后系统时钟为HSI，重新打开HSE和PLL并切回PLL */
+static void Power_Clock_Restore(void)
+{
+    RCC_HSEConfig(RCC_HSE_ON);
+    if(RCC_WaitForHSEStartUp() != SUCCESS)
+    {
+        return;
+    }
+    RCC_PLLCmd(ENABLE);
+    while(RCC_GetFlagStatus(RCC_FLAG_PLLRDY) == RESET)
+    {
+    }
+    RCC_SYSCLKConfig(RCC_SYSCLKSource_PLLCLK);
+    while(RCC_GetSYSCLKSource() != 0x08)
+    {
+    }
+}
+
+/* Stop模式睡眠，由RTC唤醒定时器或EXTI唤醒 */
+static void Power_Stop(uint32_t idle_ms)
+{
+    uint32_t start, ms;
+
+    RTC_WakeUpCmd(DISABLE);
+    RTC_SetWakeUpCounter(tickless_rtc_counts(idle_ms, POWER_WUT_HZ, POWER_WUT_MAX) - 1);
+    RTC_ClearITPendingBit(RTC_IT_WUT);
+    EXTI_ClearITPendingBit(EXTI_Line22);
+    RTC_WakeUpCmd(ENABLE);
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    start = Power_RTC_Stamp();
+
+    PWR_EnterSTOPMode(PWR_Regulator_LowPower, PWR_STOPEntry_WFI);
+
+    Power_Clock_Restore();
+    ms = tickless_rtc_elapsed_ms(start, Power_RTC_Stamp(), POWER_RTC_PREDIV_S, &power_rtc_frac);
+    RTC_WakeUpCmd(DISABLE);
+
+    // 补上Stop期间的tick，不足1ms的部分留在RTC余数中，SysTick从新的tick边界开始
+    system_tick += ms;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    power_stats.stops++;
+    power_stats.stop_ms += ms;
+    power_stats.sleep_ms += ms;
+    if(ms < idle_ms)
+    {
+        power_stats.early_wakes++;
+    }
+}
+
+/**
+ * @brief  初始化
+ */
+void Power_Init(uint8_t use_stop)
+{
+    tickless_init(&power_tickless, SysTick->LOAD + 1, POWER_SYSTICK_COMP);
+    power_stop_ready = use_stop ? (Power_RTC_Init() == 0) : 0;
+}
+
+/**
+ * @brief  Stop模式是否可用
+ */
+uint8_t Power_Stop_Ready(void)
+{
+    return power_stop_ready;
+}
+
+/**
+ * @brief  空闲睡眠
+ */
+void Power_Idle(uint32_t idle_ms, uint8_t allow_stop)
+{
+    uint32_t ctrl, val, load, ticks, next, complete;
+    uint8_t expired;
+
+    if(idle_ms == 0)
+    {
+        return;
+    }
+    if(allow_stop && power_stop_ready && idle_ms >= POWER_STOP_MIN_MS)
+    {
+        Power_Stop(idle_ms);
+        return;
+    }
+
+    // 停止SysTick，关中断前已到的tick中断还挂起着就不睡了
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    val = SysTick->VAL;
+    if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+    {
+        SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+        return;
+    }
+
+    ticks = idle_ms;
+    load = tickless_sleep_load(&power_tickless, &ticks, val);
+    SysTick->LOAD = load;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();
+    __ISB();
+
+    // 读CTRL同时取出并清除COUNTFLAG
+    ctrl = SysTick->CTRL;
+    SysTick->CTRL = ctrl & ~SysTick_CTRL_ENABLE_Msk;
+    val = SysTick->VAL;
+    expired = (ctrl & SysTick_CTRL_COUNTFLAG_Msk) != 0;
+
+    complete = tickless_wake(&power_tickless, ticks, load, val, expired, &next);
+    system_tick += complete;
+
+    // 先计完当前tick剩余的部分，之后硬件按1ms的LOAD重装
+    SysTick->LOAD = next;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = power_tickless.tick_cycles - 1;
+
+    power_stats.sleeps++;
+    if(expired)
+    {
+        Power_Account((load + 1) + (load - val) + POWER_SYSTICK_COMP);
+    }
+    else
+    {
+        Power_Account(load - val + POWER_SYSTICK_COMP);
+        power_stats.early_wakes++;
+    }
+}
+
+/**
+ * @brief  获取睡眠统计
+ */
+const Power_Stats_t *Power_Get_Stats(void)
+{
+    return &power_stats;
+}
+
+/**
+ * @brief  RTC唤醒中断，只需清除标志，补偿在Power_Idle中完成
+ */
+void RTC_WKUP_IRQHandler(void)
+{
+    if(RTC_GetITStatus(RTC_IT_WUT) != RESET)
+    {
+        RTC_ClearITPendingBit(RTC_IT_WUT);
+    }
+    EXTI_ClearITPendingBit(EXTI_Line22);
+}
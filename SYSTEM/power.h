@@ -0,0 +1,59 @@
+#ifndef __POWER_H
+#define __POWER_H
+
+/**
+ * @file    power.h
+ * @brief   无节拍空闲与低功耗模式
+ * @details 主循环没有就绪任务时调用Power_Idle：把SysTick重装为到下一次释放的整段时间，
+ *          在WFI中睡眠，到期或被其它中断唤醒后按计数器补偿system_tick（换算见tickless.h）。
+ *          启用Stop模式且空闲时间足够长时改为进入Stop模式，由RTC唤醒定时器（LSE）唤醒，
+ *          醒来后恢复HSE+PLL时钟并按RTC亚秒计数补偿system_tick。
+ *          Stop模式下所有定时器、DMA、串口停止，只有EXTI（按键、MPU6050 INT）和RTC能唤醒，
+ *          是否允许进入由调用者根据外设状态决定
+ */
+
+#include "stm32f4xx.h"
+
+#define POWER_SYSTICK_COMP      48          /* 停止/重启SysTick丢失的计数 */
+#define POWER_STOP_MIN_MS       20          /* 空闲至少这么久才进入Stop模式 */
+#define POWER_LSE_TIMEOUT_MS    3000        /* 等待LSE起振的最长时间 */
+#define POWER_RTC_PREDIV_A      7           /* LSE 32768Hz / 8 = 4096Hz */
+#define POWER_RTC_PREDIV_S      4095        /* 亚秒分辨率约244us */
+#define POWER_WUT_HZ            2048        /* 唤醒定时器时钟 RTCCLK/16 */
+#define POWER_WUT_MAX           65536       /* 16位唤醒计数，约32秒 */
+
+/**
+ * @brief  睡眠统计
+ */
+typedef struct {
+    uint32_t sleeps;            /* WFI睡眠次数 */
+    uint32_t stops;             /* Stop模式次数 */
+    uint32_t early_wakes;       /* 计划时间未到被其它中断唤醒的次数 */
+    uint32_t sleep_ms;          /* 累计睡眠时间（含Stop），ms */
+    uint32_t stop_ms;           /* 其中Stop模式的时间，ms */
+} Power_Stats_t;
+
+/**
+ * @brief  初始化，须在SysTick按1ms配置之后调用
+ * @param  use_stop: 1-配置RTC唤醒以允许Stop模式（LSE不起振时自动放弃）
+ */
+void Power_Init(uint8_t use_stop);
+
+/**
+ * @brief  Stop模式是否可用
+ */
+uint8_t Power_Stop_Ready(void);
+
+/**
+ * @brief  空闲睡眠，须在关中断（PRIMASK=1）时调用，返回后由调用者开中断
+ * @param  idle_ms: 距下一次任务释放的毫秒数，为0时直接返回
+ * @param  allow_stop: 外设都已空闲，可以进入Stop模式
+ */
+void Power_Idle(uint32_t idle_ms, uint8_t allow_stop);
+
+/**
+ * @brief  获取睡眠统计
+ */
+const Power_Stats_t *Power_Get_Stats(void);
+
+#endif /* __POWER_H */
@@ -0,0 +1,163 @@
+#include "sched.h"
+#include "dwt_time.h"
+
+/**
+ * @file    sched.c
+ * @brief   协作式周期任务调度器源文件
+ */
+
+/* a时刻是否已到达b时刻，允许回绕 */
+static uint8_t sched_reached(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) >= 0;
+}
+
+/* 任务的相对截止时间 */
+static uint32_t sched_deadline(const Sched_Task_t *t)
+{
+    return t->deadline ? t->deadline : t->period;
+}
+
+/**
+ * @brief  初始化
+ */
+void Sched_Init(Sched_t *s, Sched_Task_t *tasks, uint8_t count, Sched_Clock_t now_ms)
+{
+    uint32_t now = now_ms();
+    uint8_t i;
+
+    s->tasks = tasks;
+    s->count = count;
+    s->now_ms = now_ms;
+    for(i = 0; i < count; i++)
+    {
+        tasks[i].release = now;
+    }
+    Sched_Reset_Stats(s);
+}
+
+/**
+ * @brief  now时刻应执行的任务序号
+ */
+uint8_t Sched_Ready(const Sched_t *s, uint32_t now)
+{
+    const Sched_Task_t *t, *best = 0;
+    uint8_t i, idx = SCHED_NONE;
+
+    for(i = 0; i < s->count; i++)
+    {
+        t = &s->tasks[i];
+        if(!sched_reached(now, t->release))
+        {
+            continue;
+        }
+        if(best == 0 || t->priority < best->priority ||
+           (t->priority == best->priority &&
+            (int32_t)((t->release + sched_deadline(t)) - (best->release + sched_deadline(best))) < 0))
+        {
+            best = t;
+            idx = i;
+        }
+    }
+    return idx;
+}
+
+/**
+ * @brief  执行一个就绪任务
+ */
+uint8_t Sched_Run(Sched_t *s)
+{
+    Sched_Task_t *t;
+    uint32_t start, end, cycles;
+    uint8_t idx;
+
+    start = s->now_ms();
+    idx = Sched_Ready(s, start);
+    if(idx == SCHED_NONE)
+    {
+        return 0;
+    }
+    t = &s->tasks[idx];
+
+    if(start - t->release > t->max_latency)
+    {
+        t->max_latency = start - t->release;
+    }
+
+    cycles = time_now_cycles();
+    t->func();
+    cycles = time_elapsed_cycles(cycles, time_now_cycles());
+    end = s->now_ms();
+
+    t->runs++;
+    t->last_cycles = cycles;
+    t->total_cycles += cycles;
+    if(cycles > t->max_cycles)
+    {
+        t->max_cycles = cycles;
+    }
+    if(end - t->release > sched_deadline(t))
+    {
+        t->overruns++;
+    }
+
+    /* 下一次释放；已经落后一个周期以上的释放丢弃，只补执行一次 */
+    t->release += t->period;
+    while((int32_t)(end - t->release) >= (int32_t)t->period)
+    {
+        t->release += t->period;
+        t->skipped++;
+    }
+    return 1;
+}
+
+/**
+ * @brief  距最早一次释放还有多少毫秒
+ */
+uint32_t Sched_Next_Release(const Sched_t *s, uint32_t now)
+{
+    uint32_t wait = 0xFFFFFFFFu;
+    uint8_t i;
+
+    for(i = 0; i < s->count; i++)
+    {
+        if(sched_reached(now, s->tasks[i].release))
+        {
+            return 0;
+        }
+        if(s->tasks[i].release - now < wait)
+        {
+            wait = s->tasks[i].release - now;
+        }
+    }
+    return wait;
+}
+
+/**
+ * @brief  平均执行周期数
+ */
+uint32_t Sched_Avg_Cycles(const Sched_Task_t *t)
+{
+    return t->runs ? (uint32_t)(t->total_cycles / t->runs) : 0;
+}
+
+/**
+ * @brief  清零所有任务的统计
+ */
+void Sched_Reset_Stats(Sched_t *s)
+{
+    Sched_Task_t *t;
+    uint8_t i;
+
+    for(i = 0; i < s->count; i++)
+    {
+        t = &s->tasks[i];
+        t->runs = 0;
+        t->overruns = 0;
+        t->skipped = 0;
+        t->max_latency = 0;
+        t->last_cycles = 0;
+        t->max_cycles = 0;
+        t->total_cycles = 0;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef __SCHED_H
+#define __SCHED_H
+
+/**
+ * @file    sched.h
+ * @brief   协作式周期任务调度器
+ * @details 任务表驱动，每个任务一次执行完毕后返回（run-to-completion），不抢占。
+ *          任务每period毫秒释放一次，释放后在deadline毫秒内完成才算按时。
+ *          有多个任务就绪时先执行priority小的，相同时先执行截止时间早的。
+ *          执行太慢错过了整个周期的释放直接丢弃（计入skipped），
+ *          只保留一次补执行，释放时刻按周期对齐，不会累积漂移。
+ *          执行时间用DWT周期计数统计（PC上编译时定义TIME_HOST），
+ *          毫秒时钟由调用者提供，PC上可以用虚拟时间模拟。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define SCHED_NONE          0xFF        /* 没有就绪任务 */
+
+typedef void (*Sched_Func_t)(void);
+typedef uint32_t (*Sched_Clock_t)(void);
+
+/**
+ * @brief  任务，前5项静态配置，其余由调度器维护
+ */
+typedef struct {
+    const char *name;
+    Sched_Func_t func;
+    uint32_t period;            /* 周期，ms，不能为0 */
+    uint32_t deadline;          /* 相对释放时刻的截止时间，ms，0表示等于周期 */
+    uint8_t priority;           /* 数值越小越优先 */
+
+    uint32_t release;           /* 下一次释放时刻，ms */
+    uint32_t runs;              /* 执行次数 */
+    uint32_t overruns;          /* 超过截止时间才完成的次数 */
+    uint32_t skipped;           /* 被丢弃的释放次数 */
+    uint32_t max_latency;       /* 释放到开始执行的最大延迟，ms */
+    uint32_t last_cycles;       /* 最近一次执行的周期数 */
+    uint32_t max_cycles;        /* 最长执行周期数 */
+    uint64_t total_cycles;      /* 累计执行周期数 */
+} Sched_Task_t;
+
+/**
+ * @brief  调度器
+ */
+typedef struct {
+    Sched_Task_t *tasks;
+    uint8_t count;
+    Sched_Clock_t now_ms;       /* 毫秒时钟 */
+} Sched_t;
+
+/**
+ * @brief  初始化，所有任务在当前时刻首次释放，统计清零
+ * @param  tasks: 任务表
+ * @param  count: 任务数，不超过SCHED_NONE
+ * @param  now_ms: 毫秒时钟
+ */
+void Sched_Init(Sched_t *s, Sched_Task_t *tasks, uint8_t count, Sched_Clock_t now_ms);
+
+/**
+ * @brief  now时刻应执行的任务序号，没有就绪任务返回SCHED_NONE
+ */
+uint8_t Sched_Ready(const Sched_t *s, uint32_t now);
+
+/**
+ * @brief  执行一个就绪任务
+ * @retval 1-执行了任务, 0-没有就绪任务
+ */
+uint8_t Sched_Run(Sched_t *s);
+
+/**
+ * @brief  距最早一次释放还有多少毫秒，已有任务就绪时为0
+ */
+uint32_t Sched_Next_Release(const Sched_t *s, uint32_t now);
+
+/**
+ * @brief  平均执行周期数
+ */
+uint32_t Sched_Avg_Cycles(const Sched_Task_t *t);
+
+/**
+ * @brief  清零所有任务的统计，不影响释放时刻
+ */
+void Sched_Reset_Stats(Sched_t *s);
+
+#endif /* __SCHED_H */
@@ -0,0 +1,129 @@
+#include "spsc_queue.h"
+
+/**
+ * @brief  初始化队列
+ * @param  q: 队列指针
+ * @param  buf: 缓冲区
+ * @param  capacity: 缓冲区大小，必须是2的幂
+ * @retval 0-成功, 1-容量不是2的幂
+ */
+uint8_t SPSC_Init(SPSC_Queue_t *q, uint8_t *buf, uint32_t capacity)
+{
+    if(capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return 1;
+    }
+
+    q->buf = buf;
+    q->mask = capacity - 1;
+    q->head = 0;
+    q->tail = 0;
+    q->dropped = 0;
+    return 0;
+}
+
+/**
+ * @brief  队列中可读的字节数
+ */
+uint32_t SPSC_Count(const SPSC_Queue_t *q)
+{
+    /* 索引自由递增，无符号减法自动处理回绕 */
+    return q->head - q->tail;
+}
+
+/**
+ * @brief  队列中剩余的空间
+ */
+uint32_t SPSC_Free(const SPSC_Queue_t *q)
+{
+    return (q->mask + 1) - (q->head - q->tail);
+}
+
+/**
+ * @brief  写入数据（生产者调用）
+ * @param  q: 队列指针
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval 实际写入的字节数，空间不足的部分计入dropped
+ */
+uint32_t SPSC_Write(SPSC_Queue_t *q, const uint8_t *data, uint32_t len)
+{
+    uint32_t head = q->head;
+    uint32_t tail = q->tail;
+    uint32_t space;
+    uint32_t i;
+
+    /* 先读tail再写数据：确保消费者已读完这些位置 */
+    SPSC_BARRIER();
+
+    space = (q->mask + 1) - (head - tail);
+    if(len > space)
+    {
+        q->dropped += len - space;
+        len = space;
+    }
+
+    for(i = 0; i < len; i++)
+    {
+        q->buf[(head + i) & q->mask] = data[i];
+    }
+
+    /* 数据写完后才发布head */
+    SPSC_BARRIER();
+    q->head = head + len;
+
+    return len;
+}
+
+/**
+ * @brief  读出数据（消费者调用）
+ * @param  q: 队列指针
+ * @param  data: 输出缓冲区
+ * @param  len: 最多读出的字节数
+ * @retval 实际读出的字节数
+ */
+uint32_t SPSC_Read(SPSC_Queue_t *q, uint8_t *data, uint32_t len)
+{
+    uint32_t tail = q->tail;
+    uint32_t head = q->head;
+    uint32_t count;
+    uint32_t i;
+
+    /* 先读head再读数据：确保看到的是生产者已发布的数据 */
+    SPSC_BARRIER();
+
+    count = head - tail;
+    if(len > count)
+    {
+        len = count;
+    }
+
+    for(i = 0; i < len; i++)
+    {
+        data[i] = q->buf[(tail + i) & q->mask];
+    }
+
+    /* 数据读完后才释放空间 */
+    SPSC_BARRIER();
+    q->tail = tail + len;
+
+    return len;
+}
+
+/**
+ * @brief  写入一个字节（生产者调用）
+ * @retval 1-成功, 0-队列满
+ */
+uint8_t SPSC_Put(SPSC_Queue_t *q, uint8_t ch)
+{
+    return (uint8_t)SPSC_Write(q, &ch, 1);
+}
+
+/**
+ * @brief  读出一个字节（消费者调用）
+ * @retval 1-成功, 0-队列空
+ */
+uint8_t SPSC_Get(SPSC_Queue_t *q, uint8_t *ch)
+{
+    return (uint8_t)SPSC_Read(q, ch, 1);
+}
@@ -0,0 +1,86 @@
+#ifndef __SPSC_QUEUE_H
+#define __SPSC_QUEUE_H
+
+/**
+ * @file    spsc_queue.h
+ * @brief   单生产者/单消费者无锁字节队列
+ * @details 用于中断(生产者)与主循环(消费者)之间传递数据，不需要关中断。
+ *          容量必须是2的幂，读写索引自由递增，用掩码取模。
+ *          生产者只写head，消费者只写tail；发布索引前用内存屏障
+ *          保证数据先于索引可见
+ */
+
+#include <stdint.h>
+
+/* 内存屏障，PC上编译时可在包含本文件前自行定义 */
+#ifndef SPSC_BARRIER
+#include "stm32f4xx.h"
+#define SPSC_BARRIER()      __DMB()
+#endif
+
+/**
+ * @brief  无锁队列结构体
+ */
+typedef struct {
+    uint8_t *buf;                   /* 缓冲区 */
+    uint32_t mask;                  /* 容量-1 */
+    volatile uint32_t head;         /* 写索引，仅生产者修改 */
+    volatile uint32_t tail;         /* 读索引，仅消费者修改 */
+    uint32_t dropped;               /* 队列满丢弃的字节数，仅生产者修改 */
+} SPSC_Queue_t;
+
+/**
+ * @brief  静态初始化，效果与SPSC_Init相同，capacity必须是2的幂（调用者自行检查）
+ */
+#define SPSC_INITIALIZER(buf, capacity)     { (buf), (capacity) - 1, 0, 0, 0 }
+
+/**
+ * @brief  初始化队列
+ * @param  q: 队列指针
+ * @param  buf: 缓冲区
+ * @param  capacity: 缓冲区大小，必须是2的幂
+ * @retval 0-成功, 1-容量不是2的幂
+ */
+uint8_t SPSC_Init(SPSC_Queue_t *q, uint8_t *buf, uint32_t capacity);
+
+/**
+ * @brief  队列中可读的字节数
+ */
+uint32_t SPSC_Count(const SPSC_Queue_t *q);
+
+/**
+ * @brief  队列中剩余的空间
+ */
+uint32_t SPSC_Free(const SPSC_Queue_t *q);
+
+/**
+ * @brief  写入数据（生产者调用）
+ * @param  q: 队列指针
+ * @param  data: 数据
+ * @param  len: 数据长度
+ * @retval 实际写入的字节数，空间不足的部分计入dropped
+ */
+uint32_t SPSC_Write(SPSC_Queue_t *q, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief  读出数据（消费者调用）
+ * @param  q: 队列指针
+ * @param  data: 输出缓冲区
+ * @param  len: 最多读出的字节数
+ * @retval 实际读出的字节数
+ */
+uint32_t SPSC_Read(SPSC_Queue_t *q, uint8_t *data, uint32_t len);
+
+/**
+ * @brief  写入一个字节（生产者调用）
+ * @retval 1-成功, 0-队列满
+ */
+uint8_t SPSC_Put(SPSC_Queue_t *q, uint8_t ch);
+
+/**
+ * @brief  读出一个字节（消费者调用）
+ * @retval 1-成功, 0-队列空
+ */
+uint8_t SPSC_Get(SPSC_Queue_t *q, uint8_t *ch);
+
+#endif /* __SPSC_QUEUE_H */
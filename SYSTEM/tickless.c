@@ -0,0 +1,127 @@
+#include "tickless.h"
+
+/**
+ * @file    tickless.c
+ * @brief   无节拍空闲的计数换算源文件
+ */
+
+#define TICKLESS_DAY_SECONDS    86400u
+
+/**
+ * @brief  初始化
+ */
+void tickless_init(Tickless_t *t, uint32_t tick_cycles, uint32_t stop_comp)
+{
+    t->tick_cycles = tick_cycles;
+    t->max_ticks = TICKLESS_SYSTICK_MAX / tick_cycles;
+    t->stop_comp = stop_comp;
+}
+
+/**
+ * @brief  入睡时的重装值
+ * @note   当前tick还剩val个计数，之后再计ticks-1个整tick；
+ *         VAL写0后启动，第一个时钟装入LOAD，到0共计LOAD+1个
+ */
+uint32_t tickless_sleep_load(const Tickless_t *t, uint32_t *ticks, uint32_t val)
+{
+    /* VAL为0且没有挂起的中断：刚重装过，到下一次到0还要整个tick */
+    if(val == 0)
+    {
+        val = t->tick_cycles;
+    }
+    if(*ticks > t->max_ticks)
+    {
+        *ticks = t->max_ticks;
+    }
+    if(*ticks == 0)
+    {
+        *ticks = 1;
+    }
+
+    /* 当前tick马上结束，来不及在这个边界醒来并读出VAL，改为睡到下一个 */
+    if(*ticks == 1 && val < t->stop_comp + 1 + TICKLESS_LOAD_MIN)
+    {
+        *ticks = 2;
+    }
+    return val + t->tick_cycles * (*ticks - 1) - t->stop_comp - 1;
+}
+
+/**
+ * @brief  醒来后的补偿
+ */
+uint32_t tickless_wake(const Tickless_t *t, uint32_t ticks, uint32_t load, uint32_t val,
+                       uint8_t expired, uint32_t *next_load)
+{
+    uint32_t done, complete;
+
+    if(expired)
+    {
+        /* 计到0后已计done个：VAL为0说明刚到0，否则重装用了1个时钟，又计了load - val个；
+           重启后到0共计next_load+1个 */
+        done = val ? load - val + 1 : 0;
+        *next_load = (t->tick_cycles - 1) - done;
+        if(*next_load < t->stop_comp || *next_load > t->tick_cycles)
+        {
+            *next_load = t->tick_cycles - 1;
+        }
+        return ticks - 1;
+    }
+
+    /* 被其它中断提前唤醒：从入睡前最后一个tick边界算起已计done个，
+       VAL为0说明还没有装入LOAD，相当于剩load+1个 */
+    if(val == 0)
+    {
+        val = load + 1;
+    }
+    done = ticks * t->tick_cycles - val;
+    complete = done / t->tick_cycles;
+    *next_load = (complete + 1) * t->tick_cycles - done - 1;
+    if(*next_load == 0)
+    {
+        /* 下一个时钟就到tick边界，LOAD不能为0：这个tick算作已完成，多计一个整tick */
+        complete++;
+        *next_load = t->tick_cycles;
+    }
+    return complete;
+}
+
+/**
+ * @brief  毫秒换算为RTC唤醒定时器计数
+ */
+uint32_t tickless_rtc_counts(uint32_t ms, uint32_t wut_hz, uint32_t max_counts)
+{
+    uint64_t counts = (uint64_t)ms * wut_hz / 1000u;
+
+    if(counts < 1)
+    {
+        counts = 1;
+    }
+    if(counts > max_counts)
+    {
+        counts = max_counts;
+    }
+    return (uint32_t)counts;
+}
+
+/**
+ * @brief  RTC时间戳
+ */
+uint32_t tickless_rtc_stamp(uint32_t seconds, uint32_t ss, uint32_t prediv_s)
+{
+    return seconds * (prediv_s + 1) + (prediv_s - ss);
+}
+
+/**
+ * @brief  两个RTC时间戳之间经过的毫秒
+ */
+uint32_t tickless_rtc_elapsed_ms(uint32_t start, uint32_t end, uint32_t prediv_s, uint32_t *frac)
+{
+    uint32_t per_s = prediv_s + 1;
+    uint32_t day = TICKLESS_DAY_SECONDS * per_s;
+    uint32_t diff = (end >= start) ? end - start : end + (day - start);
+    uint64_t total;
+
+    total = (uint64_t)diff * 1000u + *frac;
+    *frac = (uint32_t)(total % per_s);
+    return (uint32_t)(total / per_s);
+}
@@ -0,0 +1,78 @@
+#ifndef __TICKLESS_H
+#define __TICKLESS_H
+
+/**
+ * @file    tickless.h
+ * @brief   无节拍空闲的计数换算
+ * @details 空闲时把SysTick的重装值改为到下一次释放的整段时间，只在到期时中断一次，
+ *          醒来后按计数器剩余值算出实际经过的整tick数补到system_tick，
+ *          并让不足一个tick的部分继续计完，之后恢复每tick一次中断，tick边界不漂移。
+ *          SysTick是24位递减计数器，168MHz时一次最多计约99ms。
+ *          Stop模式下SysTick停止，改用RTC唤醒定时器计时，用RTC亚秒计数换算经过的毫秒，
+ *          不足1ms的余数留到下次，长时间累计不漂移。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define TICKLESS_SYSTICK_MAX    0x00FFFFFFu     /* SysTick 24位重装值上限 */
+#define TICKLESS_LOAD_MIN       100u            /* 入睡的最小重装值，到期唤醒后读出VAL前计数器不会再次到0 */
+
+/**
+ * @brief  SysTick参数
+ */
+typedef struct {
+    uint32_t tick_cycles;       /* 每tick的计数，即正常运行时的LOAD+1 */
+    uint32_t max_ticks;         /* 一次最多睡眠的tick数 */
+    uint32_t stop_comp;         /* 停止到重新启动计数器之间丢失的计数 */
+} Tickless_t;
+
+/**
+ * @brief  初始化
+ * @param  tick_cycles: 每tick的计数
+ * @param  stop_comp: 停止/重启计数器的补偿计数
+ */
+void tickless_init(Tickless_t *t, uint32_t tick_cycles, uint32_t stop_comp);
+
+/**
+ * @brief  入睡时的重装值
+ * @param  ticks: 计划睡眠的tick数（至少1），超过max_ticks时改为max_ticks；
+ *         当前tick剩余不足stop_comp+1+TICKLESS_LOAD_MIN个计数时改为2
+ * @param  val: 停止计数器时的VAL，即当前tick剩余的计数，0表示刚重装、剩整个tick
+ * @retval 写入LOAD的值
+ */
+uint32_t tickless_sleep_load(const Tickless_t *t, uint32_t *ticks, uint32_t val);
+
+/**
+ * @brief  醒来后的补偿
+ * @param  ticks: tickless_sleep_load调整后的tick数
+ * @param  load: 入睡时写入的LOAD
+ * @param  val: 醒来停止计数器时的VAL
+ * @param  expired: 计数器是否已到0（COUNTFLAG），此时SysTick中断已挂起，会再加1个tick
+ * @param  next_load: 输出当前tick剩余的计数，重启计数器时写入LOAD
+ * @retval 应补到system_tick的整tick数（不含挂起中断的那1个）
+ */
+uint32_t tickless_wake(const Tickless_t *t, uint32_t ticks, uint32_t load, uint32_t val,
+                       uint8_t expired, uint32_t *next_load);
+
+/**
+ * @brief  毫秒换算为RTC唤醒定时器计数，限制在1~max_counts
+ * @param  wut_hz: 唤醒定时器时钟频率
+ */
+uint32_t tickless_rtc_counts(uint32_t ms, uint32_t wut_hz, uint32_t max_counts);
+
+/**
+ * @brief  RTC时间戳：一天中的亚秒计数
+ * @param  seconds: 当天的秒数
+ * @param  ss: 亚秒寄存器SSR，从prediv_s向下计数
+ * @param  prediv_s: 同步预分频值，每秒prediv_s+1个亚秒
+ */
+uint32_t tickless_rtc_stamp(uint32_t seconds, uint32_t ss, uint32_t prediv_s);
+
+/**
+ * @brief  两个RTC时间戳之间经过的毫秒，允许跨午夜
+ * @param  frac: 不足1ms的余数，调用之间保留
+ */
+uint32_t tickless_rtc_elapsed_ms(uint32_t start, uint32_t end, uint32_t prediv_s, uint32_t *frac);
+
+#endif /* __TICKLESS_H */
@@ -0,0 +1,384 @@
+#include "timer_wheel.h"
+
+/**
+ * @file    timer_wheel.c
+ * @brief   分级时间轮软件定时器源文件
+ */
+
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+
+/* 第level级一个槽代表的毫秒数的位数 */
+#define TIMER_LEVEL_SHIFT(level)    (TIMER_WHEEL_BITS * (level))
+
+/* 加锁、解锁，没有设置时不做任何事 */
+static void timer_wheel_lock(const Timer_Wheel_t *w)
+{
+    if(w->lock)
+    {
+        w->lock();
+    }
+}
+
+static void timer_wheel_unlock(const Timer_Wheel_t *w)
+{
+    if(w->unlock)
+    {
+        w->unlock();
+    }
+}
+
+/* 从所在链表中摘下 */
+static void timer_unlink(Timer_t *t)
+{
+    *t->pprev = t->next;
+    if(t->next)
+    {
+        t->next->pprev = t->pprev;
+    }
+    t->next = 0;
+    t->pprev = 0;
+}
+
+/* 插到链表头 */
+static void timer_link(Timer_t **head, Timer_t *t)
+{
+    t->next = *head;
+    if(t->next)
+    {
+        t->next->pprev = &t->next;
+    }
+    *head = t;
+    t->pprev = head;
+}
+
+/* 停止，未启动时不做任何事 */
+static void timer_wheel_remove(Timer_Wheel_t *w, Timer_t *t)
+{
+    if(t->pprev == 0)
+    {
+        return;
+    }
+    if(t->level < TIMER_WHEEL_LEVELS)
+    {
+        w->count[t->level]--;
+    }
+    timer_unlink(t);
+    t->level = TIMER_WHEEL_LEVELS;
+}
+
+/* 按到期时刻放到对应的级和槽 */
+static void timer_wheel_add(Timer_Wheel_t *w, Timer_t *t)
+{
+    uint32_t delta = t->expires - w->base;
+    uint32_t expires = t->expires;
+    uint8_t level = 0;
+
+    if((int32_t)delta < 0)
+    {
+        /* 已经过期（base之前的时刻都已处理），放在下一个要处理的槽 */
+        expires = w->base;
+    }
+    else if(delta >= TIMER_WHEEL_RANGE)
+    {
+        /* 超出范围先放在顶层最远的槽，下放时再按剩余时间放置 */
+        level = TIMER_WHEEL_LEVELS - 1;
+        expires = w->base + TIMER_WHEEL_RANGE - 1;
+    }
+    else
+    {
+        while(delta >= (1u << TIMER_LEVEL_SHIFT(level + 1)))
+        {
+            level++;
+        }
+    }
+
+    timer_link(&w->slots[level][(expires >> TIMER_LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK], t);
+    t->level = level;
+    w->count[level]++;
+}
+
+/* 把整条链表摘到head，不再计入任何一级 */
+static void timer_wheel_take(Timer_Wheel_t *w, uint8_t level, uint32_t idx, Timer_t **head)
+{
+    Timer_t *t;
+
+    *head = w->slots[level][idx];
+    w->slots[level][idx] = 0;
+    if(*head)
+    {
+        (*head)->pprev = head;
+    }
+    for(t = *head; t; t = t->next)
+    {
+        t->level = TIMER_WHEEL_LEVELS;
+        w->count[level]--;
+    }
+}
+
+/* base是64的倍数时把高级的当前槽下放到低级 */
+static void timer_wheel_cascade(Timer_Wheel_t *w)
+{
+    Timer_t *list, *t;
+    uint32_t idx;
+    uint8_t level;
+
+    for(level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        idx = (w->base >> TIMER_LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK;
+        timer_wheel_take(w, level, idx, &list);
+        while((t = list) != 0)
+        {
+            timer_unlink(t);
+            timer_wheel_add(w, t);
+        }
+        if(idx != 0)
+        {
+            break;
+        }
+    }
+}
+
+/* 跳过没有定时器的时刻，直到有定时器的槽或下一次下放，返回1-跳过了 */
+static uint8_t timer_wheel_skip(Timer_Wheel_t *w, uint32_t now)
+{
+    uint32_t mask, next;
+    uint8_t level = 0;
+
+    while(level < TIMER_WHEEL_LEVELS && w->count[level] == 0)
+    {
+        level++;
+    }
+    if(level == 0)
+    {
+        /* 第0级有定时器，跳过其中的空槽 */
+        next = w->base;
+        while((next & TIMER_WHEEL_MASK) != 0 && next != now + 1 &&
+              w->slots[0][next & TIMER_WHEEL_MASK] == 0)
+        {
+            next++;
+        }
+        if(next == w->base)
+        {
+            return 0;
+        }
+        w->base = next;
+        return 1;
+    }
+    /* 低几级都没有定时器，直接跳到下一次下放 */
+    if(level == TIMER_WHEEL_LEVELS)
+    {
+        w->base = now + 1;
+        return 1;
+    }
+
+    mask = (1u << TIMER_LEVEL_SHIFT(level)) - 1;
+    if((w->base & mask) == 0)
+    {
+        return 0;
+    }
+    next = (w->base | mask) + 1;
+    if((int32_t)(next - (now + 1)) > 0)
+    {
+        next = now + 1;
+    }
+    w->base = next;
+    return 1;
+}
+
+/**
+ * @brief  初始化时间轮
+ */
+void Timer_Wheel_Init(Timer_Wheel_t *w, Timer_Clock_t now_ms)
+{
+    uint8_t level;
+    uint32_t i;
+
+    for(level = 0; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        for(i = 0; i < TIMER_WHEEL_SLOTS; i++)
+        {
+            w->slots[level][i] = 0;
+        }
+        w->count[level] = 0;
+    }
+    w->now_ms = now_ms;
+    w->base = now_ms();
+    w->fired = 0;
+    w->lock = 0;
+    w->unlock = 0;
+}
+
+/**
+ * @brief  设置互斥函数
+ */
+void Timer_Wheel_Set_Lock(Timer_Wheel_t *w, Timer_Lock_t lock, Timer_Lock_t unlock)
+{
+    w->lock = lock;
+    w->unlock = unlock;
+}
+
+/**
+ * @brief  初始化定时器
+ */
+void Timer_Init(Timer_t *t, Timer_Func_t func, void *arg)
+{
+    t->next = 0;
+    t->pprev = 0;
+    t->expires = 0;
+    t->period = 0;
+    t->func = func;
+    t->arg = arg;
+    t->level = TIMER_WHEEL_LEVELS;
+}
+
+/**
+ * @brief  启动定时器
+ */
+void Timer_Start(Timer_Wheel_t *w, Timer_t *t, uint32_t delay, uint32_t period)
+{
+    if(delay > TIMER_DELAY_MAX)
+    {
+        delay = TIMER_DELAY_MAX;
+    }
+    if(period > TIMER_DELAY_MAX)
+    {
+        period = TIMER_DELAY_MAX;
+    }
+
+    timer_wheel_lock(w);
+    timer_wheel_remove(w, t);
+    t->expires = w->now_ms() + delay;
+    t->period = period;
+    timer_wheel_add(w, t);
+    timer_wheel_unlock(w);
+}
+
+/**
+ * @brief  停止定时器
+ */
+void Timer_Stop(Timer_Wheel_t *w, Timer_t *t)
+{
+    timer_wheel_lock(w);
+    timer_wheel_remove(w, t);
+    timer_wheel_unlock(w);
+}
+
+/**
+ * @brief  定时器是否已启动且未到期
+ */
+uint8_t Timer_Pending(const Timer_t *t)
+{
+    return t->pprev != 0;
+}
+
+/**
+ * @brief  处理到当前时刻为止的所有到期定时器
+ */
+uint32_t Timer_Wheel_Run(Timer_Wheel_t *w)
+{
+    uint32_t now = w->now_ms();
+    uint32_t fired = 0;
+    Timer_t *list, *t;
+    Timer_Func_t func;
+    void *arg;
+
+    timer_wheel_lock(w);
+    while((int32_t)(now - w->base) >= 0)
+    {
+        if(timer_wheel_skip(w, now))
+        {
+            continue;
+        }
+        if((w->base & TIMER_WHEEL_MASK) == 0)
+        {
+            timer_wheel_cascade(w);
+        }
+
+        /* 先摘下本槽再前进，回调中新启动的定时器不会落进正在处理的链表 */
+        timer_wheel_take(w, 0, w->base & TIMER_WHEEL_MASK, &list);
+        w->base++;
+
+        while((t = list) != 0)
+        {
+            timer_unlink(t);
+            if(t->period)
+            {
+                /* 先重新启动，回调中可以停止自己 */
+                t->expires += t->period;
+                if((int32_t)(now - t->expires) >= (int32_t)t->period)
+                {
+                    t->expires += (now - t->expires) / t->period * t->period;
+                }
+                timer_wheel_add(w, t);
+            }
+            fired++;
+            func = t->func;
+            arg = t->arg;
+            if(func)
+            {
+                /* 回调不持有锁；list中剩下的定时器被其它任务停止时从list摘下，不再执行 */
+                timer_wheel_unlock(w);
+                func(arg);
+                timer_wheel_lock(w);
+            }
+        }
+    }
+
+    w->fired += fired;
+    timer_wheel_unlock(w);
+    return fired;
+}
+
+/**
+ * @brief  距下一次需要调用Run还有多少毫秒
+ */
+uint32_t Timer_Wheel_Next(const Timer_Wheel_t *w)
+{
+    uint32_t now = w->now_ms();
+    uint32_t ahead = TIMER_NEVER;
+    uint32_t span, first, at, i;
+    uint8_t level;
+
+    if(w->count[0])
+    {
+        for(i = 0; i < TIMER_WHEEL_SLOTS; i++)
+        {
+            if(w->slots[0][(w->base + i) & TIMER_WHEEL_MASK])
+            {
+                ahead = i;
+                break;
+            }
+        }
+    }
+
+    /* 高级的定时器在所在槽下放时才需要处理 */
+    for(level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+        if(w->count[level] == 0)
+        {
+            continue;
+        }
+        span = 1u << TIMER_LEVEL_SHIFT(level);
+        first = ((w->base + span - 1) & ~(span - 1)) - w->base;
+        for(i = 0; i < TIMER_WHEEL_SLOTS; i++)
+        {
+            at = first + i * span;
+            if(at >= ahead)
+            {
+                break;
+            }
+            if(w->slots[level][((w->base + at) >> TIMER_LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK])
+            {
+                ahead = at;
+                break;
+            }
+        }
+    }
+
+    if(ahead == TIMER_NEVER)
+    {
+        return TIMER_NEVER;
+    }
+    at = w->base + ahead;
+    return ((int32_t)(at - now) > 0) ? at - now : 0;
+}
@@ -0,0 +1,103 @@
+#ifndef __TIMER_WHEEL_H
+#define __TIMER_WHEEL_H
+
+/**
+ * @file    timer_wheel.h
+ * @brief   分级时间轮软件定时器
+ * @details 4级时间轮，每级64个槽，时间单位为1ms（SysTick），一次最长可定时约4.6小时，
+ *          更长的定时到顶层后重新放置，直到剩余时间足够短。
+ *          定时器是链表节点，由调用者分配，启动、停止都是O(1)；
+ *          每经过64^n ms把第n级的一个槽下放到低一级，到期的定时器从第0级取出。
+ *          SysTick只推进毫秒时钟，到期回调在Timer_Wheel_Run中执行（主循环，线程上下文），
+ *          回调中可以启动、停止任意定时器，包括自己。
+ *          没有定时器的级整段跳过，长时间睡眠后追赶时间不必逐毫秒处理。
+ *          启动、停止和Run都只能在主循环中调用，不能在中断中调用；
+ *          多个任务共用一个时间轮时用Timer_Wheel_Set_Lock设置互斥，回调执行时不持有锁。
+ *          本模块不访问外设，可以在PC上测试
+ */
+
+#include <stdint.h>
+
+#define TIMER_WHEEL_BITS        6
+#define TIMER_WHEEL_SLOTS       (1u << TIMER_WHEEL_BITS)    /* 每级槽数 */
+#define TIMER_WHEEL_LEVELS      4
+#define TIMER_WHEEL_RANGE       (1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) /* 一次可放置的最长时间，ms */
+#define TIMER_DELAY_MAX         0x7FFFFFFFu                 /* 定时时间上限，ms */
+#define TIMER_NEVER             0xFFFFFFFFu                 /* 没有定时器时Timer_Wheel_Next的返回值 */
+
+typedef void (*Timer_Func_t)(void *arg);
+typedef uint32_t (*Timer_Clock_t)(void);
+typedef void (*Timer_Lock_t)(void);
+
+/**
+ * @brief  定时器，由Timer_Init初始化，其余字段由时间轮维护
+ */
+typedef struct Timer_s {
+    struct Timer_s *next;
+    struct Timer_s **pprev;     /* 指向前一个节点的next，NULL表示未启动 */
+    uint32_t expires;           /* 到期时刻，ms */
+    uint32_t period;            /* 周期，ms，0为单次 */
+    Timer_Func_t func;          /* 到期回调，可以为NULL */
+    void *arg;
+    uint8_t level;              /* 所在的级 */
+} Timer_t;
+
+/**
+ * @brief  时间轮
+ */
+typedef struct {
+    Timer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint32_t count[TIMER_WHEEL_LEVELS];     /* 每级的定时器数 */
+    uint32_t base;              /* 下一个要处理的时刻，之前的时刻都已处理 */
+    Timer_Clock_t now_ms;       /* 毫秒时钟 */
+    uint32_t fired;             /* 累计到期次数 */
+    Timer_Lock_t lock;          /* 互斥，NULL表示不需要 */
+    Timer_Lock_t unlock;
+} Timer_Wheel_t;
+
+/**
+ * @brief  初始化时间轮，从当前时刻开始计时
+ * @param  now_ms: 毫秒时钟
+ */
+void Timer_Wheel_Init(Timer_Wheel_t *w, Timer_Clock_t now_ms);
+
+/**
+ * @brief  设置互斥函数，在Init之后调用，lock、unlock都为NULL表示不加锁
+ */
+void Timer_Wheel_Set_Lock(Timer_Wheel_t *w, Timer_Lock_t lock, Timer_Lock_t unlock);
+
+/**
+ * @brief  初始化定时器，只需调用一次
+ */
+void Timer_Init(Timer_t *t, Timer_Func_t func, void *arg);
+
+/**
+ * @brief  启动定时器，已启动的先停止再按新参数启动
+ * @param  delay: 距现在的毫秒数，不超过TIMER_DELAY_MAX，0表示在下一个tick到期
+ * @param  period: 周期，0为单次；周期定时器按到期时刻对齐，落后一个周期以上的到期丢弃
+ */
+void Timer_Start(Timer_Wheel_t *w, Timer_t *t, uint32_t delay, uint32_t period);
+
+/**
+ * @brief  停止定时器，未启动时不做任何事
+ */
+void Timer_Stop(Timer_Wheel_t *w, Timer_t *t);
+
+/**
+ * @brief  定时器是否已启动且未到期
+ */
+uint8_t Timer_Pending(const Timer_t *t);
+
+/**
+ * @brief  处理到当前时刻为止的所有到期定时器，执行回调
+ * @retval 本次执行的回调数
+ */
+uint32_t Timer_Wheel_Run(Timer_Wheel_t *w);
+
+/**
+ * @brief  距下一次需要调用Run还有多少毫秒，已有到期时为0，没有定时器时为TIMER_NEVER
+ * @note   高级的定时器按下放时刻计算，结果可能早于实际到期，不会晚于
+ */
+uint32_t Timer_Wheel_Next(const Timer_Wheel_t *w);
+
+#endif /* __TIMER_WHEEL_H */
@@ -7,10 +7,24 @@
 #define ENABLE_BLUETOOTH   1    // 1-启用蓝牙, 0-禁用蓝牙 (远程控制) - 保留用于调试
 #define ENABLE_BREATHING   0    // 1-启用呼吸灯, 0-禁用呼吸灯 (状态指示) - 临时禁用调试LCD/蓝牙问题
 #define ENABLE_ALARM       0    // 1-启用报警, 0-禁用报警 (蜂鸣器和LED) - 临时禁用调试LCD/蓝牙问题
+#define ENABLE_STOP_MODE   0    // 1-长时间空闲时进入Stop模式 (需要LSE晶振，蓝牙/MQ-2串口收不到数据时不能唤醒)
+#define ENABLE_FMT_BENCH   0    // 1-启动时比较sprintf与Fmt的耗时并通过蓝牙输出 (会链接C库的sprintf)
+#include "os_config.h"    // ENABLE_RTOS在SYSTEM/os_config.h中，与delay.c、os.c、stm32f4xx_it.c共用
+
+// Stop模式下定时器和DMA停止，连续采样的传感器无法工作
+#if ENABLE_STOP_MODE && (ENABLE_DHT11 || ENABLE_MPU6050 || ENABLE_LIGHT)
+#error "ENABLE_STOP_MODE requires DHT11, MPU6050 and light sampling to be disabled"
+#endif
+
+// 内核任务自己决定睡眠，不经过协作式调度器的无节拍空闲
+#if ENABLE_RTOS && ENABLE_STOP_MODE
+#error "ENABLE_STOP_MODE is not supported with ENABLE_RTOS"
+#endif
 
 /* =================== 头文件包含 =================== */
 #include "stm32f4xx.h"
 #include "delay.h"
+#include "dwt_time.h"
 #include "led.h"
 #include "key.h"
 #include "lcd.h"
@@ -24,9 +38,21 @@
 #include "beep.h"
 #include "ADC3.h"
 #include "uart.h"        // 添加UART头文件以支持UART_BAUD_9600
-#include <stdio.h>
+#include "bt_cmd.h"      // 蓝牙命令表驱动分发器
+#include "bt_frame.h"    // 蓝牙二进制遥测帧
+#include "bt_stream.h"   // 蓝牙遥测订阅推送
+#include "fmt.h"         // 整数格式化，代替sprintf
+#include "sched.h"       // 协作式周期任务调度
+#include "power.h"       // 无节拍空闲、Stop模式
+#include "timer_wheel.h" // 分级时间轮软件定时器
+#if ENABLE_RTOS
+#include "os.h"          // 抢占式实时内核
+#endif
 #include <string.h>
 #include <stdlib.h>
+#if ENABLE_FMT_BENCH
+#include <stdio.h>
+#endif
 
 /* =================== 缺失函数声明 =================== */
 // 注：实际的函数名在对应的头文件中定义
@@ -43,20 +69,33 @@
 #define HUMI_LOW_THRESHOLD   40    // 湿度低报警阈值(%)
 #define LIGHT_LOW_THRESHOLD  40    // 光照低报警阈值(0-100)
 #define SMOKE_HIGH_THRESHOLD 120   // 烟雾高报警阈值(ppm) - 方便演示取120
+#define MPU_FIFO_RATE_HZ     1000  // MPU6050 FIFO采样率(Hz)
+#define MPU_FIFO_BATCH       10    // 每10次数据就绪读一次FIFO
+#define STATUS_REPORT_MS     5000  // 主循环状态输出周期(ms)
+#define KEY_LOCK_MS          200   // 按键处理后200ms内不再响应
+#define SYSINFO_ROTATE_MS    3000  // 系统信息页面切换显示内容的周期(ms)
+#define BT_DEBUG_REPORT_MS   5000  // 蓝牙调试信息输出周期(ms)
+#define ALARM_CHECK_MS       100   // 报警检查周期(ms)
 
 /* =================== 蓝牙参数化命令定义 =================== */
-// 改进命令格式: 两位数字命令，例如 "01" 设置温度高阈值为35℃
-// 支持的命令:
-// 01 - 设置温度高阈值为35℃
-// 02 - 设置温度低阈值为15℃  
-// 03 - 设置湿度高阈值为80%
-// 04 - 设置湿度低阈值为30%
-// 05 - 设置光照低阈值为30%
-// 06 - 设置烟雾高阈值为200ppm
-// 07 - 启用报警并强制测试
-// 08 - 禁用所有报警
-// 09 - 查询当前状态
-// 00 - 恢复默认阈值
+// 命令由bt_cmd.c的表驱动分发器解析，见下方bt_cmd_table
+// 两位数字兼容命令，例如 "01" 设置温度高阈值为35℃:
+// 01 - 设置温度高阈值为35℃          文字命令: SET TH [值]
+// 02 - 设置温度低阈值为15℃          文字命令: SET TL [值]
+// 03 - 设置湿度高阈值为80%          文字命令: SET HH [值]
+// 04 - 设置湿度低阈值为30%          文字命令: SET HL [值]
+// 05 - 设置光照低阈值为30%          文字命令: SET LL [值]
+// 06 - 设置烟雾高阈值为200ppm       文字命令: SET SH [值]
+// 07 - 启用报警                     文字命令: ALARM ON
+// 08 - 禁用所有报警                 文字命令: ALARM OFF
+// 09 - 查询当前状态                 文字命令: GET ALL
+// 00 - 恢复默认阈值                 文字命令: RESET
+// 10 - 发送一帧二进制遥测           文字命令: GET BIN （帧格式见bt_frame.h）
+// 11 - 订阅字段并开始推送           文字命令: STREAM FIELDS <BT_FIELD_xxx掩码，十进制>
+// 12 - 设置推送频率并开始推送       文字命令: STREAM RATE <1-50Hz>
+// 13 - 停止推送                     文字命令: STREAM OFF
+// 14 - 输出各任务的执行统计          文字命令: GET TASKS
+// 数字命令也可以带参数，例如 "01 40" 等同于 "SET TH 40"
 
 #define BT_CMD_BUFFER_SIZE      20     // 蓝牙命令缓冲区大小
 
@@ -64,8 +103,7 @@
 // LCD阈值修改提示结构
 typedef struct {
     uint8_t active;           // 是否显示提示
-    uint32_t start_time;      // 提示开始时间
-    uint32_t duration;        // 提示持续时间(ms)
+    Timer_t timer;            // 到期后关闭提示
     char message[32];         // 提示消息内容
 } LCD_Notification_t;
 
@@ -96,6 +134,9 @@ typedef struct {
     // 姿态数据 (MPU6050)
     MPU6050_Data_t mpu_data;
     uint8_t mpu_status;
+    uint8_t attitude_valid;          // roll/pitch是否有效
+    float roll;                      // 融合后的姿态角(度)
+    float pitch;
     
     // 系统状态
     uint32_t error_count;
@@ -113,6 +154,57 @@ typedef struct {
     uint8_t any_alarm;
 } AlarmStatus_t;
 
+// 传感器编号
+typedef enum {
+    SENSOR_DHT11 = 0,
+    SENSOR_MQ2,
+    SENSOR_MPU6050,
+    SENSOR_LIGHT
+} SensorId_t;
+
+// 一次采集的结果，由Sensor_Apply写入sensor_data
+// 协作式调度时采集后直接写入；内核构建中各采集任务经sensor_queue发给monitor任务，只有它写sensor_data
+typedef struct {
+    uint8_t id;                      // SensorId_t
+    uint8_t error;                   // 本次采集出错
+    union {
+        struct {
+            uint8_t fresh;           // 有新的读取结果
+            uint8_t status;          // 读取结果，0-成功
+            uint8_t temperature;
+            uint8_t humidity;
+        } dht11;
+        struct {
+            uint16_t ppm;
+        } mq2;
+        struct {
+            uint16_t raw;
+            uint8_t percent;
+        } light;
+        struct {
+            uint16_t samples;        // 本次取出的采样数，0时只报告错误
+            MPU6050_Data_t data;     // 最新一个采样
+            uint8_t attitude_valid;
+            float roll;
+            float pitch;
+        } mpu;
+    } v;
+} SensorMsg_t;
+
+// 显示和蓝牙读取的数据副本，内核构建中由monitor任务发布
+typedef struct {
+    SensorData_t sensor;
+    AlarmStatus_t alarm;
+} Snapshot_t;
+
+// 蓝牙命令从收到到处理完成的延迟(us)
+typedef struct {
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint32_t total_us;
+} BT_Latency_t;
+
 // 动态阈值结构 - 支持蓝牙远程修改
 typedef struct {
     uint8_t temp_high;      // 温度高阈值
@@ -137,6 +229,7 @@ AlarmStatus_t alarm_status = {0};
 PageType_t current_page = PAGE_TEMP_HUMID;
 PageType_t previous_page = PAGE_SYSTEM_INFO; // 初始化为不同值，强制第一次刷新
 volatile uint32_t system_tick = 0;           // 改为volatile，由SysTick中断更新，供delay.c访问
+static Timer_Wheel_t sys_timers;             // 系统软件定时器，由system_tick驱动，回调在主循环中执行
 uint8_t alarm_disabled = 0;                // 报警禁用标志（命令8使用）
 
 // 动态阈值实例 - 初始化为默认值
@@ -155,23 +248,66 @@ BluetoothState_t bt_state = {0};
 // LCD提示实例
 LCD_Notification_t lcd_notification = {0};
 
+// 按键锁定、系统信息轮换、蓝牙调试输出定时器
+static Timer_t key_lock_timer;
+static Timer_t sysinfo_timer;
+static Timer_t bt_debug_timer;
+static uint8_t sysinfo_mode = 0;             // 系统信息页面当前显示的内容
+
+#if ENABLE_RTOS
+// 传感器任务 -> monitor任务的采集结果，monitor -> 显示、蓝牙的最新数据副本
+#define SENSOR_QUEUE_LENGTH     8
+static SensorMsg_t sensor_queue_buf[SENSOR_QUEUE_LENGTH];
+static OS_Queue_t sensor_queue;
+static Snapshot_t snapshot_box_buf;
+static OS_Queue_t snapshot_box;
+
+// 任务之间共用的少量数据（LCD提示）读写时暂停任务切换
+#define APP_LOCK()      OS_Suspend()
+#define APP_UNLOCK()    OS_Resume()
+#else
+#define APP_LOCK()
+#define APP_UNLOCK()
+#endif
+
 // 蓝牙命令缓冲区
 char bt_command_buffer[BT_CMD_BUFFER_SIZE] = {0};
 uint8_t bt_command_ready = 0;
+uint32_t bt_command_stamp = 0;               // 命令最后一段数据到达的DWT周期计数，BlueTooth.c中写入
+static BT_Latency_t bt_latency = {0};
 
 /* =================== 函数声明 =================== */
 void System_Init(void);
 void Sensors_Init(void);
 void Data_Collection(void);
+void Motion_Collection(void);                    // 取出MPU6050 FIFO采样
+void Sensor_Apply(const SensorMsg_t *msg);       // 采集结果写入sensor_data
+void Snapshot_Read(Snapshot_t *snap);            // 读取传感器数据和报警状态
 void Alarm_Check(void);
 void Key_Handler(void);
 void Display_Update(void);
 void Bluetooth_Handler(void);                    // 蓝牙命令处理
+void Bluetooth_CommandInit(void);                // 初始化蓝牙命令表
 void Bluetooth_ParseCommand(char* command);      // 参数化命令解析
+void Telemetry_Fill(BT_Frame_t *frame, uint16_t fields);  // 填充二进制遥测帧
+void Bluetooth_StreamPoll(void);                 // 遥测订阅推送
 void LCD_ShowNotification(char* message, uint32_t duration);  // 显示LCD提示
 void LCD_UpdateNotification(void);               // 更新LCD提示状态
+void LCD_NotificationExpire(void *arg);          // LCD提示到期
+void SysInfo_Rotate(void *arg);                  // 系统信息页面切换显示内容
+void Bluetooth_DebugReport(void *arg);           // 蓝牙调试信息输出
+void Heartbeat_Task(void);                       // 运行指示灯
+void Status_Report(void);                        // 调度器状态输出
 
 /* =================== 系统时钟相关 =================== */
+/**
+ * @brief 毫秒时钟，供调度器和软件定时器使用
+ */
+static uint32_t System_Clock(void)
+{
+    return system_tick;
+}
+
 // 非阻塞延时函数 - 修复版，避免死循环
 void delay_ms_non_blocking(uint32_t ms)
 {
@@ -185,7 +321,7 @@ void delay_ms_non_blocking(uint32_t ms)
         {
             break;  // 超时退出，防止死循环
         }
-        __NOP();  // 空操作，让CPU处理其他任务
+        __WFI();  // 睡眠到下一个中断（至少每1ms一次SysTick）
     }
 }
 
@@ -194,19 +330,32 @@ void System_Init(void)
 {
     // 基础系统初始化
     SystemInit();
+    time_init();    // 使能DWT周期计数器，供Udelay_Lib和耗时统计使用
     
     // 首先确保LCD能工作
     lcd_init();
     lcd_clear();
     lcd_print_str(0, 0, "Smart Agriculture");
     lcd_print_str(1, 0, "Starting...");
+    lcd_sync();     // 写屏是异步的，确保启动画面在后续初始化之前已显示
     
     // 配置SysTick定时器，1ms中断一次 - 移到LCD后避免中断干扰初始化
     SysTick_Config(SystemCoreClock / 1000);
     NVIC_SetPriority(SysTick_IRQn, 0);
+    Power_Init(ENABLE_STOP_MODE);   // 空闲时按下一次任务释放时间重新装载SysTick
+    
+    // 软件定时器，须在使用定时器的模块（LED呼吸灯）初始化之前
+    Timer_Wheel_Init(&sys_timers, System_Clock);
+    Timer_Init(&lcd_notification.timer, LCD_NotificationExpire, 0);
+    Timer_Init(&key_lock_timer, 0, 0);
+    Timer_Init(&sysinfo_timer, SysInfo_Rotate, 0);
+    Timer_Start(&sys_timers, &sysinfo_timer, SYSINFO_ROTATE_MS, SYSINFO_ROTATE_MS);
     
     // 基础硬件初始化
     Led_Init();
+#if ENABLE_BREATHING
+    Led_BreathingInit(&sys_timers);
+#endif
     lcd_print_str(1, 0, "LED OK");
     delay_ms_non_blocking(300);
     
@@ -230,6 +379,9 @@ void System_Init(void)
     delay_ms_non_blocking(200);  // 等待UART稳定
     
     Bluetooth_Init();
+    Bluetooth_CommandInit();
+    Timer_Init(&bt_debug_timer, Bluetooth_DebugReport, 0);
+    Timer_Start(&sys_timers, &bt_debug_timer, BT_DEBUG_REPORT_MS, BT_DEBUG_REPORT_MS);
     bt_state.enabled = 1;
     lcd_print_str(1, 0, "BT OK");
     delay_ms_non_blocking(300);
@@ -247,12 +399,75 @@ void System_Init(void)
     delay_ms_non_blocking(200);  // 确保UART完全稳定
     Bluetooth_SendString("=== STM32 Smart Agriculture System ===\r\n");
     Bluetooth_SendString("DEBUG MODE: Only BT+LCD Enabled\r\n");
-    Bluetooth_SendString("Command Format: Two Digits (00-09)\r\n");
-    Bluetooth_SendString("Test Commands: 08-DisableAlarm, 09-QueryStatus\r\n");
-    Bluetooth_SendString("Ready for Two-Digit Commands!\r\n");
+    Bluetooth_SendString("Command Format: Two Digits (00-09) or Verbs\r\n");
+    Bluetooth_SendString("Examples: 08, SET TH 35, ALARM OFF, GET ALL\r\n");
+    Bluetooth_SendString("Ready for Commands!\r\n");
 #endif
 }
 
+#if ENABLE_FMT_BENCH && ENABLE_BLUETOOTH
+#define FMT_BENCH_ROUNDS    100
+
+/**
+ * @brief 用DWT周期计数比较sprintf与Fmt格式化同样两行显示内容的耗时
+ * @note  温湿度行是纯整数，姿态行是三个一位小数的浮点数
+ */
+static void Fmt_Benchmark(void)
+{
+    char line[LCD_FB_COLS_MAX + 1];
+    char report[64];
+    Fmt_t f;
+    uint32_t start, cyc_int[2], cyc_flt[2];
+    uint16_t i;
+    float x = -0.12f, y = 0.98f, z = 1.03f;
+
+    start = time_now_cycles();
+    for(i = 0; i < FMT_BENCH_ROUNDS; i++)
+    {
+        sprintf(line, "T:%dC H:%d%% %s", sensor_data.temperature, sensor_data.humidity, "OK");
+    }
+    cyc_int[0] = time_elapsed_cycles(start, time_now_cycles()) / FMT_BENCH_ROUNDS;
+
+    start = time_now_cycles();
+    for(i = 0; i < FMT_BENCH_ROUNDS; i++)
+    {
+        Fmt_Init(&f, line, sizeof(line));
+        Fmt_Str(&f, "T:");
+        Fmt_Uint(&f, sensor_data.temperature, 0, ' ');
+        Fmt_Str(&f, "C H:");
+        Fmt_Uint(&f, sensor_data.humidity, 0, ' ');
+        Fmt_Str(&f, "% OK");
+    }
+    cyc_int[1] = time_elapsed_cycles(start, time_now_cycles()) / FMT_BENCH_ROUNDS;
+
+    start = time_now_cycles();
+    for(i = 0; i < FMT_BENCH_ROUNDS; i++)
+    {
+        snprintf(line, sizeof(line), "X:%.1f Y:%.1f Z:%.1f", x, y, z);
+    }
+    cyc_flt[0] = time_elapsed_cycles(start, time_now_cycles()) / FMT_BENCH_ROUNDS;
+
+    start = time_now_cycles();
+    for(i = 0; i < FMT_BENCH_ROUNDS; i++)
+    {
+        Fmt_Init(&f, line, sizeof(line));
+        Fmt_Str(&f, "X:");
+        Fmt_Float(&f, x, 1, 0);
+        Fmt_Str(&f, " Y:");
+        Fmt_Float(&f, y, 1, 0);
+        Fmt_Str(&f, " Z:");
+        Fmt_Float(&f, z, 1, 0);
+    }
+    cyc_flt[1] = time_elapsed_cycles(start, time_now_cycles()) / FMT_BENCH_ROUNDS;
+
+    Fmt_Init(&f, report, sizeof(report));
+    Fmt_Printf(&f, "FMT cyc int %lu/%lu float %lu/%lu\r\n",
+               (unsigned long)cyc_int[0], (unsigned long)cyc_int[1],
+               (unsigned long)cyc_flt[0], (unsigned long)cyc_flt[1]);
+    Bluetooth_SendString(report);
+}
+#endif
+
 void Sensors_Init(void)
 {
     char str[50];
@@ -265,6 +480,18 @@ void Sensors_Init(void)
     lcd_print_str(1, 0, "DEBUG: Skip Sensors");
     delay_ms_non_blocking(500);
     
+#if ENABLE_DHT11
+    // DHT11使用TIM9输入捕获非阻塞读取，由Data_Collection每秒启动一次
+    dht11_async_init();
+#endif
+    
+#if ENABLE_LIGHT
+    // 光敏电阻由TIM2触发的ADC3扫描+DMA采样，读取不阻塞
+    Light_Init();
+    // 光照低报警交给ADC3模拟看门狗
+    Light_Alarm_SetThreshold(thresholds.light_low);
+#endif
+    
     // 设置所有传感器的默认值和状态
     sensor_data.dht11_status = 0;
     sensor_data.temperature = 25;  // 默认温度
@@ -285,6 +512,38 @@ void Sensors_Init(void)
     sensor_data.mpu_data.gyro_z = 0.0f;
     sensor_data.mpu_data.temp = 25.0f;
     
+#if ENABLE_MPU6050
+    // MPU6050以FIFO批量模式连续采样，数据就绪中断中批量读出
+    sensor_data.mpu_status = (MPU6050_Init() == 0);
+    if(sensor_data.mpu_status)
+    {
+        MPU6050_Bench_t bench;
+        
+        MPU6050_Benchmark(&bench, 8);
+#if ENABLE_BLUETOOTH
+        Fmt_t f;
+        
+        Fmt_Init(&f, str, sizeof(str));
+        Fmt_Printf(&f, "MPU us 3x=%lu 1x=%lu dma=%lu/%lu\r\n",
+                   (unsigned long)bench.legacy_us, (unsigned long)bench.burst_us,
+                   (unsigned long)bench.dma_bus_us, (unsigned long)bench.dma_cpu_us);
+        Bluetooth_SendString(str);
+#endif
+        if(MPU6050_FIFO_Start(MPU_FIFO_RATE_HZ, MPU_FIFO_BATCH) != 0)
+        {
+            sensor_data.mpu_status = 0;
+        }
+        else
+        {
+            MPU6050_Attitude_Init((float)MPU6050_FIFO_Get_Stats()->rate_hz);
+        }
+    }
+#endif
+    
+#if ENABLE_FMT_BENCH && ENABLE_BLUETOOTH
+    Fmt_Benchmark();
+#endif
+    
     // 初始化完成
     lcd_print_str(1, 0, "Sensors Ready!");
     delay_ms_non_blocking(1000);
@@ -294,34 +553,184 @@ void Sensors_Init(void)
 }
 
 /* =================== 第2步：数据采集 =================== */
-void Data_Collection(void)
+/**
+ * @brief 取出FIFO中已读出的全部采样，每个都参与姿态融合，显示和报警只用最新一个
+ * @retval 1-msg中有新采样或FIFO溢出
+ */
+static uint8_t Motion_Read(SensorMsg_t *msg)
 {
-    static uint32_t last_read = 0;
+#if ENABLE_MPU6050
+    static uint32_t last_overflows = 0;
+    MPU6050_Data_t samples[8];
+    uint16_t n, i;
     
-    // 在调试模式下，跳过所有传感器数据采集，只更新计数
-    if(system_tick - last_read >= 1000)
+    msg->id = SENSOR_MPU6050;
+    msg->error = 0;
+    msg->v.mpu.samples = 0;
+    while((n = MPU6050_FIFO_Read(samples, 8)) > 0)
     {
-        last_read = system_tick;
-        
-        // 保持默认值不变，只更新数据更新计数
-        sensor_data.data_update_count++;
-        
-        // 模拟一些数据变化用于调试显示
-        static uint8_t sim_counter = 0;
-        sim_counter++;
-        
-        // 模拟温度在24-26度之间变化
-        sensor_data.temperature = 24 + (sim_counter % 3);
-        // 模拟湿度在58-62%之间变化  
-        sensor_data.humidity = 58 + (sim_counter % 5);
-        // 模拟光照在45-55%之间变化
-        sensor_data.light_percent = 45 + (sim_counter % 11);
-        // 模拟烟雾值在40-50ppm之间变化
-        sensor_data.smoke_ppm_value = 40 + (sim_counter % 11);
-        sensor_data.smoke_percent = (float)sensor_data.smoke_ppm_value / 10.0f;
+        for(i = 0; i < n; i++)
+        {
+            MPU6050_Attitude_Feed(&samples[i]);
+        }
+        msg->v.mpu.data = samples[n - 1];
+        msg->v.mpu.samples += n;
+    }
+    if(MPU6050_FIFO_Get_Stats()->overflows != last_overflows)
+    {
+        last_overflows = MPU6050_FIFO_Get_Stats()->overflows;
+        msg->error = 1;
+    }
+    msg->v.mpu.roll = 0.0f;
+    msg->v.mpu.pitch = 0.0f;
+    msg->v.mpu.attitude_valid = MPU6050_Attitude_Get(&msg->v.mpu.roll, &msg->v.mpu.pitch);
+    return msg->v.mpu.samples > 0 || msg->error;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief 温湿度：取上一秒启动的读取结果，再启动下一次；读取过程不占用CPU
+ */
+static void DHT11_Read(SensorMsg_t *msg)
+{
+    msg->id = SENSOR_DHT11;
+    msg->error = 0;
+    msg->v.dht11.fresh = 0;
+#if ENABLE_DHT11
+    if(dht11_async_ready())
+    {
+        msg->v.dht11.fresh = 1;
+        msg->v.dht11.status = dht11_async_result(&msg->v.dht11.temperature,
+                                                 &msg->v.dht11.humidity);
+        msg->error = (msg->v.dht11.status != 0);
+    }
+    dht11_async_start();
+#else
+    static uint8_t sim_counter = 0;
+    
+    // 模拟温度在24-26度之间变化，湿度在58-62%之间变化
+    sim_counter++;
+    msg->v.dht11.fresh = 1;
+    msg->v.dht11.status = 0;
+    msg->v.dht11.temperature = 24 + (sim_counter % 3);
+    msg->v.dht11.humidity = 58 + (sim_counter % 5);
+#endif
+}
+
+/**
+ * @brief 光照：ADC3由TIM2触发扫描，这里只取DMA搬运好的结果
+ */
+static void Light_Read(SensorMsg_t *msg)
+{
+    msg->id = SENSOR_LIGHT;
+    msg->error = 0;
+#if ENABLE_LIGHT
+    msg->v.light.raw = Light_GetRawValue();
+    msg->v.light.percent = Light_GetValue();
+#else
+    static uint8_t sim_counter = 0;
+    
+    // 模拟光照在45-55%之间变化，原始值保持不变
+    sim_counter++;
+    msg->v.light.raw = 0;
+    msg->v.light.percent = 45 + (sim_counter % 11);
+#endif
+}
+
+/**
+ * @brief 烟雾：模拟值在40-50ppm之间变化
+ */
+static void MQ2_Read(SensorMsg_t *msg)
+{
+    static uint8_t sim_counter = 0;
+    
+    sim_counter++;
+    msg->id = SENSOR_MQ2;
+    msg->error = 0;
+    msg->v.mq2.ppm = 40 + (sim_counter % 11);
+}
+
+/**
+ * @brief 把一次采集的结果写入sensor_data
+ * @note  每秒一次的温湿度结果同时计为一次数据更新
+ */
+void Sensor_Apply(const SensorMsg_t *msg)
+{
+    if(msg->error)
+    {
+        sensor_data.error_count++;
+    }
+    
+    switch(msg->id)
+    {
+        case SENSOR_DHT11:
+            sensor_data.data_update_count++;
+            if(msg->v.dht11.fresh)
+            {
+                sensor_data.dht11_status = msg->v.dht11.status;
+                if(msg->v.dht11.status == 0)
+                {
+                    sensor_data.temperature = msg->v.dht11.temperature;
+                    sensor_data.humidity = msg->v.dht11.humidity;
+                }
+            }
+            break;
+            
+        case SENSOR_MQ2:
+            sensor_data.smoke_ppm_value = msg->v.mq2.ppm;
+            sensor_data.smoke_percent = (float)msg->v.mq2.ppm / 10.0f;
+            break;
+            
+        case SENSOR_LIGHT:
+#if ENABLE_LIGHT
+            sensor_data.light_raw_value = msg->v.light.raw;
+#endif
+            sensor_data.light_percent = msg->v.light.percent;
+            break;
+            
+        case SENSOR_MPU6050:
+            if(msg->v.mpu.samples == 0)
+            {
+                break;
+            }
+            sensor_data.mpu_data = msg->v.mpu.data;
+            sensor_data.attitude_valid = msg->v.mpu.attitude_valid;
+            sensor_data.roll = msg->v.mpu.roll;
+            sensor_data.pitch = msg->v.mpu.pitch;
+            break;
+    }
+}
+
+/**
+ * @brief 取出MPU6050 FIFO采样，由调度器每10ms调用
+ */
+void Motion_Collection(void)
+{
+    SensorMsg_t msg;
+    
+    if(sensor_data.mpu_status && Motion_Read(&msg))
+    {
+        Sensor_Apply(&msg);
     }
 }
 
+/**
+ * @brief 每秒采集一次慢速传感器，由调度器按周期调用
+ */
+void Data_Collection(void)
+{
+    SensorMsg_t msg;
+    
+    DHT11_Read(&msg);
+    Sensor_Apply(&msg);
+    Light_Read(&msg);
+    Sensor_Apply(&msg);
+    MQ2_Read(&msg);
+    Sensor_Apply(&msg);
+}
+
 /* =================== 第3步：报警检查 =================== */
 void Alarm_Check(void)
 {
@@ -350,8 +759,12 @@ void Alarm_Check(void)
     alarm_status.humi_high_alarm = (sensor_data.humidity > thresholds.humi_high);
     alarm_status.humi_low_alarm = (sensor_data.humidity < thresholds.humi_low);
     
-    // 光照报警检查 - 使用动态阈值
+    // 光照报警检查 - 启用光敏电阻时由ADC模拟看门狗在硬件中比较
+#if ENABLE_LIGHT
+    alarm_status.light_low_alarm = Light_Alarm_Active();
+#else
     alarm_status.light_low_alarm = (sensor_data.light_percent < thresholds.light_low);
+#endif
     
     // 烟雾报警检查 - 使用动态阈值
     alarm_status.smoke_high_alarm = (sensor_data.smoke_ppm_value > thresholds.smoke_high);
@@ -421,14 +834,29 @@ void Alarm_Check(void)
 #endif // ENABLE_ALARM
 }
 
+/**
+ * @brief 读取传感器数据和报警状态的副本
+ * @note  内核构建中读取monitor任务发布的最新副本，不直接访问sensor_data/alarm_status
+ */
+void Snapshot_Read(Snapshot_t *snap)
+{
+#if ENABLE_RTOS
+    if(OS_Queue_Peek(&snapshot_box, snap, 0) == 0)
+    {
+        return;
+    }
+#endif
+    snap->sensor = sensor_data;
+    snap->alarm = alarm_status;
+}
+
 /* =================== 第4步：按键处理 =================== */
 void Key_Handler(void)
 {
-    static uint32_t last_key_time = 0;
     static uint8_t key_pressed[4] = {0};
     
     // 按键防抖：200ms内只处理一次按键
-    if(system_tick - last_key_time < 200)
+    if(Timer_Pending(&key_lock_timer))
         return;
     
     // 检测KEY0 - 温湿度页面
@@ -437,7 +865,7 @@ void Key_Handler(void)
         if(!key_pressed[0])
         {
             current_page = PAGE_TEMP_HUMID;
-            last_key_time = system_tick;
+            Timer_Start(&sys_timers, &key_lock_timer, KEY_LOCK_MS, 0);
             key_pressed[0] = 1;
         }
     }
@@ -452,7 +880,7 @@ void Key_Handler(void)
         if(!key_pressed[1])
         {
             current_page = PAGE_LIGHT_SMOKE;
-            last_key_time = system_tick;
+            Timer_Start(&sys_timers, &key_lock_timer, KEY_LOCK_MS, 0);
             key_pressed[1] = 1;
         }
     }
@@ -467,7 +895,7 @@ void Key_Handler(void)
         if(!key_pressed[2])
         {
             current_page = PAGE_ATTITUDE;
-            last_key_time = system_tick;
+            Timer_Start(&sys_timers, &key_lock_timer, KEY_LOCK_MS, 0);
             key_pressed[2] = 1;
         }
     }
@@ -482,7 +910,7 @@ void Key_Handler(void)
         if(!key_pressed[3])
         {
             current_page = PAGE_BLUETOOTH;
-            last_key_time = system_tick;
+            Timer_Start(&sys_timers, &key_lock_timer, KEY_LOCK_MS, 0);
             key_pressed[3] = 1;
         }
     }
@@ -498,7 +926,7 @@ void Key_Handler(void)
         if(!combo_pressed)
         {
             current_page = PAGE_SYSTEM_INFO;
-            last_key_time = system_tick;
+            Timer_Start(&sys_timers, &key_lock_timer, KEY_LOCK_MS, 0);
             combo_pressed = 1;
         }
     }
@@ -511,19 +939,24 @@ void Key_Handler(void)
 /* =================== 第5步：显示更新 =================== */
 void Display_Update(void)
 {
-    char str[50];
+    char str[LCD_FB_COLS_MAX + 1];    // 一行，超出部分截断
+    Fmt_t f;
+    Snapshot_t snap;
     
     // 优先处理LCD通知
     if(lcd_notification.active)
     {
         LCD_UpdateNotification();
+        lcd_refresh();
         return;  // 通知期间不显示其他内容
     }
     
-    // 只在页面变化时清屏
+    Snapshot_Read(&snap);
+    
+    // 页面变化时清空帧缓冲，不再发送耗时的清屏指令
     if(current_page != previous_page)
     {
-        lcd_clear();
+        lcd_fb_clear(&lcd_screen);
         previous_page = current_page;
     }
     
@@ -531,93 +964,120 @@ void Display_Update(void)
     switch(current_page)
     {
         case PAGE_TEMP_HUMID:
-            lcd_print_str(0, 0, "=== Temp/Humid ===");
-            sprintf(str, "T:%dC H:%d%% %s", 
-                    sensor_data.temperature, 
-                    sensor_data.humidity,
-                    alarm_status.temp_high_alarm ? "T-HIGH" : 
-                    (alarm_status.temp_low_alarm ? "T-LOW" : 
-                    (alarm_status.humi_high_alarm ? "H-HIGH" : 
-                    (alarm_status.humi_low_alarm ? "H-LOW" : "OK"))));
-            lcd_print_str(1, 0, str);
+            lcd_fb_put_line(&lcd_screen, 0, "=== Temp/Humid ===");
+            Fmt_Init(&f, str, sizeof(str));
+            Fmt_Str(&f, "T:");
+            Fmt_Uint(&f, snap.sensor.temperature, 0, ' ');
+            Fmt_Str(&f, "C H:");
+            Fmt_Uint(&f, snap.sensor.humidity, 0, ' ');
+            Fmt_Str(&f, "% ");
+            Fmt_Str(&f, snap.alarm.temp_high_alarm ? "T-HIGH" : 
+                        (snap.alarm.temp_low_alarm ? "T-LOW" : 
+                        (snap.alarm.humi_high_alarm ? "H-HIGH" : 
+                        (snap.alarm.humi_low_alarm ? "H-LOW" : "OK"))));
+            lcd_fb_put_line(&lcd_screen, 1, str);
             break;
             
         case PAGE_LIGHT_SMOKE:
-            lcd_print_str(0, 0, "=== Light/Smoke ===");
-            sprintf(str, "L:%d%% MQ2:%dppm%s", 
-                    sensor_data.light_percent, 
-                    sensor_data.smoke_ppm_value,
-                    (sensor_data.smoke_ppm_value == 0) ? "!" : 
-                    (alarm_status.smoke_high_alarm ? "H" : ""));
-            lcd_print_str(1, 0, str);
+            lcd_fb_put_line(&lcd_screen, 0, "=== Light/Smoke ===");
+            Fmt_Init(&f, str, sizeof(str));
+            Fmt_Str(&f, "L:");
+            Fmt_Uint(&f, snap.sensor.light_percent, 0, ' ');
+            Fmt_Str(&f, "% MQ2:");
+            Fmt_Uint(&f, snap.sensor.smoke_ppm_value, 0, ' ');
+            Fmt_Str(&f, "ppm");
+            Fmt_Str(&f, (snap.sensor.smoke_ppm_value == 0) ? "!" : 
+                        (snap.alarm.smoke_high_alarm ? "H" : ""));
+            lcd_fb_put_line(&lcd_screen, 1, str);
             break;
             
         case PAGE_ATTITUDE:
-            lcd_print_str(0, 0, "=== MPU6050 ===");
             #if ENABLE_MPU6050
             // 如果MPU6050启用且状态正常，显示角度信息
-            if(sensor_data.mpu_status)
+            if(snap.sensor.mpu_status)
             {
-                // 使用新的角度显示功能
+#if ENABLE_RTOS
+                // I2C只由imu任务访问，这里显示它发来的融合姿态
+                Fmt_Init(&f, str, sizeof(str));
+                Fmt_Str(&f, "Roll: ");
+                Fmt_Float(&f, snap.sensor.roll, 2, 0);
+                lcd_fb_put_line(&lcd_screen, 0, str);
+                Fmt_Init(&f, str, sizeof(str));
+                Fmt_Str(&f, "Pitch: ");
+                Fmt_Float(&f, snap.sensor.pitch, 2, 0);
+                lcd_fb_put_line(&lcd_screen, 1, str);
+#else
+                // 使用新的角度显示功能，两行都由它绘制，不再写标题
                 MPU6050_Read_And_Display();
+#endif
             }
             else
             {
-                sprintf(str, "MPU6050 Offline");
-                lcd_print_str(1, 0, str);
+                lcd_fb_put_line(&lcd_screen, 0, "=== MPU6050 ===");
+                lcd_fb_put_line(&lcd_screen, 1, "MPU6050 Offline");
             }
             #else
             // MPU6050被禁用时显示默认信息
-            sprintf(str, "X:%.1f Y:%.1f Z:%.1f", 
-                    sensor_data.mpu_data.accel_x,
-                    sensor_data.mpu_data.accel_y,
-                    sensor_data.mpu_data.accel_z);
-            lcd_print_str(1, 0, str);
+            lcd_fb_put_line(&lcd_screen, 0, "=== MPU6050 ===");
+            Fmt_Init(&f, str, sizeof(str));
+            Fmt_Str(&f, "X:");
+            Fmt_Float(&f, snap.sensor.mpu_data.accel_x, 1, 0);
+            Fmt_Str(&f, " Y:");
+            Fmt_Float(&f, snap.sensor.mpu_data.accel_y, 1, 0);
+            Fmt_Str(&f, " Z:");
+            Fmt_Float(&f, snap.sensor.mpu_data.accel_z, 1, 0);
+            lcd_fb_put_line(&lcd_screen, 1, str);
             #endif
             break;
             
         case PAGE_BLUETOOTH:
-            lcd_print_str(0, 0, "=== Bluetooth ===");
-            sprintf(str, "BT:%s Cmd:%ld %s", 
-                    bt_state.enabled ? "ON" : "OFF",
-                    bt_state.command_count,
-                    alarm_disabled ? "DISABLED" : "ENABLED");
-            lcd_print_str(1, 0, str);
+            lcd_fb_put_line(&lcd_screen, 0, "=== Bluetooth ===");
+            Fmt_Init(&f, str, sizeof(str));
+            Fmt_Str(&f, bt_state.enabled ? "BT:ON Cmd:" : "BT:OFF Cmd:");
+            Fmt_Uint(&f, bt_state.command_count, 0, ' ');
+            Fmt_Str(&f, alarm_disabled ? " DISABLED" : " ENABLED");
+            lcd_fb_put_line(&lcd_screen, 1, str);
             break;
             
         case PAGE_SYSTEM_INFO:
-            lcd_print_str(0, 0, "=== System Info ===");
-            // 添加MQ2调试信息显示
-            static uint8_t debug_mode = 0;
-            static uint32_t last_switch = 0;
-            
-            // 每3秒切换显示内容
-            if(system_tick - last_switch >= 3000)
-            {
-                last_switch = system_tick;
-                debug_mode = (debug_mode + 1) % 3;
-            }
-            
-            switch(debug_mode)
+            lcd_fb_put_line(&lcd_screen, 0, "=== System Info ===");
+            // 显示内容由sysinfo_timer每3秒切换一次，包括MQ2调试信息
+            Fmt_Init(&f, str, sizeof(str));
+            switch(sysinfo_mode)
             {
                 case 0: // 显示运行时间和错误
-                    sprintf(str, "Time:%lds Err:%ld", 
-                            system_tick / 1000, sensor_data.error_count);
+                    Fmt_Str(&f, "Time:");
+                    Fmt_Uint(&f, system_tick / 1000, 0, ' ');
+                    Fmt_Str(&f, "s Err:");
+                    Fmt_Uint(&f, snap.sensor.error_count, 0, ' ');
                     break;
                 case 1: // 显示MQ2状态
-                    sprintf(str, "MQ2:%dppm Ready:%d", 
-                            sensor_data.smoke_ppm_value, MQ2_IsDataReady());
+                    Fmt_Str(&f, "MQ2:");
+                    Fmt_Uint(&f, snap.sensor.smoke_ppm_value, 0, ' ');
+                    Fmt_Str(&f, "ppm Ready:");
+                    Fmt_Uint(&f, MQ2_IsDataReady(), 0, ' ');
                     break;
                 case 2: // 显示传感器状态
-                    sprintf(str, "DHT:%d L:%d MQ:%d", 
-                            sensor_data.dht11_status,
-                            (sensor_data.light_raw_value > 0 ? 1 : 0),
-                            (sensor_data.smoke_ppm_value > 0 ? 1 : 0));
+                    Fmt_Str(&f, "DHT:");
+                    Fmt_Uint(&f, snap.sensor.dht11_status, 0, ' ');
+                    Fmt_Str(&f, snap.sensor.light_raw_value > 0 ? " L:1" : " L:0");
+                    Fmt_Str(&f, snap.sensor.smoke_ppm_value > 0 ? " MQ:1" : " MQ:0");
                     break;
             }
-            lcd_print_str(1, 0, str);
+            lcd_fb_put_line(&lcd_screen, 1, str);
             break;
     }
+    
+    // 只把变化的字符写到屏幕
+    lcd_refresh();
+}
+
+/**
+ * @brief 系统信息页面切换显示内容，由sysinfo_timer周期调用
+ */
+void SysInfo_Rotate(void *arg)
+{
+    sysinfo_mode = (sysinfo_mode + 1) % 3;
 }
 
 /* =================== 蓝牙处理函数 =================== */
@@ -629,11 +1089,12 @@ void Display_Update(void)
  */
 void LCD_ShowNotification(char* message, uint32_t duration)
 {
+    APP_LOCK();
     lcd_notification.active = 1;
-    lcd_notification.start_time = system_tick;
-    lcd_notification.duration = duration;
+    Timer_Start(&sys_timers, &lcd_notification.timer, duration, 0);
     strncpy(lcd_notification.message, message, sizeof(lcd_notification.message)-1);
     lcd_notification.message[sizeof(lcd_notification.message)-1] = '\0';
+    APP_UNLOCK();
 }
 
 /**
@@ -643,219 +1104,913 @@ void LCD_UpdateNotification(void)
 {
     if(lcd_notification.active)
     {
-        // 检查是否超时
-        if(system_tick - lcd_notification.start_time >= lcd_notification.duration)
-        {
-            lcd_notification.active = 0;
-        }
-        else
-        {
-            // 在屏幕顶部显示通知
-            lcd_print_str(0, 0, lcd_notification.message);
-        }
+        // 在屏幕顶部显示通知，到期由定时器关闭
+        APP_LOCK();
+        lcd_fb_put_line(&lcd_screen, 0, lcd_notification.message);
+        APP_UNLOCK();
     }
 }
 
 /**
- * @brief 解析蓝牙两位数字命令（调试简化版）
- * @param command: 命令字符串，格式如"01"表示设置温度高阈值
+ * @brief LCD通知到期，由lcd_notification.timer调用
  */
-void Bluetooth_ParseCommand(char* command)
+void LCD_NotificationExpire(void *arg)
 {
-    char response[100];
-    int cmd_num;
-    
-    Bluetooth_SendString("PARSE: Starting command analysis...\r\n");
-    
-    // 验证命令长度
-    if(strlen(command) < 2)
-    {
-        Bluetooth_SendString("ERROR: Command too short (need 2 digits)\r\n");
-        return;
-    }
-    
-    // 验证命令是否都是数字
-    if(command[0] < '0' || command[0] > '9' || command[1] < '0' || command[1] > '9')
-    {
-        sprintf(response, "ERROR: Invalid chars: %c%c (need digits)\r\n", command[0], command[1]);
-        Bluetooth_SendString(response);
-        return;
-    }
-    
-    // 解析两位数命令
-    cmd_num = (command[0] - '0') * 10 + (command[1] - '0');
-    
-    sprintf(response, "PARSE: Command %02d recognized\r\n", cmd_num);
-    Bluetooth_SendString(response);
-    
-    // 根据命令执行对应操作 - 简化版本，只保留关键命令
-    switch(cmd_num)
+    lcd_notification.active = 0;
+}
+
+/* =================== 蓝牙命令表 =================== */
+// 阈值编号，作为命令表项的param传给BT_Cmd_SetThreshold
+enum {
+    BT_TH_TEMP_HIGH = 0,
+    BT_TH_TEMP_LOW,
+    BT_TH_HUMI_HIGH,
+    BT_TH_HUMI_LOW,
+    BT_TH_LIGHT_LOW,
+    BT_TH_SMOKE_HIGH
+};
+
+// 推送命令编号，作为命令表项的param传给BT_Cmd_Stream
+enum {
+    BT_STREAM_CMD_FIELDS = 0,
+    BT_STREAM_CMD_RATE,
+    BT_STREAM_CMD_OFF
+};
+
+static BT_CmdStatus_t BT_Cmd_Reset(const BT_CmdEntry_t *cmd, int32_t value);
+static BT_CmdStatus_t BT_Cmd_SetThreshold(const BT_CmdEntry_t *cmd, int32_t value);
+static BT_CmdStatus_t BT_Cmd_SetAlarm(const BT_CmdEntry_t *cmd, int32_t value);
+static BT_CmdStatus_t BT_Cmd_GetAll(const BT_CmdEntry_t *cmd, int32_t value);
+static BT_CmdStatus_t BT_Cmd_GetBinary(const BT_CmdEntry_t *cmd, int32_t value);
+static BT_CmdStatus_t BT_Cmd_Stream(const BT_CmdEntry_t *cmd, int32_t value);
+static BT_CmdStatus_t BT_Cmd_GetTasks(const BT_CmdEntry_t *cmd, int32_t value);
+
+// 新增命令只需在此表中加一行，解析耗时不变
+static const BT_CmdEntry_t bt_cmd_table[] = {
+    /* 命令名       编号 param             默认  最小  最大  处理函数 */
+    { "RESET",      0,  0,                 0,    0,    0,    BT_Cmd_Reset },
+    { "SET TH",     1,  BT_TH_TEMP_HIGH,   35,   0,    99,   BT_Cmd_SetThreshold },
+    { "SET TL",     2,  BT_TH_TEMP_LOW,    15,   0,    99,   BT_Cmd_SetThreshold },
+    { "SET HH",     3,  BT_TH_HUMI_HIGH,   80,   0,    100,  BT_Cmd_SetThreshold },
+    { "SET HL",     4,  BT_TH_HUMI_LOW,    30,   0,    100,  BT_Cmd_SetThreshold },
+    { "SET LL",     5,  BT_TH_LIGHT_LOW,   30,   0,    100,  BT_Cmd_SetThreshold },
+    { "SET SH",     6,  BT_TH_SMOKE_HIGH,  200,  0,    9999, BT_Cmd_SetThreshold },
+    { "ALARM ON",   7,  1,                 0,    0,    0,    BT_Cmd_SetAlarm },
+    { "ALARM OFF",  8,  0,                 0,    0,    0,    BT_Cmd_SetAlarm },
+    { "GET ALL",    9,  0,                 0,    0,    0,    BT_Cmd_GetAll },
+    { "GET BIN",    10, 0,                 0,    0,    0,    BT_Cmd_GetBinary },
+    { "STREAM FIELDS", 11, BT_STREAM_CMD_FIELDS, BT_FIELD_TEMP | BT_FIELD_HUMI, 1, BT_FIELD_ALL, BT_Cmd_Stream },
+    { "STREAM RATE",   12, BT_STREAM_CMD_RATE,   1,    1,    BT_STREAM_RATE_MAX, BT_Cmd_Stream },
+    { "STREAM OFF",    13, BT_STREAM_CMD_OFF,    0,    0,    0,    BT_Cmd_Stream },
+    { "GET TASKS",  14, 0,                 0,    0,    0,    BT_Cmd_GetTasks },
+};
+
+static BT_CmdDispatcher_t bt_cmd_dispatcher;
+
+// 遥测推送：9600波特率约960字节/秒
+#define BT_STREAM_BUDGET        (BLUETOOTH_BAUDRATE / 10)
+static BT_Stream_t bt_stream;
+static uint16_t bt_stream_fields = BT_FIELD_TEMP | BT_FIELD_HUMI;
+static uint8_t bt_stream_rate = 1;
+
+/**
+ * @brief 阈值变化后同步到硬件比较器
+ */
+static void Thresholds_Apply(void)
+{
+#if ENABLE_LIGHT
+    Light_Alarm_SetThreshold(thresholds.light_low);
+#endif
+}
+
+/**
+ * @brief 00 / RESET - 恢复默认阈值并启用报警
+ */
+static BT_CmdStatus_t BT_Cmd_Reset(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    alarm_disabled = 0;
+    thresholds.temp_high = TEMP_HIGH_THRESHOLD;
+    thresholds.temp_low = TEMP_LOW_THRESHOLD;
+    thresholds.humi_high = HUMI_HIGH_THRESHOLD;
+    thresholds.humi_low = HUMI_LOW_THRESHOLD;
+    thresholds.light_low = LIGHT_LOW_THRESHOLD;
+    thresholds.smoke_high = SMOKE_HIGH_THRESHOLD;
+    Thresholds_Apply();
+    Bluetooth_SendString("SUCCESS: Reset to defaults\r\n");
+    LCD_ShowNotification("Reset & ENABLED", 2000);
+    return BT_CMD_OK;
+}
+
+/**
+ * @brief 01-06 / SET xx [值] - 设置阈值，范围已由命令表检查
+ */
+static BT_CmdStatus_t BT_Cmd_SetThreshold(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    static const char *const names[] = {
+        "TempHigh", "TempLow", "HumiHigh", "HumiLow", "LightLow", "SmokeHigh"
+    };
+    char response[48];
+    Fmt_t f;
+
+    switch(cmd->param)
     {
-        case 1: // 01 - 设置温度高阈值为35℃
-            thresholds.temp_high = 35;
-            Bluetooth_SendString("SUCCESS: Temp High = 35C\r\n");
-            LCD_ShowNotification("TempHigh: 35C", 2000);
-            break;
-            
-        case 2: // 02 - 设置温度低阈值为15℃
-            thresholds.temp_low = 15;
-            Bluetooth_SendString("SUCCESS: Temp Low = 15C\r\n");
-            LCD_ShowNotification("TempLow: 15C", 2000);
-            break;
-            
-        case 8: // 08 - 禁用所有报警
-            alarm_disabled = 1;
-            Bluetooth_SendString("SUCCESS: All Alarms DISABLED\r\n");
-            LCD_ShowNotification("Alarms DISABLED", 2000);
-            break;
-            
-        case 9: // 09 - 查询当前状态（调试增强版）
-            sprintf(response, "Status: T=%dC H=%d%% DEBUG_MODE\r\n",
-                    sensor_data.temperature, sensor_data.humidity);
-            Bluetooth_SendString(response);
-            sprintf(response, "Thresholds: TH=%d TL=%d AlarmOff=%d\r\n",
-                    thresholds.temp_high, thresholds.temp_low, alarm_disabled);
-            Bluetooth_SendString(response);
-            sprintf(response, "System: Tick=%ld Updates=%ld\r\n",
-                    system_tick, sensor_data.data_update_count);
-            Bluetooth_SendString(response);
-            return;
-            
-        case 0: // 00 - 恢复默认阈值
-            alarm_disabled = 0;
-            thresholds.temp_high = TEMP_HIGH_THRESHOLD;
-            thresholds.temp_low = TEMP_LOW_THRESHOLD;
-            thresholds.humi_high = HUMI_HIGH_THRESHOLD;
-            thresholds.humi_low = HUMI_LOW_THRESHOLD;
-            thresholds.light_low = LIGHT_LOW_THRESHOLD;
-            thresholds.smoke_high = SMOKE_HIGH_THRESHOLD;
-            Bluetooth_SendString("SUCCESS: Reset to defaults\r\n");
-            LCD_ShowNotification("Reset & ENABLED", 2000);
-            break;
-            
+        case BT_TH_TEMP_HIGH:  thresholds.temp_high = (uint8_t)value;   break;
+        case BT_TH_TEMP_LOW:   thresholds.temp_low = (uint8_t)value;    break;
+        case BT_TH_HUMI_HIGH:  thresholds.humi_high = (uint8_t)value;   break;
+        case BT_TH_HUMI_LOW:   thresholds.humi_low = (uint8_t)value;    break;
+        case BT_TH_LIGHT_LOW:  thresholds.light_low = (uint8_t)value;   break;
+        case BT_TH_SMOKE_HIGH: thresholds.smoke_high = (uint16_t)value; break;
         default:
-            sprintf(response, "ERROR: Unknown command %02d\r\n", cmd_num);
-            Bluetooth_SendString(response);
-            Bluetooth_SendString("DEBUG: Valid commands: 00,01,02,08,09\r\n");
-            return;
+            return BT_CMD_ERR_FAIL;
     }
-    
-    // 更新蓝牙状态
-    bt_state.command_count++;
-    bt_state.last_command = system_tick;
-    
-    Bluetooth_SendString("PARSE: Command completed successfully!\r\n");
-}
+    Thresholds_Apply();
 
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "SUCCESS: %s = %ld\r\n", names[cmd->param], (long)value);
+    Bluetooth_SendString(response);
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "%s: %ld", names[cmd->param], (long)value);
+    LCD_ShowNotification(response, 2000);
+    return BT_CMD_OK;
+}
 
 /**
- * @brief 蓝牙命令处理主函数（调试增强版）
+ * @brief 07 / ALARM ON, 08 / ALARM OFF - 启用或禁用报警
  */
-void Bluetooth_Handler(void)
+static BT_CmdStatus_t BT_Cmd_SetAlarm(const BT_CmdEntry_t *cmd, int32_t value)
 {
-#if ENABLE_BLUETOOTH
-    static uint32_t last_bluetooth_check = 0;
-    static uint32_t bt_check_counter = 0;
-    
-    // 每10ms检查一次蓝牙命令（提高响应速度）
-    if(system_tick - last_bluetooth_check >= 10)
+    alarm_disabled = (uint8_t)(cmd->param == 0);
+    if(alarm_disabled)
     {
-        last_bluetooth_check = system_tick;
-        bt_check_counter++;
-        
-        // 每500次检查输出一次调试信息（约5秒）
-        if(bt_check_counter % 500 == 0)
-        {
-            char debug_info[60];
-            sprintf(debug_info, "BT: Checking %ld, Ready=%d\r\n", bt_check_counter, bt_command_ready);
-            Bluetooth_SendString(debug_info);
-        }
-        
-        // 处理蓝牙命令
-        if(bt_command_ready)
-        {
-            // 立即确认收到命令
-            Bluetooth_SendString("BT: Command received!\r\n");
-            
-            // 显示收到的原始命令
-            Bluetooth_SendString("BT: Raw command=[");
-            Bluetooth_SendString(bt_command_buffer);
-            Bluetooth_SendString("]\r\n");
-            
-            // 处理完整命令
-            Bluetooth_SendString("BT: Parsing command...\r\n");
-            Bluetooth_ParseCommand(bt_command_buffer);
-            
-            // 清空缓冲区
-            memset(bt_command_buffer, 0, BT_CMD_BUFFER_SIZE);
-            bt_command_ready = 0;
-            
-            // 发送处理完成确认
-            Bluetooth_SendString("BT: Command processing completed!\r\n");
-        }
+        Bluetooth_SendString("SUCCESS: All Alarms DISABLED\r\n");
+        LCD_ShowNotification("Alarms DISABLED", 2000);
     }
-#endif
+    else
+    {
+        Bluetooth_SendString("SUCCESS: Alarms ENABLED\r\n");
+        LCD_ShowNotification("Alarms ENABLED", 2000);
+    }
+    return BT_CMD_OK;
 }
 
-/* =================== 主函数 =================== */
-int main(void)
+/**
+ * @brief 09 / GET ALL - 查询当前状态
+ */
+static BT_CmdStatus_t BT_Cmd_GetAll(const BT_CmdEntry_t *cmd, int32_t value)
 {
-    // 系统初始化
-    System_Init();
+    char response[100];
+    Fmt_t f;
+    Snapshot_t snap;
+
+    Snapshot_Read(&snap);
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "Status: T=%dC H=%d%% L=%d%% S=%dppm\r\n",
+            snap.sensor.temperature, snap.sensor.humidity,
+            snap.sensor.light_percent, snap.sensor.smoke_ppm_value);
+    Bluetooth_SendString(response);
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "Thresholds: TH=%d TL=%d HH=%d HL=%d LL=%d SH=%d AlarmOff=%d\r\n",
+            thresholds.temp_high, thresholds.temp_low,
+            thresholds.humi_high, thresholds.humi_low,
+            thresholds.light_low, thresholds.smoke_high, alarm_disabled);
+    Bluetooth_SendString(response);
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "System: Tick=%lu Updates=%lu\r\n",
+               (unsigned long)system_tick, (unsigned long)snap.sensor.data_update_count);
+    Bluetooth_SendString(response);
+    return BT_CMD_OK;
+}
+
+/**
+ * @brief 把当前传感器数据、报警状态和阈值填入遥测帧
+ * @param frame: 输出帧
+ * @param fields: 需要包含的字段掩码(BT_FIELD_xxx)
+ */
+void Telemetry_Fill(BT_Frame_t *frame, uint16_t fields)
+{
+    Snapshot_t snap;
+
+    Snapshot_Read(&snap);
+    frame->timestamp = system_tick;
+    frame->fields = fields;
+
+    frame->temperature = snap.sensor.temperature;
+    frame->humidity = snap.sensor.humidity;
+    frame->light_percent = snap.sensor.light_percent;
+    frame->light_raw = snap.sensor.light_raw_value;
+    frame->smoke_ppm = snap.sensor.smoke_ppm_value;
+    frame->accel_mg[0] = (int16_t)(snap.sensor.mpu_data.accel_x * 1000.0f);
+    frame->accel_mg[1] = (int16_t)(snap.sensor.mpu_data.accel_y * 1000.0f);
+    frame->accel_mg[2] = (int16_t)(snap.sensor.mpu_data.accel_z * 1000.0f);
+    frame->gyro_dps10[0] = (int16_t)(snap.sensor.mpu_data.gyro_x * 10.0f);
+    frame->gyro_dps10[1] = (int16_t)(snap.sensor.mpu_data.gyro_y * 10.0f);
+    frame->gyro_dps10[2] = (int16_t)(snap.sensor.mpu_data.gyro_z * 10.0f);
+    frame->mpu_temp_c100 = (int16_t)(snap.sensor.mpu_data.temp * 100.0f);
+    frame->status = (snap.sensor.dht11_status == 0 ? BT_STATUS_DHT11_OK : 0) |
+                    (snap.sensor.mpu_status ? BT_STATUS_MPU_OK : 0);
+
+    frame->alarms = (snap.alarm.temp_high_alarm ? BT_ALARM_TEMP_HIGH : 0) |
+                    (snap.alarm.temp_low_alarm ? BT_ALARM_TEMP_LOW : 0) |
+                    (snap.alarm.humi_high_alarm ? BT_ALARM_HUMI_HIGH : 0) |
+                    (snap.alarm.humi_low_alarm ? BT_ALARM_HUMI_LOW : 0) |
+                    (snap.alarm.light_low_alarm ? BT_ALARM_LIGHT_LOW : 0) |
+                    (snap.alarm.smoke_high_alarm ? BT_ALARM_SMOKE_HIGH : 0) |
+                    (alarm_disabled ? BT_ALARM_DISABLED : 0);
+
+    frame->temp_high = thresholds.temp_high;
+    frame->temp_low = thresholds.temp_low;
+    frame->humi_high = thresholds.humi_high;
+    frame->humi_low = thresholds.humi_low;
+    frame->light_low = thresholds.light_low;
+    frame->smoke_high = thresholds.smoke_high;
+
+    /* 姿态角取融合结果，与LCD显示一致；尚无结果时不发送该字段 */
+    if((fields & BT_FIELD_ANGLE) && snap.sensor.attitude_valid)
+    {
+        frame->roll_c100 = (int16_t)(snap.sensor.roll * 100.0f);
+        frame->pitch_c100 = (int16_t)(snap.sensor.pitch * 100.0f);
+    }
+    else
+    {
+        frame->fields &= (uint16_t)~BT_FIELD_ANGLE;
+    }
+}
+
+/**
+ * @brief 10 / GET BIN - 发送一帧包含全部字段的二进制遥测
+ */
+static BT_CmdStatus_t BT_Cmd_GetBinary(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    static uint8_t seq = 0;
+    BT_Frame_t frame;
+    uint8_t out[BT_FRAME_ENCODED_MAX];
+    uint16_t len;
+
+    Telemetry_Fill(&frame, BT_FIELD_ALL);
+    frame.seq = seq++;
+    len = BT_Frame_Encode(&frame, out);
+    Bluetooth_SendData(out, len);
+    return BT_CMD_OK;
+}
+
+/**
+ * @brief 11 / STREAM FIELDS, 12 / STREAM RATE, 13 / STREAM OFF - 订阅推送
+ */
+static BT_CmdStatus_t BT_Cmd_Stream(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    char response[60];
+    Fmt_t f;
+    uint16_t fields = bt_stream_fields;
+    uint8_t rate = bt_stream_rate;
+
+    if(cmd->param == BT_STREAM_CMD_OFF)
+    {
+        BT_Stream_Stop(&bt_stream);
+        Bluetooth_SendString("SUCCESS: Stream OFF\r\n");
+        return BT_CMD_OK;
+    }
+
+    if(cmd->param == BT_STREAM_CMD_FIELDS)
+    {
+        fields = (uint16_t)value;
+    }
+    else
+    {
+        rate = (uint8_t)value;
+    }
+
+    switch(BT_Stream_Subscribe(&bt_stream, fields, rate, system_tick))
+    {
+        case BT_STREAM_OK:
+            bt_stream_fields = fields;
+            bt_stream_rate = rate;
+            Fmt_Init(&f, response, sizeof(response));
+            Fmt_Printf(&f, "SUCCESS: Stream fields=0x%03X rate=%dHz\r\n", fields, rate);
+            Bluetooth_SendString(response);
+            return BT_CMD_OK;
+
+        case BT_STREAM_ERR_BUDGET:
+            Fmt_Init(&f, response, sizeof(response));
+            Fmt_Printf(&f, "ERROR: %d bytes x %dHz exceeds %d B/s\r\n",
+                       BT_Stream_FrameSize(fields), rate, BT_STREAM_BUDGET);
+            Bluetooth_SendString(response);
+            return BT_CMD_ERR_RANGE;
+
+        default:
+            return BT_CMD_ERR_RANGE;
+    }
+}
+
+/**
+ * @brief 遥测推送调度，在主循环中调用
+ */
+void Bluetooth_StreamPoll(void)
+{
+    BT_Frame_t sample;
+    uint8_t out[BT_FRAME_ENCODED_MAX];
+    uint16_t len;
+
+    // 没到推送时间不取数据：快照复制和换算（含姿态角）只在要发帧时做
+    if(!BT_Stream_Due(&bt_stream, system_tick))
+    {
+        return;
+    }
+
+    Telemetry_Fill(&sample, bt_stream.fields);
+    len = BT_Stream_Poll(&bt_stream, system_tick, &sample, out);
+    if(len > 0)
+    {
+        Bluetooth_SendData(out, len);
+    }
+}
+
+/**
+ * @brief 初始化蓝牙命令分发器
+ */
+void Bluetooth_CommandInit(void)
+{
+    BT_Stream_Init(&bt_stream, BT_STREAM_BUDGET);
+
+    if(BT_Cmd_Init(&bt_cmd_dispatcher, bt_cmd_table,
+                   sizeof(bt_cmd_table) / sizeof(bt_cmd_table[0])) != 0)
+    {
+        Bluetooth_SendString("ERROR: Command table invalid\r\n");
+    }
+}
+
+/**
+ * @brief 解析并执行一条蓝牙命令
+ * @param command: 命令字符串，如"01"、"01 40"、"SET TH 35"、"GET ALL"
+ */
+void Bluetooth_ParseCommand(char* command)
+{
+    const BT_CmdEntry_t *cmd;
+    BT_CmdStatus_t status;
+
+    status = BT_Cmd_Execute(&bt_cmd_dispatcher, command, &cmd);
+
+    switch(status)
+    {
+        case BT_CMD_OK:
+            // 更新蓝牙状态
+            bt_state.command_count++;
+            bt_state.last_command = system_tick;
+            break;
+
+        case BT_CMD_ERR_EMPTY:
+            Bluetooth_SendString("ERROR: Empty command\r\n");
+            break;
+
+        case BT_CMD_ERR_UNKNOWN:
+            Bluetooth_SendString("ERROR: Unknown command [");
+            Bluetooth_SendString(command);
+            Bluetooth_SendString("]\r\n");
+            Bluetooth_SendString("Valid: 00-14, RESET, SET TH|TL|HH|HL|LL|SH <n>, ALARM ON|OFF, GET ALL|BIN|TASKS, STREAM FIELDS|RATE <n>|OFF\r\n");
+            break;
+
+        case BT_CMD_ERR_ARG:
+            Bluetooth_SendString("ERROR: Bad argument for ");
+            Bluetooth_SendString((char*)cmd->name);
+            Bluetooth_SendString("\r\n");
+            break;
+
+        case BT_CMD_ERR_RANGE:
+            Bluetooth_SendString("ERROR: Value out of range for ");
+            Bluetooth_SendString((char*)cmd->name);
+            Bluetooth_SendString("\r\n");
+            break;
+
+        default:
+            Bluetooth_SendString("ERROR: Command failed\r\n");
+            break;
+    }
+}
+
+static uint32_t bt_check_counter = 0;   // 蓝牙命令检查次数
+
+/**
+ * @brief 每5秒输出一次蓝牙调试信息，由bt_debug_timer周期调用
+ */
+void Bluetooth_DebugReport(void *arg)
+{
+    char debug_info[60];
+    Fmt_t f;
     
-    // 传感器初始化
-    Sensors_Init();
+    Fmt_Init(&f, debug_info, sizeof(debug_info));
+    Fmt_Printf(&f, "BT: Checking %lu, Ready=%d\r\n", (unsigned long)bt_check_counter, bt_command_ready);
+    Bluetooth_SendString(debug_info);
+}
+
+/**
+ * @brief 记录一次蓝牙命令从收到到处理完成的延迟
+ * @param cycles: DWT周期数
+ */
+static void BT_Latency_Record(uint32_t cycles)
+{
+    uint32_t us = time_cycles_to_us(cycles);
     
+    bt_latency.count++;
+    bt_latency.last_us = us;
+    bt_latency.total_us += us;
+    if(us > bt_latency.max_us)
+    {
+        bt_latency.max_us = us;
+    }
+}
+
+/**
+ * @brief 蓝牙命令处理主函数（调试增强版），由调度器每10ms调用
+ */
+void Bluetooth_Handler(void)
+{
 #if ENABLE_BLUETOOTH
-    // 发送主循环启动确认
-    Bluetooth_SendString("MAIN: Entering main loop...\r\n");
+    bt_check_counter++;
+    
+    // 处理蓝牙命令
+    if(bt_command_ready)
+    {
+        // 立即确认收到命令
+        Bluetooth_SendString("BT: Command received!\r\n");
+        
+        // 显示收到的原始命令
+        Bluetooth_SendString("BT: Raw command=[");
+        Bluetooth_SendString(bt_command_buffer);
+        Bluetooth_SendString("]\r\n");
+        
+        // 处理完整命令
+        Bluetooth_SendString("BT: Parsing command...\r\n");
+        Bluetooth_ParseCommand(bt_command_buffer);
+        
+        // 清空缓冲区
+        memset(bt_command_buffer, 0, BT_CMD_BUFFER_SIZE);
+        bt_command_ready = 0;
+        
+        // 发送处理完成确认
+        Bluetooth_SendString("BT: Command processing completed!\r\n");
+        
+        // 从命令最后一段数据到达串口到回复全部入队
+        BT_Latency_Record(time_elapsed_cycles(bt_command_stamp, time_now_cycles()));
+    }
+#endif
+}
+
+/**
+ * @brief 系统运行指示 - LED0每2秒翻转一次
+ */
+void Heartbeat_Task(void)
+{
+    Led_Toggle(LED0);
+}
+
+/* =================== 任务调度 =================== */
+#if !ENABLE_RTOS
+// 周期(ms)、截止时间(ms，0为等于周期)、优先级(越小越优先)
+// 原超级循环每10ms把所有步骤跑一遍，这里按各自需要的频率释放
+static Sched_Task_t main_tasks[] = {
+    /* 名称     函数                  周期  截止 优先级 */
+    { "uart",   UART_Poll,            5,    0,   0 },   // 串口队列：蓝牙命令组帧、MQ-2数据帧
+#if ENABLE_BLUETOOTH
+    { "bt",     Bluetooth_Handler,    10,   0,   1 },
+#endif
+    { "key",    Key_Handler,          10,   0,   2 },
+#if ENABLE_MPU6050
+    { "imu",    Motion_Collection,    10,   0,   2 },
+#endif
+    { "data",   Data_Collection,      1000, 0,   3 },
+#if ENABLE_ALARM
+    { "alarm",  Alarm_Check,          ALARM_CHECK_MS, 0, 3 },
+#endif
+#if ENABLE_BLUETOOTH
+    { "stream", Bluetooth_StreamPoll, 10,   0,   4 },
+#endif
+    { "lcd",    Display_Update,       50,   0,   5 },
+    { "led",    Heartbeat_Task,       2000, 0,   6 },
+#if ENABLE_BLUETOOTH
+    { "status", Status_Report,        STATUS_REPORT_MS, 0, 7 },
+#endif
+};
+
+#define MAIN_TASK_COUNT     (sizeof(main_tasks) / sizeof(main_tasks[0]))
+
+static Sched_t main_sched;
+
+/**
+ * @brief 串口发送、LCD写屏和蜂鸣器播放都已完成，可以进入Stop模式
+ */
+static uint8_t Stop_Allowed(void)
+{
+#if ENABLE_STOP_MODE
+    UART_TxStats_t tx;
+    
+    UART_GetTxStats(USART2, &tx);
+    return tx.depth == 0 && USART_GetFlagStatus(USART2, USART_FLAG_TC) != RESET && lcd_idle() &&
+           !Beep_Playing();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief 没有任务就绪时睡眠到下一次任务释放或定时器到期
+ * @note  关中断后再检查并睡眠：检查之后到达的中断仍会挂起并唤醒WFI，
+ *        不会错过唤醒；醒来补偿system_tick后开中断，中断服务函数立即执行
+ */
+static void Sched_Idle(void)
+{
+    uint32_t idle, timer_idle;
+    
+    __disable_irq();
+    idle = Sched_Next_Release(&main_sched, system_tick);
+    timer_idle = Timer_Wheel_Next(&sys_timers);
+    if(timer_idle < idle)
+    {
+        idle = timer_idle;
+    }
+    Power_Idle(idle, Stop_Allowed());
+    __enable_irq();
+}
+
+/**
+ * @brief 每5秒输出主循环状态：调度次数、本周期睡眠/唤醒时间和睡眠占比
+ */
+void Status_Report(void)
+{
+#if ENABLE_BLUETOOTH
+    static uint32_t last_sleep = 0;
+    static uint32_t last_tick = 0;
+    const Power_Stats_t *pw = Power_Get_Stats();
+    uint32_t window = system_tick - last_tick;
+    uint32_t slept = pw->sleep_ms - last_sleep;
+    uint32_t runs = 0;
+    char debug_msg[80];
+    Fmt_t f;
+    uint8_t i;
+    
+    last_sleep = pw->sleep_ms;
+    last_tick = system_tick;
+    if(slept > window)
+    {
+        slept = window;
+    }
+    for(i = 0; i < MAIN_TASK_COUNT; i++)
+    {
+        runs += main_tasks[i].runs;
+    }
+    
+    Fmt_Init(&f, debug_msg, sizeof(debug_msg));
+    Fmt_Printf(&f, "MAIN: Runs %lu, Sleep %lums Awake %lums (", (unsigned long)runs,
+               (unsigned long)slept, (unsigned long)(window - slept));
+    // 睡眠占比按千分比计算，输出一位小数的百分比
+    Fmt_Fixed(&f, window ? (int32_t)((uint64_t)slept * 1000u / window) : 0, 1, 0);
+    Fmt_Printf(&f, "%%), Stop %lu, Tick %lu\r\n", (unsigned long)pw->stops, (unsigned long)system_tick);
+    Bluetooth_SendString(debug_msg);
+#endif
+}
+
+#else /* ENABLE_RTOS */
+// 各传感器、显示、蓝牙命令处理各自是一个内核任务，优先级数值越小越优先
+// 采集任务只把结果发到sensor_queue，monitor任务是sensor_data/alarm_status唯一的写者，
+// 处理完每个结果后把数据副本写入snapshot_box，显示和蓝牙只读取副本
+#define TIMER_TASK_POLL_MS      10     // 其它任务启动的定时器最多晚这么久才开始计算睡眠时间
+#define SENSOR_SEND_TIMEOUT_MS  10     // sensor_queue满时采集任务最多等待的时间(ms)
+
+// 任务表项，周期任务由Periodic_Task每period毫秒调用一次job
+typedef struct {
+    const char *name;
+    OS_Task_Func_t entry;       // 任务函数，参数是表项本身
+    void (*job)(void);          // 周期任务每次执行的函数，其它任务为NULL
+    uint32_t period;            // 周期(ms)
+    uint32_t *stack;
+    uint32_t stack_words;
+    uint8_t priority;
+    OS_Task_t tcb;
+} App_Task_t;
+
+#define STACK_WORDS(stack)      (sizeof(stack) / sizeof((stack)[0]))
+
+// 任务栈，按GET TASKS输出的余量调整
+static uint32_t bt_stack[512] __attribute__((aligned(8)));
+static uint32_t key_stack[128] __attribute__((aligned(8)));
+#if ENABLE_MPU6050
+static uint32_t imu_stack[256] __attribute__((aligned(8)));
+#endif
+static uint32_t timer_stack[384] __attribute__((aligned(8)));
+static uint32_t monitor_stack[256] __attribute__((aligned(8)));
+static uint32_t dht11_stack[192] __attribute__((aligned(8)));
+static uint32_t mq2_stack[128] __attribute__((aligned(8)));
+static uint32_t light_stack[128] __attribute__((aligned(8)));
+static uint32_t lcd_stack[384] __attribute__((aligned(8)));
+static uint32_t led_stack[128] __attribute__((aligned(8)));
+#if ENABLE_BLUETOOTH
+static uint32_t status_stack[256] __attribute__((aligned(8)));
+#endif
+
+/**
+ * @brief 周期任务：按固定周期调用job，周期不随job的执行时间漂移
+ */
+static void Periodic_Task(void *arg)
+{
+    const App_Task_t *task = (const App_Task_t *)arg;
+    uint32_t wake = OS_Now();
+    
+    while(1)
+    {
+        task->job();
+        OS_Delay_Until(&wake, task->period);
+    }
+}
+
+/**
+ * @brief 采集结果交给monitor任务，队列满时最多等待SENSOR_SEND_TIMEOUT_MS
+ */
+static void Sensor_Send(const SensorMsg_t *msg)
+{
+    OS_Queue_Send(&sensor_queue, msg, SENSOR_SEND_TIMEOUT_MS);
+}
+
+/**
+ * @brief 蓝牙：串口接收队列、命令处理和遥测推送
+ */
+static void BT_Job(void)
+{
+    UART_Poll();
+#if ENABLE_BLUETOOTH
+    Bluetooth_Handler();
+    Bluetooth_StreamPoll();
+#endif
+}
+
+#if ENABLE_MPU6050
+/**
+ * @brief 姿态：取出FIFO采样并融合，每次只发送最新一个采样，队列满时不等待
+ */
+static void IMU_Job(void)
+{
+    SensorMsg_t msg;
+    
+    if(sensor_data.mpu_status && Motion_Read(&msg))
+    {
+        OS_Queue_Send(&sensor_queue, &msg, 0);
+    }
+}
 #endif
+
+static void DHT11_Job(void)
+{
+    SensorMsg_t msg;
     
-    // 主循环 - 专注于LCD和蓝牙调试
-    uint32_t loop_counter = 0;
-    uint32_t last_debug_output = 0;
+    DHT11_Read(&msg);
+    Sensor_Send(&msg);
+}
+
+static void MQ2_Job(void)
+{
+    SensorMsg_t msg;
+    
+    MQ2_Read(&msg);
+    Sensor_Send(&msg);
+}
+
+static void Light_Job(void)
+{
+    SensorMsg_t msg;
+    
+    Light_Read(&msg);
+    Sensor_Send(&msg);
+}
+
+/**
+ * @brief 把sensor_data和alarm_status的副本写入snapshot_box
+ */
+static void Snapshot_Publish(void)
+{
+    Snapshot_t snap;
+    
+    snap.sensor = sensor_data;
+    snap.alarm = alarm_status;
+    OS_Queue_Overwrite(&snapshot_box, &snap);
+}
+
+/**
+ * @brief 汇总采集结果、检查报警并发布数据副本
+ */
+static void Monitor_Task(void *arg)
+{
+    SensorMsg_t msg;
+#if ENABLE_ALARM
+    uint32_t last_check = OS_Now();
+#endif
     
     while(1)
     {
-        loop_counter++;
-        
-        // 每5秒输出一次主循环运行状态
-        if(system_tick - last_debug_output >= 5000)
+        // 没有新结果时也按报警检查周期醒来
+        if(OS_Queue_Receive(&sensor_queue, &msg, ALARM_CHECK_MS) == 0)
         {
-            last_debug_output = system_tick;
-#if ENABLE_BLUETOOTH
-            char debug_msg[50];
-            sprintf(debug_msg, "MAIN: Loop %ld, Tick %ld\r\n", loop_counter, system_tick);
-            Bluetooth_SendString(debug_msg);
+            Sensor_Apply(&msg);
+        }
+#if ENABLE_ALARM
+        if(OS_Now() - last_check >= ALARM_CHECK_MS)
+        {
+            last_check = OS_Now();
+            Alarm_Check();
+        }
 #endif
+        Snapshot_Publish();
+    }
+}
+
+/**
+ * @brief 执行到期的软件定时器回调，睡眠到下一个定时器到期
+ */
+static void Timer_Task(void *arg)
+{
+    uint32_t idle;
+    
+    while(1)
+    {
+        Timer_Wheel_Run(&sys_timers);
+        OS_Suspend();
+        idle = Timer_Wheel_Next(&sys_timers);
+        OS_Resume();
+        if(idle > TIMER_TASK_POLL_MS)
+        {
+            idle = TIMER_TASK_POLL_MS;
         }
-        
-        // 系统运行指示 - LED每2秒闪烁一次（降低频率）
-        static uint32_t last_led_toggle = 0;
-        if(system_tick - last_led_toggle >= 2000)
+        OS_Delay(idle ? idle : 1);
+    }
+}
+
+static App_Task_t app_tasks[] = {
+    /* 名称      任务函数        周期任务        周期  栈                                      优先级 */
+    { "bt",      Periodic_Task,  BT_Job,         5,    bt_stack,      STACK_WORDS(bt_stack),      1 },
+    { "key",     Periodic_Task,  Key_Handler,    10,   key_stack,     STACK_WORDS(key_stack),     2 },
+#if ENABLE_MPU6050
+    { "imu",     Periodic_Task,  IMU_Job,        10,   imu_stack,     STACK_WORDS(imu_stack),     2 },
+#endif
+    { "timer",   Timer_Task,     0,              0,    timer_stack,   STACK_WORDS(timer_stack),   3 },
+    { "monitor", Monitor_Task,   0,              0,    monitor_stack, STACK_WORDS(monitor_stack), 3 },
+    { "dht11",   Periodic_Task,  DHT11_Job,      1000, dht11_stack,   STACK_WORDS(dht11_stack),   4 },
+    { "mq2",     Periodic_Task,  MQ2_Job,        1000, mq2_stack,     STACK_WORDS(mq2_stack),     4 },
+    { "light",   Periodic_Task,  Light_Job,      1000, light_stack,   STACK_WORDS(light_stack),   4 },
+    { "lcd",     Periodic_Task,  Display_Update, 50,   lcd_stack,     STACK_WORDS(lcd_stack),     5 },
+    { "led",     Periodic_Task,  Heartbeat_Task, 2000, led_stack,     STACK_WORDS(led_stack),     6 },
+#if ENABLE_BLUETOOTH
+    { "status",  Periodic_Task,  Status_Report,  STATUS_REPORT_MS, status_stack, STACK_WORDS(status_stack), 7 },
+#endif
+};
+
+#define APP_TASK_COUNT      (sizeof(app_tasks) / sizeof(app_tasks[0]))
+
+/**
+ * @brief 创建队列和任务并启动内核，不返回
+ */
+static void RTOS_Start(void)
+{
+    App_Task_t *t;
+    uint8_t i;
+    
+    OS_Queue_Init(&sensor_queue, sensor_queue_buf, sizeof(SensorMsg_t), SENSOR_QUEUE_LENGTH);
+    OS_Queue_Init(&snapshot_box, &snapshot_box_buf, sizeof(Snapshot_t), 1);
+    Snapshot_Publish();
+    
+    // 定时器由各任务启动、停止，由timer任务执行回调
+    Timer_Wheel_Set_Lock(&sys_timers, OS_Suspend, OS_Resume);
+    
+    for(i = 0; i < APP_TASK_COUNT; i++)
+    {
+        t = &app_tasks[i];
+        OS_Task_Create(&t->tcb, t->name, t->entry, t, t->stack, t->stack_words, t->priority);
+    }
+    OS_Start();
+}
+
+/**
+ * @brief 每5秒输出内核状态：本周期CPU占用（空闲任务以外的tick占比）、任务切换次数
+ */
+void Status_Report(void)
+{
+#if ENABLE_BLUETOOTH
+    static uint32_t last_idle = 0;
+    static uint32_t last_switches = 0;
+    static uint32_t last_tick = 0;
+    const OS_Task_t *t;
+    uint32_t now = OS_Now();
+    uint32_t window = now - last_tick;
+    uint32_t idle = 0, switches = 0, busy;
+    char debug_msg[80];
+    Fmt_t f;
+    uint8_t i;
+    
+    for(i = 0; i < OS_Task_Count(); i++)
+    {
+        t = OS_Task_Get(i);
+        switches += t->switches;
+        if(t->priority == OS_PRIO_IDLE)
         {
-            last_led_toggle = system_tick;
-            Led_Toggle(LED0);
+            idle = t->ticks;
         }
-        
-        // 数据采集 - 简化版，主要用于LCD显示
-        Data_Collection();
-        
-        // 报警检查 - 在调试模式下禁用
-#if ENABLE_ALARM
-        Alarm_Check();
+    }
+    busy = window - (idle - last_idle);
+    if(busy > window)
+    {
+        busy = window;
+    }
+    
+    Fmt_Init(&f, debug_msg, sizeof(debug_msg));
+    Fmt_Str(&f, "OS: Load ");
+    Fmt_Fixed(&f, window ? (int32_t)((uint64_t)busy * 1000u / window) : 0, 1, 0);
+    Fmt_Printf(&f, "%%, Switches %lu, Tick %lu\r\n",
+               (unsigned long)(switches - last_switches), (unsigned long)now);
+    Bluetooth_SendString(debug_msg);
+    
+    last_idle = idle;
+    last_switches = switches;
+    last_tick = now;
 #endif
-        
-        // 按键处理
-        Key_Handler();
-        
-        // 蓝牙命令处理 - 重点调试对象
-        Bluetooth_Handler();
-        
-        // 显示更新 - 重点调试对象
-        Display_Update();
-        
-        // 主循环无阻塞延时，让系统快速响应
-        delay_ms_non_blocking(10);  // 添加小延时，避免过度占用CPU
+}
+#endif /* ENABLE_RTOS */
+
+/**
+ * @brief 14 / GET TASKS - 每个任务一行，然后是软件定时器的到期次数和蓝牙命令的响应延迟
+ * @note  协作式调度：执行次数、平均/最长执行周期数、最大启动延迟(ms)、超时完成次数、丢弃的释放次数；
+ *        内核构建：优先级、栈余量/栈大小(字节)、被切换进来的次数、占用的tick数，以及传感器队列的使用情况
+ */
+static BT_CmdStatus_t BT_Cmd_GetTasks(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    char response[80];
+    Fmt_t f;
+    uint8_t i;
+#if ENABLE_RTOS
+    const OS_Task_t *t;
+
+    for(i = 0; i < OS_Task_Count(); i++)
+    {
+        t = OS_Task_Get(i);
+        Fmt_Init(&f, response, sizeof(response));
+        Fmt_Printf(&f, "%-7s p=%u stack=%lu/%lu sw=%lu ticks=%lu%s\r\n",
+                   t->name, t->priority, (unsigned long)OS_Stack_Free(t),
+                   (unsigned long)(t->stack_words * 4), (unsigned long)t->switches,
+                   (unsigned long)t->ticks, t->overflow ? " OVERFLOW" : "");
+        Bluetooth_SendString(response);
+    }
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "queue  peak=%u/%u full=%lu\r\n",
+               sensor_queue.peak, sensor_queue.length, (unsigned long)sensor_queue.full);
+    Bluetooth_SendString(response);
+#else
+    const Sched_Task_t *t;
+
+    for(i = 0; i < MAIN_TASK_COUNT; i++)
+    {
+        t = &main_tasks[i];
+        Fmt_Init(&f, response, sizeof(response));
+        Fmt_Printf(&f, "%-6s n=%lu avg=%lu max=%lu lat=%lu over=%lu skip=%lu\r\n",
+                   t->name, (unsigned long)t->runs, (unsigned long)Sched_Avg_Cycles(t),
+                   (unsigned long)t->max_cycles, (unsigned long)t->max_latency,
+                   (unsigned long)t->overruns, (unsigned long)t->skipped);
+        Bluetooth_SendString(response);
+    }
+#endif
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "timer  fired=%lu\r\n", (unsigned long)sys_timers.fired);
+    Bluetooth_SendString(response);
+    Fmt_Init(&f, response, sizeof(response));
+    Fmt_Printf(&f, "btlat  n=%lu last=%luus avg=%luus max=%luus\r\n",
+               (unsigned long)bt_latency.count, (unsigned long)bt_latency.last_us,
+               (unsigned long)(bt_latency.count ? bt_latency.total_us / bt_latency.count : 0),
+               (unsigned long)bt_latency.max_us);
+    Bluetooth_SendString(response);
+    return BT_CMD_OK;
+}
+
+/* =================== 主函数 =================== */
+int main(void)
+{
+    // 系统初始化
+    System_Init();
+    
+    // 传感器初始化
+    Sensors_Init();
+    
+#if ENABLE_BLUETOOTH
+    // 发送主循环启动确认
+    Bluetooth_SendString("MAIN: Entering main loop...\r\n");
+#endif
+    
+#if ENABLE_RTOS
+    // 之后各任务按优先级抢占运行，主栈只供中断使用
+    RTOS_Start();
+#else
+    // 主循环 - 每次执行一个就绪任务，没有就绪任务时睡眠
+    Sched_Init(&main_sched, main_tasks, MAIN_TASK_COUNT, System_Clock);
+    
+    while(1)
+    {
+        // 先执行到期的定时器回调，再执行一个就绪任务
+        if(!Timer_Wheel_Run(&sys_timers) && !Sched_Run(&main_sched))
+        {
+            Sched_Idle();
+        }
     }
+#endif
 }
@@ -30,6 +30,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f4xx_it.h"
 #include "main.h"
+#include "os_config.h"
 
 /** @addtogroup Template_Project
   * @{
@@ -107,6 +108,9 @@ void UsageFault_Handler(void)
   }
 }
 
+#if !ENABLE_RTOS
+/* With ENABLE_RTOS the kernel in SYSTEM/os.c implements SVC_Handler and PendSV_Handler */
+
 /**
   * @brief  This function handles SVCall exception.
   * @param  None
@@ -115,6 +119,7 @@ void UsageFault_Handler(void)
 void SVC_Handler(void)
 {
 }
+#endif
 
 /**
   * @brief  This function handles Debug Monitor exception.
@@ -125,6 +130,7 @@ void DebugMon_Handler(void)
 {
 }
 
+#if !ENABLE_RTOS
 /**
   * @brief  This function handles PendSVC exception.
   * @param  None
@@ -133,6 +139,7 @@ void DebugMon_Handler(void)
 void PendSV_Handler(void)
 {
 }
+#endif
 
 
 
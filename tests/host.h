@@ -0,0 +1,12 @@
+#ifndef __HOST_H
+#define __HOST_H
+
+/**
+ * @file    host.h
+ * @brief   PC端编译时替换依赖Cortex-M的宏，由CMakeLists.txt强制包含
+ */
+
+/* PC上没有__DMB，用编译器的全屏障代替 */
+#define SPSC_BARRIER()      __sync_synchronize()
+
+#endif /* __HOST_H */
@@ -0,0 +1,26 @@
+#ifndef __TEST_H
+#define __TEST_H
+
+/**
+ * @file    test.h
+ * @brief   PC端测试用的断言
+ * @details CHECK失败时打印位置并计数，不中止，TEST_EXIT按失败数返回
+ */
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+    if(!(cond)) { \
+        printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while(0)
+
+#define TEST_EXIT() do { \
+    printf("%s: %s\n", __FILE__, test_failures ? "FAILED" : "ok"); \
+    return test_failures ? 1 : 0; \
+} while(0)
+
+#endif /* __TEST_H */
@@ -0,0 +1,130 @@
+/**
+ * @file    test_adc_filter.c
+ * @brief   ADC抽取滤波器测试：各过采样倍数与直接求和比较、满量程不溢出、
+ *          抖动信号的分辨率提升、IIR阶跃响应、交织缓冲区
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "adc_filter.h"
+
+/* 与逐个累加的参考值比较 */
+static void test_sum(void)
+{
+    ADC_Decim_t d;
+    uint32_t acc, k, i;
+    uint8_t bits;
+    uint16_t s;
+
+    srand(13);
+    for(bits = 0; bits <= ADC_DECIM_BITS_MAX; bits++)
+    {
+        ADC_Decim_Init(&d, bits, 0);
+        CHECK(ADC_Decim_Get(&d) == 0 && !d.valid);
+        for(k = 0; k < 50; k++)
+        {
+            acc = 0;
+            for(i = 0; i < (1u << (2 * bits)); i++)
+            {
+                s = (uint16_t)(rand() % 4096);
+                acc += s;
+                CHECK(ADC_Decim_Feed(&d, s) == (i + 1 == (1u << (2 * bits))));
+            }
+            CHECK(ADC_Decim_Get(&d) == (bits ? (acc + (1u << (bits - 1))) >> bits : acc));
+        }
+        CHECK(d.outputs == 50);
+    }
+
+    /* 超过上限按上限 */
+    ADC_Decim_Init(&d, 9, 0);
+    CHECK(d.os_bits == ADC_DECIM_BITS_MAX && d.n == 256);
+
+    /* 满量程：16位结果不溢出，换回12位仍是4095 */
+    for(i = 0; i < 256; i++)
+    {
+        ADC_Decim_Feed(&d, 4095);
+    }
+    CHECK(ADC_Decim_Get(&d) == 65520);
+    CHECK(ADC_Decim_Get12(&d) == 4095);
+}
+
+/* 真值在两个码之间，噪声使采样在两码之间跳动，过采样后分辨出小数部分 */
+static void test_dither(void)
+{
+    ADC_Decim_t d;
+    uint32_t i;
+
+    ADC_Decim_Init(&d, 2, 0);
+    for(i = 0; i < 16; i++)
+    {
+        ADC_Decim_Feed(&d, (i % 4 == 0) ? 1001 : 1000);
+    }
+    CHECK(ADC_Decim_Get(&d) == 4001);           /* 1000.25 * 4 */
+    CHECK(ADC_Decim_Get12(&d) == 1000);
+
+    ADC_Decim_Init(&d, 2, 0);
+    for(i = 0; i < 16; i++)
+    {
+        ADC_Decim_Feed(&d, 1000 + (i & 1));
+    }
+    CHECK(ADC_Decim_Get(&d) == 4002);           /* 1000.5 * 4 */
+    CHECK(ADC_Decim_Get12(&d) == 1001);
+}
+
+/* IIR：第一个输出直接作为初值，之后单调逼近阶跃的终值 */
+static void test_iir(void)
+{
+    ADC_Decim_t d;
+    uint16_t last, i, k;
+
+    ADC_Decim_Init(&d, 0, 2);
+    ADC_Decim_Feed(&d, 2000);
+    CHECK(ADC_Decim_Get(&d) == 2000);
+
+    last = 2000;
+    for(k = 0; k < 40; k++)
+    {
+        ADC_Decim_Feed(&d, 3000);
+        CHECK(ADC_Decim_Get(&d) >= last && ADC_Decim_Get(&d) <= 3000);
+        last = ADC_Decim_Get(&d);
+        if(k == 0)
+        {
+            CHECK(last == 2250);                /* 走了差值的1/4 */
+        }
+    }
+    CHECK(last == 3000);
+
+    /* 输入不变时输出稳定，不会因截断漂移 */
+    for(i = 0; i < 100; i++)
+    {
+        ADC_Decim_Feed(&d, 3000);
+    }
+    CHECK(ADC_Decim_Get(&d) == 3000);
+}
+
+/* 交织缓冲区：只取本通道的采样 */
+static void test_block(void)
+{
+    ADC_Decim_t d;
+    uint16_t buf[3 * 32];
+    uint16_t i;
+
+    for(i = 0; i < 3 * 32; i++)
+    {
+        buf[i] = (i % 3 == 1) ? 1234 : 4095;
+    }
+    ADC_Decim_Init(&d, 2, 0);
+    CHECK(ADC_Decim_FeedBlock(&d, buf + 1, 3, 32) == 2);
+    CHECK(ADC_Decim_Get(&d) == 1234 * 4);
+    CHECK(ADC_Decim_FeedBlock(&d, buf + 1, 3, 8) == 0);
+    CHECK(d.count == 8);
+}
+
+int main(void)
+{
+    test_sum();
+    test_dither();
+    test_iir();
+    test_block();
+    TEST_EXIT();
+}
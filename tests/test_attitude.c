@@ -0,0 +1,322 @@
+/**
+ * @file    test_attitude.c
+ * @brief   姿态解算测试：atan2和1/sqrt近似与libm比较的误差、加速度计倾角、
+ *          互补滤波的收敛、陀螺仪零偏、振动剔除和±180°回绕、与双精度参考滤波器的偏差；
+ *          最后打印近似函数与libm在本机上的耗时（只作参考，不作断言）
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <time.h>
+#include "test.h"
+#include "attitude.h"
+
+static void test_atan2(void)
+{
+    double err, max_err = 0;
+    float y, x;
+    int i, j;
+
+    for(i = -500; i <= 500; i++)
+    {
+        for(j = -500; j <= 500; j++)
+        {
+            y = i * 0.0137f;
+            x = j * 0.0113f;
+            if(i == 0 && j == 0)
+            {
+                continue;
+            }
+            err = fabs((double)Attitude_Atan2(y, x) - atan2((double)y, (double)x));
+            if(err > max_err)
+            {
+                max_err = err;
+            }
+        }
+    }
+    printf("  atan2 max error %.2e rad\n", max_err);
+    CHECK(max_err < 1.5e-5);
+    CHECK(Attitude_Atan2(0.0f, 0.0f) == 0.0f);
+    CHECK(fabsf(Attitude_Atan2(1.0f, 0.0f) - ATTITUDE_PI / 2) < 1e-6f);
+    CHECK(fabsf(Attitude_Atan2(0.0f, -1.0f) - ATTITUDE_PI) < 1e-6f);
+}
+
+static void test_invsqrt(void)
+{
+    double err, max_err = 0;
+    float x;
+
+    for(x = 1e-4f; x < 1e4f; x *= 1.001f)
+    {
+        err = fabs(Attitude_InvSqrt(x) * sqrt((double)x) - 1.0);
+        if(err > max_err)
+        {
+            max_err = err;
+        }
+    }
+    printf("  invsqrt max relative error %.2e\n", max_err);
+    CHECK(max_err < 1e-5);
+}
+
+/* 按已知倾角构造重力向量，反算的角度与之一致 */
+static void test_accel_angles(void)
+{
+    float roll, pitch, r, p;
+    double max_err = 0;
+    int i, j;
+
+    for(i = -179; i <= 179; i += 7)
+    {
+        for(j = -89; j <= 89; j += 7)
+        {
+            r = i / ATTITUDE_RAD2DEG;
+            p = j / ATTITUDE_RAD2DEG;
+            Attitude_Accel_Angles(-sinf(p), cosf(p) * sinf(r), cosf(p) * cosf(r), &roll, &pitch);
+            max_err = fmax(max_err, fabs(roll - i));
+            max_err = fmax(max_err, fabs(pitch - j));
+        }
+    }
+    printf("  accel angle max error %.2e deg\n", max_err);
+    CHECK(max_err < 1e-3);
+
+    /* 量纲无关：原始LSB输入得到同样的角度 */
+    Attitude_Accel_Angles(0.0f, 8192.0f, 8192.0f, &roll, &pitch);
+    CHECK(fabsf(roll - 45.0f) < 1e-3f && fabsf(pitch) < 1e-3f);
+}
+
+static void test_filter(void)
+{
+    Attitude_t a;
+    int i;
+
+    /* 第一个有效采样直接作为初值；之前的异常采样不初始化 */
+    Attitude_Init(&a, 1000.0f, 0.5f);
+    Attitude_Update(&a, 0.0f, 0.0f, 3.0f, 0.0f, 0.0f);
+    CHECK(!a.valid);
+    Attitude_Update(&a, 0.0f, 0.5f, 0.8660254f, 0.0f, 0.0f);
+    CHECK(a.valid && fabsf(a.roll - 30.0f) < 1e-3f);
+
+    /* 静止时陀螺仪有1°/s零偏：积分漂移被加速度计拉住，稳态误差约bias*tau */
+    for(i = 0; i < 20000; i++)
+    {
+        Attitude_Update(&a, 0.0f, 0.5f, 0.8660254f, 1.0f, -1.0f);
+    }
+    printf("  steady state with 1 deg/s bias: roll %.4f pitch %.4f\n", a.roll, a.pitch);
+    CHECK(fabsf(a.roll - 30.0f - 0.5f) < 0.01f);
+    CHECK(fabsf(a.pitch + 0.5f) < 0.01f);
+
+    /* 振动：模长超出1g±30%时只积分陀螺仪，计入rejected */
+    Attitude_Update(&a, 0.0f, 1.0f, 1.5f, 0.0f, 0.0f);
+    CHECK(a.rejected == 1);
+
+    /* 匀速转动：陀螺仪与加速度计一致时跟踪误差很小 */
+    Attitude_Init(&a, 500.0f, 0.5f);
+    for(i = 0; i <= 500; i++)
+    {
+        float r = (i * 0.1f) / ATTITUDE_RAD2DEG;
+        Attitude_Update(&a, 0.0f, sinf(r), cosf(r), 50.0f, 0.0f);
+    }
+    CHECK(fabsf(a.roll - 50.0f) < 0.05f);
+
+    /* 横滚穿过180°回绕到-180°，不会从另一侧绕远路 */
+    Attitude_Init(&a, 100.0f, 0.5f);
+    for(i = 0; i <= 100; i++)
+    {
+        float r = (175.0f + i * 0.1f) / ATTITUDE_RAD2DEG;
+        Attitude_Update(&a, 0.0f, sinf(r), cosf(r), 10.0f, 0.0f);
+        CHECK(a.roll <= 180.0f && a.roll >= -180.0f);
+    }
+    CHECK(fabsf(a.roll - (185.0f - 360.0f)) < 0.05f);
+}
+
+/* 双精度参考实现：与Attitude_Update同样的算法，atan2和sqrt用libm */
+typedef struct {
+    double roll;
+    double pitch;
+    double dt;
+    double alpha;
+    int valid;
+} RefAttitude_t;
+
+static double ref_wrap(double deg)
+{
+    if(deg > 180.0)
+    {
+        deg -= 360.0;
+    }
+    else if(deg < -180.0)
+    {
+        deg += 360.0;
+    }
+    return deg;
+}
+
+static void ref_update(RefAttitude_t *r, double ax, double ay, double az, double gx, double gy)
+{
+    double norm = sqrt(ax * ax + ay * ay + az * az);
+    double roll_acc = atan2(ay, az) * 180.0 / M_PI;
+    double pitch_acc = atan2(-ax, sqrt(ay * ay + az * az)) * 180.0 / M_PI;
+    int accel_ok = (norm >= 1.0 - ATTITUDE_ACCEL_TOL && norm <= 1.0 + ATTITUDE_ACCEL_TOL);
+
+    if(!r->valid)
+    {
+        if(accel_ok)
+        {
+            r->roll = roll_acc;
+            r->pitch = pitch_acc;
+            r->valid = 1;
+        }
+        return;
+    }
+    r->roll = ref_wrap(r->roll + gx * r->dt);
+    r->pitch += gy * r->dt;
+    if(accel_ok)
+    {
+        r->roll = ref_wrap(r->roll + (1.0 - r->alpha) * ref_wrap(roll_acc - r->roll));
+        r->pitch += (1.0 - r->alpha) * (pitch_acc - r->pitch);
+    }
+}
+
+/* 真实姿态：倾斜斜坡、保持、振荡，横滚最后一段穿过180° */
+static void truth(double t, double *roll, double *pitch)
+{
+    if(t < 5.0)
+    {
+        *roll = 12.0 * t;                       /* 0 -> 60° */
+        *pitch = -6.0 * t;                      /* 0 -> -30° */
+    }
+    else if(t < 10.0)
+    {
+        *roll = 60.0 - 24.0 * (t - 5.0);        /* 60 -> -60° */
+        *pitch = -30.0 + 15.0 * (t - 5.0);      /* -30 -> 45° */
+    }
+    else if(t < 20.0)
+    {
+        *roll = -60.0 + 25.0 * sin(2.0 * M_PI * 1.5 * (t - 10.0));
+        *pitch = 45.0 - 15.0 * (t - 10.0) / 10.0 + 10.0 * sin(2.0 * M_PI * 0.7 * (t - 10.0));
+    }
+    else
+    {
+        *roll = ref_wrap(-60.0 - 30.0 * (t - 20.0));    /* 经过-180°回绕 */
+        *pitch = 30.0 * cos(2.0 * M_PI * 0.2 * (t - 20.0));
+    }
+}
+
+/* 同样的陀螺仪+加速度计序列（含零偏和噪声）分别送入单精度近似滤波器和双精度参考滤波器 */
+static void test_reference(void)
+{
+    const double rate = 200.0, dt = 1.0 / rate, tau = 0.5;
+    const double bias_x = 1.5, bias_y = -2.0;
+    Attitude_t a;
+    RefAttitude_t r;
+    double t, roll, pitch, roll_next, pitch_next, gx, gy, err;
+    double max_roll = 0, max_pitch = 0;
+    float ax, ay, az;
+    int i, n = (int)(30.0 * rate);
+
+    Attitude_Init(&a, (float)rate, (float)tau);
+    r.roll = 0;
+    r.pitch = 0;
+    r.dt = a.dt;
+    r.alpha = a.alpha;
+    r.valid = 0;
+    srand(3);
+
+    for(i = 0; i < n; i++)
+    {
+        t = i * dt;
+        truth(t, &roll, &pitch);
+        truth(t + dt, &roll_next, &pitch_next);
+        gx = ref_wrap(roll_next - roll) * rate + bias_x + (rand() % 201 - 100) * 0.005;
+        gy = (pitch_next - pitch) * rate + bias_y + (rand() % 201 - 100) * 0.005;
+        ax = (float)(-sin(pitch * M_PI / 180.0) + (rand() % 201 - 100) * 2e-4);
+        ay = (float)(cos(pitch * M_PI / 180.0) * sin(roll * M_PI / 180.0) + (rand() % 201 - 100) * 2e-4);
+        az = (float)(cos(pitch * M_PI / 180.0) * cos(roll * M_PI / 180.0) + (rand() % 201 - 100) * 2e-4);
+        /* 偶尔有振动采样，两边都应跳过修正 */
+        if(i % 97 == 50)
+        {
+            ax *= 1.6f;
+            ay *= 1.6f;
+            az *= 1.6f;
+        }
+
+        Attitude_Update(&a, ax, ay, az, (float)gx, (float)gy);
+        ref_update(&r, ax, ay, az, (float)gx, (float)gy);
+        CHECK(a.valid == r.valid);
+
+        err = fabs(ref_wrap(a.roll - r.roll));
+        if(err > max_roll)
+        {
+            max_roll = err;
+        }
+        err = fabs(a.pitch - r.pitch);
+        if(err > max_pitch)
+        {
+            max_pitch = err;
+        }
+    }
+    printf("  vs double reference: max roll error %.2e deg, pitch %.2e deg\n", max_roll, max_pitch);
+    CHECK(max_roll < 0.005);
+    CHECK(max_pitch < 0.005);
+
+    /* 参考滤波器本身跟得上真实姿态（零偏造成约bias*tau的稳态偏差） */
+    truth((n - 1) * dt, &roll, &pitch);
+    CHECK(fabs(ref_wrap(r.roll - roll)) < 3.0);
+    CHECK(fabs(r.pitch - pitch) < 3.0);
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 本机上的相对耗时，供对比；M4F上的数字以DWT测量为准 */
+static void bench(void)
+{
+    volatile float sink = 0;
+    double t0, t1, t2;
+    int i;
+
+    t0 = seconds();
+    for(i = 0; i < 2000000; i++)
+    {
+        sink += Attitude_Atan2(i * 1e-6f - 1.0f, 0.7f);
+    }
+    t1 = seconds();
+    for(i = 0; i < 2000000; i++)
+    {
+        sink += atan2f(i * 1e-6f - 1.0f, 0.7f);
+    }
+    t2 = seconds();
+    printf("  atan2: approx %.1f ns, libm %.1f ns per call\n",
+           (t1 - t0) * 1e9 / 2000000, (t2 - t1) * 1e9 / 2000000);
+
+    t0 = seconds();
+    for(i = 0; i < 2000000; i++)
+    {
+        sink += Attitude_InvSqrt(i * 1e-3f + 0.1f);
+    }
+    t1 = seconds();
+    for(i = 0; i < 2000000; i++)
+    {
+        sink += 1.0f / sqrtf(i * 1e-3f + 0.1f);
+    }
+    t2 = seconds();
+    printf("  invsqrt: approx %.1f ns, libm %.1f ns per call\n",
+           (t1 - t0) * 1e9 / 2000000, (t2 - t1) * 1e9 / 2000000);
+    (void)sink;
+}
+
+int main(void)
+{
+    test_atan2();
+    test_invsqrt();
+    test_accel_angles();
+    test_filter();
+    test_reference();
+    bench();
+    TEST_EXIT();
+}
@@ -0,0 +1,132 @@
+/**
+ * @file    test_beep_tone.c
+ * @brief   蜂鸣器音调参数测试：频率误差、PSC/ARR范围、占空比、超出范围，以及音符时长换算的夹紧
+ */
+
+#include <math.h>
+#include "test.h"
+#include "beep_tone.h"
+
+static void test_calc(void)
+{
+    static const uint32_t clks[] = { 168000000, 84000000, 42000000, 16000000, 1000000 };
+    Beep_Tone_t t;
+    double n, ideal, err, worst = 0;
+    uint32_t c, f;
+    uint8_t r;
+
+    for(c = 0; c < sizeof(clks) / sizeof(clks[0]); c++)
+    {
+        for(f = 1; f <= 30000; f++)
+        {
+            r = Beep_Tone_Calc(clks[c], f, 50, &t);
+            if(clks[c] / f < BEEP_TONE_PERIOD_MIN)
+            {
+                CHECK(r == 1);
+                continue;
+            }
+            CHECK(r == 0);
+            CHECK(t.arr <= BEEP_TONE_ARR_MAX);
+
+            /* 周期的时钟数与理想值相差不超过这个PSC下能做到的最好结果 */
+            n = (double)(t.psc + 1) * (t.arr + 1);
+            ideal = (double)clks[c] / f;
+            CHECK(fabs(n - ideal) <= (t.psc + 1) / 2.0 + 0.5 + 1e-9);
+            /* PSC最小：再小一级ARR就放不下 */
+            CHECK(t.psc == 0 || ideal / t.psc > BEEP_TONE_ARR_MAX + 0.5);
+            /* 50%占空比 */
+            CHECK(fabs(t.ccr * 2.0 - (t.arr + 1)) <= 1.0);
+
+            if(f >= 20 && f <= 20000 && clks[c] >= 16000000)
+            {
+                err = fabs(clks[c] / n - f) / f;
+                if(err > worst)
+                {
+                    worst = err;
+                }
+            }
+        }
+    }
+    /* 定时器时钟不低于16MHz时，音频范围内频率误差不超过0.1% */
+    CHECK(worst < 1e-3);
+
+    /* 超出范围 */
+    CHECK(Beep_Tone_Calc(84000000, 0, 50, &t) == 1);
+    CHECK(Beep_Tone_Calc(84000000, 84000000 / BEEP_TONE_PERIOD_MIN + 1, 50, &t) == 1);
+    CHECK(Beep_Tone_Calc(84000000, 84000000 / BEEP_TONE_PERIOD_MIN, 50, &t) == 0);
+    CHECK(t.psc == 0 && t.arr == BEEP_TONE_PERIOD_MIN - 1);
+    /* 最低频率：PSC到65535时一个周期仍放不下 */
+    CHECK(Beep_Tone_Calc(0xFFFFFFFFu, 1, 50, &t) == 1);
+    CHECK(Beep_Tone_Calc(65536u * 65535u, 1, 50, &t) == 0 && t.psc == 65535);
+}
+
+static void test_duty(void)
+{
+    Beep_Tone_t t;
+    uint32_t d, dd;
+
+    for(d = 0; d <= 120; d++)
+    {
+        CHECK(Beep_Tone_Calc(84000000, 262, (uint8_t)d, &t) == 0);
+        dd = d > 100 ? 100 : d;
+        /* 四舍五入到最近的比较值 */
+        CHECK(fabs((double)t.ccr / (t.arr + 1) - dd / 100.0) <= 0.5 / (t.arr + 1) + 1e-12);
+        if(dd == 0)
+        {
+            CHECK(t.ccr == 0);
+        }
+        if(dd == 100)
+        {
+            /* CCR = ARR+1，输出恒为高 */
+            CHECK(t.ccr == t.arr + 1);
+        }
+    }
+}
+
+static void test_ticks(void)
+{
+    uint32_t ms, e;
+
+    CHECK(Beep_Tone_Ticks(2000, 0) == 2);
+    CHECK(Beep_Tone_Ticks(2000, 200) == 400);
+    CHECK(Beep_Tone_Ticks(2000, 32767) == 65534);
+    CHECK(Beep_Tone_Ticks(2000, 32768) == 65536);
+    CHECK(Beep_Tone_Ticks(2000, 40000) == 65536);
+    CHECK(Beep_Tone_Ticks(10000, 1) == 10);
+    /* 不足两个计数按两个，四舍五入 */
+    CHECK(Beep_Tone_Ticks(1000, 1) == 2);
+    CHECK(Beep_Tone_Ticks(1, 1499) == 2);
+    CHECK(Beep_Tone_Ticks(1, 2500) == 3);
+    /* 整秒部分乘法会溢出的时长走饱和分支 */
+    CHECK(Beep_Tone_Ticks(2000, 0xFFFFFFFFu) == 65536);
+    CHECK(Beep_Tone_Ticks(1000000, 0xFFFFFFFFu) == 65536);
+    CHECK(Beep_Tone_Ticks(1000000, 65) == 65000);
+    CHECK(Beep_Tone_Ticks(1000000, 66) == 65536);
+    CHECK(Beep_Tone_Ticks(100000, 999) == 65536);
+
+    for(ms = 0; ms < 100000; ms++)
+    {
+        e = ms * 2;
+        if(e < 2)
+        {
+            e = 2;
+        }
+        if(e > 65536)
+        {
+            e = 65536;
+        }
+        if(Beep_Tone_Ticks(2000, ms) != e)
+        {
+            CHECK(Beep_Tone_Ticks(2000, ms) == e);
+            break;
+        }
+    }
+}
+
+int main(void)
+{
+    test_calc();
+    test_duty();
+    test_ticks();
+    TEST_EXIT();
+}
@@ -0,0 +1,194 @@
+/**
+ * @file    test_bt_cmd.c
+ * @brief   蓝牙命令分发器测试：数字/文字命令、参数解析、范围检查和建表错误；
+ *          最后打印整张命令表加未知命令的分发耗时（只作参考，不作断言）
+ */
+
+#include <time.h>
+#include "test.h"
+#include "bt_cmd.h"
+
+static int32_t last_value;
+static int last_param;
+static int calls;
+
+static BT_CmdStatus_t record(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    last_value = value;
+    last_param = cmd->param;
+    calls++;
+    return BT_CMD_OK;
+}
+
+static BT_CmdStatus_t fail(const BT_CmdEntry_t *cmd, int32_t value)
+{
+    (void)cmd;
+    (void)value;
+    return BT_CMD_ERR_FAIL;
+}
+
+static const BT_CmdEntry_t table[] = {
+    {"RESET",       0,                  0, 0,   0,       0,    record},
+    {"SET TH",      1,                  1, 35,  0,       99,   record},
+    {"SET HH",      2,                  2, 80,  0,       100,  record},
+    {"SET SH",      6,                  6, 200, 0,       9999, record},
+    {"ALARM OFF",   8,                  8, 0,   0,       0,    record},
+    {"GET ALL",     9,                  9, 0,   0,       0,    record},
+    {"GET TASKS",   BT_CMD_NO_OPCODE,   10, 0,  0,       0,    record},
+    {"SET OFFSET",  BT_CMD_NO_OPCODE,   11, 0,  -1000,   1000, record},
+    {"SELFTEST",    20,                 20, 0,  0,       0,    fail},
+};
+#define TABLE_COUNT     (sizeof(table) / sizeof(table[0]))
+
+/* 执行一条命令，返回结果，并检查成功时处理函数收到的参数 */
+static BT_CmdStatus_t run(BT_CmdDispatcher_t *d, const char *line, int param, int32_t value)
+{
+    const BT_CmdEntry_t *m;
+    BT_CmdStatus_t s;
+    int before = calls;
+
+    last_value = -12345;
+    s = BT_Cmd_Execute(d, line, &m);
+    if(s == BT_CMD_OK)
+    {
+        CHECK(calls == before + 1);
+        CHECK(m != 0 && m->param == param);
+        CHECK(last_param == param && last_value == value);
+    }
+    else if(s == BT_CMD_ERR_UNKNOWN || s == BT_CMD_ERR_EMPTY)
+    {
+        CHECK(m == 0);
+    }
+    return s;
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 本机上的分发耗时：表中每条命令的名称、数字形式和带参数形式，加上各类未知命令 */
+static void bench(void)
+{
+    static const char *unknown[] = {
+        "07", "99", "SET", "SET TX 5", "GET ALLX", "FOO",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ", "RESET NOW",
+    };
+    char lines[TABLE_COUNT * 3 + sizeof(unknown) / sizeof(unknown[0])][32];
+    BT_CmdDispatcher_t d;
+    const BT_CmdEntry_t *m;
+    uint32_t i, n = 0, rounds = 100000;
+    uint32_t ok = 0;
+    double t0, t1;
+
+    CHECK(BT_Cmd_Init(&d, table, TABLE_COUNT) == 0);
+    for(i = 0; i < TABLE_COUNT; i++)
+    {
+        snprintf(lines[n++], sizeof(lines[0]), "%s", table[i].name);
+        snprintf(lines[n++], sizeof(lines[0]), "%s %ld", table[i].name, (long)table[i].max_value);
+        if(table[i].opcode != BT_CMD_NO_OPCODE)
+        {
+            snprintf(lines[n++], sizeof(lines[0]), "%02d", table[i].opcode);
+        }
+    }
+    for(i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++)
+    {
+        snprintf(lines[n++], sizeof(lines[0]), "%s", unknown[i]);
+    }
+
+    t0 = seconds();
+    for(i = 0; i < rounds * n; i++)
+    {
+        if(BT_Cmd_Execute(&d, lines[i % n], &m) == BT_CMD_OK)
+        {
+            ok++;
+        }
+    }
+    t1 = seconds();
+    CHECK(d.executed + d.errors == rounds * n);
+    CHECK(d.executed == ok);
+    printf("  dispatch: %u lines (%u ok per round), %.1f ns per command, %.2f M commands/s\n",
+           (unsigned)n, (unsigned)(ok / rounds), (t1 - t0) * 1e9 / (rounds * n),
+           rounds * n / (t1 - t0) * 1e-6);
+}
+
+int main(void)
+{
+    BT_CmdDispatcher_t d;
+    uint32_t i;
+
+    CHECK(BT_Cmd_Init(&d, table, TABLE_COUNT) == 0);
+
+    /* 两位数字兼容命令 */
+    CHECK(run(&d, "01", 1, 35) == BT_CMD_OK);
+    CHECK(run(&d, "01 40", 1, 40) == BT_CMD_OK);
+    CHECK(run(&d, "  06   1234  ", 6, 1234) == BT_CMD_OK);
+    CHECK(run(&d, "00", 0, 0) == BT_CMD_OK);
+    CHECK(run(&d, "07", 0, 0) == BT_CMD_ERR_UNKNOWN);
+    CHECK(run(&d, "01 100", 0, 0) == BT_CMD_ERR_RANGE);
+    CHECK(run(&d, "09 1", 0, 0) == BT_CMD_ERR_RANGE);
+    CHECK(run(&d, "01 4x", 0, 0) == BT_CMD_ERR_ARG);
+
+    /* 文字命令：大小写不敏感，多余空格合并 */
+    CHECK(run(&d, "SET TH 50", 1, 50) == BT_CMD_OK);
+    CHECK(run(&d, "set  th 51", 1, 51) == BT_CMD_OK);
+    CHECK(run(&d, "Set Th", 1, 35) == BT_CMD_OK);
+    CHECK(run(&d, "alarm off", 8, 0) == BT_CMD_OK);
+    CHECK(run(&d, "GET TASKS", 10, 0) == BT_CMD_OK);
+    CHECK(run(&d, "SET OFFSET -250", 11, -250) == BT_CMD_OK);
+    CHECK(run(&d, "SET OFFSET +7", 11, 7) == BT_CMD_OK);
+    CHECK(run(&d, "SET OFFSET -1001", 0, 0) == BT_CMD_ERR_RANGE);
+    CHECK(run(&d, "SET TH 1234567890", 0, 0) == BT_CMD_ERR_ARG);
+    CHECK(run(&d, "SET TH 5 6", 0, 0) == BT_CMD_ERR_ARG);
+    CHECK(run(&d, "SET TH -", 0, 0) == BT_CMD_ERR_ARG);
+
+    /* 未知命令：前缀、多出的单词、超长名称都不能误匹配 */
+    CHECK(run(&d, "SET", 0, 0) == BT_CMD_ERR_UNKNOWN);
+    CHECK(run(&d, "SET TH X", 0, 0) == BT_CMD_ERR_UNKNOWN);
+    CHECK(run(&d, "GET ALLX", 0, 0) == BT_CMD_ERR_UNKNOWN);
+    CHECK(run(&d, "FOO", 0, 0) == BT_CMD_ERR_UNKNOWN);
+    CHECK(run(&d, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 0, 0) == BT_CMD_ERR_UNKNOWN);
+    CHECK(run(&d, "", 0, 0) == BT_CMD_ERR_EMPTY);
+    CHECK(run(&d, "   ", 0, 0) == BT_CMD_ERR_EMPTY);
+
+    /* 处理函数返回的错误原样返回 */
+    CHECK(run(&d, "SELFTEST", 0, 0) == BT_CMD_ERR_FAIL);
+    CHECK(run(&d, "20", 0, 0) == BT_CMD_ERR_FAIL);
+
+    /* 每个表项都能按名称找到 */
+    for(i = 0; i < TABLE_COUNT; i++)
+    {
+        const BT_CmdEntry_t *m;
+        BT_Cmd_Execute(&d, table[i].name, &m);
+        CHECK(m == &table[i]);
+    }
+
+    /* 统计：上面成功11条、失败17条，再加遍历表项时成功8条、失败1条 */
+    CHECK(d.executed == 11 + 8);
+    CHECK(d.errors == 17 + 1);
+
+    /* 建表错误：重复名称、重复编号、编号越界、命令太多 */
+    {
+        static const BT_CmdEntry_t dup_name[] = {
+            {"GET ALL", 1, 0, 0, 0, 0, record},
+            {"GET ALL", 2, 0, 0, 0, 0, record},
+        };
+        static const BT_CmdEntry_t dup_op[] = {
+            {"A", 3, 0, 0, 0, 0, record},
+            {"B", 3, 0, 0, 0, 0, record},
+        };
+        static const BT_CmdEntry_t bad_op[] = {
+            {"A", 100, 0, 0, 0, 0, record},
+        };
+        CHECK(BT_Cmd_Init(&d, dup_name, 2) == 1);
+        CHECK(BT_Cmd_Init(&d, dup_op, 2) == 1);
+        CHECK(BT_Cmd_Init(&d, bad_op, 1) == 1);
+        CHECK(BT_Cmd_Init(&d, table, BT_CMD_HASH_SLOTS / 2 + 1) == 1);
+    }
+
+    bench();
+    TEST_EXIT();
+}
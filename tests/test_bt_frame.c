@@ -0,0 +1,219 @@
+/**
+ * @file    test_bt_frame.c
+ * @brief   遥测帧测试：CRC16标准值、COBS往返、各字段组合的编解码和接收分帧
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "bt_frame.h"
+
+/* 只比较mask中包含的字段 */
+static int frame_equal(const BT_Frame_t *a, const BT_Frame_t *b, uint16_t mask)
+{
+    int i;
+
+    if(a->seq != b->seq || a->timestamp != b->timestamp || a->fields != b->fields)
+        return 0;
+    if((mask & BT_FIELD_TEMP) && a->temperature != b->temperature)
+        return 0;
+    if((mask & BT_FIELD_HUMI) && a->humidity != b->humidity)
+        return 0;
+    if((mask & BT_FIELD_LIGHT) && (a->light_percent != b->light_percent || a->light_raw != b->light_raw))
+        return 0;
+    if((mask & BT_FIELD_SMOKE) && a->smoke_ppm != b->smoke_ppm)
+        return 0;
+    for(i = 0; i < 3; i++)
+    {
+        if((mask & BT_FIELD_ACCEL) && a->accel_mg[i] != b->accel_mg[i])
+            return 0;
+        if((mask & BT_FIELD_GYRO) && a->gyro_dps10[i] != b->gyro_dps10[i])
+            return 0;
+    }
+    if((mask & BT_FIELD_MPU_TEMP) && a->mpu_temp_c100 != b->mpu_temp_c100)
+        return 0;
+    if((mask & BT_FIELD_STATUS) && a->status != b->status)
+        return 0;
+    if((mask & BT_FIELD_ALARMS) && a->alarms != b->alarms)
+        return 0;
+    if((mask & BT_FIELD_THRESHOLDS) &&
+       (a->temp_high != b->temp_high || a->temp_low != b->temp_low || a->humi_high != b->humi_high ||
+        a->humi_low != b->humi_low || a->light_low != b->light_low || a->smoke_high != b->smoke_high))
+        return 0;
+    if((mask & BT_FIELD_ANGLE) && (a->roll_c100 != b->roll_c100 || a->pitch_c100 != b->pitch_c100))
+        return 0;
+    return 1;
+}
+
+static void random_frame(BT_Frame_t *f, uint16_t mask)
+{
+    int i;
+
+    f->seq = (uint8_t)rand();
+    f->timestamp = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    f->fields = mask;
+    f->temperature = (uint8_t)rand();
+    f->humidity = (uint8_t)rand();
+    f->light_percent = (uint8_t)rand();
+    f->light_raw = (uint16_t)rand();
+    f->smoke_ppm = (uint16_t)rand();
+    for(i = 0; i < 3; i++)
+    {
+        f->accel_mg[i] = (int16_t)rand();
+        f->gyro_dps10[i] = (int16_t)rand();
+    }
+    f->mpu_temp_c100 = (int16_t)rand();
+    f->status = (uint8_t)rand();
+    f->alarms = (uint8_t)rand();
+    f->temp_high = (uint8_t)rand();
+    f->temp_low = (uint8_t)rand();
+    f->humi_high = (uint8_t)rand();
+    f->humi_low = (uint8_t)rand();
+    f->light_low = (uint8_t)rand();
+    f->smoke_high = (uint16_t)rand();
+    f->roll_c100 = (int16_t)rand();
+    f->pitch_c100 = (int16_t)rand();
+}
+
+static void test_crc(void)
+{
+    const uint8_t check[] = "123456789";
+
+    /* CRC-16/CCITT-FALSE的标准校验值 */
+    CHECK(BT_Frame_Crc16(0xFFFF, check, 9) == 0x29B1);
+    /* 分段计算与一次计算相同 */
+    CHECK(BT_Frame_Crc16(BT_Frame_Crc16(0xFFFF, check, 4), check + 4, 5) == 0x29B1);
+    CHECK(BT_Frame_Crc16(0xFFFF, check, 0) == 0xFFFF);
+}
+
+static void test_cobs(void)
+{
+    static uint8_t src[1100], enc[1200], dec[1200];
+    const uint16_t edges[] = {1, 2, 253, 254, 255, 256, 507, 508, 509, 1024};
+    uint16_t n, e, i;
+    int it, k;
+
+    /* 随机数据，约三分之一是0 */
+    for(it = 0; it < 5000; it++)
+    {
+        n = (uint16_t)(1 + rand() % 600);
+        for(i = 0; i < n; i++)
+        {
+            src[i] = (rand() % 3 == 0) ? 0 : (uint8_t)rand();
+        }
+        e = BT_Frame_CobsEncode(src, n, enc);
+        CHECK(e <= n + n / 254 + 1);
+        CHECK(memchr(enc, 0, e) == 0);
+        CHECK(BT_Frame_CobsDecode(enc, e, dec) == n && memcmp(src, dec, n) == 0);
+    }
+
+    /* 254字节分组边界，全非0和全0两种极端 */
+    for(k = 0; k < 2; k++)
+    {
+        for(i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+        {
+            n = edges[i];
+            memset(src, k ? 0 : 0x5A, n);
+            e = BT_Frame_CobsEncode(src, n, enc);
+            CHECK(e <= n + n / 254 + 1);
+            CHECK(memchr(enc, 0, e) == 0);
+            CHECK(BT_Frame_CobsDecode(enc, e, dec) == n && memcmp(src, dec, n) == 0);
+        }
+    }
+
+    /* 原地解码 */
+    memcpy(src, "\x11\x00\x22\x33\x00", 5);
+    e = BT_Frame_CobsEncode(src, 5, enc);
+    CHECK(BT_Frame_CobsDecode(enc, e, enc) == 5 && memcmp(enc, src, 5) == 0);
+
+    /* 非法输入：含0、长度码越界 */
+    CHECK(BT_Frame_CobsDecode((const uint8_t *)"\x03\x01\x00", 3, dec) == 0);
+    CHECK(BT_Frame_CobsDecode((const uint8_t *)"\x05\x01\x02", 3, dec) == 0);
+}
+
+static void test_frames(void)
+{
+    BT_Frame_t f, g;
+    uint8_t out[BT_FRAME_ENCODED_MAX];
+    uint16_t len, mask;
+    uint32_t i;
+
+    /* 每种字段组合都能原样往返，长度不超过上限 */
+    for(mask = 0; mask <= BT_FIELD_ALL; mask++)
+    {
+        random_frame(&f, mask);
+        len = BT_Frame_Encode(&f, out);
+        CHECK(len <= BT_FRAME_ENCODED_MAX);
+        CHECK(out[len - 1] == 0 && memchr(out, 0, len - 1) == 0);
+        memset(&g, 0, sizeof(g));
+        CHECK(BT_Frame_Decode(out, len - 1, &g) == 0);
+        CHECK(frame_equal(&f, &g, mask));
+    }
+
+    /* 任意一个字节出错都能被发现 */
+    random_frame(&f, BT_FIELD_ALL);
+    len = BT_Frame_Encode(&f, out);
+    for(i = 0; i + 1 < len; i++)
+    {
+        uint8_t bad[BT_FRAME_ENCODED_MAX];
+        memcpy(bad, out, len);
+        bad[i] ^= 0x40;
+        if(bad[i] == 0)
+        {
+            bad[i] = 0x01;
+        }
+        CHECK(BT_Frame_Decode(bad, len - 1, &g) != 0);
+    }
+}
+
+static void test_rx(void)
+{
+    BT_FrameRx_t rx;
+    BT_Frame_t f, g;
+    uint8_t out[BT_FRAME_ENCODED_MAX];
+    const uint8_t junk[] = {0x12, 0x34, 0x56};
+    uint16_t len, i;
+    int got = 0;
+
+    BT_FrameRx_Init(&rx);
+    random_frame(&f, BT_FIELD_ALL);
+    len = BT_Frame_Encode(&f, out);
+
+    /* 先收到半帧垃圾，在下一个0x00处重新同步 */
+    for(i = 0; i < sizeof(junk); i++)
+    {
+        got += BT_FrameRx_Feed(&rx, junk[i], &g);
+    }
+    got += BT_FrameRx_Feed(&rx, 0, &g);
+    CHECK(got == 0 && rx.errors == 1);
+
+    for(i = 0; i < len; i++)
+    {
+        got += BT_FrameRx_Feed(&rx, out[i], &g);
+    }
+    CHECK(got == 1 && rx.frames == 1);
+    CHECK(frame_equal(&f, &g, BT_FIELD_ALL));
+
+    /* 超长的帧丢弃到下一个0x00，之后的帧正常 */
+    for(i = 0; i < BT_FRAME_ENCODED_MAX + 10; i++)
+    {
+        got += BT_FrameRx_Feed(&rx, 0x01, &g);
+    }
+    got += BT_FrameRx_Feed(&rx, 0, &g);
+    CHECK(got == 1 && rx.errors == 2);
+    for(i = 0; i < len; i++)
+    {
+        got += BT_FrameRx_Feed(&rx, out[i], &g);
+    }
+    CHECK(got == 2 && rx.frames == 2);
+}
+
+int main(void)
+{
+    srand(1);
+    test_crc();
+    test_cobs();
+    test_frames();
+    test_rx();
+    TEST_EXIT();
+}
@@ -0,0 +1,144 @@
+/**
+ * @file    test_bt_stream.c
+ * @brief   遥测推送调度器测试：带宽预算、固定节拍、关键帧、差分帧和调用过晚
+ */
+
+#include <string.h>
+#include "test.h"
+#include "bt_stream.h"
+
+/* 接收端：把收到的字节交给分帧器，帧中包含的字段覆盖本地副本 */
+static void receive(BT_FrameRx_t *rx, BT_Frame_t *held, const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+
+    for(i = 0; i < len; i++)
+    {
+        BT_FrameRx_Feed(rx, data[i], held);
+    }
+}
+
+static void test_subscribe(void)
+{
+    BT_Stream_t s;
+    uint16_t mask;
+
+    BT_Stream_Init(&s, 960);
+    CHECK(!BT_Stream_Due(&s, 0));
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_TEMP, 0, 0) == BT_STREAM_ERR_RATE);
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_TEMP, BT_STREAM_RATE_MAX + 1, 0) == BT_STREAM_ERR_RATE);
+    /* 全部字段46字节，50Hz需要2300字节/秒，超出9600波特率的预算 */
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_ALL, 50, 0) == BT_STREAM_ERR_BUDGET);
+    CHECK(s.fields == 0);
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_ALL, 20, 0) == BT_STREAM_OK);
+    CHECK(s.fields == BT_FIELD_ALL && s.period == 50);
+    /* 失败时保持原有订阅 */
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_ALL, 50, 0) == BT_STREAM_ERR_BUDGET);
+    CHECK(s.fields == BT_FIELD_ALL && s.period == 50);
+    /* 掩码0等于停止 */
+    CHECK(BT_Stream_Subscribe(&s, 0, 0, 0) == BT_STREAM_OK && s.fields == 0);
+
+    /* FrameSize是关键帧编码长度的上限 */
+    for(mask = 1; mask <= BT_FIELD_ALL; mask++)
+    {
+        BT_Frame_t f;
+        uint8_t out[BT_FRAME_ENCODED_MAX];
+
+        memset(&f, 0x5A, sizeof(f));
+        f.fields = mask;
+        CHECK(BT_Frame_Encode(&f, out) <= BT_Stream_FrameSize(mask));
+    }
+}
+
+static void test_cadence(void)
+{
+    BT_Stream_t s;
+    BT_Frame_t sample, held;
+    BT_FrameRx_t rx;
+    uint8_t out[BT_FRAME_ENCODED_MAX];
+    uint32_t t, sent_at[64], n_sent = 0, bytes = 0;
+    uint16_t len;
+
+    memset(&sample, 0, sizeof(sample));
+    memset(&held, 0, sizeof(held));
+    BT_FrameRx_Init(&rx);
+    BT_Stream_Init(&s, 960);
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_TEMP | BT_FIELD_SMOKE, 10, 1000) == BT_STREAM_OK);
+
+    /* 每1ms调用一次，10秒内温度每700ms变化一次 */
+    for(t = 1000; t < 11000; t++)
+    {
+        if(t % 700 == 0)
+        {
+            sample.temperature++;
+        }
+        CHECK(BT_Stream_Due(&s, t) == (s.fields && (int32_t)(t - s.next_due) >= 0));
+        if(!BT_Stream_Due(&s, t))
+        {
+            CHECK(BT_Stream_Poll(&s, t, &sample, out) == 0);
+            continue;
+        }
+        len = BT_Stream_Poll(&s, t, &sample, out);
+        if(len)
+        {
+            /* 发送只发生在100ms节拍上 */
+            CHECK((t - 1000) % 100 == 0);
+            if(n_sent < 64)
+            {
+                sent_at[n_sent] = t;
+            }
+            n_sent++;
+            bytes += len;
+            receive(&rx, &held, out, len);
+            CHECK(held.temperature == sample.temperature);
+        }
+    }
+
+    /* 10个关键帧；温度变化14次，其中落在关键帧节拍上的不单独发 */
+    CHECK(s.keyframes == 10);
+    CHECK(s.frames == n_sent && rx.frames == n_sent);
+    CHECK(s.frames + s.skipped == 100);
+    CHECK(s.late == 0);
+    CHECK(s.bytes == bytes);
+    CHECK(sent_at[0] == 1000);
+    /* 平均带宽远低于预算 */
+    CHECK(bytes / 10 < 960);
+}
+
+static void test_late(void)
+{
+    BT_Stream_t s;
+    BT_Frame_t sample;
+    uint8_t out[BT_FRAME_ENCODED_MAX];
+    uint32_t t;
+
+    memset(&sample, 0, sizeof(sample));
+    BT_Stream_Init(&s, 960);
+    CHECK(BT_Stream_Subscribe(&s, BT_FIELD_TEMP, 10, 0) == BT_STREAM_OK);
+
+    /* 每37ms才调用一次：不会补发欠下的周期，节拍保持在调用时刻之后 */
+    for(t = 0; t < 1000; t += 37)
+    {
+        BT_Stream_Poll(&s, t, &sample, out);
+        CHECK((int32_t)(s.next_due - t) > 0);
+    }
+    CHECK(s.late == 0);
+
+    /* 中断了350ms：丢掉3个周期 */
+    t = s.next_due + 350;
+    BT_Stream_Poll(&s, t, &sample, out);
+    CHECK(s.late == 3);
+    CHECK(s.next_due == t + 100);
+
+    BT_Stream_Stop(&s);
+    CHECK(!BT_Stream_Due(&s, t + 1000));
+    CHECK(BT_Stream_Poll(&s, t + 1000, &sample, out) == 0);
+}
+
+int main(void)
+{
+    test_subscribe();
+    test_cadence();
+    test_late();
+    TEST_EXIT();
+}
@@ -0,0 +1,158 @@
+/**
+ * @file    test_dht11_decode.c
+ * @brief   DHT11解码测试：合成的下降沿序列，含时序容差、毛刺、16位回绕、校验错误和超时
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "dht11_decode.h"
+
+/**
+ * 生成一次读数的下降沿：响应F0、F1，然后每位一个
+ * bit0/bit1为'0'/'1'的高电平时间，glitch为释放总线时多出的毛刺边沿数
+ */
+static uint8_t trace(uint16_t t, const uint8_t d[5], uint16_t *e, uint16_t bit0, uint16_t bit1,
+                     uint8_t glitch)
+{
+    uint8_t n = 0, i;
+
+    for(i = 0; i < glitch; i++)
+    {
+        e[n++] = (uint16_t)(t - 7 * (glitch - i));
+    }
+    e[n++] = t;
+    t = (uint16_t)(t + 160);
+    e[n++] = t;
+    for(i = 0; i < 40; i++)
+    {
+        t = (uint16_t)(t + 50 + (((d[i / 8] >> (7 - i % 8)) & 1) ? bit1 : bit0));
+        e[n++] = t;
+    }
+    return n;
+}
+
+static void test_decode(void)
+{
+    uint8_t d[5] = {55, 0, 24, 3, 82};
+    uint8_t o[5];
+    uint16_t e[DHT11_EDGE_MAX];
+    uint8_t n, k;
+    int i;
+
+    /* 标称时序、跨过16位定时器回绕 */
+    n = trace(65500, d, e, 27, 70, 0);
+    CHECK(n == DHT11_EDGE_COUNT);
+    CHECK(dht11_decode_edges(e, n, o) == DHT11_OK);
+    for(k = 0; k < 5; k++)
+    {
+        CHECK(o[k] == d[k]);
+    }
+
+    /* 数据手册允许的高电平范围：'0' 26-28us，'1' 70us，再各放宽一些 */
+    CHECK(dht11_decode_edges(e, trace(0, d, e, 20, 70, 0), o) == DHT11_OK && o[2] == 24);
+    CHECK(dht11_decode_edges(e, trace(0, d, e, 40, 60, 0), o) == DHT11_OK && o[2] == 24);
+    CHECK(dht11_decode_edges(e, trace(0, d, e, 27, 120, 0), o) == DHT11_OK && o[2] == 24);
+
+    /* 前面有毛刺边沿时跳过 */
+    n = trace(1000, d, e, 27, 70, 2);
+    CHECK(dht11_decode_edges(e, n, o) == DHT11_OK && o[0] == 55);
+
+    /* 脉宽超出范围 */
+    CHECK(dht11_decode_edges(e, trace(0, d, e, 27, 140, 0), o) == DHT11_ERR_PULSE);
+    n = trace(0, d, e, 27, 70, 0);
+    e[20] = (uint16_t)(e[20] - 40);
+    CHECK(dht11_decode_edges(e, n, o) == DHT11_ERR_PULSE);
+
+    /* 校验和错误 */
+    d[4]++;
+    CHECK(dht11_decode_edges(e, trace(0, d, e, 27, 70, 0), o) == DHT11_ERR_CHECKSUM);
+    d[4]--;
+
+    /* 边沿不足或没有响应信号 */
+    CHECK(dht11_decode_edges(e, 41, o) == DHT11_ERR_NO_RESPONSE);
+    n = trace(0, d, e, 27, 70, 0);
+    e[1] = (uint16_t)(e[0] + 300);
+    CHECK(dht11_decode_edges(e, n, o) == DHT11_ERR_NO_RESPONSE);
+
+    /* 随机数据全部能解出 */
+    for(i = 0; i < 2000; i++)
+    {
+        for(k = 0; k < 4; k++)
+        {
+            d[k] = (uint8_t)rand();
+        }
+        d[4] = (uint8_t)(d[0] + d[1] + d[2] + d[3]);
+        n = trace((uint16_t)rand(), d, e, (uint16_t)(24 + rand() % 8), (uint16_t)(64 + rand() % 12), 0);
+        CHECK(dht11_decode_edges(e, n, o) == DHT11_OK);
+        for(k = 0; k < 5; k++)
+        {
+            CHECK(o[k] == d[k]);
+        }
+    }
+}
+
+static void test_sm(void)
+{
+    const uint8_t d[5] = {60, 0, 21, 5, 86};
+    uint16_t e[DHT11_EDGE_MAX];
+    DHT11_Sm_t sm;
+    DHT11_Action_t a = DHT11_ACT_NONE;
+    uint8_t n, i;
+
+    dht11_sm_init(&sm);
+
+    /* 起始信号：拉低20ms，忙时不能重新开始 */
+    CHECK(dht11_sm_start(&sm, 60000) == DHT11_ACT_DRIVE_LOW);
+    CHECK(sm.deadline == (uint16_t)(60000 + DHT11_START_US));
+    CHECK(dht11_sm_start(&sm, 60010) == DHT11_ACT_NONE);
+    CHECK(dht11_sm_edge(&sm, 60100) == DHT11_ACT_NONE && sm.count == 0);
+    CHECK(dht11_sm_timer(&sm, sm.deadline) == DHT11_ACT_RELEASE);
+    CHECK(sm.state == DHT11_SM_CAPTURE);
+
+    /* 带一个毛刺：42个边沿时还解不出，第43个边沿后结束 */
+    n = trace((uint16_t)(sm.deadline - DHT11_TIMEOUT_US + 30), d, e, 27, 70, 1);
+    for(i = 0; i < n; i++)
+    {
+        a = dht11_sm_edge(&sm, e[i]);
+        CHECK(a == (i + 1 == n ? DHT11_ACT_FINISH : DHT11_ACT_NONE));
+    }
+    CHECK(sm.state == DHT11_SM_DONE && sm.result == DHT11_OK);
+    CHECK(sm.data[0] == 60 && sm.data[2] == 21 && sm.reads == 1);
+
+    /* 超时：只收到一部分边沿 */
+    CHECK(dht11_sm_start(&sm, 0) == DHT11_ACT_DRIVE_LOW);
+    CHECK(dht11_sm_timer(&sm, DHT11_START_US) == DHT11_ACT_RELEASE);
+    n = trace(DHT11_START_US + 30, d, e, 27, 70, 0);
+    for(i = 0; i < 10; i++)
+    {
+        dht11_sm_edge(&sm, e[i]);
+    }
+    CHECK(dht11_sm_timer(&sm, sm.deadline) == DHT11_ACT_FINISH);
+    CHECK(sm.result == DHT11_ERR_NO_RESPONSE && sm.timeouts == 1);
+
+    /* 脉宽错误：缓冲区满后结束并计入errors */
+    CHECK(dht11_sm_start(&sm, 0) == DHT11_ACT_DRIVE_LOW);
+    CHECK(dht11_sm_timer(&sm, DHT11_START_US) == DHT11_ACT_RELEASE);
+    n = trace(DHT11_START_US + 30, d, e, 27, 150, 0);
+    for(i = 0; i < n; i++)
+    {
+        a = dht11_sm_edge(&sm, e[i]);
+    }
+    CHECK(a == DHT11_ACT_NONE);
+    CHECK(dht11_sm_edge(&sm, (uint16_t)(e[n - 1] + 80)) == DHT11_ACT_NONE);
+    CHECK(dht11_sm_edge(&sm, (uint16_t)(e[n - 1] + 160)) == DHT11_ACT_FINISH);
+    CHECK(sm.result == DHT11_ERR_PULSE && sm.errors == 1);
+    CHECK(sm.reads == 1);
+
+    /* 结束后的定时事件和边沿不起作用 */
+    CHECK(dht11_sm_timer(&sm, 0) == DHT11_ACT_NONE);
+    CHECK(dht11_sm_edge(&sm, 0) == DHT11_ACT_NONE);
+}
+
+int main(void)
+{
+    srand(7);
+    test_decode();
+    test_sm();
+    TEST_EXIT();
+}
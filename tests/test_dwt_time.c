@@ -0,0 +1,99 @@
+/**
+ * @file    test_dwt_time.c
+ * @brief   DWT计时测试：换算的取整和饱和、计数器回绕、延时不短于要求
+ */
+
+#include <pthread.h>
+#include "test.h"
+#include "dwt_time.h"
+
+uint32_t SystemCoreClock = 168000000;
+
+static volatile int ticking;
+
+/* 模拟CYCCNT：另一个线程不断推进计数器 */
+static void *ticker(void *arg)
+{
+    (void)arg;
+    while(ticking)
+    {
+        __atomic_fetch_add((uint32_t *)&time_host_cycles, 7, __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+static void test_convert(void)
+{
+    const uint32_t clocks[] = {168000000, 84000000, 16000000, 100000000};
+    uint32_t c, v;
+    uint64_t exact;
+
+    for(c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+    {
+        SystemCoreClock = clocks[c];
+        for(v = 0; v < 200000; v += 13)
+        {
+            /* us/ns -> 周期向上取整，周期 -> us/ns向下取整 */
+            exact = (uint64_t)v * SystemCoreClock;
+            CHECK(time_us_to_cycles(v) == (exact + 999999) / 1000000);
+            CHECK(time_ns_to_cycles(v) == (exact + 999999999) / 1000000000);
+            CHECK(time_cycles_to_us(v) == (uint64_t)v * 1000000 / SystemCoreClock);
+            CHECK(time_cycles_to_ns(v) == (uint64_t)v * 1000000000 / SystemCoreClock);
+            /* 往返不会变短 */
+            CHECK(time_cycles_to_us(time_us_to_cycles(v)) == v);
+        }
+    }
+
+    SystemCoreClock = 168000000;
+    CHECK(time_us_to_cycles(1) == 168);
+    CHECK(time_ns_to_cycles(1) == 1);
+    CHECK(time_ns_to_cycles(100) == 17);
+    CHECK(time_cycles_to_ns(17) == 101);
+    CHECK(time_us_to_cycles(0xFFFFFFFFu) == 0xFFFFFFFFu);
+    CHECK(time_cycles_to_ns(0xFFFFFFFFu) == 0xFFFFFFFFu);
+    CHECK(time_cycles_to_us(0xFFFFFFFFu) == 25565281);
+}
+
+static void test_wrap(void)
+{
+    CHECK(time_elapsed_cycles(0xFFFFFF00u, 0x100) == 0x200);
+    CHECK(time_reached(0x10, 0xFFFFFFF0u));
+    CHECK(!time_reached(0xFFFFFFF0u, 0x10));
+    CHECK(time_reached(5, 5));
+
+    time_host_cycles = 0xFFFFF000u;
+    CHECK(time_elapsed_us(0xFFFFF000u - 168 * 3) == 3);
+}
+
+static void test_delay(void)
+{
+    pthread_t t;
+    uint32_t start, us;
+
+    SystemCoreClock = 168000000;
+    time_host_cycles = 0xFFFF0000u;
+    ticking = 1;
+    pthread_create(&t, 0, ticker, 0);
+
+    /* 跨过回绕的延时也不会提前返回 */
+    for(us = 1; us < 2000; us = us * 3 + 1)
+    {
+        start = time_now_cycles();
+        udelay(us);
+        CHECK(time_elapsed_cycles(start, time_now_cycles()) >= us * 168);
+        start = time_now_cycles();
+        ndelay(us * 10);
+        CHECK(time_elapsed_cycles(start, time_now_cycles()) >= time_ns_to_cycles(us * 10));
+    }
+
+    ticking = 0;
+    pthread_join(t, 0);
+}
+
+int main(void)
+{
+    test_convert();
+    test_wrap();
+    test_delay();
+    TEST_EXIT();
+}
@@ -0,0 +1,258 @@
+/**
+ * @file    test_fmt.c
+ * @brief   格式化输出测试：与C库snprintf逐项比较，以及截断、浮点饱和、NaN和无穷大；
+ *          最后打印Fmt与sprintf格式化同样LCD行和遥测行的耗时（只作参考，不作断言）
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "test.h"
+#include "fmt.h"
+
+#define CHECK_STR(got, exp) do { \
+    if(strcmp((got), (exp)) != 0) { \
+        printf("  got '%s' expected '%s'\n", (got), (exp)); \
+    } \
+    CHECK(strcmp((got), (exp)) == 0); \
+} while(0)
+
+static void test_int(void)
+{
+    static const int32_t v[] = { 0, 1, -1, 9, 10, -10, 99, 100, 12345, -12345, 2147483647, (int32_t)0x80000000 };
+    char a[64], b[64];
+    Fmt_t f;
+    uint32_t i;
+
+    for(i = 0; i < sizeof(v) / sizeof(v[0]); i++)
+    {
+        Fmt_Init(&f, a, sizeof(a));
+        Fmt_Int(&f, v[i], 0, ' ');
+        snprintf(b, sizeof(b), "%d", (int)v[i]);
+        CHECK_STR(a, b);
+
+        Fmt_Init(&f, a, sizeof(a));
+        Fmt_Int(&f, v[i], 6, '0');
+        snprintf(b, sizeof(b), "%06d", (int)v[i]);
+        CHECK_STR(a, b);
+
+        Fmt_Init(&f, a, sizeof(a));
+        Fmt_Printf(&f, "[%-5d|%5d|%05d|%lu|%03X]", v[i], v[i], v[i],
+                   (unsigned long)(uint32_t)v[i], (unsigned)v[i]);
+        snprintf(b, sizeof(b), "[%-5d|%5d|%05d|%lu|%03X]", (int)v[i], (int)v[i], (int)v[i],
+                 (unsigned long)(uint32_t)v[i], (unsigned)v[i]);
+        CHECK_STR(a, b);
+    }
+}
+
+static void test_fixed(void)
+{
+    char a[64], b[64], c[64];
+    Fmt_t f;
+    int32_t v;
+    long p, av;
+    int i, d, k;
+
+    srand(20);
+    for(i = 0; i < 100000; i++)
+    {
+        v = (int32_t)(rand() % 2000001) - 1000000;
+        d = rand() % 4;
+        for(p = 1, k = 0; k < d; k++)
+        {
+            p *= 10;
+        }
+        av = labs((long)v);
+
+        Fmt_Init(&f, a, sizeof(a));
+        Fmt_Fixed(&f, v, (uint8_t)d, 8);
+        if(d)
+        {
+            snprintf(b, sizeof(b), "%s%ld.%0*ld", v < 0 ? "-" : "", av / p, d, av % p);
+        }
+        else
+        {
+            snprintf(b, sizeof(b), "%ld", (long)v);
+        }
+        snprintf(c, sizeof(c), "%8s", b);
+        CHECK_STR(a, c);
+    }
+}
+
+static void test_float(void)
+{
+    char a[64], b[64];
+    Fmt_t f;
+    float x;
+    int i;
+
+    /* 远离舍入边界的值与C库一致，舍入为0时不输出负号，C库输出-0.00，跳过 */
+    for(i = -100000; i <= 100000; i += 7)
+    {
+        x = i / 1000.0f + 0.0002f;
+        if(fabsf(x) < 0.005f)
+        {
+            continue;
+        }
+        Fmt_Init(&f, a, sizeof(a));
+        Fmt_Float(&f, x, 2, 0);
+        snprintf(b, sizeof(b), "%.2f", x);
+        CHECK_STR(a, b);
+    }
+
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, -0.5f, 2, 0);
+    CHECK_STR(a, "-0.50");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, 2.5f, 0, 4);
+    CHECK_STR(a, "   3");
+
+    /* 超出int32范围饱和，不发生溢出的转换 */
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, 2147483647.0f, 0, 0);
+    CHECK_STR(a, "2147483647");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, 1e20f, 2, 0);
+    CHECK_STR(a, "21474836.47");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, -1e20f, 0, 0);
+    CHECK_STR(a, "-2147483647");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, 2147483520.0f, 0, 0);     /* 小于2^31的最大float */
+    CHECK_STR(a, "2147483520");
+
+    /* NaN和无穷大 */
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, NAN, 2, 0);
+    CHECK_STR(a, "nan");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, -NAN, 1, 5);
+    CHECK_STR(a, "  nan");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, INFINITY, 1, 0);
+    CHECK_STR(a, "inf");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, -INFINITY, 1, 6);
+    CHECK_STR(a, "  -inf");
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Float(&f, 3.40282347e38f, 0, 0);    /* 最大的有限值按饱和处理 */
+    CHECK_STR(a, "2147483647");
+}
+
+static void test_misc(void)
+{
+    char a[64];
+    Fmt_t f;
+
+    Fmt_Init(&f, a, 6);
+    Fmt_Str(&f, "hello world");
+    CHECK_STR(a, "hello");
+    CHECK(f.truncated);
+
+    Fmt_Init(&f, a, sizeof(a));
+    CHECK(Fmt_Printf(&f, "%s=%c%%", "k", 'v') == 4);
+    CHECK_STR(a, "k=v%");
+
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Str(&f, "ab");
+    Fmt_Pad(&f, 5);
+    Fmt_Char(&f, '|');
+    CHECK_STR(a, "ab   |");
+
+    Fmt_Init(&f, a, sizeof(a));
+    Fmt_Hex(&f, 0xBEEF, 6);
+    CHECK_STR(a, "00BEEF");
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#define BENCH_ROUNDS    1000000
+
+/* 与固件Fmt_Benchmark相同的两行LCD内容，加上GET ALL回复中的两行遥测文本 */
+static void bench(void)
+{
+    volatile int temp = 26, humi = 61, light = 73, smoke = 215;
+    volatile float x = -0.12f, y = 0.98f, z = 1.03f;
+    char a[96], b[96];
+    double t0, t1, t2;
+    Fmt_t f;
+    int i;
+
+    t0 = seconds();
+    for(i = 0; i < BENCH_ROUNDS; i++)
+    {
+        sprintf(a, "T:%dC H:%d%% %s", temp, humi, "OK");
+    }
+    t1 = seconds();
+    for(i = 0; i < BENCH_ROUNDS; i++)
+    {
+        Fmt_Init(&f, b, sizeof(b));
+        Fmt_Str(&f, "T:");
+        Fmt_Uint(&f, (uint32_t)temp, 0, ' ');
+        Fmt_Str(&f, "C H:");
+        Fmt_Uint(&f, (uint32_t)humi, 0, ' ');
+        Fmt_Str(&f, "% OK");
+    }
+    t2 = seconds();
+    CHECK_STR(b, a);
+    printf("  LCD int line: sprintf %.1f ns, Fmt %.1f ns\n",
+           (t1 - t0) * 1e9 / BENCH_ROUNDS, (t2 - t1) * 1e9 / BENCH_ROUNDS);
+
+    t0 = seconds();
+    for(i = 0; i < BENCH_ROUNDS; i++)
+    {
+        sprintf(a, "X:%.1f Y:%.1f Z:%.1f", x, y, z);
+    }
+    t1 = seconds();
+    for(i = 0; i < BENCH_ROUNDS; i++)
+    {
+        Fmt_Init(&f, b, sizeof(b));
+        Fmt_Str(&f, "X:");
+        Fmt_Float(&f, x, 1, 0);
+        Fmt_Str(&f, " Y:");
+        Fmt_Float(&f, y, 1, 0);
+        Fmt_Str(&f, " Z:");
+        Fmt_Float(&f, z, 1, 0);
+    }
+    t2 = seconds();
+    CHECK_STR(b, a);
+    printf("  LCD float line: sprintf %.1f ns, Fmt %.1f ns\n",
+           (t1 - t0) * 1e9 / BENCH_ROUNDS, (t2 - t1) * 1e9 / BENCH_ROUNDS);
+
+    t0 = seconds();
+    for(i = 0; i < BENCH_ROUNDS; i++)
+    {
+        sprintf(a, "Status: T=%dC H=%d%% L=%d%% S=%dppm\r\n", temp, humi, light, smoke);
+        sprintf(a + 48, "System: Tick=%lu Updates=%lu\r\n", (unsigned long)i, 1234567ul);
+    }
+    t1 = seconds();
+    for(i = 0; i < BENCH_ROUNDS; i++)
+    {
+        Fmt_Init(&f, b, 48);
+        Fmt_Printf(&f, "Status: T=%dC H=%d%% L=%d%% S=%dppm\r\n", temp, humi, light, smoke);
+        Fmt_Init(&f, b + 48, 48);
+        Fmt_Printf(&f, "System: Tick=%lu Updates=%lu\r\n", (unsigned long)i, 1234567ul);
+    }
+    t2 = seconds();
+    CHECK_STR(b, a);
+    CHECK_STR(b + 48, a + 48);
+    printf("  telemetry lines: sprintf %.1f ns, Fmt_Printf %.1f ns\n",
+           (t1 - t0) * 1e9 / BENCH_ROUNDS, (t2 - t1) * 1e9 / BENCH_ROUNDS);
+}
+
+int main(void)
+{
+    test_int();
+    test_fixed();
+    test_float();
+    test_misc();
+    bench();
+    TEST_EXIT();
+}
@@ -0,0 +1,361 @@
+/**
+ * @file    test_i2c_sm.c
+ * @brief   I2C状态机测试：按状态机返回的动作驱动一个模拟的从机和外设，
+ *          按脚本注入应答失败、仲裁丢失、总线错误和总线卡死，检查结果、
+ *          重试次数、总线恢复和统计
+ */
+
+#include <string.h>
+#include "test.h"
+#include "i2c_sm.h"
+
+#define SLAVE_ADDR      0xD0
+#define PHASE_TIMEOUT   100
+#define BACKOFF         50
+
+/* 待送给状态机的硬件事件 */
+enum { EV_NONE, EV_SB, EV_ADDR, EV_BTF, EV_RXNE, EV_DMA, EV_AF, EV_ARLO, EV_BERR };
+
+/* 模拟的总线和从机 */
+typedef struct {
+    uint8_t regs[256];
+    uint8_t ptr;                /* 从机寄存器指针 */
+    uint8_t addressed;          /* 下一个发送字节是地址 */
+    uint8_t reg_phase;          /* 下一个写入字节是寄存器地址 */
+    uint8_t dma_rx;             /* 已使能DMA接收 */
+    uint8_t ack;                /* 应答使能 */
+    int pending;
+    uint32_t now;
+
+    /* 故障脚本：在接下来的若干次START上注入 */
+    int nack;
+    int arlo;
+    int berr;
+    int stuck;
+
+    /* 外设侧看到的动作计数 */
+    uint32_t starts;
+    uint32_t stops;
+    uint32_t recovers;
+    uint32_t done;
+} Bus_t;
+
+static void bus_reset(Bus_t *b)
+{
+    uint32_t i;
+
+    memset(b, 0, sizeof(*b));
+    for(i = 0; i < 256; i++)
+    {
+        b->regs[i] = (uint8_t)(i * 7 + 1);
+    }
+    b->now = 1000;
+}
+
+/* 执行一组动作，决定下一个硬件事件 */
+static void bus_apply(Bus_t *b, I2C_Sm_t *sm, uint16_t act)
+{
+    uint16_t i;
+
+    if(act & I2C_ACT_ACK_ON)
+    {
+        b->ack = 1;
+    }
+    if(act & I2C_ACT_ACK_OFF)
+    {
+        b->ack = 0;
+    }
+    if(act & I2C_ACT_DMA_RX)
+    {
+        b->dma_rx = 1;
+    }
+    if(act & I2C_ACT_CLEAR_ADDR)
+    {
+        if(b->dma_rx)
+        {
+            /* DMA一次收完，最后一个字节之前都要应答 */
+            CHECK(b->ack);
+            for(i = 0; i < sm->rx_len; i++)
+            {
+                sm->rx[i] = b->regs[b->ptr++];
+            }
+            b->pending = EV_DMA;
+        }
+    }
+    if(act & I2C_ACT_BUF_ON)
+    {
+        /* 单字节读：清除ADDR前必须已关闭应答 */
+        CHECK(!b->ack);
+        b->pending = EV_RXNE;
+    }
+    if(act & I2C_ACT_SEND)
+    {
+        if(b->addressed)
+        {
+            b->addressed = 0;
+            if(b->nack > 0 || (sm->out & 0xFE) != SLAVE_ADDR)
+            {
+                b->nack -= b->nack > 0;
+                b->pending = EV_AF;
+            }
+            else
+            {
+                b->reg_phase = !(sm->out & 1);
+                b->pending = EV_ADDR;
+            }
+        }
+        else
+        {
+            if(b->reg_phase)
+            {
+                b->ptr = sm->out;
+                b->reg_phase = 0;
+            }
+            else
+            {
+                b->regs[b->ptr++] = sm->out;
+            }
+            b->pending = EV_BTF;
+        }
+    }
+    if(act & I2C_ACT_STOP)
+    {
+        b->stops++;
+    }
+    if(act & I2C_ACT_START)
+    {
+        b->starts++;
+        b->addressed = 1;
+        b->dma_rx = 0;
+        if(b->stuck > 0)
+        {
+            /* 从机拉住SDA，START发不出去，不产生任何事件 */
+            b->stuck--;
+            b->pending = EV_NONE;
+        }
+        else if(b->arlo > 0)
+        {
+            b->arlo--;
+            b->pending = EV_ARLO;
+        }
+        else if(b->berr > 0)
+        {
+            b->berr--;
+            b->pending = EV_BERR;
+        }
+        else
+        {
+            b->pending = EV_SB;
+        }
+    }
+    if(act & I2C_ACT_IT_OFF)
+    {
+        b->pending = EV_NONE;
+        b->dma_rx = 0;
+    }
+    if(act & I2C_ACT_RECOVER)
+    {
+        b->recovers++;
+    }
+    if(act & I2C_ACT_DONE)
+    {
+        b->done++;
+    }
+}
+
+/* 运行一次传输直到结束，返回结果 */
+static uint8_t bus_run(Bus_t *b, I2C_Sm_t *sm, const uint8_t *tx, uint8_t tx_len,
+                       uint8_t *rx, uint16_t rx_len)
+{
+    uint32_t done = b->done, steps = 0;
+    uint16_t act;
+    int ev;
+
+    act = i2c_sm_begin(sm, SLAVE_ADDR, tx, tx_len, rx, rx_len, b->now);
+    CHECK(act != I2C_ACT_NONE);
+    bus_apply(b, sm, act);
+    while(b->done == done && steps++ < 100000)
+    {
+        ev = b->pending;
+        b->pending = EV_NONE;
+        b->now += 3;
+        switch(ev)
+        {
+        case EV_SB:   act = i2c_sm_event(sm, I2C_SM_SB, 0, b->now); break;
+        case EV_ADDR: act = i2c_sm_event(sm, I2C_SM_ADDR, 0, b->now); break;
+        case EV_BTF:  act = i2c_sm_event(sm, I2C_SM_BTF, 0, b->now); break;
+        case EV_RXNE: act = i2c_sm_event(sm, I2C_SM_RXNE, b->regs[b->ptr++], b->now); break;
+        case EV_DMA:  act = i2c_sm_dma_done(sm, b->now); break;
+        case EV_AF:   act = i2c_sm_error(sm, I2C_SM_AF, b->now); break;
+        case EV_ARLO: act = i2c_sm_error(sm, I2C_SM_ARLO, b->now); break;
+        case EV_BERR: act = i2c_sm_error(sm, I2C_SM_BERR, b->now); break;
+        default:
+            /* 没有事件：主循环轮询推进超时和重试 */
+            b->now += 10;
+            act = i2c_sm_poll(sm, b->now);
+            break;
+        }
+        bus_apply(b, sm, act);
+    }
+    CHECK(!i2c_sm_busy(sm));
+    return sm->result;
+}
+
+static void test_clean(void)
+{
+    I2C_Sm_t sm;
+    Bus_t b;
+    uint8_t tx[3] = {0x10, 0xAA, 0x55};
+    uint8_t rx[14];
+    uint8_t i;
+
+    bus_reset(&b);
+    i2c_sm_init(&sm, PHASE_TIMEOUT, 10, BACKOFF, 2);
+
+    /* 写寄存器 */
+    CHECK(bus_run(&b, &sm, tx, 3, 0, 0) == I2C_OK);
+    CHECK(b.regs[0x10] == 0xAA && b.regs[0x11] == 0x55);
+    CHECK(b.starts == 1 && b.stops == 1);
+
+    /* 单字节读：ACK关闭，RXNE中断收 */
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 1) == I2C_OK);
+    CHECK(rx[0] == 0xAA);
+    CHECK(b.starts == 3 && b.stops == 2);
+
+    /* 多字节读走DMA */
+    tx[0] = 0x3B;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 14) == I2C_OK);
+    for(i = 0; i < 14; i++)
+    {
+        CHECK(rx[i] == (uint8_t)((0x3B + i) * 7 + 1));
+    }
+
+    /* 无发送字节的纯读 */
+    b.ptr = 0x20;
+    CHECK(bus_run(&b, &sm, 0, 0, rx, 2) == I2C_OK);
+    CHECK(rx[0] == b.regs[0x20] && rx[1] == b.regs[0x21]);
+
+    CHECK(sm.transfers == 4 && sm.ok == 4 && sm.failures == 0);
+    CHECK(sm.retries == 0 && sm.recoveries == 0 && b.recovers == 0);
+    CHECK(sm.max_latency >= sm.last_latency && sm.total_latency >= sm.max_latency);
+}
+
+static void test_args(void)
+{
+    I2C_Sm_t sm;
+    uint8_t tx[I2C_SM_TX_MAX + 1] = {0};
+    uint8_t rx[2];
+
+    i2c_sm_init(&sm, PHASE_TIMEOUT, 10, BACKOFF, 2);
+    CHECK(i2c_sm_begin(&sm, SLAVE_ADDR, tx, I2C_SM_TX_MAX + 1, 0, 0, 0) == I2C_ACT_NONE);
+    CHECK(i2c_sm_begin(&sm, SLAVE_ADDR, 0, 0, 0, 0, 0) == I2C_ACT_NONE);
+    CHECK(i2c_sm_begin(&sm, SLAVE_ADDR, tx, 1, rx, 2, 0) == (I2C_ACT_ACK_ON | I2C_ACT_START));
+    /* 进行中不能再开始 */
+    CHECK(i2c_sm_begin(&sm, SLAVE_ADDR, tx, 1, rx, 2, 0) == I2C_ACT_NONE);
+    /* 不属于当前阶段的事件被忽略 */
+    CHECK(i2c_sm_event(&sm, I2C_SM_BTF, 0, 1) == I2C_ACT_NONE);
+}
+
+/* 可恢复的错误：重试次数之内成功 */
+static void test_retry(void)
+{
+    I2C_Sm_t sm;
+    Bus_t b;
+    uint8_t tx[1] = {0x75};
+    uint8_t rx[2];
+
+    bus_reset(&b);
+    i2c_sm_init(&sm, PHASE_TIMEOUT, 10, BACKOFF, 2);
+
+    b.nack = 2;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 2) == I2C_OK);
+    CHECK(sm.nacks == 2 && sm.retries == 2 && b.starts == 4);   /* 两次失败的START + 写、读各一次 */
+    CHECK(b.stops == 3);                /* 两次NACK后各发STOP，成功后一次 */
+    CHECK(b.recovers == 0);
+
+    b.arlo = 1;
+    b.starts = b.stops = 0;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 2) == I2C_OK);
+    CHECK(sm.arlo == 1 && b.stops == 1); /* 仲裁丢失后不发STOP */
+
+    b.berr = 1;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 2) == I2C_OK);
+    CHECK(sm.bus_errors == 1 && b.recovers == 1);
+
+    /* 总线卡死：START阶段超时，恢复总线后重试 */
+    b.stuck = 1;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 2) == I2C_OK);
+    CHECK(sm.timeouts == 1 && b.recovers == 2 && sm.recoveries == 2);
+
+    CHECK(sm.ok == 4 && sm.failures == 0 && sm.retries == 5);
+    CHECK(rx[0] == b.regs[0x75]);
+}
+
+/* 重试用尽：按最后一次错误报告，且只回调一次 */
+static void test_fail(void)
+{
+    I2C_Sm_t sm;
+    Bus_t b;
+    uint8_t tx[2] = {0x6B, 0x00};
+    uint8_t rx[2];
+    uint32_t t0;
+
+    bus_reset(&b);
+    i2c_sm_init(&sm, PHASE_TIMEOUT, 10, BACKOFF, 2);
+
+    b.nack = 10;
+    CHECK(bus_run(&b, &sm, tx, 2, 0, 0) == I2C_ERR_NACK);
+    CHECK(b.starts == 3 && b.done == 1);
+    CHECK(sm.failures == 1 && sm.retries == 2);
+
+    /* 卡死始终不释放：三次超时、三次恢复，总时长不短于超时和退避之和 */
+    b.nack = 0;
+    b.stuck = 10;
+    t0 = b.now;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 2) == I2C_ERR_TIMEOUT);
+    CHECK(sm.timeouts == 3 && b.recovers == 3);
+    CHECK(b.now - t0 >= 3 * PHASE_TIMEOUT + 2 * BACKOFF);
+    CHECK(sm.failures == 2 && b.done == 2);
+
+    /* 不重试 */
+    i2c_sm_init(&sm, PHASE_TIMEOUT, 10, BACKOFF, 0);
+    b.stuck = 0;
+    b.arlo = 1;
+    CHECK(bus_run(&b, &sm, tx, 1, rx, 2) == I2C_ERR_ARLO);
+    CHECK(sm.retries == 0 && sm.failures == 1);
+}
+
+/* DMA阶段的超时随字节数增加 */
+static void test_dma_timeout(void)
+{
+    I2C_Sm_t sm;
+    uint8_t tx[1] = {0x3B};
+    uint8_t rx[14];
+    uint16_t act;
+
+    i2c_sm_init(&sm, PHASE_TIMEOUT, 10, BACKOFF, 0);
+    i2c_sm_begin(&sm, SLAVE_ADDR, tx, 1, rx, 14, 0);
+    i2c_sm_event(&sm, I2C_SM_SB, 0, 1);
+    i2c_sm_event(&sm, I2C_SM_ADDR, 0, 2);
+    i2c_sm_event(&sm, I2C_SM_BTF, 0, 3);
+    i2c_sm_event(&sm, I2C_SM_SB, 0, 4);
+    act = i2c_sm_event(&sm, I2C_SM_ADDR, 0, 5);
+    CHECK(act & I2C_ACT_DMA_RX);
+    CHECK(sm.state == I2C_SM_RX_DMA);
+    CHECK(i2c_sm_poll(&sm, 5 + PHASE_TIMEOUT + 14 * 10 - 1) == I2C_ACT_NONE);
+    act = i2c_sm_poll(&sm, 5 + PHASE_TIMEOUT + 14 * 10);
+    CHECK((act & I2C_ACT_DONE) && (act & I2C_ACT_RECOVER));
+    CHECK(sm.result == I2C_ERR_TIMEOUT);
+    /* 超时之后迟到的DMA完成不再结束传输 */
+    CHECK(i2c_sm_dma_done(&sm, 500) == I2C_ACT_NONE);
+}
+
+int main(void)
+{
+    test_clean();
+    test_args();
+    test_retry();
+    test_fail();
+    test_dma_timeout();
+    TEST_EXIT();
+}
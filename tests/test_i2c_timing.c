@@ -0,0 +1,121 @@
+/**
+ * @file    test_i2c_timing.c
+ * @brief   I2C时钟寄存器计算测试：常用PCLK1下的CCR/TRISE表，
+ *          以及全部合法PCLK1和一组SCL频率下“不超过目标、且CCR最小”的性质
+ */
+
+#include "test.h"
+#include "i2c_timing.h"
+
+typedef struct {
+    uint32_t pclk1;
+    uint32_t scl;
+    uint8_t duty;
+    uint16_t ccr;
+    uint16_t trise;
+    uint32_t actual;
+} Row_t;
+
+static const Row_t table[] = {
+    /* 168MHz系统时钟，APB1四分频 */
+    { 42000000, 100000, I2C_TIMING_DUTY_2,    210,    43, 100000 },
+    { 42000000, 400000, I2C_TIMING_DUTY_2,    0x8023, 13, 400000 },
+    { 42000000, 400000, I2C_TIMING_DUTY_16_9, 0xC005, 13, 336000 },
+    { 42000000, 400000, I2C_TIMING_DUTY_AUTO, 0x8023, 13, 400000 },
+    /* 10MHz整数倍时16/9可精确得到400kHz */
+    { 40000000, 400000, I2C_TIMING_DUTY_2,    0x8022, 13, 392156 },
+    { 40000000, 400000, I2C_TIMING_DUTY_16_9, 0xC004, 13, 400000 },
+    { 40000000, 400000, I2C_TIMING_DUTY_AUTO, 0xC004, 13, 400000 },
+    /* 16MHz HSI直接作APB1 */
+    { 16000000, 100000, I2C_TIMING_DUTY_2,    80,     17, 100000 },
+    { 16000000, 400000, I2C_TIMING_DUTY_2,    0x800E, 5,  380952 },
+    { 16000000, 400000, I2C_TIMING_DUTY_AUTO, 0x800E, 5,  380952 },
+    { 2000000,  100000, I2C_TIMING_DUTY_2,    10,     3,  100000 },
+    { 50000000, 10000,  I2C_TIMING_DUTY_2,    2500,   51, 10000 },
+    /* 不整除时向上取整，实际频率略低 */
+    { 42000000, 300000, I2C_TIMING_DUTY_2,    0x802F, 13, 297872 },
+    { 30000000, 100000, I2C_TIMING_DUTY_2,    150,    31, 100000 },
+};
+
+static void test_table(void)
+{
+    I2C_Timing_t t;
+    uint32_t i;
+
+    for(i = 0; i < sizeof(table) / sizeof(table[0]); i++)
+    {
+        CHECK(i2c_timing_compute(table[i].pclk1, table[i].scl, table[i].duty, &t) == 0);
+        CHECK(t.freq == table[i].pclk1 / 1000000);
+        CHECK(t.ccr == table[i].ccr);
+        CHECK(t.trise == table[i].trise);
+        CHECK(t.scl_hz == table[i].actual);
+        if(t.ccr != table[i].ccr || t.scl_hz != table[i].actual)
+        {
+            printf("  row %u: ccr 0x%04X scl %u\n", (unsigned)i, t.ccr, (unsigned)t.scl_hz);
+        }
+    }
+}
+
+static void test_errors(void)
+{
+    I2C_Timing_t t;
+
+    CHECK(i2c_timing_compute(1000000, 100000, 0, &t) == 1);     /* PCLK1过低 */
+    CHECK(i2c_timing_compute(51000000, 100000, 0, &t) == 1);    /* PCLK1过高 */
+    CHECK(i2c_timing_compute(42000000, 0, 0, &t) == 1);
+    CHECK(i2c_timing_compute(42000000, 400001, 0, &t) == 1);
+    CHECK(i2c_timing_compute(3000000, 400000, 0, &t) == 1);     /* 快速模式要求至少4MHz */
+    CHECK(i2c_timing_compute(50000000, 1000, 0, &t) == 1);      /* CCR超过12位 */
+    CHECK(i2c_timing_compute(50000000, 6200, 0, &t) == 0);
+}
+
+/* 计算出的CCR是使频率不超过目标的最小值 */
+static void test_sweep(void)
+{
+    static const uint32_t scls[] = { 10000, 50000, 99999, 100000, 100001, 250000, 333333, 399999, 400000 };
+    I2C_Timing_t t;
+    uint32_t mhz, k, div, ccr;
+    uint8_t duty;
+
+    for(mhz = I2C_TIMING_FREQ_MIN; mhz <= I2C_TIMING_FREQ_MAX; mhz++)
+    {
+        for(k = 0; k < sizeof(scls) / sizeof(scls[0]); k++)
+        {
+            for(duty = I2C_TIMING_DUTY_2; duty <= I2C_TIMING_DUTY_AUTO; duty++)
+            {
+                if(i2c_timing_compute(mhz * 1000000, scls[k], duty, &t) != 0)
+                {
+                    CHECK(scls[k] > I2C_SPEED_STANDARD && mhz < I2C_TIMING_FREQ_MIN_FM);
+                    continue;
+                }
+                ccr = t.ccr & 0x0FFF;
+                if(!(t.ccr & I2C_TIMING_CCR_FS))
+                {
+                    CHECK(scls[k] <= I2C_SPEED_STANDARD);
+                    CHECK(ccr >= 4);
+                    CHECK(t.trise == mhz + 1);              /* 1000ns */
+                    div = 2;
+                }
+                else
+                {
+                    CHECK(scls[k] > I2C_SPEED_STANDARD);
+                    CHECK(t.trise == mhz * 300 / 1000 + 1); /* 300ns */
+                    div = (t.ccr & I2C_TIMING_CCR_DUTY) ? 25 : 3;
+                }
+                CHECK(t.scl_hz == mhz * 1000000 / (div * ccr));
+                CHECK(t.scl_hz <= scls[k]);
+                /* CCR再小1就会超过目标（除非已是下限） */
+                CHECK(ccr == ((t.ccr & I2C_TIMING_CCR_FS) ? 1 : 4) ||
+                      (uint64_t)mhz * 1000000 > (uint64_t)scls[k] * div * (ccr - 1));
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    test_table();
+    test_errors();
+    test_sweep();
+    TEST_EXIT();
+}
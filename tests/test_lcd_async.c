@@ -0,0 +1,160 @@
+/**
+ * @file    test_lcd_async.c
+ * @brief   LCD异步队列测试：按执行时间暂停出队、队列满、两个线程并发存取
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+#include "lcd_async.h"
+
+#define STRESS_ITEMS    200000u
+
+static LCD_Async_t stress_a;
+static volatile int stress_errors;
+
+/* 生产者：数据和指令交替，队列满时让出CPU重试 */
+static void *producer(void *arg)
+{
+    uint32_t i;
+
+    (void)arg;
+    for(i = 0; i < STRESS_ITEMS; i++)
+    {
+        while(!lcd_async_put(&stress_a, (uint16_t)((i & 0xFF) | (i & 0x100 ? 0 : LCD_ASYNC_RS))))
+        {
+            sched_yield();
+        }
+    }
+    return 0;
+}
+
+/* 消费者（相当于定时器中断）：忙标志模式下逐项取出，检查顺序 */
+static void *consumer(void *arg)
+{
+    uint32_t i = 0;
+    uint16_t entry;
+
+    (void)arg;
+    while(i < STRESS_ITEMS)
+    {
+        if(!lcd_async_next(&stress_a, 1, &entry))
+        {
+            sched_yield();
+            continue;
+        }
+        if(entry != (uint16_t)((i & 0xFF) | (i & 0x100 ? 0 : LCD_ASYNC_RS)))
+        {
+            stress_errors++;
+        }
+        i++;
+    }
+    return 0;
+}
+
+/* 数到下一项写出为止经过的tick数 */
+static uint32_t ticks_until_next(LCD_Async_t *a, uint16_t *entry)
+{
+    uint32_t n = 1;
+
+    while(!lcd_async_next(a, 0, entry))
+    {
+        n++;
+    }
+    return n;
+}
+
+static void test_timing(void)
+{
+    LCD_Async_t a;
+    uint16_t entry, i;
+
+    /* 10us一个tick：普通项40us=4tick，清屏1600us=160tick，不整除时向上取整 */
+    lcd_async_init(&a, 10, 37, 1520);
+    CHECK(a.exec_ticks == 4);
+    CHECK(a.clear_ticks == 152);
+    CHECK(lcd_async_idle(&a));
+    CHECK(!lcd_async_next(&a, 0, &entry));
+
+    CHECK(lcd_async_put(&a, 0x01));
+    CHECK(lcd_async_put(&a, 'A' | LCD_ASYNC_RS));
+    CHECK(lcd_async_put(&a, 0x02));
+    CHECK(lcd_async_put(&a, 0x80));
+    CHECK(lcd_async_put(&a, 0x01 | LCD_ASYNC_RS));
+    CHECK(lcd_async_put(&a, 'B' | LCD_ASYNC_RS));
+    CHECK(!lcd_async_idle(&a));
+
+    CHECK(lcd_async_next(&a, 0, &entry) && entry == 0x01);
+    CHECK(ticks_until_next(&a, &entry) == 152 && entry == ('A' | LCD_ASYNC_RS));
+    CHECK(ticks_until_next(&a, &entry) == 4 && entry == 0x02);
+    CHECK(ticks_until_next(&a, &entry) == 152 && entry == 0x80);
+    /* 数据0x01不是清屏指令 */
+    CHECK(ticks_until_next(&a, &entry) == 4 && entry == (0x01 | LCD_ASYNC_RS));
+    CHECK(ticks_until_next(&a, &entry) == 4 && entry == ('B' | LCD_ASYNC_RS));
+    CHECK(!lcd_async_idle(&a));
+
+    /* 最后一项执行完后才空闲 */
+    for(i = 0; i < 3; i++)
+    {
+        CHECK(!lcd_async_next(&a, 0, &entry));
+        CHECK(!lcd_async_idle(&a));
+    }
+    CHECK(!lcd_async_next(&a, 0, &entry));
+    CHECK(lcd_async_idle(&a));
+    CHECK(a.issued == 6);
+    CHECK(a.max_depth == 6);
+
+    /* 补足等待只会延长，不会缩短 */
+    CHECK(lcd_async_put(&a, 'C' | LCD_ASYNC_RS));
+    CHECK(lcd_async_next(&a, 0, &entry));
+    lcd_async_delay(&a, 15);
+    CHECK(a.holdoff == 4);
+    lcd_async_delay(&a, 95);
+    CHECK(a.holdoff == 10);
+}
+
+static void test_full(void)
+{
+    LCD_Async_t a;
+    uint16_t entry, i;
+
+    lcd_async_init(&a, 10, 40, 1600);
+    CHECK(lcd_async_space(&a) == LCD_ASYNC_DEPTH);
+    for(i = 0; i < LCD_ASYNC_DEPTH; i++)
+    {
+        CHECK(lcd_async_put(&a, i | LCD_ASYNC_RS));
+    }
+    CHECK(lcd_async_space(&a) == 0);
+    CHECK(!lcd_async_put(&a, 0x55));
+    CHECK(a.max_depth == LCD_ASYNC_DEPTH);
+
+    /* 忙标志模式每个tick都可以写出 */
+    for(i = 0; i < LCD_ASYNC_DEPTH; i++)
+    {
+        CHECK(lcd_async_next(&a, 1, &entry) && entry == (i | LCD_ASYNC_RS));
+    }
+    CHECK(!lcd_async_next(&a, 1, &entry));
+    CHECK(lcd_async_idle(&a));
+}
+
+static void test_stress(void)
+{
+    pthread_t p, c;
+
+    lcd_async_init(&stress_a, 10, 40, 1600);
+    pthread_create(&p, 0, producer, 0);
+    pthread_create(&c, 0, consumer, 0);
+    pthread_join(p, 0);
+    pthread_join(c, 0);
+    CHECK(stress_errors == 0);
+    CHECK(stress_a.issued == STRESS_ITEMS);
+    CHECK(lcd_async_idle(&stress_a));
+}
+
+int main(void)
+{
+    test_timing();
+    test_full();
+    test_stress();
+    TEST_EXIT();
+}
@@ -0,0 +1,82 @@
+/**
+ * @file    test_lcd_bus.c
+ * @brief   LCD数据总线BSRR查找表测试：按lcd.h的引脚定义逐位重建256个字节值的置位/复位字并逐项比较
+ */
+
+#include "test.h"
+#include "lcd_bus.h"
+
+static const uint32_t pin[8] = {
+    D0_PIN, D1_PIN, D2_PIN, D3_PIN, D4_PIN, D5_PIN, D6_PIN, D7_PIN
+};
+static const uint8_t port_idx[8] = {
+    D0_PORT_IDX, D1_PORT_IDX, D2_PORT_IDX, D3_PORT_IDX,
+    D4_PORT_IDX, D5_PORT_IDX, D6_PORT_IDX, D7_PORT_IDX
+};
+
+/* 端口序号与Dx_GPIO_PORT一致 */
+static void test_ports(void)
+{
+    GPIO_TypeDef *const ports[LCD_BUS_PORTS] = {
+        LCD_BUS_PORT0, LCD_BUS_PORT1, LCD_BUS_PORT2, LCD_BUS_PORT3
+    };
+    GPIO_TypeDef *const line_port[8] = {
+        D0_GPIO_PORT, D1_GPIO_PORT, D2_GPIO_PORT, D3_GPIO_PORT,
+        D4_GPIO_PORT, D5_GPIO_PORT, D6_GPIO_PORT, D7_GPIO_PORT
+    };
+    int n;
+
+    for(n = 0; n < 8; n++)
+    {
+        CHECK(port_idx[n] < LCD_BUS_PORTS);
+        CHECK(ports[port_idx[n]] == line_port[n]);
+    }
+}
+
+static void test_table(void)
+{
+    uint32_t set, reset, mask;
+    int v, k, n;
+
+    for(v = 0; v < 256; v++)
+    {
+        for(k = 0; k < LCD_BUS_PORTS; k++)
+        {
+            set = 0;
+            reset = 0;
+            mask = 0;
+            for(n = 0; n < 8; n++)
+            {
+                if(port_idx[n] != k)
+                {
+                    continue;
+                }
+                mask |= pin[n];
+                if((v >> n) & 1)
+                {
+                    set |= pin[n];
+                }
+                else
+                {
+                    reset |= pin[n];
+                }
+            }
+            if(lcd_bus_table[v].bsrr[k] != (set | (reset << 16)))
+            {
+                printf("  value 0x%02X port %d: 0x%08lX expected 0x%08lX\n", v, k,
+                       (unsigned long)lcd_bus_table[v].bsrr[k], (unsigned long)(set | (reset << 16)));
+            }
+            CHECK(lcd_bus_table[v].bsrr[k] == (set | (reset << 16)));
+            /* 该端口上的每根数据线恰好被置位或复位一次，不碰其它引脚 */
+            CHECK(((lcd_bus_table[v].bsrr[k] & 0xFFFFu) | (lcd_bus_table[v].bsrr[k] >> 16)) == mask);
+            CHECK(((lcd_bus_table[v].bsrr[k] & 0xFFFFu) & (lcd_bus_table[v].bsrr[k] >> 16)) == 0);
+        }
+    }
+}
+
+int main(void)
+{
+    test_ports();
+    test_table();
+    TEST_EXIT();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file    test_lcd_fb.c
+ * @brief   LCD帧缓冲测试：模拟HD44780的DDRAM和地址计数器，随机改写后
+ *          比较屏幕内容，并检查各种变化形状写出的字节数
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "lcd_fb.h"
+
+static const uint8_t row_addr[LCD_FB_ROWS_MAX] = { 0x00, 0x40, 0x14, 0x54 };
+
+static uint8_t ddram[128];
+static uint8_t ac;
+static uint32_t cmds, dats;
+
+static void fake_cmd(uint8_t cmd)
+{
+    CHECK(cmd & 0x80);                  /* 只应发送设置DDRAM地址指令 */
+    ac = cmd & 0x7F;
+    cmds++;
+}
+
+static void fake_dat(uint8_t dat)
+{
+    ddram[ac] = dat;
+    ac = (ac + 1) & 0x7F;
+    dats++;
+}
+
+static void fake_clear(void)
+{
+    memset(ddram, ' ', sizeof(ddram));
+    ac = 0;
+}
+
+/* 屏幕内容与待显示内容一致 */
+static int panel_matches(const LCD_Fb_t *fb)
+{
+    uint8_t r, c;
+
+    for(r = 0; r < fb->rows; r++)
+    {
+        for(c = 0; c < fb->cols; c++)
+        {
+            if(ddram[row_addr[r] + c] != (uint8_t)fb->draw[r][c])
+            {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static void test_shapes(void)
+{
+    LCD_Fb_t fb;
+
+    fake_clear();
+    lcd_fb_init(&fb, 2, 16, fake_cmd, fake_dat, 0);
+    CHECK(lcd_fb_flush(&fb) == 0);
+
+    /* 单个字符：设置地址+数据 */
+    lcd_fb_puts(&fb, 1, 5, "x");
+    CHECK(lcd_fb_flush(&fb) == 2);
+    CHECK(panel_matches(&fb));
+    CHECK(lcd_fb_flush(&fb) == 0);
+
+    /* 连续一段：一次设置地址 */
+    lcd_fb_puts(&fb, 0, 3, "hello");
+    CHECK(lcd_fb_flush(&fb) == 6);
+
+    /* 隔一个未变字符：重写它比移动光标省 */
+    lcd_fb_puts(&fb, 0, 3, "J");
+    lcd_fb_puts(&fb, 0, 5, "L");
+    CHECK(lcd_fb_flush(&fb) == 4);
+    CHECK(panel_matches(&fb));
+
+    /* 隔两个：移动光标 */
+    lcd_fb_puts(&fb, 0, 3, "h");
+    lcd_fb_puts(&fb, 0, 6, "X");
+    CHECK(lcd_fb_flush(&fb) == 4);
+    CHECK(panel_matches(&fb));
+
+    /* 首行末尾与次行开头不连续，换行必须设置地址 */
+    lcd_fb_puts(&fb, 0, 15, "a");
+    lcd_fb_puts(&fb, 1, 0, "b");
+    CHECK(lcd_fb_flush(&fb) == 4);
+    CHECK(panel_matches(&fb));
+
+    /* 超出行尾的部分丢弃，越界的行忽略 */
+    lcd_fb_puts(&fb, 1, 14, "0123");
+    lcd_fb_puts(&fb, 2, 0, "zz");
+    lcd_fb_flush(&fb);
+    CHECK(panel_matches(&fb));
+    CHECK(ddram[0x40 + 16] == ' ');
+
+    /* 外部改写过屏幕：全部重写 */
+    lcd_fb_invalidate(&fb);
+    CHECK(lcd_fb_flush(&fb) == 2 + 32);
+    CHECK(fb.flushes == 9);
+}
+
+/* 随机改写，每次刷新后屏幕都与待显示内容一致，写出的数据不超过变化字符的两倍 */
+static void test_random(uint8_t rows, uint8_t cols)
+{
+    LCD_Fb_t fb;
+    char line[LCD_FB_COLS_MAX + 1];
+    uint32_t iter, n, k, changed, before;
+    uint8_t r, c;
+
+    srand(rows * 100 + cols);
+    fake_clear();
+    lcd_fb_init(&fb, rows, cols, fake_cmd, fake_dat, 0);
+    for(iter = 0; iter < 5000; iter++)
+    {
+        n = rand() % 4;
+        for(k = 0; k < n; k++)
+        {
+            r = (uint8_t)(rand() % rows);
+            c = (uint8_t)(rand() % cols);
+            memset(line, 'a' + rand() % 3, sizeof(line));
+            line[rand() % (cols - c) + 1] = '\0';
+            if(rand() % 4 == 0)
+            {
+                lcd_fb_put_line(&fb, r, line);
+            }
+            else
+            {
+                lcd_fb_puts(&fb, r, c, line);
+            }
+        }
+
+        changed = 0;
+        for(r = 0; r < rows; r++)
+        {
+            for(c = 0; c < cols; c++)
+            {
+                changed += fb.draw[r][c] != fb.panel[r][c];
+            }
+        }
+        before = dats;
+        lcd_fb_flush(&fb);
+        CHECK(panel_matches(&fb));
+        CHECK(dats - before <= changed * 2);
+        CHECK(fb.last_bytes <= changed * 2);
+    }
+    CHECK(fb.bytes == cmds + dats);
+}
+
+int main(void)
+{
+    test_shapes();
+    cmds = dats = 0;
+    test_random(2, 16);
+    cmds = dats = 0;
+    test_random(4, 20);
+    TEST_EXIT();
+}
@@ -0,0 +1,74 @@
+/**
+ * @file    test_light_conv.c
+ * @brief   光照换算测试：对全部原始值和百分比穷举检查阈值换算与显示映射一致
+ */
+
+#include "test.h"
+#include "light_conv.h"
+
+static void test_table(void)
+{
+    CHECK(Light_RawToPercent(0) == 100);
+    CHECK(Light_RawToPercent(40) == 100);
+    CHECK(Light_RawToPercent(41) == 99);
+    CHECK(Light_RawToPercent(2048) == 50);
+    CHECK(Light_RawToPercent(4094) == 1);
+    CHECK(Light_RawToPercent(4095) == 0);
+    CHECK(Light_RawToPercent(9999) == 0);
+
+    CHECK(Light_PercentToRaw(100) == 0);
+    CHECK(Light_PercentToRaw(0) == 4095);
+    CHECK(Light_PercentToRaw(200) == 0);
+    CHECK(Light_LowAlarmRaw(0) == LIGHT_RAW_MAX + 1);
+    CHECK(Light_LowAlarmRaw(1) == 4095);
+    CHECK(Light_LowAlarmRaw(101) == 0);
+}
+
+/* 两个换算的定义式对每个原始值都成立 */
+static void test_exhaustive(void)
+{
+    uint16_t raw, thr;
+    uint8_t p;
+
+    for(p = 0; p <= 101; p++)
+    {
+        thr = Light_PercentToRaw(p);
+        for(raw = 0; raw <= LIGHT_RAW_MAX; raw++)
+        {
+            CHECK((Light_RawToPercent(raw) <= p) == (raw >= thr));
+        }
+        thr = Light_LowAlarmRaw(p);
+        for(raw = 0; raw <= LIGHT_RAW_MAX; raw++)
+        {
+            CHECK((Light_RawToPercent(raw) < p) == (raw >= thr));
+        }
+    }
+}
+
+/* 回差41个原始值：低于N%报警后，显示值回到N+1%才解除 */
+static void test_hysteresis(void)
+{
+    uint16_t thr;
+    uint8_t p;
+
+    for(p = 1; p <= 100; p++)
+    {
+        thr = Light_LowAlarmRaw(p);
+        if(thr <= LIGHT_ALARM_HYST_RAW)
+        {
+            continue;
+        }
+        /* 解除条件：原始值 < thr - 回差 */
+        CHECK(Light_RawToPercent(thr - LIGHT_ALARM_HYST_RAW - 1) == p + 1);
+        CHECK(Light_RawToPercent(thr - LIGHT_ALARM_HYST_RAW) <= p + 1);
+        CHECK(Light_RawToPercent(thr) == p - 1);
+    }
+}
+
+int main(void)
+{
+    test_table();
+    test_exhaustive();
+    test_hysteresis();
+    TEST_EXIT();
+}
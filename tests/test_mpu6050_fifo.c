@@ -0,0 +1,171 @@
+/**
+ * @file    test_mpu6050_fifo.c
+ * @brief   MPU6050 FIFO测试：各种FIFO_EN组合的包长和解析、溢出判断，
+ *          以及在一包写到一半时读FIFO_COUNT的模拟数据流不丢包不错位
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "mpu6050_fifo.h"
+
+static void put_be16(uint8_t *p, int16_t v)
+{
+    p[0] = (uint8_t)((uint16_t)v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/* 按寄存器顺序生成一包，第n次采样的各项取可核对的值 */
+static uint8_t make_packet(uint8_t *p, uint8_t fifo_en, int16_t n)
+{
+    uint8_t len = 0, i;
+
+    if(fifo_en & MPU6050_FIFO_ACCEL)
+    {
+        for(i = 0; i < 3; i++)
+        {
+            put_be16(p + len, (int16_t)(n * 3 + i - 20000));
+            len += 2;
+        }
+    }
+    if(fifo_en & MPU6050_FIFO_TEMP)
+    {
+        put_be16(p + len, (int16_t)-n);
+        len += 2;
+    }
+    for(i = 0; i < 3; i++)
+    {
+        if(fifo_en & (MPU6050_FIFO_XG >> i))
+        {
+            put_be16(p + len, (int16_t)(n + 1000 * (i + 1)));
+            len += 2;
+        }
+    }
+    return len;
+}
+
+static int packet_matches(const MPU6050_Raw_t *r, uint8_t fifo_en, int16_t n)
+{
+    uint8_t i;
+
+    for(i = 0; i < 3; i++)
+    {
+        if(r->accel[i] != ((fifo_en & MPU6050_FIFO_ACCEL) ? (int16_t)(n * 3 + i - 20000) : 0))
+        {
+            return 0;
+        }
+        if(r->gyro[i] != ((fifo_en & (MPU6050_FIFO_XG >> i)) ? (int16_t)(n + 1000 * (i + 1)) : 0))
+        {
+            return 0;
+        }
+    }
+    return r->temp == ((fifo_en & MPU6050_FIFO_TEMP) ? (int16_t)-n : 0);
+}
+
+/* 全部32种组合：包长与生成的字节数一致，解析出的值与写入的一致 */
+static void test_parse(void)
+{
+    uint8_t buf[14 * 4];
+    MPU6050_Raw_t out[4];
+    uint8_t en, size, len;
+    int16_t n;
+
+    CHECK(mpu6050_fifo_packet_size(MPU6050_FIFO_ALL) == 14);
+    CHECK(mpu6050_fifo_packet_size(MPU6050_FIFO_ACCEL) == 6);
+    CHECK(mpu6050_fifo_packet_size(0) == 0);
+
+    for(en = 0; en < 32; en++)
+    {
+        uint8_t fifo_en = (uint8_t)(en << 3);
+
+        size = mpu6050_fifo_packet_size(fifo_en);
+        len = 0;
+        for(n = 0; n < 4; n++)
+        {
+            CHECK(make_packet(buf + len, fifo_en, n) == size);
+            len += size;
+        }
+        if(size == 0)
+        {
+            CHECK(mpu6050_fifo_parse(buf, len, fifo_en, out, 4) == 0);
+            continue;
+        }
+        /* 尾部不足一包忽略，max限制包数 */
+        CHECK(mpu6050_fifo_parse(buf, len - 1, fifo_en, out, 4) == 3);
+        CHECK(mpu6050_fifo_parse(buf, len, fifo_en, out, 2) == 2);
+        CHECK(mpu6050_fifo_parse(buf, len, fifo_en, out, 4) == 4);
+        for(n = 0; n < 4; n++)
+        {
+            CHECK(packet_matches(&out[n], fifo_en, n));
+        }
+    }
+}
+
+/* 溢出只看INT_STATUS和写满；计数不是整包的倍数不算溢出 */
+static void test_overflow(void)
+{
+    CHECK(!mpu6050_fifo_overflowed(0x00, 0));
+    CHECK(!mpu6050_fifo_overflowed(0x01, 14 * 5 + 3));        /* 写到一半，DATA_RDY位无关 */
+    CHECK(!mpu6050_fifo_overflowed(0x00, 1023));
+    CHECK(mpu6050_fifo_overflowed(MPU6050_INT_FIFO_OFLOW, 14));
+    CHECK(mpu6050_fifo_overflowed(0x11, 0));
+    CHECK(mpu6050_fifo_overflowed(0x00, MPU6050_FIFO_SIZE));
+
+    CHECK(mpu6050_fifo_burst_len(14 * 5 + 3, 14, 448) == 14 * 5);
+    CHECK(mpu6050_fifo_burst_len(13, 14, 448) == 0);
+    CHECK(mpu6050_fifo_burst_len(1000, 14, 448) == 448);
+    CHECK(mpu6050_fifo_burst_len(1000, 12, 100) == 96);
+    CHECK(mpu6050_fifo_burst_len(100, 0, 448) == 0);
+}
+
+/* 模拟FIFO：采样逐字节写入，读取方在任意时刻读计数，只取整包 */
+static void test_stream(void)
+{
+    static uint8_t fifo[1 << 16];
+    uint8_t pkt[14], buf[448];
+    MPU6050_Raw_t out[32];
+    uint32_t head = 0, tail = 0, wpos = 14, k, i;
+    uint16_t count, len, got;
+    int16_t produced = 0, expect = 0;
+
+    srand(18);
+    for(k = 0; k < 20000; k++)
+    {
+        /* 写入随机个字节，一包可能写到一半 */
+        for(i = rand() % 40; i > 0; i--)
+        {
+            if(wpos == 14)
+            {
+                make_packet(pkt, MPU6050_FIFO_ALL, produced++);
+                wpos = 0;
+            }
+            fifo[head++ & 0xFFFF] = pkt[wpos++];
+        }
+
+        count = (uint16_t)(head - tail);
+        CHECK(count < MPU6050_FIFO_SIZE);
+        CHECK(!mpu6050_fifo_overflowed(0, count));
+        len = mpu6050_fifo_burst_len(count, 14, sizeof(buf));
+        for(i = 0; i < len; i++)
+        {
+            buf[i] = fifo[tail++ & 0xFFFF];
+        }
+        got = mpu6050_fifo_parse(buf, len, MPU6050_FIFO_ALL, out, 32);
+        CHECK(got == len / 14);
+        for(i = 0; i < got; i++)
+        {
+            CHECK(packet_matches(&out[i], MPU6050_FIFO_ALL, expect));
+            expect++;
+        }
+    }
+    /* 读出的包都连续，只差还没写完或还没读的 */
+    CHECK(expect > 10000);
+    CHECK(produced - expect <= (int16_t)((head - tail) / 14 + 1));
+}
+
+int main(void)
+{
+    test_parse();
+    test_overflow();
+    test_stream();
+    TEST_EXIT();
+}
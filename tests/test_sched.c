@@ -0,0 +1,124 @@
+/**
+ * @file    test_sched.c
+ * @brief   调度器测试：虚拟时间模拟10分钟，检查执行次数、丢弃、超时、优先级和毫秒时钟回绕
+ */
+
+#include "test.h"
+#include "sched.h"
+#include "dwt_time.h"
+
+#define CYCLES_PER_MS   168000u
+
+uint32_t SystemCoreClock = 168000000;
+
+static uint32_t vnow;
+static int order[8];
+static int norder;
+
+static uint32_t clk(void)
+{
+    return vnow;
+}
+
+/* 任务执行ms毫秒的虚拟时间 */
+static void burn(uint32_t ms)
+{
+    vnow += ms;
+    time_host_cycles += ms * CYCLES_PER_MS;
+}
+
+static int cnt[4];
+
+static void fast(void) { cnt[0]++; time_host_cycles += 500; }
+static void mid(void) { cnt[1]++; burn(1); }
+static void slow(void) { cnt[2]++; burn(cnt[2] % 50 == 0 ? 120 : 3); }   /* 偶尔执行很久 */
+static void lcd(void) { cnt[3]++; burn(2); }
+
+static void rec0(void) { if(norder < 8) order[norder++] = 0; }
+static void rec1(void) { if(norder < 8) order[norder++] = 1; }
+static void rec2(void) { if(norder < 8) order[norder++] = 2; }
+
+/* 主循环：没有就绪任务时睡到下一个SysTick */
+static void run_for(Sched_t *s, uint32_t ms)
+{
+    uint32_t start = vnow;
+
+    while(vnow - start < ms)
+    {
+        if(!Sched_Run(s))
+        {
+            CHECK(Sched_Next_Release(s, vnow) > 0);
+            burn(1);
+        }
+    }
+}
+
+static void test_simulation(void)
+{
+    Sched_Task_t tasks[] = {
+        {"fast", fast, 5, 0, 0},
+        {"mid", mid, 10, 0, 1},
+        {"slow", slow, 1000, 0, 3},
+        {"lcd", lcd, 50, 0, 5},
+    };
+    Sched_t s;
+    uint32_t i;
+
+    vnow = 0xFFFFF000u;                     /* 模拟过程中毫秒时钟回绕 */
+    Sched_Init(&s, tasks, 4, clk);
+    run_for(&s, 600000);
+
+    for(i = 0; i < 4; i++)
+    {
+        /* 每个释放要么执行要么计入丢弃，不会少也不会多 */
+        CHECK(tasks[i].runs + tasks[i].skipped >= 600000 / tasks[i].period);
+        CHECK(tasks[i].runs + tasks[i].skipped <= 600000 / tasks[i].period + 1);
+        CHECK(tasks[i].runs == (uint32_t)cnt[i]);
+    }
+    /* slow执行120ms时，fast和mid会被拖过整周期，丢弃的释放计入skipped */
+    CHECK(tasks[0].skipped > 0 && tasks[1].skipped > 0);
+    CHECK(tasks[0].overruns > 0);
+    CHECK(tasks[2].skipped == 0 && tasks[2].overruns == 0);
+    CHECK(tasks[0].max_latency >= 115 && tasks[0].max_latency <= 125);
+    /* 执行周期数来自DWT */
+    CHECK(Sched_Avg_Cycles(&tasks[0]) == 500);
+    CHECK(tasks[1].max_cycles == CYCLES_PER_MS);
+    CHECK(tasks[2].max_cycles == 120 * CYCLES_PER_MS);
+
+    Sched_Reset_Stats(&s);
+    CHECK(tasks[0].runs == 0 && tasks[2].max_cycles == 0 && Sched_Avg_Cycles(&tasks[0]) == 0);
+}
+
+static void test_order(void)
+{
+    Sched_Task_t tasks[] = {
+        {"a", rec0, 100, 0, 2},
+        {"b", rec1, 100, 30, 1},
+        {"c", rec2, 100, 20, 1},
+    };
+    Sched_t s;
+
+    /* 优先级相同时截止时间早的先执行，优先级低的最后 */
+    vnow = 1000;
+    norder = 0;
+    Sched_Init(&s, tasks, 3, clk);
+    CHECK(Sched_Ready(&s, vnow) == 2);
+    while(Sched_Run(&s))
+    {
+    }
+    CHECK(norder == 3 && order[0] == 2 && order[1] == 1 && order[2] == 0);
+
+    /* 释放时刻按周期对齐 */
+    CHECK(Sched_Next_Release(&s, vnow) == 100);
+    CHECK(Sched_Ready(&s, vnow + 99) == SCHED_NONE);
+    vnow += 137;
+    CHECK(Sched_Run(&s));
+    CHECK(tasks[2].release == 1200 && tasks[2].max_latency == 37);
+}
+
+int main(void)
+{
+    test_simulation();
+    test_order();
+    TEST_EXIT();
+}
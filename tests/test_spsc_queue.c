@@ -0,0 +1,128 @@
+/**
+ * @file    test_spsc_queue.c
+ * @brief   SPSC队列测试：边界情况和两个线程并发读写
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "test.h"
+#include "spsc_queue.h"
+
+#define STRESS_BYTES    (1u << 20)
+
+static uint8_t stress_buf[64];
+static SPSC_Queue_t stress_q;
+static volatile int stress_errors;
+
+/* 生产者：按序写入递增序列，块长度不断变化，队列满时重试余下部分 */
+static void *producer(void *arg)
+{
+    uint8_t chunk[37];
+    uint32_t sent = 0, n, i, done;
+
+    (void)arg;
+    while(sent < STRESS_BYTES)
+    {
+        n = 1 + sent % sizeof(chunk);
+        if(n > STRESS_BYTES - sent)
+        {
+            n = STRESS_BYTES - sent;
+        }
+        for(i = 0; i < n; i++)
+        {
+            chunk[i] = (uint8_t)(sent + i);
+        }
+        done = 0;
+        while(done < n)
+        {
+            /* 只写有空位的部分，避免计入dropped */
+            uint32_t room = SPSC_Free(&stress_q);
+            if(room > n - done)
+            {
+                room = n - done;
+            }
+            if(room == 0)
+            {
+                sched_yield();
+            }
+            done += SPSC_Write(&stress_q, chunk + done, room);
+        }
+        sent += n;
+    }
+    return 0;
+}
+
+/* 消费者：逐段读出并检查序列连续 */
+static void *consumer(void *arg)
+{
+    uint8_t chunk[29];
+    uint32_t got = 0, n, i;
+
+    (void)arg;
+    while(got < STRESS_BYTES)
+    {
+        n = SPSC_Read(&stress_q, chunk, 1 + got % sizeof(chunk));
+        if(n == 0)
+        {
+            sched_yield();
+        }
+        for(i = 0; i < n; i++)
+        {
+            if(chunk[i] != (uint8_t)(got + i))
+            {
+                stress_errors++;
+            }
+        }
+        got += n;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    SPSC_Queue_t q;
+    uint8_t buf[8], out[16], ch;
+    uint8_t data[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    SPSC_Queue_t init = SPSC_INITIALIZER(buf, sizeof(buf));
+    pthread_t p, c;
+
+    CHECK(SPSC_Init(&q, buf, 6) == 1);
+    CHECK(SPSC_Init(&q, buf, 0) == 1);
+    CHECK(SPSC_Init(&q, buf, sizeof(buf)) == 0);
+    CHECK(memcmp(&init, &q, sizeof(q)) == 0);
+
+    /* 空队列 */
+    CHECK(SPSC_Count(&q) == 0 && SPSC_Free(&q) == 8);
+    CHECK(SPSC_Get(&q, &ch) == 0);
+
+    /* 写满后多余的丢弃并计数 */
+    CHECK(SPSC_Write(&q, data, 12) == 8);
+    CHECK(q.dropped == 4);
+    CHECK(SPSC_Put(&q, 99) == 0 && q.dropped == 5);
+    CHECK(SPSC_Count(&q) == 8 && SPSC_Free(&q) == 0);
+
+    /* 读出部分后写入，跨过缓冲区末尾回绕 */
+    CHECK(SPSC_Read(&q, out, 5) == 5 && memcmp(out, data, 5) == 0);
+    CHECK(SPSC_Write(&q, data + 8, 4) == 4);
+    CHECK(SPSC_Read(&q, out, 16) == 7);
+    CHECK(memcmp(out, data + 5, 7) == 0);
+
+    /* 索引接近32位上限时的回绕 */
+    q.head = q.tail = 0xFFFFFFFEu;
+    CHECK(SPSC_Write(&q, data, 5) == 5 && SPSC_Count(&q) == 5);
+    CHECK(SPSC_Read(&q, out, 5) == 5 && memcmp(out, data, 5) == 0);
+    CHECK(q.head == 3 && SPSC_Count(&q) == 0);
+
+    /* 两个线程并发，验证数据不丢失、不乱序 */
+    CHECK(SPSC_Init(&stress_q, stress_buf, sizeof(stress_buf)) == 0);
+    pthread_create(&p, 0, producer, 0);
+    pthread_create(&c, 0, consumer, 0);
+    pthread_join(p, 0);
+    pthread_join(c, 0);
+    CHECK(stress_errors == 0);
+    CHECK(stress_q.dropped == 0);
+    CHECK(SPSC_Count(&stress_q) == 0);
+
+    TEST_EXIT();
+}
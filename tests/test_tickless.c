@@ -0,0 +1,200 @@
+/**
+ * @file    test_tickless.c
+ * @brief   无节拍空闲测试：按时钟周期模拟SysTick，反复睡眠/唤醒后tick边界不漂移，以及RTC换算
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "tickless.h"
+
+#define TICK_CYCLES     168000u     /* 168MHz，1ms */
+
+/* SysTick模型：使能时每个时钟，VAL为0则装入LOAD，否则减1，减到0时置COUNTFLAG并挂起中断 */
+static uint32_t st_load, st_val, st_enable, st_countflag, st_events;
+static uint64_t now;
+
+static void clk(uint64_t n)
+{
+    uint64_t step;
+
+    while(n)
+    {
+        if(!st_enable)
+        {
+            now += n;
+            return;
+        }
+        if(st_val == 0)
+        {
+            st_val = st_load;
+            now++;
+            n--;
+            continue;
+        }
+        step = st_val < n ? st_val : n;
+        st_val -= (uint32_t)step;
+        now += step;
+        n -= step;
+        if(st_val == 0)
+        {
+            st_countflag = 1;
+            st_events++;
+        }
+    }
+}
+
+/* 下一次SysTick中断的时刻 */
+static uint64_t next_event(void)
+{
+    return now + (st_val ? st_val : (uint64_t)st_load + 1);
+}
+
+/* 与power.c中Power_Idle相同的步骤，计数器停止期间入睡丢失gap_in个时钟，醒来丢失gap_out个 */
+static uint32_t idle(Tickless_t *t, uint32_t ms, uint32_t gap_in, uint32_t gap_out, uint8_t early)
+{
+    uint32_t ticks = ms, load, val, next, complete;
+    uint8_t expired;
+
+    st_enable = 0;
+    clk(gap_in);
+    load = tickless_sleep_load(t, &ticks, st_val);
+    st_load = load;
+    st_val = 0;
+    st_enable = 1;
+    st_countflag = 0;
+    st_events = 0;
+
+    /* 到期后几个时钟内醒来（少于TICKLESS_LOAD_MIN），或被其它中断提前唤醒 */
+    clk(early ? (uint64_t)rand() % ((uint64_t)load + 1) : (uint64_t)load + 1 + rand() % 50);
+
+    expired = (uint8_t)st_countflag;
+    st_countflag = 0;
+    st_enable = 0;
+    clk(gap_out);
+    val = st_val;
+    complete = tickless_wake(t, ticks, load, val, expired, &next);
+
+    st_load = next;
+    st_val = 0;
+    st_enable = 1;
+    clk(1);
+    st_load = t->tick_cycles - 1;
+    /* 挂起的SysTick中断再加1 */
+    return complete + (st_events ? 1 : 0);
+}
+
+static void test_sleep_load(void)
+{
+    Tickless_t t;
+    uint32_t ticks, load;
+
+    tickless_init(&t, TICK_CYCLES, 48);
+    CHECK(t.max_ticks == 99);
+
+    ticks = 0;
+    load = tickless_sleep_load(&t, &ticks, 1000);
+    CHECK(ticks == 1 && load == 1000 - 49);
+
+    ticks = 500;
+    load = tickless_sleep_load(&t, &ticks, 1000);
+    CHECK(ticks == 99 && load == 1000 + 98 * TICK_CYCLES - 49);
+    CHECK(load <= TICKLESS_SYSTICK_MAX);
+
+    /* VAL为0：刚重装，还剩整个tick */
+    ticks = 99;
+    load = tickless_sleep_load(&t, &ticks, 0);
+    CHECK(ticks == 99 && load == 99 * TICK_CYCLES - 49 && load <= TICKLESS_SYSTICK_MAX);
+
+    /* 当前tick马上结束，睡到下一个边界 */
+    ticks = 1;
+    load = tickless_sleep_load(&t, &ticks, 49 + TICKLESS_LOAD_MIN - 1);
+    CHECK(ticks == 2 && load == TICK_CYCLES + TICKLESS_LOAD_MIN - 1);
+    ticks = 1;
+    load = tickless_sleep_load(&t, &ticks, 49 + TICKLESS_LOAD_MIN);
+    CHECK(ticks == 1 && load == TICKLESS_LOAD_MIN);
+}
+
+static void test_simulation(void)
+{
+    static const uint32_t gaps[][2] = { {0, 0}, {24, 24}, {48, 0}, {0, 48}, {10, 30} };
+    Tickless_t t;
+    uint64_t system_tick;
+    uint32_t g, i, early_wakes;
+    int64_t err, max_err;
+
+    for(g = 0; g < sizeof(gaps) / sizeof(gaps[0]); g++)
+    {
+        srand(22 + g);
+        tickless_init(&t, TICK_CYCLES, gaps[g][0] + gaps[g][1]);
+        st_load = TICK_CYCLES - 1;
+        st_val = 0;
+        st_enable = 1;
+        now = 0;
+        system_tick = 0;
+        max_err = 0;
+        early_wakes = 0;
+
+        for(i = 0; i < 200000; i++)
+        {
+            /* 醒着运行一段时间，tick中断正常计数 */
+            st_events = 0;
+            clk((uint64_t)rand() % 400000);
+            system_tick += st_events;
+
+            early_wakes += (i % 3 == 0);
+            system_tick += idle(&t, 1 + rand() % 150, gaps[g][0], gaps[g][1], i % 3 == 0);
+
+            /* 下一次中断应正好落在第system_tick+1个tick边界上 */
+            err = (int64_t)next_event() - (int64_t)(system_tick + 1) * TICK_CYCLES;
+            if(err < 0)
+            {
+                err = -err;
+            }
+            if(err > max_err)
+            {
+                max_err = err;
+            }
+        }
+        if(max_err)
+        {
+            printf("  gap %u/%u: max error %lld cycles\n", (unsigned)gaps[g][0], (unsigned)gaps[g][1],
+                   (long long)max_err);
+        }
+        CHECK(max_err == 0);
+        CHECK(early_wakes > 0);
+    }
+}
+
+static void test_rtc(void)
+{
+    uint32_t frac, total, start, end, i;
+
+    CHECK(tickless_rtc_counts(0, 2048, 65536) == 1);
+    CHECK(tickless_rtc_counts(20, 2048, 65536) == 40);
+    CHECK(tickless_rtc_counts(1000, 2048, 65536) == 2048);
+    CHECK(tickless_rtc_counts(100000, 2048, 65536) == 65536);
+
+    /* 跨午夜：23:59:59的亚秒100到00:00:00的亚秒4045，共151个亚秒 */
+    frac = 0;
+    start = tickless_rtc_stamp(86399, 100, 4095);
+    end = tickless_rtc_stamp(0, 4045, 4095);
+    CHECK(tickless_rtc_elapsed_ms(start, end, 4095, &frac) == 151000 / 4096);
+    CHECK(frac == 151000 % 4096);
+
+    /* 不足1ms的余数累计，长时间不漂移 */
+    frac = 0;
+    total = 0;
+    for(i = 0; i < 100000; i++)
+    {
+        total += tickless_rtc_elapsed_ms(0, 7, 4095, &frac);
+    }
+    CHECK(total == 700000u * 1000u / 4096u);
+}
+
+int main(void)
+{
+    test_sleep_load();
+    test_simulation();
+    test_rtc();
+    TEST_EXIT();
+}
@@ -0,0 +1,309 @@
+/**
+ * @file    test_timer_wheel.c
+ * @brief   时间轮测试：基本启停、锁、数千个定时器逐毫秒准点到期、按Next睡眠和大跨度跳跃不漏不早
+ */
+
+#include <stdlib.h>
+#include "test.h"
+#include "timer_wheel.h"
+
+#define N   3000
+
+static uint32_t vnow;
+static Timer_Wheel_t w;
+static Timer_t tm[N];
+static uint32_t expect[N], period[N], fires[N];
+static uint8_t armed[N];
+static uint8_t exact;               /* 逐毫秒推进时要求正好在到期时刻执行 */
+static uint32_t locks, unlocks;
+
+static uint32_t clk(void)
+{
+    return vnow;
+}
+
+static uint32_t rnd(void)
+{
+    return (uint32_t)rand() ^ ((uint32_t)rand() << 15);
+}
+
+static void lock(void)
+{
+    locks++;
+}
+
+static void unlock(void)
+{
+    unlocks++;
+}
+
+/* 在回调里启动/停止定时器：arg为要操作的定时器 */
+static void restart_self(void *arg)
+{
+    fires[0]++;
+    if(fires[0] < 3)
+    {
+        Timer_Start(&w, (Timer_t *)arg, 5, 0);
+    }
+}
+
+static void stop_other(void *arg)
+{
+    fires[1]++;
+    Timer_Stop(&w, (Timer_t *)arg);
+}
+
+static void count(void *arg)
+{
+    (void)arg;
+    fires[2]++;
+}
+
+static void test_basic(void)
+{
+    Timer_t a, b, c;
+
+    vnow = 1000;
+    fires[0] = fires[1] = fires[2] = 0;
+    Timer_Wheel_Init(&w, clk);
+    CHECK(Timer_Wheel_Next(&w) == TIMER_NEVER);
+
+    Timer_Init(&a, restart_self, &a);
+    Timer_Init(&b, stop_other, &c);
+    Timer_Init(&c, count, 0);
+    CHECK(!Timer_Pending(&a));
+
+    Timer_Start(&w, &a, 10, 0);
+    Timer_Start(&w, &b, 20, 0);
+    Timer_Start(&w, &c, 20, 0);
+    CHECK(Timer_Pending(&a) && Timer_Wheel_Next(&w) == 10);
+
+    /* 重复启动按新参数，停止未启动的不做任何事 */
+    Timer_Start(&w, &a, 3, 0);
+    Timer_Stop(&w, &a);
+    Timer_Stop(&w, &a);
+    CHECK(!Timer_Pending(&a));
+    Timer_Start(&w, &a, 3, 0);
+
+    vnow += 2;
+    CHECK(Timer_Wheel_Run(&w) == 0 && Timer_Wheel_Next(&w) == 1);
+    vnow += 1;
+    CHECK(Timer_Wheel_Run(&w) == 1 && fires[0] == 1 && Timer_Pending(&a));
+    /* 回调中启动的定时器从现在算起：追赶时间时也不会提前 */
+    vnow += 10;
+    CHECK(Timer_Wheel_Run(&w) == 1 && fires[0] == 2 && a.expires == vnow + 5);
+    vnow += 5;
+    CHECK(Timer_Wheel_Run(&w) == 1 && fires[0] == 3 && !Timer_Pending(&a));
+
+    /* 同一时刻到期，b的回调停掉c，c不再执行（b、c谁先到期都不应重复执行） */
+    vnow += 2;
+    Timer_Wheel_Run(&w);
+    CHECK(fires[1] == 1 && fires[2] <= 1 && !Timer_Pending(&c));
+    CHECK(Timer_Wheel_Next(&w) == TIMER_NEVER);
+
+    /* 周期定时器落后多个周期：到期执行一次，丢弃的释放之后只补执行一次，之后按到期时刻对齐 */
+    Timer_Start(&w, &c, 10, 10);
+    fires[2] = 0;
+    vnow += 55;
+    CHECK(Timer_Wheel_Run(&w) == 2 && fires[2] == 2);
+    CHECK(c.expires == vnow + 5);
+
+    /* 锁只在操作时间轮时持有，回调执行时不持有 */
+    Timer_Wheel_Set_Lock(&w, lock, unlock);
+    locks = unlocks = 0;
+    Timer_Stop(&w, &c);
+    Timer_Start(&w, &c, 1, 0);
+    vnow += 1;
+    Timer_Wheel_Run(&w);
+    CHECK(locks > 0 && locks == unlocks);
+}
+
+/* 随机测试的回调：检查到期时刻，并随机启停其它定时器 */
+static void random_cb(void *arg)
+{
+    int i = (int)(long)arg, j;
+    uint32_t d, e;
+
+    CHECK(armed[i]);
+    CHECK(!exact || vnow == expect[i]);
+    CHECK((int32_t)(vnow - expect[i]) >= 0);
+    fires[i]++;
+
+    if(period[i])
+    {
+        e = expect[i] + period[i];
+        if((int32_t)(vnow - e) >= (int32_t)period[i])
+        {
+            e += (vnow - e) / period[i] * period[i];
+        }
+        expect[i] = e;
+        CHECK(tm[i].expires == e);
+    }
+    else
+    {
+        armed[i] = 0;
+    }
+
+    if(rnd() % 8 == 0)
+    {
+        j = rnd() % N;
+        Timer_Stop(&w, &tm[j]);
+        armed[j] = 0;
+    }
+    if(rnd() % 8 == 0)
+    {
+        j = rnd() % N;
+        d = 1 + rnd() % 5000;
+        period[j] = (rnd() % 4 == 0) ? 1 + rnd() % 300 : 0;
+        Timer_Start(&w, &tm[j], d, period[j]);
+        expect[j] = vnow + d;
+        armed[j] = 1;
+    }
+}
+
+/* 各级计数与链表一致，Pending与期望一致 */
+static void check_wheel(void)
+{
+    uint32_t lv, s, n, total = 0, pending = 0;
+    const Timer_t *t;
+    int i;
+
+    for(lv = 0; lv < TIMER_WHEEL_LEVELS; lv++)
+    {
+        n = 0;
+        for(s = 0; s < TIMER_WHEEL_SLOTS; s++)
+        {
+            for(t = w.slots[lv][s]; t; t = t->next)
+            {
+                n++;
+            }
+        }
+        CHECK(n == w.count[lv]);
+        total += n;
+    }
+    for(i = 0; i < N; i++)
+    {
+        CHECK(armed[i] == Timer_Pending(&tm[i]));
+        pending += armed[i];
+    }
+    CHECK(pending == total);
+}
+
+/* 已到期的定时器都已执行 */
+static uint8_t none_overdue(void)
+{
+    int i;
+
+    for(i = 0; i < N; i++)
+    {
+        if(armed[i] && (int32_t)(vnow - expect[i]) >= 0)
+        {
+            printf("  timer %d overdue: now %u expires %u\n", i, (unsigned)vnow, (unsigned)expect[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_random(void)
+{
+    uint32_t step, nx, adv, d, f, fired = 0;
+    int i, k, j;
+
+    srand(23);
+    vnow = 0xFFF00000u;                 /* 模拟过程中毫秒时钟回绕 */
+    Timer_Wheel_Init(&w, clk);
+    for(i = 0; i < N; i++)
+    {
+        /* 十分之一超出一次可放置的范围 */
+        d = (i % 10 == 0) ? rnd() % (TIMER_WHEEL_RANGE * 3) : rnd() % 70000;
+        period[i] = (i % 7 == 0) ? 1 + rnd() % 2000 : 0;
+        Timer_Init(&tm[i], random_cb, (void *)(long)i);
+        Timer_Start(&w, &tm[i], d, period[i]);
+        expect[i] = vnow + d;
+        armed[i] = 1;
+        fires[i] = 0;
+    }
+    Timer_Wheel_Run(&w);
+
+    /* 逐毫秒推进：准点到期，有到期时Next为0 */
+    exact = 1;
+    for(step = 0; step < 100000; step++)
+    {
+        vnow++;
+        nx = Timer_Wheel_Next(&w);
+        for(i = 0; i < N; i++)
+        {
+            if(armed[i] && expect[i] == vnow)
+            {
+                CHECK(nx == 0);
+                break;
+            }
+        }
+        fired += Timer_Wheel_Run(&w);
+        if(!none_overdue())
+        {
+            CHECK(0);
+            return;
+        }
+        if(step % 10000 == 0)
+        {
+            check_wheel();
+        }
+    }
+    CHECK(fired > 10000);
+
+    /* 按Next睡眠，随机提前醒来或一次跳过很久（长时间Stop模式） */
+    exact = 0;
+    for(step = 0; step < 50000; step++)
+    {
+        nx = Timer_Wheel_Next(&w);
+        if(nx == TIMER_NEVER)
+        {
+            nx = 100000;
+        }
+        switch(rnd() % 4)
+        {
+            case 0:  adv = nx ? 1 + rnd() % nx : 1; break;
+            case 1:  adv = rnd() % 3000000; break;
+            default: adv = nx; break;
+        }
+        vnow += adv;
+        f = Timer_Wheel_Run(&w);
+        if(nx > 1 && adv < nx)
+        {
+            /* Next可能早于实际到期，不会晚于：提前醒来时不应有回调 */
+            CHECK(f == 0);
+            continue;
+        }
+        if(!none_overdue())
+        {
+            CHECK(0);
+            return;
+        }
+        if(step % 5000 == 0)
+        {
+            check_wheel();
+        }
+        if(rnd() % 50 == 0)
+        {
+            for(k = 0; k < 200; k++)
+            {
+                j = rnd() % N;
+                d = rnd() % (TIMER_WHEEL_RANGE * 2);
+                period[j] = (rnd() % 3 == 0) ? 1 + rnd() % 100000 : 0;
+                Timer_Start(&w, &tm[j], d, period[j]);
+                expect[j] = vnow + d;
+                armed[j] = 1;
+            }
+        }
+    }
+    check_wheel();
+}
+
+int main(void)
+{
+    test_basic();
+    test_random();
+    TEST_EXIT();
+}
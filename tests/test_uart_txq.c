@@ -0,0 +1,303 @@
+/**
+ * @file    test_uart_txq.c
+ * @brief   UART发送队列测试：用模拟DMA代替外设，DMA完成时按中断服务函数的顺序
+ *          调用ChunkDone和Kick，检查入队、分段连续发送、回绕、队列满丢弃和统计
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "uart_txq.h"
+
+#define STREAM_MAX  100000
+
+static UART_TxQueue_t q;
+static uint8_t qbuf[256];
+
+/* 模拟DMA：记录当前正在发送的段 */
+static const uint8_t *dma_data;
+static uint16_t dma_len;
+static uint32_t dma_starts;
+static uint16_t dma_max_len;
+
+/* 线路上收到的数据 */
+static uint8_t wire[STREAM_MAX];
+static uint32_t wire_len;
+
+/* 发送端的第i个字节 */
+static uint8_t stream_byte(uint32_t i)
+{
+    return (uint8_t)(i * 167u + (i >> 8) + 3u);
+}
+
+static void dma_start(void *ctx, const uint8_t *data, uint16_t len)
+{
+    CHECK(ctx == &q);
+    CHECK(dma_len == 0);                    /* 不会在DMA忙时再次启动 */
+    CHECK(len > 0);
+    CHECK(data >= q.buf && data + len <= q.buf + q.size);  /* 连续段不跨越缓冲区末尾 */
+    dma_data = data;
+    dma_len = len;
+    dma_starts++;
+    if(len > dma_max_len)
+    {
+        dma_max_len = len;
+    }
+}
+
+/* 模拟DMA传输完成中断：数据上线，释放并启动下一段 */
+static void dma_complete(void)
+{
+    CHECK(dma_len != 0);
+    memcpy(wire + wire_len, dma_data, dma_len);
+    wire_len += dma_len;
+    dma_len = 0;
+    UART_TxQueue_ChunkDone(&q);
+    UART_TxQueue_Kick(&q, dma_start, &q);
+}
+
+/* 模拟UART_Write：入队后启动DMA */
+static uint16_t uart_write(const uint8_t *data, uint16_t len)
+{
+    uint16_t n = UART_TxQueue_Write(&q, data, len);
+    UART_TxQueue_Kick(&q, dma_start, &q);
+    return n;
+}
+
+static void drain(void)
+{
+    while(dma_len != 0)
+    {
+        dma_complete();
+    }
+}
+
+static void reset(uint16_t size, uint16_t max_chunk)
+{
+    UART_TxQueue_Init(&q, qbuf, size, max_chunk);
+    dma_len = 0;
+    dma_starts = 0;
+    dma_max_len = 0;
+    wire_len = 0;
+}
+
+/* 入队即启动DMA，发送期间追加的数据在完成中断里连续发出 */
+static void test_enqueue_chain(void)
+{
+    uint8_t data[64];
+    UART_TxStats_t st;
+    uint32_t i;
+
+    for(i = 0; i < sizeof(data); i++)
+    {
+        data[i] = stream_byte(i);
+    }
+    reset(128, 0);
+
+    CHECK(uart_write(data, 10) == 10);
+    CHECK(dma_starts == 1 && dma_len == 10);
+    CHECK(UART_TxQueue_Depth(&q) == 10);
+
+    /* DMA忙：只入队，不启动 */
+    CHECK(uart_write(data + 10, 20) == 20);
+    CHECK(uart_write(data + 30, 5) == 5);
+    CHECK(dma_starts == 1);
+    CHECK(UART_TxQueue_Depth(&q) == 35);
+
+    /* 第一段完成后，发送期间追加的25字节作为一段发出 */
+    dma_complete();
+    CHECK(dma_starts == 2 && dma_len == 25);
+    CHECK(UART_TxQueue_Depth(&q) == 25);
+    dma_complete();
+    CHECK(dma_len == 0);
+    CHECK(UART_TxQueue_Depth(&q) == 0);
+
+    CHECK(wire_len == 35);
+    CHECK(memcmp(wire, data, 35) == 0);
+
+    UART_TxQueue_GetStats(&q, &st);
+    CHECK(st.depth == 0);
+    CHECK(st.sent == 35);
+    CHECK(st.dropped == 0);
+    CHECK(st.high_water == 35);
+
+    /* 队列为空时完成中断不再启动 */
+    UART_TxQueue_Kick(&q, dma_start, &q);
+    CHECK(dma_starts == 2);
+}
+
+/* 数据跨越缓冲区末尾时分两段发送 */
+static void test_wrap(void)
+{
+    uint8_t data[64];
+    uint32_t i;
+
+    for(i = 0; i < sizeof(data); i++)
+    {
+        data[i] = stream_byte(i);
+    }
+    reset(32, 0);
+
+    /* 把读写位置推进到24 */
+    uart_write(data, 24);
+    drain();
+    wire_len = 0;
+    dma_starts = 0;
+
+    /* 20字节：8字节到末尾，12字节从头开始 */
+    CHECK(uart_write(data, 20) == 20);
+    CHECK(dma_len == 8);
+    CHECK(dma_data == qbuf + 24);
+    dma_complete();
+    CHECK(dma_len == 12);
+    CHECK(dma_data == qbuf);
+    dma_complete();
+    CHECK(dma_starts == 2);
+    CHECK(wire_len == 20);
+    CHECK(memcmp(wire, data, 20) == 0);
+}
+
+/* 单段长度受max_chunk限制 */
+static void test_max_chunk(void)
+{
+    uint8_t data[200];
+    uint32_t i;
+
+    for(i = 0; i < sizeof(data); i++)
+    {
+        data[i] = stream_byte(i);
+    }
+    reset(256, 64);
+
+    CHECK(uart_write(data, 200) == 200);
+    CHECK(dma_len == 64);
+    drain();
+    CHECK(dma_starts == 4);                 /* 64+64+64+8 */
+    CHECK(dma_max_len == 64);
+    CHECK(wire_len == 200);
+    CHECK(memcmp(wire, data, 200) == 0);
+}
+
+/* 队列满时截断，多出的字节计入dropped，high_water记录峰值 */
+static void test_full(void)
+{
+    uint8_t data[100];
+    UART_TxStats_t st;
+    uint32_t i;
+
+    for(i = 0; i < sizeof(data); i++)
+    {
+        data[i] = stream_byte(i);
+    }
+    reset(64, 16);
+
+    /* 可用容量63 */
+    CHECK(uart_write(data, 50) == 50);
+    CHECK(uart_write(data + 50, 30) == 13);
+    CHECK(UART_TxQueue_Depth(&q) == 63);
+    CHECK(uart_write(data + 63, 5) == 0);
+
+    UART_TxQueue_GetStats(&q, &st);
+    CHECK(st.depth == 63);
+    CHECK(st.high_water == 63);
+    CHECK(st.dropped == 17 + 5);
+    CHECK(st.sent == 0);
+
+    /* 发完一段后腾出的空间可以再写入 */
+    dma_complete();
+    CHECK(UART_TxQueue_Depth(&q) == 47);
+    CHECK(uart_write(data + 63, 16) == 16);
+    CHECK(UART_TxQueue_Depth(&q) == 63);
+    drain();
+
+    UART_TxQueue_GetStats(&q, &st);
+    CHECK(st.depth == 0);
+    CHECK(st.high_water == 63);             /* 峰值不随发送减小 */
+    CHECK(st.dropped == 22);
+    CHECK(st.sent == 79);
+    CHECK(wire_len == 79);
+    CHECK(memcmp(wire, data, 79) == 0);
+
+    /* 重新初始化清零统计 */
+    reset(64, 16);
+    UART_TxQueue_GetStats(&q, &st);
+    CHECK(st.high_water == 0 && st.dropped == 0 && st.sent == 0);
+}
+
+/* 随机交替写入和DMA完成：未丢弃的字节按顺序上线，统计与实际一致 */
+static void test_random(void)
+{
+    static const uint16_t sizes[] = { 256, 97, 16, 2 };
+    static const uint16_t chunks[] = { 0, 32, 5, 1 };
+    uint8_t data[80];
+    UART_TxStats_t st;
+    uint32_t s, i, n, step;
+    uint32_t accepted, dropped;
+    uint16_t depth, peak;
+
+    srand(7);
+    for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        reset(sizes[s], chunks[s]);
+        accepted = 0;
+        dropped = 0;
+        peak = 0;
+
+        for(step = 0; step < 20000 && accepted < STREAM_MAX - 256; step++)
+        {
+            if(rand() % 3 == 0 && dma_len != 0)
+            {
+                dma_complete();
+            }
+            else
+            {
+                n = (uint32_t)rand() % sizeof(data);
+                for(i = 0; i < n; i++)
+                {
+                    data[i] = stream_byte(accepted + i);
+                }
+                i = uart_write(data, (uint16_t)n);
+                accepted += i;
+                dropped += n - i;
+            }
+
+            depth = UART_TxQueue_Depth(&q);
+            CHECK(depth <= sizes[s] - 1);
+            CHECK(depth == accepted - wire_len);
+            if(depth > peak)
+            {
+                peak = depth;
+            }
+            if(chunks[s] != 0)
+            {
+                CHECK(dma_len <= chunks[s]);
+            }
+        }
+        drain();
+
+        UART_TxQueue_GetStats(&q, &st);
+        CHECK(st.depth == 0);
+        CHECK(st.sent == accepted);
+        CHECK(st.dropped == dropped);
+        CHECK(st.high_water == peak);
+        CHECK(wire_len == accepted);
+        for(i = 0; i < wire_len; i++)
+        {
+            if(wire[i] != stream_byte(i))
+            {
+                CHECK(wire[i] == stream_byte(i));
+                break;
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    test_enqueue_chain();
+    test_wrap();
+    test_max_chunk();
+    test_full();
+    test_random();
+    TEST_EXIT();
+}